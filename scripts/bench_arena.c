@@ -0,0 +1,175 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/** @file bench_arena.c
+ *  @brief Benchmark of commit parsing during a revision walk
+ *
+ *  Walks all commits reachable from HEAD and reads the author of
+ *  each commit in three ways, with the walk alone as a baseline:
+ *
+ *  walk:   no commit is read, the cost of the revision walk itself
+ *  lookup: git_commit_lookup (full parse, object cache)
+ *  quick:  git_commit__parse_ext with GIT_COMMIT_PARSE_QUICK
+ *  arena:  git_commit__parse_pool, the pool is cleared per batch
+ *
+ *  The number of calls to malloc, calloc, realloc and strdup is
+ *  counted by linking with '-Wl,--wrap=malloc,...'. Run with 'make
+ *  bench_arena REPO=path'. The output is tab separated with one row
+ *  per method.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "git2.h"
+#include "commit.h"
+#include "odb.h"
+#include "pool.h"
+
+#define BATCH 1024
+
+static size_t n_alloc = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+char *__real_strdup(const char *s);
+
+void *__wrap_malloc(size_t size) {n_alloc++; return __real_malloc(size);}
+void *__wrap_calloc(size_t nmemb, size_t size) {n_alloc++; return __real_calloc(nmemb, size);}
+void *__wrap_realloc(void *ptr, size_t size) {n_alloc++; return __real_realloc(ptr, size);}
+char *__wrap_strdup(const char *s) {n_alloc++; return __real_strdup(s);}
+
+enum {METHOD_WALK, METHOD_LOOKUP, METHOD_QUICK, METHOD_ARENA};
+static const char *method_names[] = {"walk", "lookup", "quick", "arena"};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static int walk(const char *path, int method, size_t *n_commits, size_t *n_bytes)
+{
+    int err;
+    size_t n = 0;
+    git_oid oid;
+    git_repository *repository = NULL;
+    git_revwalk *walker = NULL;
+    git_odb *odb = NULL;
+    git_pool pool;
+
+    git_pool_init(&pool, 1);
+    *n_bytes = 0;
+
+    if ((err = git_repository_open(&repository, path)) < 0 ||
+        (err = git_repository_odb(&odb, repository)) < 0 ||
+        (err = git_revwalk_new(&walker, repository)) < 0 ||
+        (err = git_revwalk_push_head(walker)) < 0)
+        goto cleanup;
+
+    while (!(err = git_revwalk_next(&oid, walker))) {
+        git_commit *commit = NULL;
+        git_odb_object *obj = NULL;
+
+        if (method == METHOD_WALK) {
+            /* Baseline, only the revision walk */
+        } else if (method == METHOD_LOOKUP) {
+            if ((err = git_commit_lookup(&commit, repository, &oid)) < 0)
+                goto cleanup;
+            *n_bytes += strlen(git_commit_author(commit)->name);
+            git_commit_free(commit);
+        } else {
+            if ((err = git_odb_read(&obj, odb, &oid)) < 0)
+                goto cleanup;
+
+            if (method == METHOD_QUICK) {
+                commit = calloc(1, sizeof(git_commit));
+                err = git_commit__parse_ext(commit, obj, GIT_COMMIT_PARSE_QUICK);
+            } else {
+                err = git_commit__parse_pool(&commit, obj, &pool);
+            }
+
+            git_odb_object_free(obj);
+            if (err < 0)
+                goto cleanup;
+
+            *n_bytes += strlen(git_commit_author(commit)->name);
+
+            if (method == METHOD_QUICK)
+                git_commit__free(commit);
+            else if (((n + 1) % BATCH) == 0)
+                git_pool_clear(&pool);
+        }
+
+        n++;
+    }
+
+    if (err == GIT_ITEROVER)
+        err = 0;
+
+cleanup:
+    git_pool_clear(&pool);
+    git_revwalk_free(walker);
+    git_odb_free(odb);
+    git_repository_free(repository);
+    *n_commits = n;
+
+    return err;
+}
+
+int main(int argc, char *argv[])
+{
+    int method;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <repository>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    git_libgit2_init();
+
+    printf("method\tcommits\tallocations\tallocations_per_commit\tseconds\n");
+    for (method = METHOD_WALK; method <= METHOD_ARENA; method++) {
+        size_t n_commits = 0, n_bytes = 0, n_start;
+        double t_start, t_end;
+
+        n_start = n_alloc;
+        t_start = now();
+        if (walk(argv[1], method, &n_commits, &n_bytes) < 0) {
+            const git_error *e = giterr_last();
+            fprintf(stderr, "error: %s\n", e ? e->message : "unknown");
+            return EXIT_FAILURE;
+        }
+        t_end = now();
+
+        printf("%s\t%lu\t%lu\t%.2f\t%.4f\n",
+               method_names[method],
+               (unsigned long)n_commits,
+               (unsigned long)(n_alloc - n_start),
+               n_commits ? (double)(n_alloc - n_start) / n_commits : 0.0,
+               t_end - t_start);
+    }
+
+    git_libgit2_shutdown();
+
+    return EXIT_SUCCESS;
+}
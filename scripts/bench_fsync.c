@@ -0,0 +1,188 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/** @file bench_fsync.c
+ *  @brief Benchmark of synchronized writes
+ *
+ *  Creates a repository for each mode and commits to it, like a bot
+ *  that commits a few generated files at a time. Each commit opens
+ *  and frees the repository, as a call to git2r does:
+ *
+ *  none:  no fsync (the default)
+ *  full:  GIT_OPT_ENABLE_FSYNC_GITDIR, every file is synced
+ *  batch: GIT_OPT_ENABLE_FSYNC_BATCH in addition, the objects are
+ *         synced before the reference is written, the directories
+ *         when the repository is freed
+ *
+ *  The calls to fsync, fdatasync and syncfs are counted by linking
+ *  with '-Wl,--wrap=fsync,...'. Run with 'make bench_fsync DIR=path
+ *  COMMITS=n FILES=n', where DIR is on the filesystem to measure. The
+ *  output is tab separated with one row per mode.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "git2.h"
+
+static size_t n_fsync = 0;
+static size_t n_syncfs = 0;
+
+int __real_fsync(int fd);
+int __real_fdatasync(int fd);
+int __real_syncfs(int fd);
+
+int __wrap_fsync(int fd) {n_fsync++; return __real_fsync(fd);}
+int __wrap_fdatasync(int fd) {n_fsync++; return __real_fdatasync(fd);}
+int __wrap_syncfs(int fd) {n_syncfs++; return __real_syncfs(fd);}
+
+enum {MODE_NONE, MODE_FULL, MODE_BATCH};
+static const char *mode_names[] = {"none", "full", "batch"};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static int commit_files(const char *path, int i, int n_files)
+{
+    int err, j;
+    char name[64], content[128];
+    git_oid oid, tree_oid, commit_oid;
+    git_repository *repository = NULL;
+    git_reference *head = NULL;
+    git_commit *parent = NULL;
+    git_treebuilder *builder = NULL;
+    git_tree *tree = NULL;
+    git_signature *sig = NULL;
+
+    if ((err = git_repository_open(&repository, path)) < 0 ||
+        (err = git_signature_now(&sig, "bench", "bench@example.org")) < 0)
+        goto cleanup;
+
+    err = git_repository_head(&head, repository);
+    if (!err) {
+        if ((err = git_commit_lookup(&parent, repository,
+                                     git_reference_target(head))) < 0 ||
+            (err = git_commit_tree(&tree, parent)) < 0)
+            goto cleanup;
+    } else if (err != GIT_EUNBORNBRANCH) {
+        goto cleanup;
+    }
+
+    if ((err = git_treebuilder_new(&builder, repository, tree)) < 0)
+        goto cleanup;
+
+    for (j = 0; j < n_files; j++) {
+        snprintf(name, sizeof(name), "file-%d-%d.txt", i, j);
+        snprintf(content, sizeof(content), "Commit %d, file %d\n", i, j);
+        if ((err = git_blob_create_frombuffer(
+                 &oid, repository, content, strlen(content))) < 0 ||
+            (err = git_treebuilder_insert(
+                 NULL, builder, name, &oid, GIT_FILEMODE_BLOB)) < 0)
+            goto cleanup;
+    }
+
+    if ((err = git_treebuilder_write(&tree_oid, builder)) < 0)
+        goto cleanup;
+    git_tree_free(tree);
+    tree = NULL;
+    if ((err = git_tree_lookup(&tree, repository, &tree_oid)) < 0)
+        goto cleanup;
+
+    err = git_commit_create(&commit_oid, repository, "HEAD", sig, sig,
+                            NULL, "Commit", tree, parent ? 1 : 0,
+                            (const git_commit **)&parent);
+
+cleanup:
+    git_signature_free(sig);
+    git_treebuilder_free(builder);
+    git_tree_free(tree);
+    git_commit_free(parent);
+    git_reference_free(head);
+    git_repository_free(repository);
+
+    return err;
+}
+
+int main(int argc, char *argv[])
+{
+    int mode, n_commits = 100, n_files = 10;
+
+    if (argc < 2 || argc > 4) {
+        fprintf(stderr, "usage: %s <directory> [commits] [files]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc > 2)
+        n_commits = atoi(argv[2]);
+    if (argc > 3)
+        n_files = atoi(argv[3]);
+
+    git_libgit2_init();
+
+    printf("mode\tcommits\tfiles\tfsync\tsyncfs\tfsync_per_commit\tseconds\n");
+    for (mode = MODE_NONE; mode <= MODE_BATCH; mode++) {
+        char path[4096];
+        int i;
+        size_t fsync_start, syncfs_start;
+        double t_start, t_end;
+        git_repository *repository = NULL;
+
+        snprintf(path, sizeof(path), "%s/bench_fsync_%s_%ld",
+                 argv[1], mode_names[mode], (long)getpid());
+        if (git_repository_init(&repository, path, 0) < 0)
+            goto on_error;
+        git_repository_free(repository);
+
+        git_libgit2_opts(GIT_OPT_ENABLE_FSYNC_GITDIR, mode != MODE_NONE);
+        git_libgit2_opts(GIT_OPT_ENABLE_FSYNC_BATCH, mode == MODE_BATCH);
+
+        fsync_start = n_fsync;
+        syncfs_start = n_syncfs;
+        t_start = now();
+        for (i = 0; i < n_commits; i++) {
+            if (commit_files(path, i, n_files) < 0)
+                goto on_error;
+        }
+        t_end = now();
+
+        printf("%s\t%d\t%d\t%lu\t%lu\t%.2f\t%.4f\n",
+               mode_names[mode], n_commits, n_files,
+               (unsigned long)(n_fsync - fsync_start),
+               (unsigned long)(n_syncfs - syncfs_start),
+               n_commits ? (double)(n_fsync - fsync_start) / n_commits : 0.0,
+               t_end - t_start);
+        fflush(stdout);
+    }
+
+    git_libgit2_shutdown();
+
+    return EXIT_SUCCESS;
+
+on_error:
+    {
+        const git_error *e = giterr_last();
+        fprintf(stderr, "error: %s\n", e ? e->message : "unknown");
+    }
+    return EXIT_FAILURE;
+}
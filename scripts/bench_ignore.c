@@ -0,0 +1,360 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/** @file bench_ignore.c
+ *  @brief Benchmark of ignore rule matching
+ *
+ *  Matches the paths in the index of a repository, and their leading
+ *  directories, against a set of ignore rules in two ways:
+ *
+ *  fnmatch:  every rule is matched with fnmatch, from the last rule
+ *  compiled: the rules are compiled with git_attr_file__compile
+ *
+ *  The rules are read from a .gitignore file, e.g. a concatenation of
+ *  the templates at https://github.com/github/gitignore, or generated
+ *  when no file is given: 5000 rules with the mix of names,
+ *  extensions, directories, anchored paths, globs and negations in
+ *  those templates, and paths that match them are added. Run with
+ *  'make bench_ignore REPO=path IGNORE=file'. The output is tab
+ *  separated with one row per method.
+ *
+ *  Before the timing, every rule that matches each path is looked up
+ *  with both methods, with and without negation as in the ignore and
+ *  attribute lookups. The benchmark fails if the methods differ for
+ *  any path.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "git2.h"
+#include "common.h"
+#include "attr_file.h"
+#include "buffer.h"
+#include "fileops.h"
+#include "strmap.h"
+
+#define ROUNDS 20
+#define N_RULES 5000
+
+enum {METHOD_FNMATCH, METHOD_COMPILED};
+static const char *method_names[] = {"fnmatch", "compiled"};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static void generate_rules(git_buf *buf)
+{
+    static const char *ext[] = {"o", "so", "a", "log", "tmp", "pyc", "class",
+                                "jar", "rds", "Rdata", "csv", "parquet", "h5",
+                                "bak", "swp", "orig", "aux", "out"};
+    int i;
+
+    for (i = 0; i < N_RULES; i++) {
+        switch (i % 10) {
+        case 0: case 1: case 2:
+            git_buf_printf(buf, "file_%d.dat\n", i);
+            break;
+        case 3: case 4:
+            git_buf_printf(buf, "*.%s%d\n", ext[i % 18], i / 18);
+            break;
+        case 5:
+            git_buf_printf(buf, "cache_%d/\n", i);
+            break;
+        case 6:
+            git_buf_printf(buf, "/data/raw_%d\n", i);
+            break;
+        case 7:
+            git_buf_printf(buf, "output_%d/*\n", i);
+            break;
+        case 8:
+            git_buf_printf(buf, "run_%d_*.txt\n", i);
+            break;
+        default:
+            git_buf_printf(buf, "!keep_%d.csv\n", i);
+            break;
+        }
+    }
+
+    git_buf_puts(buf, "*.log\n.Rproj.user/\n.Rhistory\n/inst/doc\n");
+}
+
+/* Paths that match each kind of generated rule, or almost do */
+static int generate_paths(git_vector *names)
+{
+    static const char *fmt[] = {"file_%d.dat", "src/file_%d.dat",
+                                "file_%d.dat.orig", "x.o%d", "src/x.log%d",
+                                "cache_%d/a.txt", "src/cache_%d/b.txt",
+                                "cache_%d", "data/raw_%d/c.txt",
+                                "src/data/raw_%d", "output_%d/d.txt",
+                                "output_%d", "run_%d_1.txt", "run_%d_.txt",
+                                "keep_%d.csv", "src/keep_%d.csv",
+                                "x.csv%d", "a.log", "src/.Rproj.user/%d",
+                                "inst/doc/%d.html", "src/inst/doc/%d"};
+    size_t i, j;
+
+    for (i = 0; i < N_RULES; i += 7) {
+        for (j = 0; j < sizeof(fmt) / sizeof(fmt[0]); j++) {
+            git_buf name = GIT_BUF_INIT;
+
+            if (git_buf_printf(&name, fmt[j], (int)i) < 0 ||
+                git_vector_insert(names, git_buf_detach(&name)) < 0)
+                return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int parse_rules(git_attr_file *file, const char *data)
+{
+    const char *scan = data;
+
+    while (*scan) {
+        git_attr_fnmatch *match = git__calloc(1, sizeof(*match));
+        int err;
+
+        if (!match)
+            return -1;
+
+        match->flags = GIT_ATTR_FNMATCH_ALLOWSPACE | GIT_ATTR_FNMATCH_ALLOWNEG;
+        err = git_attr_fnmatch__parse(match, &file->pool, NULL, &scan);
+        if (!err) {
+            match->flags |= GIT_ATTR_FNMATCH_IGNORE;
+            scan = git__next_line(scan);
+            if ((err = git_vector_insert(&file->rules, match)) < 0)
+                return err;
+        } else {
+            git__free(match);
+            if (err != GIT_ENOTFOUND)
+                return err;
+        }
+    }
+
+    return git_attr_file__compile(file);
+}
+
+/* Add a path, after its leading directories that are not added yet */
+static int add_path(git_vector *paths, git_strmap *dirs, const char *name)
+{
+    int err;
+    const char *scan;
+    git_attr_path *path;
+
+    for (scan = name; (scan = strchr(scan, '/')) != NULL; scan++) {
+        char *dir = git__strndup(name, scan - name);
+
+        GITERR_CHECK_ALLOC(dir);
+        if (git_strmap_exists(dirs, dir)) {
+            git__free(dir);
+            continue;
+        }
+        git_strmap_insert(dirs, dir, dir, &err);
+        if (err < 0)
+            return err;
+
+        path = git__calloc(1, sizeof(git_attr_path));
+        GITERR_CHECK_ALLOC(path);
+        if ((err = git_attr_path__init(path, dir, NULL, GIT_DIR_FLAG_TRUE)) < 0 ||
+            (err = git_vector_insert(paths, path)) < 0)
+            return err;
+    }
+
+    path = git__calloc(1, sizeof(git_attr_path));
+    GITERR_CHECK_ALLOC(path);
+    if ((err = git_attr_path__init(path, name, NULL, GIT_DIR_FLAG_FALSE)) < 0 ||
+        (err = git_vector_insert(paths, path)) < 0)
+        return err;
+
+    return 0;
+}
+
+static int load_paths(git_vector *paths, const char *repo_path, git_vector *names)
+{
+    int err;
+    size_t i;
+    char *name;
+    git_repository *repository = NULL;
+    git_index *index = NULL;
+    git_strmap *dirs = NULL;
+
+    if ((err = git_strmap_alloc(&dirs)) < 0 ||
+        (err = git_repository_open(&repository, repo_path)) < 0 ||
+        (err = git_repository_index(&index, repository)) < 0)
+        goto cleanup;
+
+    for (i = 0; i < git_index_entrycount(index); i++) {
+        const git_index_entry *entry = git_index_get_byindex(index, i);
+
+        if ((err = add_path(paths, dirs, entry->path)) < 0)
+            goto cleanup;
+    }
+
+    git_vector_foreach(names, i, name) {
+        if ((err = add_path(paths, dirs, name)) < 0)
+            goto cleanup;
+    }
+
+cleanup:
+    if (dirs) {
+        git_strmap_foreach_value(dirs, name, { git__free(name); });
+        git_strmap_free(dirs);
+    }
+    git_index_free(index);
+    git_repository_free(repository);
+
+    return err;
+}
+
+/* Compare every rule that matches each path with both methods */
+static size_t count_differences(git_attr_file *file, git_attr_matcher *matcher,
+                                git_vector *paths)
+{
+    size_t i, n = 0;
+    git_attr_path *path;
+    int negate;
+
+    git_vector_foreach(paths, i, path) {
+        int differ = 0;
+
+        for (negate = 0; negate <= 1 && !differ; negate++) {
+            size_t expected, actual, before = file->rules.length;
+
+            do {
+                file->matcher = NULL;
+                expected = git_attr_file__prev_match(file, path, before, negate);
+                file->matcher = matcher;
+                actual = git_attr_file__prev_match(file, path, before, negate);
+                if (expected != actual) {
+                    fprintf(stderr, "%s%s: rule %lu with fnmatch, %lu compiled%s\n",
+                            path->path, path->is_dir ? "/" : "",
+                            (unsigned long)expected, (unsigned long)actual,
+                            negate ? " (negate)" : "");
+                    differ = 1;
+                    break;
+                }
+                before = expected - 1;
+            } while (expected);
+        }
+        n += differ;
+    }
+
+    file->matcher = matcher;
+
+    return n;
+}
+
+int main(int argc, char *argv[])
+{
+    int method;
+    size_t i;
+    git_buf rules = GIT_BUF_INIT;
+    git_vector paths = GIT_VECTOR_INIT;
+    git_attr_path *path;
+    git_attr_file *file = NULL;
+    git_attr_matcher *matcher;
+    git_vector names = GIT_VECTOR_INIT;
+    size_t n_differences;
+
+    if (argc != 2 && argc != 3) {
+        fprintf(stderr, "usage: %s <repository> [gitignore]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    git_libgit2_init();
+
+    if (argc == 3) {
+        if (git_futils_readbuffer(&rules, argv[2]) < 0)
+            goto on_error;
+    } else {
+        generate_rules(&rules);
+        if (generate_paths(&names) < 0)
+            goto on_error;
+    }
+
+    if (git_attr_file__new(&file, NULL, GIT_ATTR_FILE__FROM_FILE) < 0 ||
+        parse_rules(file, rules.ptr) < 0 ||
+        load_paths(&paths, argv[1], &names) < 0)
+        goto on_error;
+
+    matcher = file->matcher;
+
+    n_differences = count_differences(file, matcher, &paths);
+    if (n_differences) {
+        fprintf(stderr, "error: the methods differ for %lu paths\n",
+                (unsigned long)n_differences);
+        return EXIT_FAILURE;
+    }
+
+    printf("method\trules\tpaths\tignored\tseconds\n");
+    for (method = METHOD_FNMATCH; method <= METHOD_COMPILED; method++) {
+        size_t n_ignored = 0, round;
+        double t_start, t_end;
+
+        file->matcher = (method == METHOD_COMPILED) ? matcher : NULL;
+
+        t_start = now();
+        for (round = 0; round < ROUNDS; round++) {
+            git_vector_foreach(&paths, i, path) {
+                size_t pos = git_attr_file__prev_match(
+                    file, path, file->rules.length, false);
+
+                if (pos) {
+                    git_attr_fnmatch *match = git_vector_get(&file->rules, pos - 1);
+                    if (!(match->flags & GIT_ATTR_FNMATCH_NEGATIVE))
+                        n_ignored++;
+                }
+            }
+        }
+        t_end = now();
+
+        printf("%s\t%lu\t%lu\t%lu\t%.4f\n",
+               method_names[method],
+               (unsigned long)file->rules.length,
+               (unsigned long)(ROUNDS * paths.length),
+               (unsigned long)n_ignored,
+               t_end - t_start);
+    }
+
+    file->matcher = matcher;
+    git_vector_foreach(&paths, i, path) {
+        git_attr_path__free(path);
+        git__free(path);
+    }
+    git_vector_free(&paths);
+    git_vector_free_deep(&names);
+    git_attr_file__free(file);
+    git_buf_free(&rules);
+    git_libgit2_shutdown();
+
+    return EXIT_SUCCESS;
+
+on_error:
+    {
+        const git_error *e = giterr_last();
+        fprintf(stderr, "error: %s\n", e ? e->message : "unknown");
+    }
+
+    return EXIT_FAILURE;
+}
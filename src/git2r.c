@@ -31,6 +31,7 @@
 
 #include "git2.h"
 
+#include "git2r_async.h"
 #include "git2r_blame.h"
 #include "git2r_blob.h"
 #include "git2r_branch.h"
@@ -38,16 +39,24 @@
 #include "git2r_clone.h"
 #include "git2r_config.h"
 #include "git2r_commit.h"
+#include "git2r_cred.h"
+#include "git2r_describe.h"
 #include "git2r_diff.h"
 #include "git2r_error.h"
+#include "git2r_fsck.h"
 #include "git2r_graph.h"
+#include "git2r_ignore.h"
 #include "git2r_index.h"
+#include "git2r_lfs.h"
 #include "git2r_libgit2.h"
+#include "git2r_log.h"
 #include "git2r_merge.h"
 #include "git2r_note.h"
 #include "git2r_object.h"
+#include "git2r_objects.h"
 #include "git2r_odb.h"
 #include "git2r_push.h"
+#include "git2r_rebase.h"
 #include "git2r_reference.h"
 #include "git2r_reflog.h"
 #include "git2r_remote.h"
@@ -57,100 +66,148 @@
 #include "git2r_revwalk.h"
 #include "git2r_signature.h"
 #include "git2r_stash.h"
+#include "git2r_stats.h"
 #include "git2r_status.h"
+#include "git2r_submodule.h"
 #include "git2r_tag.h"
+#include "git2r_trace.h"
 #include "git2r_tree.h"
+#include "git2r_worktree.h"
 
-#define CALLDEF(name, n) {#name, (DL_FUNC) &name, n}
+/**
+ * The .Call entry points, CALLDEF(name, number of arguments)
+ */
+#define GIT2R_CALL_METHODS \
+    CALLDEF(git2r_async_clone, 6)                    \
+    CALLDEF(git2r_async_done, 1)                     \
+    CALLDEF(git2r_async_fetch, 5)                    \
+    CALLDEF(git2r_async_odb_blobs, 1)                \
+    CALLDEF(git2r_async_progress, 1)                 \
+    CALLDEF(git2r_async_push, 4)                     \
+    CALLDEF(git2r_async_status, 6)                   \
+    CALLDEF(git2r_async_value, 1)                    \
+    CALLDEF(git2r_blame_file, 2)                     \
+    CALLDEF(git2r_blob_content, 1)                   \
+    CALLDEF(git2r_blob_create_fromdisk, 2)           \
+    CALLDEF(git2r_blob_create_fromworkdir, 2)        \
+    CALLDEF(git2r_blob_is_binary, 1)                 \
+    CALLDEF(git2r_blob_rawsize, 1)                   \
+    CALLDEF(git2r_branch_canonical_name, 1)          \
+    CALLDEF(git2r_branch_create, 3)                  \
+    CALLDEF(git2r_branch_delete, 1)                  \
+    CALLDEF(git2r_branch_get_upstream, 1)            \
+    CALLDEF(git2r_branch_is_head, 1)                 \
+    CALLDEF(git2r_branch_list, 2)                    \
+    CALLDEF(git2r_branch_remote_name, 1)             \
+    CALLDEF(git2r_branch_remote_url, 1)              \
+    CALLDEF(git2r_branch_rename, 3)                  \
+    CALLDEF(git2r_branch_set_upstream, 2)            \
+    CALLDEF(git2r_branch_table, 4)                   \
+    CALLDEF(git2r_branch_target, 1)                  \
+    CALLDEF(git2r_branch_upstream_canonical_name, 1) \
+    CALLDEF(git2r_check_attr, 3)                     \
+    CALLDEF(git2r_check_ignore, 2)                   \
+    CALLDEF(git2r_checkout_path, 2)                  \
+    CALLDEF(git2r_checkout_tree, 3)                  \
+    CALLDEF(git2r_cherrypick, 3)                     \
+    CALLDEF(git2r_clone, 7)                          \
+    CALLDEF(git2r_commit, 4)                         \
+    CALLDEF(git2r_commit_parent_list, 1)             \
+    CALLDEF(git2r_commit_tree, 1)                    \
+    CALLDEF(git2r_config_get, 1)                     \
+    CALLDEF(git2r_config_get_logical, 2)             \
+    CALLDEF(git2r_config_get_string, 2)              \
+    CALLDEF(git2r_config_set, 2)                     \
+    CALLDEF(git2r_cred_cache, 1)                     \
+    CALLDEF(git2r_describe, 4)                       \
+    CALLDEF(git2r_diff, 5)                           \
+    CALLDEF(git2r_fsck, 3)                           \
+    CALLDEF(git2r_fsync_mode, 1)                     \
+    CALLDEF(git2r_graph_ahead_behind, 2)             \
+    CALLDEF(git2r_graph_descendant_of, 2)            \
+    CALLDEF(git2r_index_add_all, 3)                  \
+    CALLDEF(git2r_index_remove_bypath, 2)            \
+    CALLDEF(git2r_lfs_fetch, 2)                      \
+    CALLDEF(git2r_lfs_push, 2)                       \
+    CALLDEF(git2r_libgit2_features, 0)               \
+    CALLDEF(git2r_libgit2_version, 0)                \
+    CALLDEF(git2r_log_stats, 4)                      \
+    CALLDEF(git2r_merge_base, 2)                     \
+    CALLDEF(git2r_merge_branch, 3)                   \
+    CALLDEF(git2r_merge_fetch_heads, 2)              \
+    CALLDEF(git2r_note_create, 7)                    \
+    CALLDEF(git2r_note_default_ref, 1)               \
+    CALLDEF(git2r_notes, 2)                          \
+    CALLDEF(git2r_note_remove, 3)                    \
+    CALLDEF(git2r_object_lookup, 2)                  \
+    CALLDEF(git2r_odb_blobs, 1)                      \
+    CALLDEF(git2r_odb_hash, 1)                       \
+    CALLDEF(git2r_odb_hashfile, 1)                   \
+    CALLDEF(git2r_odb_objects, 1)                    \
+    CALLDEF(git2r_odb_stats, 2)                      \
+    CALLDEF(git2r_push, 4)                           \
+    CALLDEF(git2r_rebase, 4)                         \
+    CALLDEF(git2r_reference_dwim, 2)                 \
+    CALLDEF(git2r_reference_list, 1)                 \
+    CALLDEF(git2r_reflog_list, 2)                    \
+    CALLDEF(git2r_remote_add, 3)                     \
+    CALLDEF(git2r_remote_fetch, 6)                   \
+    CALLDEF(git2r_remote_list, 1)                    \
+    CALLDEF(git2r_remote_remove, 2)                  \
+    CALLDEF(git2r_remote_rename, 3)                  \
+    CALLDEF(git2r_remote_set_url, 3)                 \
+    CALLDEF(git2r_remote_url, 2)                     \
+    CALLDEF(git2r_remote_ls, 3)                      \
+    CALLDEF(git2r_repository_can_open, 1)            \
+    CALLDEF(git2r_repository_discover, 2)            \
+    CALLDEF(git2r_repository_fetch_heads, 1)         \
+    CALLDEF(git2r_repository_head, 1)                \
+    CALLDEF(git2r_repository_head_detached, 1)       \
+    CALLDEF(git2r_repository_init, 2)                \
+    CALLDEF(git2r_repository_is_bare, 1)             \
+    CALLDEF(git2r_repository_is_empty, 1)            \
+    CALLDEF(git2r_repository_is_shallow, 1)          \
+    CALLDEF(git2r_repository_set_head, 2)            \
+    CALLDEF(git2r_repository_set_head_detached, 1)   \
+    CALLDEF(git2r_repository_summary, 3)             \
+    CALLDEF(git2r_repository_workdir, 1)             \
+    CALLDEF(git2r_reset, 2)                          \
+    CALLDEF(git2r_reset_default, 2)                  \
+    CALLDEF(git2r_revert, 3)                         \
+    CALLDEF(git2r_revparse_single, 2)                \
+    CALLDEF(git2r_revwalk_contributions, 4)          \
+    CALLDEF(git2r_revwalk_list, 11)                  \
+    CALLDEF(git2r_revwalk_table, 6)                  \
+    CALLDEF(git2r_signature_default, 1)              \
+    CALLDEF(git2r_ssl_cert_locations, 2)             \
+    CALLDEF(git2r_stash_drop, 2)                     \
+    CALLDEF(git2r_stash_list, 1)                     \
+    CALLDEF(git2r_stash_save, 6)                     \
+    CALLDEF(git2r_stats, 2)                          \
+    CALLDEF(git2r_status_list, 6)                    \
+    CALLDEF(git2r_submodule_status, 2)               \
+    CALLDEF(git2r_submodule_update, 4)               \
+    CALLDEF(git2r_tag_create, 4)                     \
+    CALLDEF(git2r_tag_delete, 2)                     \
+    CALLDEF(git2r_tag_list, 1)                       \
+    CALLDEF(git2r_trace_log, 0)                      \
+    CALLDEF(git2r_trace_set, 2)                      \
+    CALLDEF(git2r_transport_pool, 1)                 \
+    CALLDEF(git2r_tree_walk, 2)                      \
+    CALLDEF(git2r_worktree_add, 5)                   \
+    CALLDEF(git2r_worktree_list, 1)                  \
+    CALLDEF(git2r_worktree_remove, 3)
+
+/* Wrap each entry point to count the calls and the time spent, see
+ * git2r_stats */
+#define CALLDEF(name, n) GIT2R_STATS_CALL_##n(name)
+GIT2R_CALL_METHODS
+#undef CALLDEF
 
+#define CALLDEF(name, n) {#name, (DL_FUNC) &name##__stats, n},
 static const R_CallMethodDef callMethods[] =
 {
-    CALLDEF(git2r_blame_file, 2),
-    CALLDEF(git2r_blob_content, 1),
-    CALLDEF(git2r_blob_create_fromdisk, 2),
-    CALLDEF(git2r_blob_create_fromworkdir, 2),
-    CALLDEF(git2r_blob_is_binary, 1),
-    CALLDEF(git2r_blob_rawsize, 1),
-    CALLDEF(git2r_branch_canonical_name, 1),
-    CALLDEF(git2r_branch_create, 3),
-    CALLDEF(git2r_branch_delete, 1),
-    CALLDEF(git2r_branch_get_upstream, 1),
-    CALLDEF(git2r_branch_is_head, 1),
-    CALLDEF(git2r_branch_list, 2),
-    CALLDEF(git2r_branch_remote_name, 1),
-    CALLDEF(git2r_branch_remote_url, 1),
-    CALLDEF(git2r_branch_rename, 3),
-    CALLDEF(git2r_branch_set_upstream, 2),
-    CALLDEF(git2r_branch_target, 1),
-    CALLDEF(git2r_branch_upstream_canonical_name, 1),
-    CALLDEF(git2r_checkout_path, 2),
-    CALLDEF(git2r_checkout_tree, 3),
-    CALLDEF(git2r_clone, 7),
-    CALLDEF(git2r_commit, 4),
-    CALLDEF(git2r_commit_parent_list, 1),
-    CALLDEF(git2r_commit_tree, 1),
-    CALLDEF(git2r_config_get, 1),
-    CALLDEF(git2r_config_get_logical, 2),
-    CALLDEF(git2r_config_get_string, 2),
-    CALLDEF(git2r_config_set, 2),
-    CALLDEF(git2r_diff, 5),
-    CALLDEF(git2r_graph_ahead_behind, 2),
-    CALLDEF(git2r_graph_descendant_of, 2),
-    CALLDEF(git2r_index_add_all, 3),
-    CALLDEF(git2r_index_remove_bypath, 2),
-    CALLDEF(git2r_libgit2_features, 0),
-    CALLDEF(git2r_libgit2_version, 0),
-    CALLDEF(git2r_merge_base, 2),
-    CALLDEF(git2r_merge_branch, 3),
-    CALLDEF(git2r_merge_fetch_heads, 2),
-    CALLDEF(git2r_note_create, 7),
-    CALLDEF(git2r_note_default_ref, 1),
-    CALLDEF(git2r_notes, 2),
-    CALLDEF(git2r_note_remove, 3),
-    CALLDEF(git2r_object_lookup, 2),
-    CALLDEF(git2r_odb_blobs, 1),
-    CALLDEF(git2r_odb_hash, 1),
-    CALLDEF(git2r_odb_hashfile, 1),
-    CALLDEF(git2r_odb_objects, 1),
-    CALLDEF(git2r_push, 4),
-    CALLDEF(git2r_reference_dwim, 2),
-    CALLDEF(git2r_reference_list, 1),
-    CALLDEF(git2r_reflog_list, 2),
-    CALLDEF(git2r_remote_add, 3),
-    CALLDEF(git2r_remote_fetch, 6),
-    CALLDEF(git2r_remote_list, 1),
-    CALLDEF(git2r_remote_remove, 2),
-    CALLDEF(git2r_remote_rename, 3),
-    CALLDEF(git2r_remote_set_url, 3),
-    CALLDEF(git2r_remote_url, 2),
-    CALLDEF(git2r_remote_ls, 3),
-    CALLDEF(git2r_repository_can_open, 1),
-    CALLDEF(git2r_repository_discover, 2),
-    CALLDEF(git2r_repository_fetch_heads, 1),
-    CALLDEF(git2r_repository_head, 1),
-    CALLDEF(git2r_repository_head_detached, 1),
-    CALLDEF(git2r_repository_init, 2),
-    CALLDEF(git2r_repository_is_bare, 1),
-    CALLDEF(git2r_repository_is_empty, 1),
-    CALLDEF(git2r_repository_is_shallow, 1),
-    CALLDEF(git2r_repository_set_head, 2),
-    CALLDEF(git2r_repository_set_head_detached, 1),
-    CALLDEF(git2r_repository_workdir, 1),
-    CALLDEF(git2r_reset, 2),
-    CALLDEF(git2r_reset_default, 2),
-    CALLDEF(git2r_revparse_single, 2),
-    CALLDEF(git2r_revwalk_contributions, 4),
-    CALLDEF(git2r_revwalk_list, 5),
-    CALLDEF(git2r_signature_default, 1),
-    CALLDEF(git2r_ssl_cert_locations, 2),
-    CALLDEF(git2r_stash_drop, 2),
-    CALLDEF(git2r_stash_list, 1),
-    CALLDEF(git2r_stash_save, 6),
-    CALLDEF(git2r_status_list, 6),
-    CALLDEF(git2r_tag_create, 4),
-    CALLDEF(git2r_tag_delete, 2),
-    CALLDEF(git2r_tag_list, 1),
-    CALLDEF(git2r_tree_walk, 2),
+    GIT2R_CALL_METHODS
     {NULL, NULL, 0}
 };
 
@@ -167,7 +224,9 @@ R_init_git2r(DllInfo *info)
     R_registerRoutines(info, NULL, callMethods, NULL, NULL);
     R_useDynamicSymbols(info, FALSE);
     R_forceSymbols(info, TRUE);
+    git2r_objects_init();
     git_libgit2_init();
+    git2r_lfs_init();
 }
 
 /**
@@ -178,5 +237,8 @@ R_init_git2r(DllInfo *info)
 void
 R_unload_git2r(DllInfo *info)
 {
+    git2r_objects_release();
+    git2r_lfs_shutdown();
+    git2r_cred_cache_clear();
     git_libgit2_shutdown();
 }
@@ -53,10 +53,10 @@ int git2r_arg_check_branch(SEXP arg)
     if (!Rf_isS4(arg) || !Rf_inherits(arg, "git_branch"))
         return -1;
 
-    if (git2r_arg_check_string(GET_SLOT(arg, Rf_install("name"))))
+    if (git2r_arg_check_string(GET_SLOT(arg, git2r_sym(name))))
         return -1;
 
-    slot = GET_SLOT(arg, Rf_install("type"));
+    slot = GET_SLOT(arg, git2r_sym(type));
     if (git2r_arg_check_integer(slot))
         return -1;
     switch (INTEGER(slot)[0]) {
@@ -81,7 +81,7 @@ int git2r_arg_check_commit(SEXP arg)
     if (!Rf_isS4(arg) || !Rf_inherits(arg, "git_commit"))
         return -1;
 
-    if (git2r_arg_check_string(GET_SLOT(arg, Rf_install("sha"))))
+    if (git2r_arg_check_string(GET_SLOT(arg, git2r_sym(sha))))
         return -1;
 
     return 0;
@@ -101,7 +101,7 @@ int git2r_arg_check_commit_stash(SEXP arg)
     if (!Rf_inherits(arg, "git_commit") && !Rf_inherits(arg, "git_stash"))
         return -1;
 
-    if (git2r_arg_check_string(GET_SLOT(arg, Rf_install("sha"))))
+    if (git2r_arg_check_string(GET_SLOT(arg, git2r_sym(sha))))
         return -1;
 
     return 0;
@@ -183,8 +183,8 @@ int git2r_arg_check_fetch_heads(SEXP arg)
 {
     const char *repo = NULL;
     size_t i,n;
-    SEXP s_repo = Rf_install("repo");
-    SEXP s_path = Rf_install("path");
+    SEXP s_repo = git2r_sym(repo);
+    SEXP s_path = git2r_sym(path);
 
     if (Rf_isNull(arg) || VECSXP != TYPEOF(arg))
         return -1;
@@ -329,10 +329,10 @@ int git2r_arg_check_note(SEXP arg)
     if (!Rf_isS4(arg) || !Rf_inherits(arg, "git_note"))
         return -1;
 
-    if (git2r_arg_check_string(GET_SLOT(arg, Rf_install("sha"))))
+    if (git2r_arg_check_string(GET_SLOT(arg, git2r_sym(sha))))
         return -1;
 
-    if (git2r_arg_check_string(GET_SLOT(arg, Rf_install("refname"))))
+    if (git2r_arg_check_string(GET_SLOT(arg, git2r_sym(refname))))
         return -1;
 
     return 0;
@@ -362,7 +362,7 @@ int git2r_arg_check_repository(SEXP arg)
     if (!Rf_isS4(arg) || !Rf_inherits(arg, "git_repository"))
         return -1;
 
-    if (git2r_arg_check_string(GET_SLOT(arg, Rf_install("path"))))
+    if (git2r_arg_check_string(GET_SLOT(arg, git2r_sym(path))))
         return -1;
 
     return 0;
@@ -381,8 +381,8 @@ int git2r_arg_check_same_repo(SEXP arg1, SEXP arg2)
     if (git2r_arg_check_repository(arg1) || git2r_arg_check_repository(arg2))
         return -1;
 
-    path1 = GET_SLOT(arg1, Rf_install("path"));
-    path2 = GET_SLOT(arg2, Rf_install("path"));
+    path1 = GET_SLOT(arg1, git2r_sym(path));
+    path2 = GET_SLOT(arg2, git2r_sym(path));
     if (strcmp(CHAR(STRING_ELT(path1, 0)), CHAR(STRING_ELT(path2, 0))))
         return -1;
 
@@ -402,15 +402,15 @@ int git2r_arg_check_signature(SEXP arg)
     if (!Rf_isS4(arg) || !Rf_inherits(arg, "git_signature"))
         return -1;
 
-    if (git2r_arg_check_string(GET_SLOT(arg, Rf_install("name"))))
+    if (git2r_arg_check_string(GET_SLOT(arg, git2r_sym(name))))
         return -1;
-    if (git2r_arg_check_string(GET_SLOT(arg, Rf_install("email"))))
+    if (git2r_arg_check_string(GET_SLOT(arg, git2r_sym(email))))
         return -1;
 
-    when = GET_SLOT(arg, Rf_install("when"));
-    if (git2r_arg_check_real(GET_SLOT(when, Rf_install("time"))))
+    when = GET_SLOT(arg, git2r_sym(when));
+    if (git2r_arg_check_real(GET_SLOT(when, git2r_sym(time))))
         return -1;
-    if (git2r_arg_check_real(GET_SLOT(when, Rf_install("offset"))))
+    if (git2r_arg_check_real(GET_SLOT(when, git2r_sym(offset))))
         return -1;
 
     return 0;
@@ -496,7 +496,7 @@ int git2r_arg_check_tag(SEXP arg)
     if (!Rf_isS4(arg) || !Rf_inherits(arg, "git_tag"))
         return -1;
 
-    if (git2r_arg_check_string(GET_SLOT(arg, Rf_install("target"))))
+    if (git2r_arg_check_string(GET_SLOT(arg, git2r_sym(target))))
         return -1;
 
     return 0;
@@ -513,7 +513,7 @@ int git2r_arg_check_tree(SEXP arg)
     if (!Rf_isS4(arg) || !Rf_inherits(arg, "git_tree"))
         return -1;
 
-    if (git2r_arg_check_string(GET_SLOT(arg, Rf_install("sha"))))
+    if (git2r_arg_check_string(GET_SLOT(arg, git2r_sym(sha))))
         return -1;
 
     return 0;
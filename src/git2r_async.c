@@ -0,0 +1,859 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <Rdefines.h>
+#include "git2.h"
+#include "common.h"
+#include "push.h"
+#include "remote.h"
+#include "thread-utils.h"
+
+#include "git2r_arg.h"
+#include "git2r_async.h"
+#include "git2r_cred.h"
+#include "git2r_error.h"
+#include "git2r_objects.h"
+#include "git2r_odb.h"
+#include "git2r_status.h"
+#include "git2r_transfer.h"
+
+/**
+ * The operations that can run on a worker thread
+ */
+typedef enum {
+    GIT2R_ASYNC_CLONE,
+    GIT2R_ASYNC_FETCH,
+    GIT2R_ASYNC_PUSH,
+    GIT2R_ASYNC_STATUS,
+    GIT2R_ASYNC_ODB_BLOBS
+} git2r_async_op;
+
+/**
+ * An operation that runs on a worker thread
+ *
+ * The arguments are copied to C strings before the worker starts,
+ * except the strings of 'cred' that are kept alive by the protected
+ * value of the external pointer. The worker never calls the R
+ * API. The fields below 'lock' are shared with the worker, and the
+ * result fields are owned by the worker until 'done' is set.
+ */
+typedef struct {
+    git2r_async_op op;
+
+    /* Arguments */
+    char *path; /* the repository, or the local path of a clone */
+    char *url;
+    char *name;
+    char *msg;
+    char *branch;
+    git_strarray refspecs;
+    int bare;
+    int checkout;
+    int staged;
+    int unstaged;
+    int untracked;
+    int all_untracked;
+    int ignored;
+    int has_cred;
+    git2r_cred_data cred;
+
+    git_thread thread;
+    int started;
+
+    /* Shared with the worker */
+    git_mutex lock;
+    int done;
+    int cancel;
+    int err;
+    char *message;
+    git_transfer_progress progress;
+
+    /* Result */
+    git_repository *repository;
+    git_status_list *status_list;
+    git_transfer_progress stats;
+    git_push_stats push_stats;
+    int pushed;
+    git2r_odb_blobs_data blobs;
+} git2r_async;
+
+/**
+ * Update the progress, called from the worker thread
+ *
+ * @param async The operation.
+ * @param stats The transfer progress.
+ * @return 0 to continue, or GIT_EUSER to cancel the operation.
+ */
+static int git2r_async_update(
+    git2r_async *async,
+    const git_transfer_progress *stats)
+{
+    int cancel;
+
+    git_mutex_lock(&async->lock);
+    async->progress = *stats;
+    cancel = async->cancel;
+    git_mutex_unlock(&async->lock);
+
+    return cancel ? GIT_EUSER : 0;
+}
+
+static int git2r_async_transfer_progress_cb(
+    const git_transfer_progress *stats,
+    void *payload)
+{
+    return git2r_async_update(payload, stats);
+}
+
+static int git2r_async_push_progress_cb(
+    unsigned int current,
+    unsigned int total,
+    size_t bytes,
+    void *payload)
+{
+    git_transfer_progress stats = {0};
+
+    stats.total_objects = total;
+    stats.received_objects = current;
+    stats.received_bytes = bytes;
+
+    return git2r_async_update(payload, &stats);
+}
+
+static int git2r_async_blobs_progress_cb(size_t n_objects, void *payload)
+{
+    git_transfer_progress stats = {0};
+
+    stats.received_objects = n_objects;
+
+    return git2r_async_update(payload, &stats);
+}
+
+static int git2r_async_cred_cb(
+    git_cred **out,
+    const char *url,
+    const char *username_from_url,
+    unsigned int allowed_types,
+    void *payload)
+{
+    git2r_async *async = payload;
+
+    return git2r_cred_data_acquire_cb(
+        out, url, username_from_url, allowed_types, &async->cred);
+}
+
+static void git2r_async_callbacks(
+    git_remote_callbacks *callbacks,
+    git2r_async *async)
+{
+    callbacks->payload = async;
+    callbacks->credentials = &git2r_async_cred_cb;
+    callbacks->transfer_progress = &git2r_async_transfer_progress_cb;
+    callbacks->push_transfer_progress = &git2r_async_push_progress_cb;
+}
+
+static int git2r_async_run_clone(git2r_async *async)
+{
+    int err;
+    git_repository *repository = NULL;
+    git_clone_options opts = GIT_CLONE_OPTIONS_INIT;
+
+    if (async->checkout)
+        opts.checkout_opts.checkout_strategy = GIT_CHECKOUT_SAFE;
+    else
+        opts.checkout_opts.checkout_strategy = GIT_CHECKOUT_NONE;
+    opts.bare = async->bare;
+    opts.checkout_branch = async->branch;
+    git2r_async_callbacks(&opts.fetch_opts.callbacks, async);
+
+    err = git_clone(&repository, async->url, async->path, &opts);
+
+    if (repository)
+        git_repository_free(repository);
+
+    return err;
+}
+
+static int git2r_async_run_remote(git2r_async *async)
+{
+    int err;
+    git_remote *remote = NULL;
+    git_repository *repository = NULL;
+
+    /* Nothing to push */
+    if (GIT2R_ASYNC_PUSH == async->op && !async->refspecs.count)
+        return 0;
+
+    err = git_repository_open(&repository, async->path);
+    if (err)
+        goto cleanup;
+
+    err = git_remote_lookup(&remote, repository, async->name);
+    if (err)
+        goto cleanup;
+
+    if (GIT2R_ASYNC_FETCH == async->op) {
+        git_fetch_options opts = GIT_FETCH_OPTIONS_INIT;
+
+        git2r_async_callbacks(&opts.callbacks, async);
+        err = git_remote_fetch(remote, &async->refspecs, &opts, async->msg);
+        if (!err)
+            async->stats = *git_remote_stats(remote);
+    } else {
+        git_push_options opts = GIT_PUSH_OPTIONS_INIT;
+
+        git2r_async_callbacks(&opts.callbacks, async);
+        err = git_remote_push(remote, &async->refspecs, &opts);
+        if (!err && remote->push) {
+            async->push_stats = remote->push->stats;
+            async->pushed = 1;
+        }
+    }
+
+cleanup:
+    if (remote) {
+        if (git_remote_connected(remote))
+            git_remote_disconnect(remote);
+        git_remote_free(remote);
+    }
+
+    if (repository)
+        git_repository_free(repository);
+
+    return err;
+}
+
+static int git2r_async_run_status(git2r_async *async)
+{
+    int err;
+    git_status_options opts = GIT_STATUS_OPTIONS_INIT;
+
+    err = git_repository_open(&async->repository, async->path);
+    if (err)
+        return err;
+
+    git2r_status_options(&opts,
+                         async->untracked,
+                         async->all_untracked,
+                         async->ignored);
+
+    return git_status_list_new(&async->status_list, async->repository, &opts);
+}
+
+static int git2r_async_run_odb_blobs(git2r_async *async)
+{
+    int err;
+    git_repository *repository = NULL;
+
+    err = git_repository_open(&repository, async->path);
+    if (err)
+        return err;
+
+    async->blobs.progress = &git2r_async_blobs_progress_cb;
+    async->blobs.payload = async;
+    err = git2r_odb_blobs_collect(&async->blobs, repository);
+
+    git_repository_free(repository);
+
+    return err;
+}
+
+/**
+ * Run the operation, on the worker thread
+ *
+ * @param payload The operation.
+ * @return NULL
+ */
+static void *git2r_async_worker(void *payload)
+{
+    int err;
+    git2r_async *async = payload;
+
+    switch (async->op) {
+    case GIT2R_ASYNC_CLONE:
+        err = git2r_async_run_clone(async);
+        break;
+    case GIT2R_ASYNC_FETCH:
+    case GIT2R_ASYNC_PUSH:
+        err = git2r_async_run_remote(async);
+        break;
+    case GIT2R_ASYNC_STATUS:
+        err = git2r_async_run_status(async);
+        break;
+    default:
+        err = git2r_async_run_odb_blobs(async);
+        break;
+    }
+
+    git_mutex_lock(&async->lock);
+    if (err) {
+        const git_error *e = giterr_last();
+
+        async->err = err;
+        if (e && e->message)
+            async->message = strdup(e->message);
+        else if (GIT2R_ASYNC_STATUS == async->op ||
+                 GIT2R_ASYNC_ODB_BLOBS == async->op)
+            async->message = strdup("unknown error");
+        else
+            async->message = strdup(git2r_err_unable_to_authenticate);
+    }
+    async->done = 1;
+    git_mutex_unlock(&async->lock);
+
+    return NULL;
+}
+
+/**
+ * Start the worker thread
+ *
+ * The operation runs on the calling thread when libgit2 is built
+ * without threads (no GIT_THREADS), or if no thread could be
+ * created.
+ *
+ * @param async The operation.
+ */
+static void git2r_async_start(git2r_async *async)
+{
+#ifdef GIT_THREADS
+    if (!git_thread_create(&async->thread, git2r_async_worker, async)) {
+        async->started = 1;
+        return;
+    }
+#endif
+
+    git2r_async_worker(async);
+}
+
+/**
+ * Wait for the worker thread to finish
+ *
+ * @param async The operation.
+ */
+static void git2r_async_join(git2r_async *async)
+{
+    if (async->started) {
+        git_thread_join(&async->thread, NULL);
+        async->started = 0;
+    }
+}
+
+/**
+ * Cancel the operation, wait for the worker thread and free the
+ * operation
+ *
+ * @param handle The external pointer to the operation.
+ */
+static void git2r_async_close(SEXP handle)
+{
+    size_t i;
+    git2r_async *async = R_ExternalPtrAddr(handle);
+
+    if (!async)
+        return;
+    R_ClearExternalPtr(handle);
+
+    git_mutex_lock(&async->lock);
+    async->cancel = 1;
+    git_mutex_unlock(&async->lock);
+    git2r_async_join(async);
+
+    free(async->path);
+    free(async->url);
+    free(async->name);
+    free(async->msg);
+    free(async->branch);
+    for (i = 0; i < async->refspecs.count; i++)
+        free(async->refspecs.strings[i]);
+    free(async->refspecs.strings);
+    if (async->has_cred)
+        git2r_cred_data_free(&async->cred);
+    if (async->status_list)
+        git_status_list_free(async->status_list);
+    if (async->repository)
+        git_repository_free(async->repository);
+    git2r_odb_blobs_free(&async->blobs);
+    free(async->message);
+    git_mutex_free(&async->lock);
+    free(async);
+}
+
+/**
+ * Create the external pointer to a new operation
+ *
+ * The operation is freed, after waiting for a running worker thread,
+ * when the external pointer is garbage collected.
+ *
+ * @param op The operation.
+ * @param prot Kept alive by the external pointer.
+ * @return The external pointer.
+ */
+static SEXP git2r_async_handle(git2r_async_op op, SEXP prot)
+{
+    SEXP handle;
+    git2r_async *async;
+
+    PROTECT(handle = R_MakeExternalPtr(NULL, R_NilValue, prot));
+    R_RegisterCFinalizerEx(handle, git2r_async_close, TRUE);
+
+    async = calloc(1, sizeof(git2r_async));
+    if (!async || git_mutex_init(&async->lock)) {
+        free(async);
+        UNPROTECT(1);
+        git2r_error(__func__, NULL, git2r_err_alloc_memory_buffer, NULL);
+    }
+
+    async->op = op;
+    git2r_odb_blobs_init(&async->blobs);
+    R_SetExternalPtrAddr(handle, async);
+
+    UNPROTECT(1);
+
+    return handle;
+}
+
+/**
+ * Get the operation from the external pointer
+ *
+ * @param handle The external pointer.
+ * @return The operation, or NULL if it is already collected.
+ */
+static git2r_async *git2r_async_get(SEXP handle)
+{
+    if (TYPEOF(handle) != EXTPTRSXP)
+        return NULL;
+    return R_ExternalPtrAddr(handle);
+}
+
+static int git2r_async_strdup(char **dst, SEXP src)
+{
+    if (Rf_isNull(src))
+        return 0;
+
+    *dst = strdup(CHAR(STRING_ELT(src, 0)));
+    if (!*dst) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int git2r_async_refspecs(git2r_async *async, SEXP refspecs)
+{
+    size_t i, n;
+
+    if (Rf_isNull(refspecs))
+        return 0;
+
+    n = Rf_length(refspecs);
+    async->refspecs.strings = calloc(n ? n : 1, sizeof(char*));
+    if (!async->refspecs.strings) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return -1;
+    }
+
+    for (i = 0; i < n; i++) {
+        char **s;
+
+        if (NA_STRING == STRING_ELT(refspecs, i))
+            continue;
+
+        s = &async->refspecs.strings[async->refspecs.count];
+        *s = strdup(CHAR(STRING_ELT(refspecs, i)));
+        if (!*s) {
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            return -1;
+        }
+        async->refspecs.count++;
+    }
+
+    return 0;
+}
+
+static int git2r_async_repository(git2r_async *async, SEXP repo)
+{
+    return git2r_async_strdup(&async->path, GET_SLOT(repo, git2r_sym(path)));
+}
+
+/**
+ * Start an async clone of a remote repository
+ *
+ * @param url the remote repository to clone
+ * @param local_path local directory to clone to
+ * @param bare Create a bare repository.
+ * @param branch The name of the branch to checkout. Default is NULL
+ *        which means to use the remote's default branch.
+ * @param checkout Checkout HEAD after the clone is complete.
+ * @param credentials The credentials for remote repository access.
+ * @return External pointer to the operation
+ */
+SEXP git2r_async_clone(
+    SEXP url,
+    SEXP local_path,
+    SEXP bare,
+    SEXP branch,
+    SEXP checkout,
+    SEXP credentials)
+{
+    SEXP handle;
+    git2r_async *async;
+
+    if (git2r_arg_check_string(url))
+        git2r_error(__func__, NULL, "'url'", git2r_err_string_arg);
+    if (git2r_arg_check_string(local_path))
+        git2r_error(__func__, NULL, "'local_path'", git2r_err_string_arg);
+    if (git2r_arg_check_logical(bare))
+        git2r_error(__func__, NULL, "'bare'", git2r_err_logical_arg);
+    if ((!Rf_isNull(branch)) && git2r_arg_check_string(branch))
+        git2r_error(__func__, NULL, "'branch'", git2r_err_string_arg);
+    if (git2r_arg_check_logical(checkout))
+        git2r_error(__func__, NULL, "'checkout'", git2r_err_logical_arg);
+    if (git2r_arg_check_credentials(credentials))
+        git2r_error(__func__, NULL, "'credentials'", git2r_err_credentials_arg);
+
+    PROTECT(handle = git2r_async_handle(GIT2R_ASYNC_CLONE, credentials));
+    async = R_ExternalPtrAddr(handle);
+
+    async->bare = LOGICAL(bare)[0];
+    async->checkout = LOGICAL(checkout)[0];
+    if (git2r_async_strdup(&async->url, url) ||
+        git2r_async_strdup(&async->path, local_path) ||
+        git2r_async_strdup(&async->branch, branch)) {
+        UNPROTECT(1);
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+    }
+
+    git2r_cred_data_init(&async->cred, credentials);
+    async->has_cred = 1;
+
+    git2r_async_start(async);
+    UNPROTECT(1);
+
+    return handle;
+}
+
+/**
+ * Start an async fetch
+ *
+ * @param repo S4 class git_repository
+ * @param name The name of the remote to fetch from
+ * @param credentials The credentials for remote repository access.
+ * @param msg The one line long message to be appended to the reflog
+ * @param refspecs The refspecs to use for this fetch. Pass R_NilValue
+ *        to use the base refspecs.
+ * @return External pointer to the operation
+ */
+SEXP git2r_async_fetch(
+    SEXP repo,
+    SEXP name,
+    SEXP credentials,
+    SEXP msg,
+    SEXP refspecs)
+{
+    SEXP handle;
+    git2r_async *async;
+
+    if (git2r_arg_check_repository(repo))
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+    if (git2r_arg_check_string(name))
+        git2r_error(__func__, NULL, "'name'", git2r_err_string_arg);
+    if (git2r_arg_check_credentials(credentials))
+        git2r_error(__func__, NULL, "'credentials'", git2r_err_credentials_arg);
+    if (git2r_arg_check_string(msg))
+        git2r_error(__func__, NULL, "'msg'", git2r_err_string_arg);
+    if ((!Rf_isNull(refspecs)) && git2r_arg_check_string_vec(refspecs))
+        git2r_error(__func__, NULL, "'refspecs'", git2r_err_string_vec_arg);
+
+    PROTECT(handle = git2r_async_handle(GIT2R_ASYNC_FETCH, credentials));
+    async = R_ExternalPtrAddr(handle);
+
+    if (git2r_async_repository(async, repo) ||
+        git2r_async_strdup(&async->name, name) ||
+        git2r_async_strdup(&async->msg, msg) ||
+        git2r_async_refspecs(async, refspecs)) {
+        UNPROTECT(1);
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+    }
+
+    git2r_cred_data_init(&async->cred, credentials);
+    async->has_cred = 1;
+
+    git2r_async_start(async);
+    UNPROTECT(1);
+
+    return handle;
+}
+
+/**
+ * Start an async push
+ *
+ * @param repo S4 class git_repository
+ * @param name The remote to push to
+ * @param refspec The string vector of refspec to push
+ * @param credentials The credentials for remote repository access.
+ * @return External pointer to the operation
+ */
+SEXP git2r_async_push(SEXP repo, SEXP name, SEXP refspec, SEXP credentials)
+{
+    SEXP handle;
+    git2r_async *async;
+
+    if (git2r_arg_check_repository(repo))
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+    if (git2r_arg_check_string(name))
+        git2r_error(__func__, NULL, "'name'", git2r_err_string_arg);
+    if (git2r_arg_check_string_vec(refspec))
+        git2r_error(__func__, NULL, "'refspec'", git2r_err_string_vec_arg);
+    if (git2r_arg_check_credentials(credentials))
+        git2r_error(__func__, NULL, "'credentials'", git2r_err_credentials_arg);
+
+    PROTECT(handle = git2r_async_handle(GIT2R_ASYNC_PUSH, credentials));
+    async = R_ExternalPtrAddr(handle);
+
+    if (git2r_async_repository(async, repo) ||
+        git2r_async_strdup(&async->name, name) ||
+        git2r_async_refspecs(async, refspec)) {
+        UNPROTECT(1);
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+    }
+
+    git2r_cred_data_init(&async->cred, credentials);
+    async->has_cred = 1;
+
+    git2r_async_start(async);
+    UNPROTECT(1);
+
+    return handle;
+}
+
+/**
+ * Start an async status
+ *
+ * @param repo S4 class git_repository
+ * @param staged Include staged files.
+ * @param unstaged Include unstaged files.
+ * @param untracked Include untracked files and directories.
+ * @param all_untracked Shows individual files in untracked
+ *        directories if 'untracked' is 'TRUE'.
+ * @param ignored Include ignored files.
+ * @return External pointer to the operation
+ */
+SEXP git2r_async_status(
+    SEXP repo,
+    SEXP staged,
+    SEXP unstaged,
+    SEXP untracked,
+    SEXP all_untracked,
+    SEXP ignored)
+{
+    SEXP handle;
+    git2r_async *async;
+
+    if (git2r_arg_check_repository(repo))
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+    if (git2r_arg_check_logical(staged))
+        git2r_error(__func__, NULL, "'staged'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(unstaged))
+        git2r_error(__func__, NULL, "'unstaged'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(untracked))
+        git2r_error(__func__, NULL, "'untracked'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(all_untracked))
+        git2r_error(__func__, NULL, "'all_untracked'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(ignored))
+        git2r_error(__func__, NULL, "'ignored'", git2r_err_logical_arg);
+
+    PROTECT(handle = git2r_async_handle(GIT2R_ASYNC_STATUS, R_NilValue));
+    async = R_ExternalPtrAddr(handle);
+
+    async->staged = LOGICAL(staged)[0];
+    async->unstaged = LOGICAL(unstaged)[0];
+    async->untracked = LOGICAL(untracked)[0];
+    async->all_untracked = LOGICAL(all_untracked)[0];
+    async->ignored = LOGICAL(ignored)[0];
+    if (git2r_async_repository(async, repo)) {
+        UNPROTECT(1);
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+    }
+
+    git2r_async_start(async);
+    UNPROTECT(1);
+
+    return handle;
+}
+
+/**
+ * Start an async listing of the blobs in the object database
+ *
+ * @param repo S4 class git_repository
+ * @return External pointer to the operation
+ */
+SEXP git2r_async_odb_blobs(SEXP repo)
+{
+    SEXP handle;
+    git2r_async *async;
+
+    if (git2r_arg_check_repository(repo))
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    PROTECT(handle = git2r_async_handle(GIT2R_ASYNC_ODB_BLOBS, R_NilValue));
+    async = R_ExternalPtrAddr(handle);
+
+    if (git2r_async_repository(async, repo)) {
+        UNPROTECT(1);
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+    }
+
+    git2r_async_start(async);
+    UNPROTECT(1);
+
+    return handle;
+}
+
+/**
+ * Check if the operation is done, without waiting
+ *
+ * @param handle External pointer to the operation
+ * @return TRUE if done, else FALSE
+ */
+SEXP git2r_async_done(SEXP handle)
+{
+    int done;
+    git2r_async *async = git2r_async_get(handle);
+
+    if (!async)
+        git2r_error(__func__, NULL, "'handle'", git2r_err_async_arg);
+
+    git_mutex_lock(&async->lock);
+    done = async->done;
+    git_mutex_unlock(&async->lock);
+
+    return Rf_ScalarLogical(done);
+}
+
+/**
+ * Get the progress of the operation, without waiting
+ *
+ * @param handle External pointer to the operation
+ * @return S3 class git_transfer_progress
+ */
+SEXP git2r_async_progress(SEXP handle)
+{
+    SEXP result;
+    git_transfer_progress progress;
+    git2r_async *async = git2r_async_get(handle);
+
+    if (!async)
+        git2r_error(__func__, NULL, "'handle'", git2r_err_async_arg);
+
+    git_mutex_lock(&async->lock);
+    progress = async->progress;
+    git_mutex_unlock(&async->lock);
+
+    PROTECT(result = git2r_S3_new(git2r_S3_class__git_transfer_progress,
+                                  git2r_S3_items__git_transfer_progress));
+    git2r_transfer_progress_init(&progress, result);
+    UNPROTECT(1);
+
+    return result;
+}
+
+/**
+ * Create the R object with the result of the operation
+ *
+ * @param async The operation.
+ * @return The result.
+ */
+static SEXP git2r_async_result(git2r_async *async)
+{
+    SEXP result = R_NilValue;
+
+    switch (async->op) {
+    case GIT2R_ASYNC_FETCH:
+        PROTECT(result = git2r_S3_new(git2r_S3_class__git_transfer_progress,
+                                      git2r_S3_items__git_transfer_progress));
+        git2r_transfer_progress_init(&async->stats, result);
+        UNPROTECT(1);
+        break;
+    case GIT2R_ASYNC_PUSH:
+        if (!async->pushed)
+            break;
+        PROTECT(result = git2r_S3_new(git2r_S3_class__git_push_stats,
+                                      git2r_S3_items__git_push_stats));
+        SET_VECTOR_ELT(result, git2r_S3_item__git_push_stats__commits,
+                       Rf_ScalarInteger(async->push_stats.commits));
+        SET_VECTOR_ELT(result, git2r_S3_item__git_push_stats__objects,
+                       Rf_ScalarInteger(async->push_stats.objects));
+        SET_VECTOR_ELT(result, git2r_S3_item__git_push_stats__bases,
+                       Rf_ScalarInteger(async->push_stats.bases));
+        SET_VECTOR_ELT(result, git2r_S3_item__git_push_stats__deltas,
+                       Rf_ScalarInteger(async->push_stats.deltas));
+        SET_VECTOR_ELT(result, git2r_S3_item__git_push_stats__thin_deltas,
+                       Rf_ScalarInteger(async->push_stats.thin_deltas));
+        UNPROTECT(1);
+        break;
+    case GIT2R_ASYNC_STATUS:
+        result = git2r_status_list_value(async->status_list,
+                                         async->staged,
+                                         async->unstaged,
+                                         async->untracked,
+                                         async->ignored);
+        break;
+    case GIT2R_ASYNC_ODB_BLOBS:
+        result = git2r_odb_blobs_list(&async->blobs);
+        break;
+    default:
+        break;
+    }
+
+    return result;
+}
+
+/**
+ * Wait for the operation and collect the result
+ *
+ * The operation is freed, and the handle can not be used again.
+ *
+ * @param handle External pointer to the operation
+ * @return The result of the operation
+ */
+SEXP git2r_async_value(SEXP handle)
+{
+    SEXP result;
+    git2r_async *async = git2r_async_get(handle);
+
+    if (!async)
+        git2r_error(__func__, NULL, "'handle'", git2r_err_async_arg);
+
+    git2r_async_join(async);
+
+    if (async->err) {
+        if (async->message)
+            giterr_set_str(GITERR_NONE, async->message);
+        else
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        git2r_async_close(handle);
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+    }
+
+    PROTECT(result = git2r_async_result(async));
+    git2r_async_close(handle);
+    UNPROTECT(1);
+
+    return result;
+}
@@ -0,0 +1,51 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INCLUDE_git2r_async_h
+#define INCLUDE_git2r_async_h
+
+#include <R.h>
+#include <Rinternals.h>
+
+SEXP git2r_async_clone(
+    SEXP url,
+    SEXP local_path,
+    SEXP bare,
+    SEXP branch,
+    SEXP checkout,
+    SEXP credentials);
+SEXP git2r_async_done(SEXP handle);
+SEXP git2r_async_fetch(
+    SEXP repo,
+    SEXP name,
+    SEXP credentials,
+    SEXP msg,
+    SEXP refspecs);
+SEXP git2r_async_odb_blobs(SEXP repo);
+SEXP git2r_async_progress(SEXP handle);
+SEXP git2r_async_push(SEXP repo, SEXP name, SEXP refspec, SEXP credentials);
+SEXP git2r_async_status(
+    SEXP repo,
+    SEXP staged,
+    SEXP unstaged,
+    SEXP untracked,
+    SEXP all_untracked,
+    SEXP ignored);
+SEXP git2r_async_value(SEXP handle);
+
+#endif
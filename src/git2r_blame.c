@@ -22,6 +22,7 @@
 #include "git2r_arg.h"
 #include "git2r_blame.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_repository.h"
 #include "git2r_signature.h"
 
@@ -39,18 +40,18 @@ void git2r_blame_init(git_blame *source, SEXP repo, SEXP path, SEXP dest)
 {
     SEXP hunks;
     size_t i, n;
-    SEXP s_hunks = Rf_install("hunks");
-    SEXP s_lines_in_hunk = Rf_install("lines_in_hunk");
-    SEXP s_final_commit_id = Rf_install("final_commit_id");
-    SEXP s_final_start_line_number = Rf_install("final_start_line_number");
-    SEXP s_final_signature = Rf_install("final_signature");
-    SEXP s_orig_commit_id = Rf_install("orig_commit_id");
-    SEXP s_orig_start_line_number = Rf_install("orig_start_line_number");
-    SEXP s_orig_signature = Rf_install("orig_signature");
-    SEXP s_orig_path = Rf_install("orig_path");
-    SEXP s_boundary = Rf_install("boundary");
-    SEXP s_repo = Rf_install("repo");
-    SEXP s_path = Rf_install("path");
+    SEXP s_hunks = git2r_sym(hunks);
+    SEXP s_lines_in_hunk = git2r_sym(lines_in_hunk);
+    SEXP s_final_commit_id = git2r_sym(final_commit_id);
+    SEXP s_final_start_line_number = git2r_sym(final_start_line_number);
+    SEXP s_final_signature = git2r_sym(final_signature);
+    SEXP s_orig_commit_id = git2r_sym(orig_commit_id);
+    SEXP s_orig_start_line_number = git2r_sym(orig_start_line_number);
+    SEXP s_orig_signature = git2r_sym(orig_signature);
+    SEXP s_orig_path = git2r_sym(orig_path);
+    SEXP s_boundary = git2r_sym(boundary);
+    SEXP s_repo = git2r_sym(repo);
+    SEXP s_path = git2r_sym(path);
 
     n = git_blame_get_hunk_count(source);
     PROTECT(hunks = Rf_allocVector(VECSXP, n));
@@ -66,7 +67,7 @@ void git2r_blame_init(git_blame *source, SEXP repo, SEXP path, SEXP dest)
             SET_VECTOR_ELT(
                 hunks,
                 i,
-                item = NEW_OBJECT(MAKE_CLASS("git_blame_hunk")));
+                item = git2r_S4_new(git2r_S4_class__git_blame_hunk));
 
             SET_SLOT(item, s_lines_in_hunk, Rf_ScalarInteger(hunk->lines_in_hunk));
 
@@ -142,7 +143,7 @@ SEXP git2r_blame_file(SEXP repo, SEXP path)
     if (err)
         goto cleanup;
 
-    PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_blame")));
+    PROTECT(result = git2r_S4_new(git2r_S4_class__git_blame));
     git2r_blame_init(blame, repo, path, result);
 
 cleanup:
@@ -16,15 +16,19 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <string.h>
 #include "git2r_arg.h"
 #include "git2r_blob.h"
 #include "git2r_error.h"
+#include "git2r_lfs.h"
 #include "git2r_objects.h"
 #include "git2r_repository.h"
 
 /**
  * Get content of a blob
  *
+ * The content of a Git LFS pointer file is read from the LFS store,
+ * see git2r_lfs.c.
  * @param blob S3 class git_blob
  * @return content
  */
@@ -36,6 +40,7 @@ SEXP git2r_blob_content(SEXP blob)
     git_blob *blob_obj = NULL;
     git_oid oid;
     git_repository *repository = NULL;
+    git_buf lfs = {0};
 
     if (git2r_arg_check_blob(blob))
         git2r_error(__func__, NULL, "'blob'", git2r_err_blob_arg);
@@ -51,10 +56,22 @@ SEXP git2r_blob_content(SEXP blob)
     if (err)
         goto cleanup;
 
-    PROTECT(result = Rf_allocVector(STRSXP, 1));
-    SET_STRING_ELT(result, 0, Rf_mkChar(git_blob_rawcontent(blob_obj)));
+    err = git2r_lfs_blob_content(&lfs, repository, blob_obj);
+    if (err == GIT_ENOTFOUND) {
+        err = 0;
+        PROTECT(result = Rf_allocVector(STRSXP, 1));
+        SET_STRING_ELT(result, 0, Rf_mkChar(git_blob_rawcontent(blob_obj)));
+    } else if (!err) {
+        PROTECT(result = Rf_allocVector(STRSXP, 1));
+        if (memchr(lfs.ptr, '\0', lfs.size))
+            SET_STRING_ELT(result, 0, NA_STRING);
+        else
+            SET_STRING_ELT(result, 0, Rf_mkCharLen(lfs.ptr, (int)lfs.size));
+    }
 
 cleanup:
+    git_buf_free(&lfs);
+
     if (blob_obj)
         git_blob_free(blob_obj);
 
@@ -113,9 +130,8 @@ SEXP git2r_blob_create_fromdisk(SEXP repo, SEXP path)
                 goto cleanup;
 
             SET_VECTOR_ELT(result, i,
-                           item = Rf_mkNamed(VECSXP, git2r_S3_items__git_blob));
-            Rf_setAttrib(item, R_ClassSymbol,
-                         Rf_mkString(git2r_S3_class__git_blob));
+                           item = git2r_S3_new(git2r_S3_class__git_blob,
+                                               git2r_S3_items__git_blob));
             git2r_blob_init(blob, repo, item);
             git_blob_free(blob);
         }
@@ -181,9 +197,8 @@ SEXP git2r_blob_create_fromworkdir(SEXP repo, SEXP relative_path)
                 goto cleanup;
 
             SET_VECTOR_ELT(result, i,
-                           item = Rf_mkNamed(VECSXP, git2r_S3_items__git_blob));
-            Rf_setAttrib(item, R_ClassSymbol,
-                         Rf_mkString(git2r_S3_class__git_blob));
+                           item = git2r_S3_new(git2r_S3_class__git_blob,
+                                               git2r_S3_items__git_blob));
             git2r_blob_init(blob, repo, item);
             git_blob_free(blob);
         }
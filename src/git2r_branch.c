@@ -17,12 +17,20 @@
  */
 
 #include <Rdefines.h>
+#include "array.h"
+#include "commit_list.h"
+#include "oidmap.h"
+#include "pool.h"
+#include "pqueue.h"
 #include "refs.h"
+#include "revwalk.h"
+#include "strmap.h"
 
 #include "git2r_arg.h"
 #include "git2r_branch.h"
 #include "git2r_commit.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_reference.h"
 #include "git2r_repository.h"
 #include "git2r_signature.h"
@@ -82,9 +90,9 @@ int git2r_branch_init(
 {
     int err;
     const char *name;
-    SEXP s_name = Rf_install("name");
-    SEXP s_type = Rf_install("type");
-    SEXP s_repo = Rf_install("repo");
+    SEXP s_name = git2r_sym(name);
+    SEXP s_type = git2r_sym(type);
+    SEXP s_repo = git2r_sym(repo);
 
     err = git_branch_name(&name, source);
     if (err)
@@ -125,7 +133,7 @@ SEXP git2r_branch_create(
     if (git2r_arg_check_logical(force))
         git2r_error(__func__, NULL, "'force'", git2r_err_logical_arg);
 
-    repo = GET_SLOT(commit, Rf_install("repo"));
+    repo = GET_SLOT(commit, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
@@ -146,7 +154,7 @@ SEXP git2r_branch_create(
     if (err)
         goto cleanup;
 
-    PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_branch")));
+    PROTECT(result = git2r_S4_new(git2r_S4_class__git_branch));
     err = git2r_branch_init(reference, GIT_BRANCH_LOCAL, repo, result);
 
 cleanup:
@@ -185,12 +193,12 @@ SEXP git2r_branch_delete(SEXP branch)
     if (git2r_arg_check_branch(branch))
         git2r_error(__func__, NULL, "'branch'", git2r_err_branch_arg);
 
-    repository = git2r_repository_open(GET_SLOT(branch, Rf_install("repo")));
+    repository = git2r_repository_open(GET_SLOT(branch, git2r_sym(repo)));
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    name = CHAR(STRING_ELT(GET_SLOT(branch, Rf_install("name")), 0));
-    type = INTEGER(GET_SLOT(branch, Rf_install("type")))[0];
+    name = CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0));
+    type = INTEGER(GET_SLOT(branch, git2r_sym(type)))[0];
     err = git_branch_lookup(&reference, repository, name, type);
     if (err)
         goto cleanup;
@@ -227,17 +235,17 @@ SEXP git2r_branch_is_head(SEXP branch)
     if (git2r_arg_check_branch(branch))
         git2r_error(__func__, NULL, "'branch'", git2r_err_branch_arg);
 
-    repository = git2r_repository_open(GET_SLOT(branch, Rf_install("repo")));
+    repository = git2r_repository_open(GET_SLOT(branch, git2r_sym(repo)));
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    name = CHAR(STRING_ELT(GET_SLOT(branch, Rf_install("name")), 0));
+    name = CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0));
 
     err = git_branch_lookup(
         &reference,
         repository,
         name,
-        INTEGER(GET_SLOT(branch, Rf_install("type")))[0]);
+        INTEGER(GET_SLOT(branch, git2r_sym(type)))[0]);
     if (err)
         goto cleanup;
 
@@ -311,14 +319,14 @@ SEXP git2r_branch_list(SEXP repo, SEXP flags)
             goto cleanup;
         }
 
-        SET_VECTOR_ELT(result, i, branch = NEW_OBJECT(MAKE_CLASS("git_branch")));
+        SET_VECTOR_ELT(result, i, branch = git2r_S4_new(git2r_S4_class__git_branch));
         err = git2r_branch_init(reference, type, repo, branch);
         if (err)
             goto cleanup;
         SET_STRING_ELT(
             names,
             i,
-            STRING_ELT(GET_SLOT(branch, Rf_install("name")), 0));
+            STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0));
         if (reference)
             git_reference_free(reference);
         reference = NULL;
@@ -361,12 +369,12 @@ SEXP git2r_branch_canonical_name(SEXP branch)
     if (git2r_arg_check_branch(branch))
         git2r_error(__func__, NULL, "'branch'", git2r_err_branch_arg);
 
-    repository = git2r_repository_open(GET_SLOT(branch, Rf_install("repo")));
+    repository = git2r_repository_open(GET_SLOT(branch, git2r_sym(repo)));
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    name = CHAR(STRING_ELT(GET_SLOT(branch, Rf_install("name")), 0));
-    type = INTEGER(GET_SLOT(branch, Rf_install("type")))[0];
+    name = CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0));
+    type = INTEGER(GET_SLOT(branch, git2r_sym(type)))[0];
     err = git_branch_lookup(&reference, repository, name, type);
     if (err)
         goto cleanup;
@@ -411,11 +419,11 @@ SEXP git2r_branch_upstream_canonical_name(SEXP branch)
     if (git2r_arg_check_branch(branch))
         git2r_error(__func__, NULL, "'branch'", git2r_err_branch_arg);
 
-    type = INTEGER(GET_SLOT(branch, Rf_install("type")))[0];
+    type = INTEGER(GET_SLOT(branch, git2r_sym(type)))[0];
     if (GIT_BRANCH_LOCAL != type)
         git2r_error(__func__, NULL, git2r_err_branch_not_local, NULL);
 
-    repo = GET_SLOT(branch, Rf_install("repo"));
+    repo = GET_SLOT(branch, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
@@ -428,7 +436,7 @@ SEXP git2r_branch_upstream_canonical_name(SEXP branch)
         &buf,
         '.',
         "branch",
-        CHAR(STRING_ELT(GET_SLOT(branch, Rf_install("name")), 0)),
+        CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0)),
         "merge");
     if (err)
         goto cleanup;
@@ -477,15 +485,15 @@ SEXP git2r_branch_remote_name(SEXP branch)
     if (git2r_arg_check_branch(branch))
         git2r_error(__func__, NULL, "'branch'", git2r_err_branch_arg);
 
-    type = INTEGER(GET_SLOT(branch, Rf_install("type")))[0];
+    type = INTEGER(GET_SLOT(branch, git2r_sym(type)))[0];
     if (GIT_BRANCH_REMOTE != type)
         git2r_error(__func__, NULL, git2r_err_branch_not_remote, NULL);
 
-    repository = git2r_repository_open(GET_SLOT(branch, Rf_install("repo")));
+    repository = git2r_repository_open(GET_SLOT(branch, git2r_sym(repo)));
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    name = CHAR(STRING_ELT(GET_SLOT(branch, Rf_install("name")), 0));
+    name = CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0));
     err = git_branch_lookup(&reference, repository, name, type);
     if (err)
         goto cleanup;
@@ -537,15 +545,15 @@ SEXP git2r_branch_remote_url(SEXP branch)
     if (git2r_arg_check_branch(branch))
         git2r_error(__func__, NULL, "'branch'", git2r_err_branch_arg);
 
-    type = INTEGER(GET_SLOT(branch, Rf_install("type")))[0];
+    type = INTEGER(GET_SLOT(branch, git2r_sym(type)))[0];
     if (GIT_BRANCH_REMOTE != type)
         git2r_error(__func__, NULL, git2r_err_branch_not_remote, NULL);
 
-    repository = git2r_repository_open(GET_SLOT(branch, Rf_install("repo")));
+    repository = git2r_repository_open(GET_SLOT(branch, git2r_sym(repo)));
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    name = CHAR(STRING_ELT(GET_SLOT(branch, Rf_install("name")), 0));
+    name = CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0));
     err = git_branch_lookup(&reference, repository, name, type);
     if (err)
         goto cleanup;
@@ -619,13 +627,13 @@ SEXP git2r_branch_rename(
     if (git2r_arg_check_logical(force))
         git2r_error(__func__, NULL, "'force'", git2r_err_logical_arg);
 
-    repo = GET_SLOT(branch, Rf_install("repo"));
+    repo = GET_SLOT(branch, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    type = INTEGER(GET_SLOT(branch, Rf_install("type")))[0];
-    name = CHAR(STRING_ELT(GET_SLOT(branch, Rf_install("name")), 0));
+    type = INTEGER(GET_SLOT(branch, git2r_sym(type)))[0];
+    name = CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0));
     err = git_branch_lookup(&reference, repository, name, type);
     if (err)
         goto cleanup;
@@ -641,7 +649,7 @@ SEXP git2r_branch_rename(
     if (err)
         goto cleanup;
 
-    PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_branch")));
+    PROTECT(result = git2r_S4_new(git2r_S4_class__git_branch));
     err = git2r_branch_init(new_reference, type, repo, result);
 
 cleanup:
@@ -682,12 +690,12 @@ SEXP git2r_branch_target(SEXP branch)
     if (git2r_arg_check_branch(branch))
         git2r_error(__func__, NULL, "'branch'", git2r_err_branch_arg);
 
-    repository = git2r_repository_open(GET_SLOT(branch, Rf_install("repo")));
+    repository = git2r_repository_open(GET_SLOT(branch, git2r_sym(repo)));
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    name = CHAR(STRING_ELT(GET_SLOT(branch, Rf_install("name")), 0));
-    type = INTEGER(GET_SLOT(branch, Rf_install("type")))[0];
+    name = CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0));
+    type = INTEGER(GET_SLOT(branch, git2r_sym(type)))[0];
     err = git_branch_lookup(&reference, repository, name, type);
     if (err)
         goto cleanup;
@@ -737,13 +745,13 @@ SEXP git2r_branch_get_upstream(SEXP branch)
     if (git2r_arg_check_branch(branch))
         git2r_error(__func__, NULL, "'branch'", git2r_err_branch_arg);
 
-    repo = GET_SLOT(branch, Rf_install("repo"));
+    repo = GET_SLOT(branch, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    name = CHAR(STRING_ELT(GET_SLOT(branch, Rf_install("name")), 0));
-    type = INTEGER(GET_SLOT(branch, Rf_install("type")))[0];
+    name = CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0));
+    type = INTEGER(GET_SLOT(branch, git2r_sym(type)))[0];
     err = git_branch_lookup(&reference, repository, name, type);
     if (err)
         goto cleanup;
@@ -755,7 +763,7 @@ SEXP git2r_branch_get_upstream(SEXP branch)
         goto cleanup;
     }
 
-    PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_branch")));
+    PROTECT(result = git2r_S4_new(git2r_S4_class__git_branch));
     err = git2r_branch_init(upstream, GIT_BRANCH_REMOTE, repo, result);
 
 cleanup:
@@ -804,13 +812,13 @@ SEXP git2r_branch_set_upstream(SEXP branch, SEXP upstream_name)
         u_name = CHAR(STRING_ELT(upstream_name, 0));
     }
 
-    repo = GET_SLOT(branch, Rf_install("repo"));
+    repo = GET_SLOT(branch, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    name = CHAR(STRING_ELT(GET_SLOT(branch, Rf_install("name")), 0));
-    type = INTEGER(GET_SLOT(branch, Rf_install("type")))[0];
+    name = CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0));
+    type = INTEGER(GET_SLOT(branch, git2r_sym(type)))[0];
     err = git_branch_lookup(&reference, repository, name, type);
     if (err)
         goto cleanup;
@@ -829,3 +837,697 @@ cleanup:
 
     return R_NilValue;
 }
+
+/**
+ * A row in the branch table
+ */
+typedef struct {
+    const char *name;
+    git_branch_t type;
+    git_oid id;
+    int has_id;
+    int head;
+    const char *upstream;
+    git_oid upstream_id;
+    int has_upstream_id;
+    size_t tip; /* index of the tip of the branch in the walk */
+    size_t upstream_tip;
+    size_t ahead;
+    size_t behind;
+} git2r_branch_row;
+
+/**
+ * The 'branch.<name>.remote' and 'branch.<name>.merge' config of a
+ * branch
+ */
+typedef struct {
+    const char *remote;
+    const char *merge;
+} git2r_branch_config;
+
+/**
+ * Data structure to hold the state of the branch table
+ */
+typedef struct {
+    git_repository *repository;
+    git_pool strings;
+    git_array_t(git2r_branch_row) rows;
+    git_strmap *config; /* branch name -> git2r_branch_config */
+    git_strmap *remotes; /* remote name -> git_remote */
+} git2r_branch_table_data;
+
+/**
+ * Read the upstream config of all branches from one snapshot of the
+ * config
+ */
+static int git2r_branch_table_config(git2r_branch_table_data *data)
+{
+    int err;
+    git_config *cfg = NULL;
+    git_config_iterator *iter = NULL;
+    git_config_entry *entry;
+
+    err = git_repository_config_snapshot(&cfg, data->repository);
+    if (err)
+        goto cleanup;
+
+    err = git_config_iterator_glob_new(&iter, cfg, "^branch\\..+\\.(remote|merge)$");
+    if (err)
+        goto cleanup;
+
+    while (!(err = git_config_next(&entry, iter))) {
+        const char *name = entry->name + strlen("branch.");
+        const char *key = strrchr(entry->name, '.');
+        char *branch = git_pool_strndup(&data->strings, name, key - name);
+        char *value = git_pool_strdup(&data->strings, entry->value);
+        git2r_branch_config *config;
+        size_t pos;
+
+        if (!branch || !value) {
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            err = GIT_ERROR;
+            goto cleanup;
+        }
+
+        pos = git_strmap_lookup_index(data->config, branch);
+        if (git_strmap_valid_index(data->config, pos)) {
+            config = git_strmap_value_at(data->config, pos);
+        } else {
+            config = git_pool_mallocz(&data->strings, sizeof(git2r_branch_config));
+            if (!config) {
+                giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+                err = GIT_ERROR;
+                goto cleanup;
+            }
+            git_strmap_insert(data->config, branch, config, &err);
+            if (err < 0)
+                goto cleanup;
+        }
+
+        /* The last value wins, like in git */
+        if (!strcmp(key, ".remote"))
+            config->remote = value;
+        else
+            config->merge = value;
+    }
+
+    if (GIT_ITEROVER == err)
+        err = 0;
+
+cleanup:
+    git_config_iterator_free(iter);
+    git_config_free(cfg);
+
+    return err;
+}
+
+/**
+ * Find the upstream of a local branch from its config
+ *
+ * @param out The full name of the upstream branch, or empty if the
+ * branch has no upstream.
+ * @param data The branch table.
+ * @param name The name of the branch.
+ * @return 0 or an error code
+ */
+static int git2r_branch_table_upstream_name(
+    git_buf *out,
+    git2r_branch_table_data *data,
+    const char *name)
+{
+    int err;
+    size_t i, pos;
+    git2r_branch_config *config;
+    git_remote *remote;
+
+    pos = git_strmap_lookup_index(data->config, name);
+    if (!git_strmap_valid_index(data->config, pos))
+        return 0;
+    config = git_strmap_value_at(data->config, pos);
+    if (!config->remote || !config->merge)
+        return 0;
+
+    /* The upstream is a local branch */
+    if (!strcmp(config->remote, "."))
+        return git_buf_puts(out, config->merge);
+
+    /* Each remote is looked up once */
+    pos = git_strmap_lookup_index(data->remotes, config->remote);
+    if (git_strmap_valid_index(data->remotes, pos)) {
+        remote = git_strmap_value_at(data->remotes, pos);
+    } else {
+        err = git_remote_lookup(&remote, data->repository, config->remote);
+        if (GIT_ENOTFOUND == err || GIT_EINVALIDSPEC == err) {
+            giterr_clear();
+            remote = NULL;
+        } else if (err) {
+            return err;
+        }
+        git_strmap_insert(data->remotes, config->remote, remote, &err);
+        if (err < 0) {
+            git_remote_free(remote);
+            return err;
+        }
+    }
+
+    if (!remote)
+        return 0;
+
+    for (i = 0; i < git_remote_refspec_count(remote); i++) {
+        const git_refspec *spec = git_remote_get_refspec(remote, i);
+
+        if (GIT_DIRECTION_FETCH == git_refspec_direction(spec) &&
+            git_refspec_src_matches(spec, config->merge))
+            return git_refspec_transform(out, spec, config->merge);
+    }
+
+    return 0;
+}
+
+/**
+ * List the branches, with their target and the upstream of the
+ * local branches
+ */
+static int git2r_branch_table_rows(git2r_branch_table_data *data, int flags)
+{
+    int err;
+    git_branch_iterator *iter = NULL;
+    git_reference *reference = NULL, *resolved = NULL;
+    git_branch_t type;
+    git_buf upstream = GIT_BUF_INIT;
+
+    err = git_branch_iterator_new(&iter, data->repository, flags);
+    if (err)
+        goto cleanup;
+
+    while (!(err = git_branch_next(&reference, &type, iter))) {
+        const char *name;
+        git2r_branch_row *row = git_array_alloc(data->rows);
+
+        if (!row) {
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            err = GIT_ERROR;
+            goto cleanup;
+        }
+        memset(row, 0, sizeof(git2r_branch_row));
+
+        err = git_branch_name(&name, reference);
+        if (err)
+            goto cleanup;
+        row->name = git_pool_strdup(&data->strings, name);
+        GITERR_CHECK_ALLOC(row->name);
+        row->type = type;
+
+        /* A symbolic reference, e.g. 'origin/HEAD', can be dangling */
+        if (!git_reference_resolve(&resolved, reference)) {
+            git_oid_cpy(&row->id, git_reference_target(resolved));
+            row->has_id = 1;
+        }
+        giterr_clear();
+
+        if (GIT_BRANCH_LOCAL == type) {
+            row->head = git_branch_is_head(reference) == 1;
+
+            err = git2r_branch_table_upstream_name(&upstream, data, row->name);
+            if (err)
+                goto cleanup;
+            if (upstream.size) {
+                row->upstream = git_pool_strdup(&data->strings,
+                                                git_reference__shorthand(upstream.ptr));
+                GITERR_CHECK_ALLOC(row->upstream);
+
+                /* The upstream is gone if it is not fetched */
+                err = git_reference_name_to_id(&row->upstream_id,
+                                               data->repository, upstream.ptr);
+                if (!err) {
+                    row->has_upstream_id = 1;
+                } else if (GIT_ENOTFOUND == err) {
+                    giterr_clear();
+                    err = 0;
+                } else {
+                    goto cleanup;
+                }
+            }
+            git_buf_clear(&upstream);
+        }
+
+        git_reference_free(resolved);
+        resolved = NULL;
+        git_reference_free(reference);
+        reference = NULL;
+    }
+
+    if (GIT_ITEROVER == err)
+        err = 0;
+
+cleanup:
+    git_branch_iterator_free(iter);
+    git_reference_free(reference);
+    git_reference_free(resolved);
+    git_buf_free(&upstream);
+
+    return err;
+}
+
+/**
+ * A commit in the queue of the walk
+ */
+typedef struct {
+    git_commit_list_node *node;
+    size_t seq; /* commits with the same time are visited in order */
+} git2r_branch_walk_item;
+
+/**
+ * The commits that are reachable from each tip in the walk
+ */
+typedef struct {
+    git_revwalk *walk;
+    git_oidmap *tips; /* commit id -> index of tip + 1 */
+    git_array_t(git_commit_list_node *) nodes; /* the tips */
+    git_oidmap *bitmaps; /* commit id -> bitmap of tips */
+    git_pool pool;
+    git_pqueue queue;
+    size_t seq;
+    size_t width; /* the number of words in a bitmap */
+} git2r_branch_walk;
+
+static int git2r_branch_walk_cmp(const void *a, const void *b)
+{
+    const git2r_branch_walk_item *x = a, *y = b;
+
+    if (x->node->time != y->node->time)
+        return x->node->time < y->node->time ? 1 : -1;
+    return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+static int git2r_branch_walk_tip(git2r_branch_walk *w, const git_oid *id, size_t *tip)
+{
+    int err;
+    size_t pos = git_oidmap_lookup_index(w->tips, id);
+    git_commit_list_node *node, **slot;
+
+    if (git_oidmap_valid_index(w->tips, pos)) {
+        *tip = (size_t)git_oidmap_value_at(w->tips, pos) - 1;
+        return 0;
+    }
+
+    node = git_revwalk__commit_lookup(w->walk, id);
+    GITERR_CHECK_ALLOC(node);
+    slot = git_array_alloc(w->nodes);
+    GITERR_CHECK_ALLOC(slot);
+    *slot = node;
+    *tip = git_array_size(w->nodes) - 1;
+
+    git_oidmap_insert(w->tips, &node->oid, (void *)(*tip + 1), &err);
+    if (err < 0)
+        return err;
+
+    return 0;
+}
+
+/**
+ * Get the bitmap of the tips that reach a commit
+ */
+static uint64_t *git2r_branch_walk_bitmap(git2r_branch_walk *w, git_commit_list_node *node)
+{
+    int err;
+    uint64_t *bitmap;
+    size_t pos = git_oidmap_lookup_index(w->bitmaps, &node->oid);
+
+    if (git_oidmap_valid_index(w->bitmaps, pos))
+        return git_oidmap_value_at(w->bitmaps, pos);
+
+    bitmap = git_pool_mallocz(&w->pool, w->width * sizeof(uint64_t));
+    if (!bitmap) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return NULL;
+    }
+
+    git_oidmap_insert(w->bitmaps, &node->oid, bitmap, &err);
+    if (err < 0)
+        return NULL;
+
+    return bitmap;
+}
+
+/**
+ * Add a commit to the queue, PARENT1 marks a commit in the queue
+ */
+static int git2r_branch_walk_push(git2r_branch_walk *w, git_commit_list_node *node)
+{
+    git2r_branch_walk_item *item;
+
+    item = git_pool_malloc(&w->pool, sizeof(git2r_branch_walk_item));
+    GITERR_CHECK_ALLOC(item);
+    item->node = node;
+    item->seq = w->seq++;
+    node->flags |= PARENT1;
+
+    return git_pqueue_insert(&w->queue, item);
+}
+
+#define GIT2R_BRANCH_BIT(bitmap, i) (((bitmap)[(i) / 64] >> ((i) % 64)) & 1)
+
+/**
+ * Count the commits ahead and behind the upstream of all branches
+ * in one walk
+ *
+ * Each commit is marked with a bitmap of the tips that reach it,
+ * and the bitmaps are passed on to the parents, newest commit
+ * first. A commit that is reachable from the branch but not from
+ * its upstream is ahead, and behind in the opposite case. A commit
+ * that all tips reach is STALE, and the walk stops when only STALE
+ * commits are left in the queue. A commit is visited again if its
+ * bitmap changes after it is visited, i.e. from clock skew.
+ */
+static int git2r_branch_table_ahead_behind(git2r_branch_table_data *data)
+{
+    int err;
+    size_t i, j, n_rows = git_array_size(data->rows), n_tips, active = 0;
+    uint64_t *bitmap, *full = NULL;
+    git2r_branch_walk w;
+    git_array_t(git2r_branch_row *) pairs = GIT_ARRAY_INIT;
+
+    memset(&w, 0, sizeof(w));
+    git_pool_init(&w.pool, 1);
+
+    err = git_revwalk_new(&w.walk, data->repository);
+    if (err)
+        goto cleanup;
+    w.tips = git_oidmap_alloc();
+    w.bitmaps = git_oidmap_alloc();
+    if (!w.tips || !w.bitmaps) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        err = GIT_ERROR;
+        goto cleanup;
+    }
+
+    for (i = 0; i < n_rows; i++) {
+        git2r_branch_row *row = git_array_get(data->rows, i), **pair;
+
+        if (!row->has_id || !row->has_upstream_id)
+            continue;
+        if ((err = git2r_branch_walk_tip(&w, &row->id, &row->tip)) ||
+            (err = git2r_branch_walk_tip(&w, &row->upstream_id, &row->upstream_tip)))
+            goto cleanup;
+        pair = git_array_alloc(pairs);
+        if (!pair) {
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            err = GIT_ERROR;
+            goto cleanup;
+        }
+        *pair = row;
+    }
+
+    n_tips = git_array_size(w.nodes);
+    if (!n_tips)
+        goto cleanup;
+    w.width = (n_tips + 63) / 64;
+
+    full = git__calloc(w.width, sizeof(uint64_t));
+    GITERR_CHECK_ALLOC(full);
+    for (i = 0; i < n_tips; i++)
+        full[i / 64] |= (uint64_t)1 << (i % 64);
+
+    err = git_pqueue_init(&w.queue, 0, n_tips, git2r_branch_walk_cmp);
+    if (err)
+        goto cleanup;
+
+    for (i = 0; i < n_tips; i++) {
+        git_commit_list_node *node = *git_array_get(w.nodes, i);
+
+        if ((err = git_commit_list_parse(w.walk, node)) < 0)
+            goto cleanup;
+        bitmap = git2r_branch_walk_bitmap(&w, node);
+        if (!bitmap) {
+            err = GIT_ERROR;
+            goto cleanup;
+        }
+        bitmap[i / 64] |= (uint64_t)1 << (i % 64);
+        if ((err = git2r_branch_walk_push(&w, node)))
+            goto cleanup;
+        active++;
+    }
+
+    /* A tip that all tips reach, e.g. only one tip */
+    for (i = 0; i < n_tips; i++) {
+        git_commit_list_node *node = *git_array_get(w.nodes, i);
+
+        bitmap = git2r_branch_walk_bitmap(&w, node);
+        if (!memcmp(bitmap, full, w.width * sizeof(uint64_t)) && !(node->flags & STALE)) {
+            node->flags |= STALE;
+            active--;
+        }
+    }
+
+    while (active) {
+        git2r_branch_walk_item *item = git_pqueue_pop(&w.queue);
+        git_commit_list_node *commit;
+
+        if (!item)
+            break;
+        commit = item->node;
+        commit->flags &= ~PARENT1;
+        if (!(commit->flags & STALE))
+            active--;
+
+        bitmap = git2r_branch_walk_bitmap(&w, commit);
+        if (!bitmap) {
+            err = GIT_ERROR;
+            goto cleanup;
+        }
+
+        for (i = 0; i < commit->out_degree; i++) {
+            git_commit_list_node *parent = commit->parents[i];
+            uint64_t *parent_bitmap;
+            int changed = 0, stale = 1;
+
+            if (parent->flags & STALE)
+                continue;
+            if ((err = git_commit_list_parse(w.walk, parent)) < 0)
+                goto cleanup;
+            parent_bitmap = git2r_branch_walk_bitmap(&w, parent);
+            if (!parent_bitmap) {
+                err = GIT_ERROR;
+                goto cleanup;
+            }
+            for (j = 0; j < w.width; j++) {
+                changed |= (bitmap[j] & ~parent_bitmap[j]) != 0;
+                parent_bitmap[j] |= bitmap[j];
+                stale &= (parent_bitmap[j] == full[j]);
+            }
+
+            if (!changed)
+                continue;
+            if (stale) {
+                parent->flags |= STALE;
+                if (parent->flags & PARENT1)
+                    active--;
+            }
+            if (!(parent->flags & PARENT1)) {
+                if ((err = git2r_branch_walk_push(&w, parent)))
+                    goto cleanup;
+                if (!stale)
+                    active++;
+            }
+        }
+    }
+
+    /* With clock skew, a commit can be visited before all its
+     * descendants, and the commits below the STALE commits left in
+     * the queue can have partial bitmaps. Only the commits with a
+     * bitmap are counted, so mark the STALE commits down to them. */
+    while (git_pqueue_size(&w.queue)) {
+        git2r_branch_walk_item *item = git_pqueue_pop(&w.queue);
+
+        item->node->flags &= ~PARENT1;
+        for (i = 0; i < item->node->out_degree; i++) {
+            git_commit_list_node *parent = item->node->parents[i];
+            size_t pos;
+
+            if (parent->flags & STALE)
+                continue;
+            pos = git_oidmap_lookup_index(w.bitmaps, &parent->oid);
+            if (!git_oidmap_valid_index(w.bitmaps, pos))
+                continue;
+            parent->flags |= STALE;
+            memcpy(git_oidmap_value_at(w.bitmaps, pos), full,
+                   w.width * sizeof(uint64_t));
+            if (!(parent->flags & PARENT1) &&
+                (err = git2r_branch_walk_push(&w, parent)))
+                goto cleanup;
+        }
+    }
+
+    /* Count the commits in the bitmaps */
+    git_oidmap_foreach_value(w.bitmaps, bitmap, {
+        if (memcmp(bitmap, full, w.width * sizeof(uint64_t))) {
+            for (i = 0; i < git_array_size(pairs); i++) {
+                git2r_branch_row *row = *git_array_get(pairs, i);
+                int tip = GIT2R_BRANCH_BIT(bitmap, row->tip);
+                int upstream = GIT2R_BRANCH_BIT(bitmap, row->upstream_tip);
+
+                if (tip && !upstream)
+                    row->ahead++;
+                else if (upstream && !tip)
+                    row->behind++;
+            }
+        }
+    });
+
+cleanup:
+    git__free(full);
+    git_pqueue_free(&w.queue);
+    git_array_clear(pairs);
+    git_array_clear(w.nodes);
+    git_oidmap_free(w.tips);
+    git_oidmap_free(w.bitmaps);
+    git_pool_clear(&w.pool);
+    git_revwalk_free(w.walk);
+
+    return err;
+}
+
+/**
+ * List branches as a table
+ *
+ * The references are iterated once, and the upstreams are resolved
+ * from one snapshot of the config. The commits ahead and behind the
+ * upstreams are counted in one walk for all branches.
+ *
+ * @param repo S4 class git_repository
+ * @param flags Filtering flags for the branch listing. Valid values
+ *        are 1 (LOCAL), 2 (REMOTE) and 3 (ALL)
+ * @param upstream Include the columns 'upstream' and
+ *        'upstream_sha'.
+ * @param ahead_behind Include the columns 'ahead' and 'behind'.
+ * @return list with the columns 'name', 'type', 'sha' and 'head',
+ * and the requested columns
+ */
+SEXP git2r_branch_table(SEXP repo, SEXP flags, SEXP upstream, SEXP ahead_behind)
+{
+    int err;
+    SEXP result = R_NilValue;
+    SEXP names;
+    size_t i, n, n_columns = 4;
+    git2r_branch_table_data data;
+    char sha[GIT_OID_HEXSZ + 1];
+
+    if (git2r_arg_check_integer(flags))
+        git2r_error(__func__, NULL, "'flags'", git2r_err_integer_arg);
+    if (git2r_arg_check_logical(upstream))
+        git2r_error(__func__, NULL, "'upstream'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(ahead_behind))
+        git2r_error(__func__, NULL, "'ahead_behind'", git2r_err_logical_arg);
+
+    memset(&data, 0, sizeof(data));
+    git_pool_init(&data.strings, 1);
+
+    data.repository = git2r_repository_open(repo);
+    if (!data.repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    if ((err = git_strmap_alloc(&data.config)) ||
+        (err = git_strmap_alloc(&data.remotes)))
+        goto cleanup;
+
+    err = git2r_branch_table_config(&data);
+    if (err)
+        goto cleanup;
+    err = git2r_branch_table_rows(&data, INTEGER(flags)[0]);
+    if (err)
+        goto cleanup;
+    if (LOGICAL(ahead_behind)[0]) {
+        err = git2r_branch_table_ahead_behind(&data);
+        if (err)
+            goto cleanup;
+    }
+
+    if (LOGICAL(upstream)[0])
+        n_columns += 2;
+    if (LOGICAL(ahead_behind)[0])
+        n_columns += 2;
+    n = git_array_size(data.rows);
+
+    PROTECT(result = Rf_allocVector(VECSXP, n_columns));
+    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, n_columns));
+    SET_VECTOR_ELT(result, 0, Rf_allocVector(STRSXP, n));
+    SET_STRING_ELT(names,  0, Rf_mkChar("name"));
+    SET_VECTOR_ELT(result, 1, Rf_allocVector(STRSXP, n));
+    SET_STRING_ELT(names,  1, Rf_mkChar("type"));
+    SET_VECTOR_ELT(result, 2, Rf_allocVector(STRSXP, n));
+    SET_STRING_ELT(names,  2, Rf_mkChar("sha"));
+    SET_VECTOR_ELT(result, 3, Rf_allocVector(LGLSXP, n));
+    SET_STRING_ELT(names,  3, Rf_mkChar("head"));
+    if (LOGICAL(upstream)[0]) {
+        SET_VECTOR_ELT(result, 4, Rf_allocVector(STRSXP, n));
+        SET_STRING_ELT(names,  4, Rf_mkChar("upstream"));
+        SET_VECTOR_ELT(result, 5, Rf_allocVector(STRSXP, n));
+        SET_STRING_ELT(names,  5, Rf_mkChar("upstream_sha"));
+    }
+    if (LOGICAL(ahead_behind)[0]) {
+        SET_VECTOR_ELT(result, n_columns - 2, Rf_allocVector(INTSXP, n));
+        SET_STRING_ELT(names,  n_columns - 2, Rf_mkChar("ahead"));
+        SET_VECTOR_ELT(result, n_columns - 1, Rf_allocVector(INTSXP, n));
+        SET_STRING_ELT(names,  n_columns - 1, Rf_mkChar("behind"));
+    }
+
+    for (i = 0; i < n; i++) {
+        git2r_branch_row *row = git_array_get(data.rows, i);
+
+        SET_STRING_ELT(VECTOR_ELT(result, 0), i, Rf_mkChar(row->name));
+        SET_STRING_ELT(VECTOR_ELT(result, 1), i, Rf_mkChar(
+                           GIT_BRANCH_LOCAL == row->type ? "local" : "remote"));
+        if (row->has_id) {
+            git_oid_tostr(sha, sizeof(sha), &row->id);
+            SET_STRING_ELT(VECTOR_ELT(result, 2), i, Rf_mkChar(sha));
+        } else {
+            SET_STRING_ELT(VECTOR_ELT(result, 2), i, NA_STRING);
+        }
+        LOGICAL(VECTOR_ELT(result, 3))[i] = row->head;
+
+        if (LOGICAL(upstream)[0]) {
+            SET_STRING_ELT(VECTOR_ELT(result, 4), i,
+                           row->upstream ? Rf_mkChar(row->upstream) : NA_STRING);
+            if (row->has_upstream_id) {
+                git_oid_tostr(sha, sizeof(sha), &row->upstream_id);
+                SET_STRING_ELT(VECTOR_ELT(result, 5), i, Rf_mkChar(sha));
+            } else {
+                SET_STRING_ELT(VECTOR_ELT(result, 5), i, NA_STRING);
+            }
+        }
+
+        if (LOGICAL(ahead_behind)[0]) {
+            int known = row->has_id && row->has_upstream_id;
+
+            INTEGER(VECTOR_ELT(result, n_columns - 2))[i] =
+                known ? (int)row->ahead : NA_INTEGER;
+            INTEGER(VECTOR_ELT(result, n_columns - 1))[i] =
+                known ? (int)row->behind : NA_INTEGER;
+        }
+    }
+
+cleanup:
+    if (data.remotes) {
+        git_remote *remote;
+
+        git_strmap_foreach_value(data.remotes, remote, {
+            git_remote_free(remote);
+        });
+    }
+    git_strmap_free(data.remotes);
+    git_strmap_free(data.config);
+    git_array_clear(data.rows);
+    git_pool_clear(&data.strings);
+
+    if (data.repository)
+        git_repository_free(data.repository);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
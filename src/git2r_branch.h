@@ -39,6 +39,7 @@ SEXP git2r_branch_rename(SEXP branch, SEXP new_branch_name, SEXP force);
 SEXP git2r_branch_target(SEXP branch);
 SEXP git2r_branch_get_upstream(SEXP branch);
 SEXP git2r_branch_set_upstream(SEXP branch, SEXP upstream_name);
+SEXP git2r_branch_table(SEXP repo, SEXP flags, SEXP upstream, SEXP ahead_behind);
 SEXP git2r_branch_upstream_canonical_name(SEXP branch);
 
 #endif
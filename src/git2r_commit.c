@@ -24,6 +24,7 @@
 #include "git2r_arg.h"
 #include "git2r_commit.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_oid.h"
 #include "git2r_repository.h"
 #include "git2r_signature.h"
@@ -334,7 +335,7 @@ SEXP git2r_commit(
     if (err)
         goto cleanup;
 
-    PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_commit")));
+    PROTECT(result = git2r_S4_new(git2r_S4_class__git_commit));
     git2r_commit_init(commit, repo, result);
 
 cleanup:
@@ -378,11 +379,74 @@ int git2r_commit_lookup(
     SEXP sha;
     git_oid oid;
 
-    sha = GET_SLOT(commit, Rf_install("sha"));
+    sha = GET_SLOT(commit, git2r_sym(sha));
     git_oid_fromstr(&oid, CHAR(STRING_ELT(sha, 0)));
     return git_commit_lookup(out, repository, &oid);
 }
 
+/**
+ * Lookup a commit and parse only the tree, parents, author and
+ * committer. The encoding, header and message of the commit are not
+ * copied, which makes it cheap to read signatures from many commits.
+ *
+ * @param out Pointer to the looked up commit. The commit is not
+ * owned by the object cache. If 'pool' is NULL it must be released
+ * with git_commit__free, else it is released when the pool is
+ * cleared.
+ * @param odb The object database to read the commit from
+ * @param oid The id of the commit
+ * @param pool Optional arena to allocate the commit from, or NULL.
+ * @return 0 or an error code
+ */
+int git2r_commit_lookup_quick(
+    git_commit **out,
+    git_odb *odb,
+    const git_oid *oid,
+    git_pool *pool)
+{
+    int err;
+    git_odb_object *obj = NULL;
+    git_commit *commit = NULL;
+
+    err = git_odb_read(&obj, odb, oid);
+    if (err)
+        return err;
+
+    if (git_odb_object_type(obj) != GIT_OBJ_COMMIT) {
+        giterr_set_str(GITERR_NONE, git2r_err_object_type);
+        err = GIT_ERROR;
+        goto cleanup;
+    }
+
+    if (pool) {
+        err = git_commit__parse_pool(out, obj, pool);
+        goto cleanup;
+    }
+
+    commit = git__calloc(1, sizeof(git_commit));
+    if (!commit) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        err = GIT_ERROR;
+        goto cleanup;
+    }
+
+    git_oid_cpy(&commit->object.cached.oid, oid);
+    commit->object.cached.type = GIT_OBJ_COMMIT;
+
+    err = git_commit__parse_ext(commit, obj, GIT_COMMIT_PARSE_QUICK);
+    if (err) {
+        git_commit__free(commit);
+        goto cleanup;
+    }
+
+    *out = commit;
+
+cleanup:
+    git_odb_object_free(obj);
+
+    return err;
+}
+
 /**
  * Get the tree pointed to by a commit
  *
@@ -401,7 +465,7 @@ SEXP git2r_commit_tree(SEXP commit)
     if (git2r_arg_check_commit_stash(commit))
         git2r_error(__func__, NULL, "'commit'", git2r_err_commit_stash_arg);
 
-    repo = GET_SLOT(commit, Rf_install("repo"));
+    repo = GET_SLOT(commit, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
@@ -414,7 +478,7 @@ SEXP git2r_commit_tree(SEXP commit)
     if (err)
         goto cleanup;
 
-    PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_tree")));
+    PROTECT(result = git2r_S4_new(git2r_S4_class__git_tree));
     git2r_tree_init((git_tree*)tree, repo, result);
 
 cleanup:
@@ -451,12 +515,12 @@ void git2r_commit_init(git_commit *source, SEXP repo, SEXP dest)
     const git_signature *author;
     const git_signature *committer;
     char sha[GIT_OID_HEXSZ + 1];
-    SEXP s_sha = Rf_install("sha");
-    SEXP s_author = Rf_install("author");
-    SEXP s_committer = Rf_install("committer");
-    SEXP s_summary = Rf_install("summary");
-    SEXP s_message = Rf_install("message");
-    SEXP s_repo = Rf_install("repo");
+    SEXP s_sha = git2r_sym(sha);
+    SEXP s_author = git2r_sym(author);
+    SEXP s_committer = git2r_sym(committer);
+    SEXP s_summary = git2r_sym(summary);
+    SEXP s_message = git2r_sym(message);
+    SEXP s_repo = git2r_sym(repo);
 
     git_oid_fmt(sha, git_commit_id(source));
     sha[GIT_OID_HEXSZ] = '\0';
@@ -499,7 +563,7 @@ SEXP git2r_commit_parent_list(SEXP commit)
     if (git2r_arg_check_commit(commit))
         git2r_error(__func__, NULL, "'commit'", git2r_err_commit_arg);
 
-    repo = GET_SLOT(commit, Rf_install("repo"));
+    repo = GET_SLOT(commit, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
@@ -519,7 +583,7 @@ SEXP git2r_commit_parent_list(SEXP commit)
         if (err)
             goto cleanup;
 
-        SET_VECTOR_ELT(list, i, item = NEW_OBJECT(MAKE_CLASS("git_commit")));
+        SET_VECTOR_ELT(list, i, item = git2r_S4_new(git2r_S4_class__git_commit));
         git2r_commit_init(parent, repo, item);
         git_commit_free(parent);
     }
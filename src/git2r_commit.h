@@ -23,6 +23,13 @@
 #include <Rinternals.h>
 
 #include "git2.h"
+#include "pool.h"
+
+/**
+ * Number of commits parsed into an arena with
+ * git2r_commit_lookup_quick before it is cleared.
+ */
+#define GIT2R_COMMIT_ARENA_BATCH 1024
 
 SEXP git2r_commit(
     SEXP repo,
@@ -33,6 +40,11 @@ int git2r_commit_lookup(
     git_commit **out,
     git_repository *repository,
     SEXP commit);
+int git2r_commit_lookup_quick(
+    git_commit **out,
+    git_odb *odb,
+    const git_oid *oid,
+    git_pool *pool);
 SEXP git2r_commit_tree(SEXP commit);
 void git2r_commit_init(git_commit *source, SEXP repo, SEXP dest);
 SEXP git2r_commit_parent_list(SEXP commit);
@@ -20,10 +20,15 @@
 #include <Rinternals.h>
 /* #include <Rdefines.h> */
 
+#include <time.h>
+
 #include "buffer.h"
 #include "common.h"
+#include "hash.h"
 
+#include "git2r_arg.h"
 #include "git2r_cred.h"
+#include "git2r_error.h"
 #include "git2r_objects.h"
 #include "git2r_transfer.h"
 
@@ -192,6 +197,316 @@ static int git2r_cred_user_pass(
     return -1;
 }
 
+/**
+ * Credentials resolved from an R credentials object, kept for
+ * 'git2r_cred_cache_ttl' seconds. The key is the url, the username
+ * from the url, the allowed types and a hash of the R object. The
+ * secrets are zeroed when the entry is freed.
+ */
+typedef struct {
+    char *url;
+    char *username_from_url;
+    unsigned int allowed_types;
+    git_oid object;
+    time_t created;
+    unsigned int type;
+    char *username;
+    char *password;
+    char *publickey;
+    char *privatekey;
+    char *passphrase;
+} git2r_cred_cache_entry;
+
+#define GIT2R_CRED_CACHE_MAX 32
+
+static git2r_cred_cache_entry *git2r_cred_cache_entries[GIT2R_CRED_CACHE_MAX];
+static size_t git2r_cred_cache_n = 0;
+static int git2r_cred_cache_ttl = 0;
+
+static void git2r_cred_cache_strfree(char *str)
+{
+    if (str) {
+        git__memzero(str, strlen(str));
+        git__free(str);
+    }
+}
+
+static void git2r_cred_cache_entry_free(git2r_cred_cache_entry *entry)
+{
+    git__free(entry->url);
+    git__free(entry->username_from_url);
+    git2r_cred_cache_strfree(entry->username);
+    git2r_cred_cache_strfree(entry->password);
+    git__free(entry->publickey);
+    git__free(entry->privatekey);
+    git2r_cred_cache_strfree(entry->passphrase);
+    git__memzero(entry, sizeof(git2r_cred_cache_entry));
+    git__free(entry);
+}
+
+static void git2r_cred_cache_remove(size_t i)
+{
+    git2r_cred_cache_entry_free(git2r_cred_cache_entries[i]);
+    memmove(&git2r_cred_cache_entries[i], &git2r_cred_cache_entries[i + 1],
+            (git2r_cred_cache_n - i - 1) * sizeof(git2r_cred_cache_entry *));
+    git2r_cred_cache_n--;
+}
+
+static void git2r_cred_cache_expire(void)
+{
+    time_t now = time(NULL);
+    size_t i = git2r_cred_cache_n;
+
+    while (i-- > 0) {
+        if (now - git2r_cred_cache_entries[i]->created >= git2r_cred_cache_ttl)
+            git2r_cred_cache_remove(i);
+    }
+}
+
+/**
+ * Free all cached credentials
+ */
+void git2r_cred_cache_clear(void)
+{
+    while (git2r_cred_cache_n)
+        git2r_cred_cache_remove(git2r_cred_cache_n - 1);
+}
+
+/**
+ * Hash the class and the elements of an R credentials object
+ */
+static int git2r_cred_cache_object(git_oid *out, SEXP credentials)
+{
+    int err;
+    R_xlen_t i;
+    SEXP names = Rf_getAttrib(credentials, R_NamesSymbol);
+    git_buf buf = GIT_BUF_INIT;
+
+    git_buf_puts(&buf, CHAR(STRING_ELT(Rf_getAttrib(credentials, R_ClassSymbol), 0)));
+    for (i = 0; i < XLENGTH(credentials); i++) {
+        SEXP elem = VECTOR_ELT(credentials, i);
+
+        git_buf_putc(&buf, '\n');
+        if (!Rf_isNull(names))
+            git_buf_puts(&buf, CHAR(STRING_ELT(names, i)));
+        git_buf_putc(&buf, '=');
+        if (Rf_isString(elem) && Rf_length(elem) && NA_STRING != STRING_ELT(elem, 0))
+            git_buf_puts(&buf, CHAR(STRING_ELT(elem, 0)));
+    }
+
+    if (git_buf_oom(&buf))
+        err = -1;
+    else
+        err = git_hash_buf(out, git_buf_cstr(&buf), git_buf_len(&buf));
+
+    git__memzero(buf.ptr, buf.asize);
+    git_buf_free(&buf);
+
+    return err;
+}
+
+static size_t git2r_cred_cache_find(
+    const char *url,
+    const char *username_from_url,
+    unsigned int allowed_types,
+    const git_oid *object)
+{
+    size_t i;
+
+    for (i = 0; i < git2r_cred_cache_n; i++) {
+        git2r_cred_cache_entry *entry = git2r_cred_cache_entries[i];
+
+        if (entry->allowed_types == allowed_types &&
+            !git_oid_cmp(&entry->object, object) &&
+            !git__strcmp(entry->url, url) &&
+            !git__strcmp(entry->username_from_url ? entry->username_from_url : "",
+                         username_from_url ? username_from_url : ""))
+            return i;
+    }
+
+    return git2r_cred_cache_n;
+}
+
+static int git2r_cred_cache_put(
+    const char *url,
+    const char *username_from_url,
+    unsigned int allowed_types,
+    const git_oid *object,
+    const git2r_cred_data *data)
+{
+    git2r_cred_cache_entry *entry;
+
+    entry = git__calloc(1, sizeof(git2r_cred_cache_entry));
+    if (!entry)
+        return -1;
+
+    entry->url = git__strdup(url);
+    if (username_from_url)
+        entry->username_from_url = git__strdup(username_from_url);
+    entry->allowed_types = allowed_types;
+    git_oid_cpy(&entry->object, object);
+    entry->created = time(NULL);
+    entry->type = data->type;
+    if (data->username)
+        entry->username = git__strdup(data->username);
+    if (data->password)
+        entry->password = git__strdup(data->password);
+    if (data->publickey)
+        entry->publickey = git__strdup(data->publickey);
+    if (data->privatekey)
+        entry->privatekey = git__strdup(data->privatekey);
+    if (data->passphrase)
+        entry->passphrase = git__strdup(data->passphrase);
+
+    if (!entry->url ||
+        (username_from_url && !entry->username_from_url) ||
+        (data->username && !entry->username) ||
+        (data->password && !entry->password) ||
+        (data->publickey && !entry->publickey) ||
+        (data->privatekey && !entry->privatekey) ||
+        (data->passphrase && !entry->passphrase)) {
+        git2r_cred_cache_entry_free(entry);
+        return -1;
+    }
+
+    /* Replace the oldest entry when the cache is full */
+    if (git2r_cred_cache_n == GIT2R_CRED_CACHE_MAX)
+        git2r_cred_cache_remove(0);
+    git2r_cred_cache_entries[git2r_cred_cache_n++] = entry;
+
+    return 0;
+}
+
+/**
+ * Create credentials from the cache, or resolve them from the R
+ * object and add them to the cache
+ *
+ * A second request for the same credentials during a transfer means
+ * that the credentials in the cache failed to authenticate. They are
+ * removed, and the credentials are resolved from the R object for
+ * the rest of the transfer.
+ */
+static int git2r_cred_cache_acquire(
+    git_cred **cred,
+    const char *url,
+    const char *username_from_url,
+    unsigned int allowed_types,
+    git2r_transfer_data *transfer)
+{
+    int err;
+    size_t i;
+    git_oid object;
+    git2r_cred_data data;
+
+    if (git2r_cred_cache_object(&object, transfer->credentials))
+        return -1;
+
+    git2r_cred_cache_expire();
+    i = git2r_cred_cache_find(url, username_from_url, allowed_types, &object);
+    if (i < git2r_cred_cache_n) {
+        git2r_cred_cache_entry *entry = git2r_cred_cache_entries[i];
+
+        if (transfer->cred_cache == GIT2R_CRED_CACHE_NONE) {
+            transfer->cred_cache = GIT2R_CRED_CACHE_HIT;
+
+            memset(&data, 0, sizeof(git2r_cred_data));
+            data.type = entry->type;
+            data.username = entry->username;
+            data.password = entry->password;
+            data.publickey = entry->publickey;
+            data.privatekey = entry->privatekey;
+            data.passphrase = entry->passphrase;
+            data.ssh_key_agent_tried = 1;
+
+            return git2r_cred_data_acquire_cb(
+                cred, url, username_from_url, allowed_types, &data);
+        }
+
+        /* Authentication failed */
+        git2r_cred_cache_remove(i);
+    }
+
+    /* Don't cache credentials that have failed during the transfer */
+    if (transfer->cred_cache == GIT2R_CRED_CACHE_HIT)
+        transfer->cred_cache = GIT2R_CRED_CACHE_FAILED;
+
+    if (git2r_cred_data_init(&data, transfer->credentials)) {
+        git2r_cred_data_free(&data);
+        return -1;
+    }
+
+    err = git2r_cred_data_acquire_cb(
+        cred, url, username_from_url, allowed_types, &data);
+    if (!err && transfer->cred_cache == GIT2R_CRED_CACHE_NONE) {
+        if (git2r_cred_cache_put(url, username_from_url, allowed_types,
+                                 &object, &data))
+            giterr_clear();
+        else
+            transfer->cred_cache = GIT2R_CRED_CACHE_HIT;
+    }
+
+    git2r_cred_data_free(&data);
+
+    return err;
+}
+
+/**
+ * Set the time to keep credentials in the cache and list the cached
+ * credentials
+ *
+ * @param ttl The number of seconds to keep credentials, 0 to clear
+ * the cache and not keep any. R_NilValue to only list the cached
+ * credentials.
+ * @return list with the columns url, username, type and age. The
+ * secrets are not listed.
+ */
+SEXP git2r_cred_cache(SEXP ttl)
+{
+    size_t i, j;
+    SEXP result, names;
+    time_t now = time(NULL);
+
+    if (!Rf_isNull(ttl)) {
+        if (git2r_arg_check_integer_gte_zero(ttl))
+            git2r_error(__func__, NULL, "'ttl'", git2r_err_integer_gte_zero_arg);
+        git2r_cred_cache_ttl = INTEGER(ttl)[0];
+    }
+
+    git2r_cred_cache_expire();
+
+    PROTECT(result = Rf_allocVector(VECSXP, 4));
+    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 4));
+
+    j = 0;
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP, git2r_cred_cache_n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("url"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP, git2r_cred_cache_n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("username"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP, git2r_cred_cache_n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("type"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(INTSXP, git2r_cred_cache_n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("age"));
+
+    for (i = 0; i < git2r_cred_cache_n; i++) {
+        git2r_cred_cache_entry *entry = git2r_cred_cache_entries[i];
+
+        SET_STRING_ELT(VECTOR_ELT(result, 0), i, Rf_mkChar(entry->url));
+        if (entry->username && strcmp(entry->username, " "))
+            SET_STRING_ELT(VECTOR_ELT(result, 1), i, Rf_mkChar(entry->username));
+        else if (entry->username_from_url)
+            SET_STRING_ELT(VECTOR_ELT(result, 1), i, Rf_mkChar(entry->username_from_url));
+        else
+            SET_STRING_ELT(VECTOR_ELT(result, 1), i, NA_STRING);
+        SET_STRING_ELT(VECTOR_ELT(result, 2), i, Rf_mkChar(
+            entry->type == GIT_CREDTYPE_SSH_KEY ? "ssh_key" : "user_pass"));
+        INTEGER(VECTOR_ELT(result, 3))[i] = (int)(now - entry->created);
+    }
+
+    UNPROTECT(1);
+
+    return result;
+}
+
 /**
  * Callback if the remote host requires authentication in order to
  * connect to it
@@ -213,8 +528,6 @@ int git2r_cred_acquire_cb(
 {
     SEXP credentials;
 
-    GIT_UNUSED(url);
-
     if (!payload)
         return -1;
 
@@ -232,6 +545,12 @@ int git2r_cred_acquire_cb(
         return -1;
     }
 
+    if (git2r_cred_cache_ttl) {
+        return git2r_cred_cache_acquire(
+            cred, url, username_from_url, allowed_types,
+            (git2r_transfer_data*)payload);
+    }
+
     if (Rf_inherits(credentials, "cred_ssh_key")) {
         return git2r_cred_ssh_key(
             cred, username_from_url, allowed_types, credentials);
@@ -245,3 +564,128 @@ int git2r_cred_acquire_cb(
 
     return -1;
 }
+
+/**
+ * Read the credentials from the S3 class object
+ *
+ * The strings are not copied, so the object must be protected while
+ * the data is used. The environment variables of 'cred_env' and
+ * 'cred_token' are read here.
+ *
+ * @param data The credentials to initialize. Free with
+ * git2r_cred_data_free.
+ * @param credentials The S3 class object with credentials, or
+ * R_NilValue to use the ssh-agent.
+ * @return 0 on success, else -1.
+ */
+int git2r_cred_data_init(git2r_cred_data *data, SEXP credentials)
+{
+    SEXP elem;
+
+    memset(data, 0, sizeof(git2r_cred_data));
+    git_buf_init(&data->env_username, 0);
+    git_buf_init(&data->env_password, 0);
+
+    if (Rf_isNull(credentials)) {
+        data->type = GIT_CREDTYPE_SSH_KEY;
+    } else if (Rf_inherits(credentials, "cred_ssh_key")) {
+        data->type = GIT_CREDTYPE_SSH_KEY;
+        data->publickey = CHAR(STRING_ELT(git2r_get_list_element(credentials, "publickey"), 0));
+        data->privatekey = CHAR(STRING_ELT(git2r_get_list_element(credentials, "privatekey"), 0));
+        elem = git2r_get_list_element(credentials, "passphrase");
+        if (Rf_length(elem) && (NA_STRING != STRING_ELT(elem, 0)))
+            data->passphrase = CHAR(STRING_ELT(elem, 0));
+    } else if (Rf_inherits(credentials, "cred_env")) {
+        if (git__getenv(&data->env_username,
+                        CHAR(STRING_ELT(git2r_get_list_element(credentials, "username"), 0))) ||
+            git__getenv(&data->env_password,
+                        CHAR(STRING_ELT(git2r_get_list_element(credentials, "password"), 0))))
+            giterr_clear();
+        if (git_buf_len(&data->env_username) && git_buf_len(&data->env_password)) {
+            data->type = GIT_CREDTYPE_USERPASS_PLAINTEXT;
+            data->username = git_buf_cstr(&data->env_username);
+            data->password = git_buf_cstr(&data->env_password);
+        }
+    } else if (Rf_inherits(credentials, "cred_token")) {
+        if (git__getenv(&data->env_password,
+                        CHAR(STRING_ELT(git2r_get_list_element(credentials, "token"), 0))))
+            giterr_clear();
+        data->type = GIT_CREDTYPE_USERPASS_PLAINTEXT;
+        data->username = " ";
+        data->password = git_buf_cstr(&data->env_password);
+    } else if (Rf_inherits(credentials, "cred_user_pass")) {
+        data->type = GIT_CREDTYPE_USERPASS_PLAINTEXT;
+        data->username = CHAR(STRING_ELT(git2r_get_list_element(credentials, "username"), 0));
+        data->password = CHAR(STRING_ELT(git2r_get_list_element(credentials, "password"), 0));
+    } else {
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Zero and free the environment variables read by
+ * git2r_cred_data_init
+ *
+ * @param data The credentials.
+ */
+void git2r_cred_data_free(git2r_cred_data *data)
+{
+    git__memzero(data->env_username.ptr, data->env_username.asize);
+    git_buf_free(&data->env_username);
+    git__memzero(data->env_password.ptr, data->env_password.asize);
+    git_buf_free(&data->env_password);
+}
+
+/**
+ * Callback if the remote host requires authentication, with the
+ * credentials from git2r_cred_data_init
+ *
+ * Does not call the R API, so it can be used from a worker thread.
+ * Give each worker a copy of the data, since the copy keeps track of
+ * whether the ssh-agent was tried.
+ *
+ * @param cred The newly created credential object.
+ * @param url The resource for which we are demanding a credential.
+ * @param user_from_url The username that was embedded in a "user@host"
+ * remote url, or NULL if not included.
+ * @param allowed_types A bitmask stating which cred types are OK to return.
+ * @param payload A git2r_cred_data.
+ * @return 0 on success, else -1.
+ */
+int git2r_cred_data_acquire_cb(
+    git_cred **cred,
+    const char *url,
+    const char *username_from_url,
+    unsigned int allowed_types,
+    void *payload)
+{
+    git2r_cred_data *data = payload;
+
+    GIT_UNUSED(url);
+
+    if (!data || !(data->type & allowed_types))
+        return -1;
+
+    if (data->type == GIT_CREDTYPE_USERPASS_PLAINTEXT) {
+        if (git_cred_userpass_plaintext_new(cred, data->username, data->password))
+            return -1;
+        return 0;
+    }
+
+    if (data->privatekey) {
+        if (git_cred_ssh_key_new(cred, username_from_url, data->publickey,
+                                 data->privatekey, data->passphrase))
+            return -1;
+        return 0;
+    }
+
+    if (data->ssh_key_agent_tried)
+        return -1;
+    data->ssh_key_agent_tried = 1;
+    if (git_cred_ssh_key_from_agent(cred, username_from_url))
+        return -1;
+
+    return 0;
+}
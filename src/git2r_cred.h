@@ -19,8 +19,26 @@
 #ifndef INCLUDE_git2r_cred_h
 #define INCLUDE_git2r_cred_h
 
+#include <R.h>
+#include <Rinternals.h>
 #include "git2.h"
 
+/**
+ * Credentials that are read once from the R object, so that they
+ * can be used from a worker thread, see git2r_cred_data_init.
+ */
+typedef struct {
+    unsigned int type;
+    const char *username;
+    const char *password;
+    const char *publickey;
+    const char *privatekey;
+    const char *passphrase;
+    git_buf env_username;
+    git_buf env_password;
+    int ssh_key_agent_tried;
+} git2r_cred_data;
+
 int git2r_cred_acquire_cb(
     git_cred **out,
     const char *url,
@@ -28,4 +46,16 @@ int git2r_cred_acquire_cb(
     unsigned int allowed_types,
     void *payload);
 
+SEXP git2r_cred_cache(SEXP ttl);
+void git2r_cred_cache_clear(void);
+
+int git2r_cred_data_init(git2r_cred_data *data, SEXP credentials);
+void git2r_cred_data_free(git2r_cred_data *data);
+int git2r_cred_data_acquire_cb(
+    git_cred **out,
+    const char *url,
+    const char *username_from_url,
+    unsigned int allowed_types,
+    void *payload);
+
 #endif
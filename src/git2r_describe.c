@@ -0,0 +1,129 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <Rdefines.h>
+#include "git2.h"
+#include "describe.h"
+
+#include "git2r_arg.h"
+#include "git2r_describe.h"
+#include "git2r_error.h"
+#include "git2r_repository.h"
+
+/**
+ * Describe commits by the nearest reachable tag
+ *
+ * The tags are read once, and the commit graph parsed while
+ * describing one commit is reused for the following commits.
+ * @param repo S4 class git_repository
+ * @param commits Character vector with the revision of each commit
+ * to describe, e.g. a sha.
+ * @param tags_only If TRUE, any tag (annotated or lightweight) can
+ * describe a commit. If FALSE, any reference can be used.
+ * @param abbrev Minimum number of hexadecimal digits of the
+ * abbreviated sha. If zero, only the name of the tag is used.
+ * @return Character vector with the description of each commit, NA
+ * if no reference can describe the commit.
+ */
+SEXP git2r_describe(SEXP repo, SEXP commits, SEXP tags_only, SEXP abbrev)
+{
+    int err = 0;
+    size_t i, n;
+    SEXP result = R_NilValue;
+    git_buf buf = {0};
+    git_repository *repository = NULL;
+    git_describe__batch *batch = NULL;
+    git_describe_options opts = GIT_DESCRIBE_OPTIONS_INIT;
+    git_describe_format_options format_opts = GIT_DESCRIBE_FORMAT_OPTIONS_INIT;
+
+    if (git2r_arg_check_string_vec(commits))
+        git2r_error(__func__, NULL, "'commits'", git2r_err_string_vec_arg);
+    if (git2r_arg_check_logical(tags_only))
+        git2r_error(__func__, NULL, "'tags_only'", git2r_err_logical_arg);
+    if (git2r_arg_check_integer_gte_zero(abbrev))
+        git2r_error(__func__, NULL, "'abbrev'", git2r_err_integer_gte_zero_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    if (LOGICAL(tags_only)[0])
+        opts.describe_strategy = GIT_DESCRIBE_TAGS;
+    else
+        opts.describe_strategy = GIT_DESCRIBE_ALL;
+    format_opts.abbreviated_size = INTEGER(abbrev)[0];
+
+    err = git_describe__batch_new(&batch, repository, &opts);
+    if (err)
+        goto cleanup;
+
+    n = Rf_length(commits);
+    PROTECT(result = Rf_allocVector(STRSXP, n));
+    for (i = 0; i < n; i++) {
+        git_object *object = NULL;
+        git_commit *commit = NULL;
+        git_describe_result *description = NULL;
+
+        SET_STRING_ELT(result, i, NA_STRING);
+        if (STRING_ELT(commits, i) == NA_STRING)
+            continue;
+
+        err = git_revparse_single(
+            &object,
+            repository,
+            CHAR(STRING_ELT(commits, i)));
+        if (err)
+            goto cleanup;
+
+        err = git_object_peel((git_object**)&commit, object, GIT_OBJ_COMMIT);
+        git_object_free(object);
+        if (err)
+            goto cleanup;
+
+        err = git_describe__batch_commit(&description, batch, commit);
+        git_commit_free(commit);
+        if (err == GIT_ENOTFOUND) {
+            giterr_clear();
+            err = 0;
+            continue;
+        }
+        if (err)
+            goto cleanup;
+
+        git_buf_clear(&buf);
+        err = git_describe_format(&buf, description, &format_opts);
+        git_describe_result_free(description);
+        if (err)
+            goto cleanup;
+
+        SET_STRING_ELT(result, i, Rf_mkChar(buf.ptr));
+    }
+
+cleanup:
+    git_buf_free(&buf);
+    git_describe__batch_free(batch);
+    git_repository_free(repository);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
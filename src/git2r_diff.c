@@ -19,6 +19,7 @@
 #include "git2r_arg.h"
 #include "git2r_diff.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_tree.h"
 #include "git2r_repository.h"
 
@@ -139,10 +140,10 @@ SEXP git2r_diff_index_to_wd(SEXP repo, SEXP filename)
 	goto cleanup;
 
     if (Rf_isNull(filename)) {
-        SEXP s_new = Rf_install("new");
-        SEXP s_old = Rf_install("old");
+        SEXP s_new = git2r_sym(new);
+        SEXP s_old = git2r_sym(old);
 
-        PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_diff")));
+        PROTECT(result = git2r_S4_new(git2r_S4_class__git_diff));
         nprotect++;
         SET_SLOT(result, s_old, Rf_mkString("index"));
         SET_SLOT(result, s_new, Rf_mkString("workdir"));
@@ -237,11 +238,11 @@ SEXP git2r_diff_head_to_index(SEXP repo, SEXP filename)
 	goto cleanup;
 
     if (Rf_isNull(filename)) {
-        SEXP s_new = Rf_install("new");
-        SEXP s_old = Rf_install("old");
+        SEXP s_new = git2r_sym(new);
+        SEXP s_old = git2r_sym(old);
 
         /* TODO: object instead of HEAD string */
-        PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_diff")));
+        PROTECT(result = git2r_S4_new(git2r_S4_class__git_diff));
         nprotect++;
         SET_SLOT(result, s_old, Rf_mkString("HEAD"));
         SET_SLOT(result, s_new, Rf_mkString("index"));
@@ -324,12 +325,12 @@ SEXP git2r_diff_tree_to_wd(SEXP tree, SEXP filename)
     if (git2r_arg_check_filename(filename))
         git2r_error(__func__, NULL, "'filename'", git2r_err_filename_arg);
 
-    repo = GET_SLOT(tree, Rf_install("repo"));
+    repo = GET_SLOT(tree, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    sha = GET_SLOT(tree, Rf_install("sha"));
+    sha = GET_SLOT(tree, git2r_sym(sha));
     err = git_revparse_single(&obj, repository, CHAR(STRING_ELT(sha, 0)));
     if (err)
 	goto cleanup;
@@ -343,11 +344,11 @@ SEXP git2r_diff_tree_to_wd(SEXP tree, SEXP filename)
 	goto cleanup;
 
     if (Rf_isNull(filename)) {
-        SEXP s_new = Rf_install("new");
+        SEXP s_new = git2r_sym(new);
 
-        PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_diff")));
+        PROTECT(result = git2r_S4_new(git2r_S4_class__git_diff));
         nprotect++;
-        SET_SLOT(result, Rf_install("old"), tree);
+        SET_SLOT(result, git2r_sym(old), tree);
         SET_SLOT(result, s_new, Rf_mkString("workdir"));
         err = git2r_diff_format_to_r(diff, result);
     } else if (0 == Rf_length(filename)) {
@@ -428,12 +429,12 @@ SEXP git2r_diff_tree_to_index(SEXP tree, SEXP filename)
     if (git2r_arg_check_filename(filename))
         git2r_error(__func__, NULL, "'filename'", git2r_err_filename_arg);
 
-    repo = GET_SLOT(tree, Rf_install("repo"));
+    repo = GET_SLOT(tree, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    sha = GET_SLOT(tree, Rf_install("sha"));
+    sha = GET_SLOT(tree, git2r_sym(sha));
     err = git_revparse_single(&obj, repository, CHAR(STRING_ELT(sha, 0)));
     if (err)
 	goto cleanup;
@@ -452,11 +453,11 @@ SEXP git2r_diff_tree_to_index(SEXP tree, SEXP filename)
 	goto cleanup;
 
     if (Rf_isNull(filename)) {
-        SEXP s_new = Rf_install("new");
+        SEXP s_new = git2r_sym(new);
 
-        PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_diff")));
+        PROTECT(result = git2r_S4_new(git2r_S4_class__git_diff));
         nprotect++;
-        SET_SLOT(result, Rf_install("old"), tree);
+        SET_SLOT(result, git2r_sym(old), tree);
         SET_SLOT(result, s_new, Rf_mkString("index"));
         err = git2r_diff_format_to_r(diff, result);
     } else if (0 == Rf_length(filename)) {
@@ -541,17 +542,17 @@ SEXP git2r_diff_tree_to_tree(SEXP tree1, SEXP tree2, SEXP filename)
         git2r_error(__func__, NULL, "'filename'", git2r_err_filename_arg);
 
     /* We already checked that tree2 is from the same repo, in R */
-    repo = GET_SLOT(tree1, Rf_install("repo"));
+    repo = GET_SLOT(tree1, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    sha1 = GET_SLOT(tree1, Rf_install("sha"));
+    sha1 = GET_SLOT(tree1, git2r_sym(sha));
     err = git_revparse_single(&obj1, repository, CHAR(STRING_ELT(sha1, 0)));
     if (err)
 	goto cleanup;
 
-    sha2 = GET_SLOT(tree2, Rf_install("sha"));
+    sha2 = GET_SLOT(tree2, git2r_sym(sha));
     err = git_revparse_single(&obj2, repository, CHAR(STRING_ELT(sha2, 0)));
     if (err)
 	goto cleanup;
@@ -574,10 +575,10 @@ SEXP git2r_diff_tree_to_tree(SEXP tree1, SEXP tree2, SEXP filename)
 	goto cleanup;
 
     if (Rf_isNull(filename)) {
-        PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_diff")));
+        PROTECT(result = git2r_S4_new(git2r_S4_class__git_diff));
         nprotect++;
-        SET_SLOT(result, Rf_install("old"), tree1);
-        SET_SLOT(result, Rf_install("new"), tree2);
+        SET_SLOT(result, git2r_sym(old), tree1);
+        SET_SLOT(result, git2r_sym(new), tree2);
         err = git2r_diff_format_to_r(diff, result);
     } else if (0 == Rf_length(filename)) {
         git_buf buf = GIT_BUF_INIT;
@@ -795,7 +796,7 @@ int git2r_diff_get_file_cb(const git_diff_delta *delta,
        temporary storage. */
     if (p->file_ptr != 0) {
         SEXP hunks;
-        SEXP s_hunks = Rf_install("hunks");
+        SEXP s_hunks = git2r_sym(hunks);
 	size_t len=p->hunk_ptr, i;
 
 	SET_SLOT(
@@ -809,10 +810,10 @@ int git2r_diff_get_file_cb(const git_diff_delta *delta,
     /* OK, ready for next file, if any */
     if (delta) {
 	SEXP file_obj;
-        SEXP s_new_file = Rf_install("new_file");
-        SEXP s_old_file = Rf_install("old_file");
+        SEXP s_new_file = git2r_sym(new_file);
+        SEXP s_old_file = git2r_sym(old_file);
 
-        PROTECT(file_obj = NEW_OBJECT(MAKE_CLASS("git_diff_file")));
+        PROTECT(file_obj = git2r_S4_new(git2r_S4_class__git_diff_file));
 	SET_VECTOR_ELT(p->result, p->file_ptr, file_obj);
 	SET_SLOT(file_obj, s_old_file, Rf_mkString(delta->old_file.path));
 	SET_SLOT(file_obj, s_new_file, Rf_mkString(delta->new_file.path));
@@ -850,7 +851,7 @@ int git2r_diff_get_hunk_cb(const git_diff_delta *delta,
     if (p->hunk_ptr != 0) {
 	SEXP lines;
 	size_t len=p->line_ptr, i;
-        SEXP s_lines = Rf_install("lines");
+        SEXP s_lines = git2r_sym(lines);
 
         PROTECT(lines = Rf_allocVector(VECSXP, p->line_ptr));
 	SET_SLOT(VECTOR_ELT(p->hunk_tmp, p->hunk_ptr-1), s_lines, lines);
@@ -862,13 +863,13 @@ int git2r_diff_get_hunk_cb(const git_diff_delta *delta,
     /* OK, ready for the next hunk, if any */
     if (hunk) {
 	SEXP hunk_obj;
-        SEXP s_old_start = Rf_install("old_start");
-        SEXP s_old_lines = Rf_install("old_lines");
-        SEXP s_new_start = Rf_install("new_start");
-        SEXP s_new_lines = Rf_install("new_lines");
-        SEXP s_header = Rf_install("header");
+        SEXP s_old_start = git2r_sym(old_start);
+        SEXP s_old_lines = git2r_sym(old_lines);
+        SEXP s_new_start = git2r_sym(new_start);
+        SEXP s_new_lines = git2r_sym(new_lines);
+        SEXP s_header = git2r_sym(header);
 
-        PROTECT(hunk_obj = NEW_OBJECT(MAKE_CLASS("git_diff_hunk")));
+        PROTECT(hunk_obj = git2r_S4_new(git2r_S4_class__git_diff_hunk));
 	SET_VECTOR_ELT(p->hunk_tmp, p->hunk_ptr, hunk_obj);
 	SET_SLOT(hunk_obj, s_old_start, Rf_ScalarInteger(hunk->old_start));
 	SET_SLOT(hunk_obj, s_old_lines, Rf_ScalarInteger(hunk->old_lines));
@@ -906,16 +907,16 @@ int git2r_diff_get_line_cb(const git_diff_delta *delta,
     static char short_buffer[200];
     char *buffer = short_buffer;
     SEXP line_obj;
-    SEXP s_origin = Rf_install("origin");
-    SEXP s_old_lineno = Rf_install("old_lineno");
-    SEXP s_new_lineno = Rf_install("new_lineno");
-    SEXP s_num_lines = Rf_install("num_lines");
-    SEXP s_content = Rf_install("content");
+    SEXP s_origin = git2r_sym(origin);
+    SEXP s_old_lineno = git2r_sym(old_lineno);
+    SEXP s_new_lineno = git2r_sym(new_lineno);
+    SEXP s_num_lines = git2r_sym(num_lines);
+    SEXP s_content = git2r_sym(content);
 
     GIT_UNUSED(delta);
     GIT_UNUSED(hunk);
 
-    PROTECT(line_obj = NEW_OBJECT(MAKE_CLASS("git_diff_line")));
+    PROTECT(line_obj = git2r_S4_new(git2r_S4_class__git_diff_line));
     SET_VECTOR_ELT(p->line_tmp, p->line_ptr++, line_obj);
 
     SET_SLOT(line_obj, s_origin, Rf_ScalarInteger(line->origin));
@@ -974,7 +975,7 @@ int git2r_diff_format_to_r(git_diff *diff, SEXP dest)
         return err;
 
     PROTECT(payload.result = Rf_allocVector(VECSXP, num_files));
-    SET_SLOT(dest, Rf_install("files"), payload.result);
+    SET_SLOT(dest, git2r_sym(files), payload.result);
     PROTECT(payload.hunk_tmp = Rf_allocVector(VECSXP, max_hunks));
     PROTECT(payload.line_tmp = Rf_allocVector(VECSXP, max_lines));
 
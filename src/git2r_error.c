@@ -24,12 +24,14 @@
  */
 
 const char git2r_err_alloc_memory_buffer[] = "Unable to allocate memory buffer";
+const char git2r_err_branch_checked_out[] = "'branch' is checked out";
 const char git2r_err_branch_not_local[] = "'branch' is not local";
 const char git2r_err_branch_not_remote[] = "'branch' is not remote";
 const char git2r_err_checkout_tree[] = "Expected commit, tag or tree";
 const char git2r_err_invalid_refname[] = "Invalid reference name";
 const char git2r_err_invalid_remote[] = "Invalid remote name";
 const char git2r_err_invalid_repository[] = "Invalid repository";
+const char git2r_err_lfs_mirror[] = "No 'file://' mirror in 'lfs.url'";
 const char git2r_err_nothing_added_to_commit[] = "Nothing added to commit";
 const char git2r_err_object_type[] = "Unexpected object type.";
 const char git2r_err_reference[] = "Unexpected reference type";
@@ -40,10 +42,14 @@ const char git2r_err_ssl_cert_locations[] =
     "Either 'filename' or 'path' may be 'NULL', but not both";
 const char git2r_err_unexpected_config_level[] = "Unexpected config level";
 const char git2r_err_unable_to_authenticate[] = "Unable to authenticate with supplied credentials";
+const char git2r_err_worktree_changes[] =
+    "The worktree has changes, use 'force' to remove it";
 
 /**
  * Error messages specific to argument checking
  */
+const char git2r_err_async_arg[] =
+    "must be the handle of an async operation that is not collected";
 const char git2r_err_blob_arg[] =
     "must be an S3 class git_blob";
 const char git2r_err_branch_arg[] =
@@ -66,12 +72,16 @@ const char git2r_err_integer_arg[] =
     "must be an integer vector of length one with non NA value";
 const char git2r_err_integer_gte_zero_arg[] =
     "must be an integer vector of length one with value greater than or equal to zero";
+const char git2r_err_integer_gt_zero_arg[] =
+    "must be an integer vector of length one with value greater than zero";
 const char git2r_err_list_arg[] =
     "must be a list";
 const char git2r_err_logical_arg[] =
     "must be logical vector of length one with non NA value";
 const char git2r_err_note_arg[] =
     "must be an S3 class git_note";
+const char git2r_err_real_arg[] =
+    "must be a real vector of length one with non NA value";
 const char git2r_err_signature_arg[] =
     "must be an S3 class git_signature";
 const char git2r_err_string_arg[] =
@@ -80,6 +90,8 @@ const char git2r_err_string_vec_arg[] =
     "must be a character vector";
 const char git2r_err_tag_arg[] =
     "must be an S3 class git_tag";
+const char git2r_err_trace_level_arg[] =
+    "must be an integer vector of length one with a trace level from 0 to 6";
 const char git2r_err_tree_arg[] =
     "must be an S3 class git_tree";
 
@@ -25,12 +25,14 @@
  * Error messages
  */
 extern const char git2r_err_alloc_memory_buffer[];
+extern const char git2r_err_branch_checked_out[];
 extern const char git2r_err_branch_not_local[];
 extern const char git2r_err_branch_not_remote[];
 extern const char git2r_err_checkout_tree[];
 extern const char git2r_err_invalid_refname[];
 extern const char git2r_err_invalid_remote[];
 extern const char git2r_err_invalid_repository[];
+extern const char git2r_err_lfs_mirror[];
 extern const char git2r_err_nothing_added_to_commit[];
 extern const char git2r_err_object_type[];
 extern const char git2r_err_reference[];
@@ -40,10 +42,12 @@ extern const char git2r_err_revparse_single[];
 extern const char git2r_err_ssl_cert_locations[];
 extern const char git2r_err_unexpected_config_level[];
 extern const char git2r_err_unable_to_authenticate[];
+extern const char git2r_err_worktree_changes[];
 
 /**
  * Error messages specific to argument checking
  */
+extern const char git2r_err_async_arg[];
 extern const char git2r_err_blob_arg[];
 extern const char git2r_err_branch_arg[];
 extern const char git2r_err_commit_arg[];
@@ -55,13 +59,16 @@ extern const char git2r_err_filename_arg[];
 extern const char git2r_err_sha_arg[];
 extern const char git2r_err_integer_arg[];
 extern const char git2r_err_integer_gte_zero_arg[];
+extern const char git2r_err_integer_gt_zero_arg[];
 extern const char git2r_err_list_arg[];
 extern const char git2r_err_logical_arg[];
 extern const char git2r_err_note_arg[];
+extern const char git2r_err_real_arg[];
 extern const char git2r_err_signature_arg[];
 extern const char git2r_err_string_arg[];
 extern const char git2r_err_string_vec_arg[];
 extern const char git2r_err_tag_arg[];
+extern const char git2r_err_trace_level_arg[];
 extern const char git2r_err_tree_arg[];
 
 void git2r_error(
@@ -0,0 +1,1208 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <Rdefines.h>
+#include <string.h>
+#include "git2.h"
+#include "git2/sys/odb_backend.h"
+#include "array.h"
+#include "buffer.h"
+#include "commit.h"
+#include "fileops.h"
+#include "hash.h"
+#include "mwindow.h"
+#include "odb.h"
+#include "oidmap.h"
+#include "pack.h"
+#include "path.h"
+#include "pool.h"
+#include "tag.h"
+#include "tree.h"
+
+#include "git2r_arg.h"
+#include "git2r_error.h"
+#include "git2r_fsck.h"
+#include "git2r_parallel.h"
+#include "git2r_repository.h"
+
+/**
+ * The number of objects that a worker verifies at a time
+ */
+#define GIT2R_FSCK_BATCH 256
+
+/**
+ * The file in the git directory with the pack files that are
+ * verified, for the incremental mode
+ */
+#define GIT2R_FSCK_VERIFIED_FILE "git2r-fsck"
+
+/**
+ * A problem that is found
+ */
+typedef struct {
+    git_oid id;
+    int has_id;
+    int loose; /* the file is the loose object */
+    const char *file;
+    char *message;
+} git2r_fsck_problem;
+
+typedef git_array_t(git2r_fsck_problem) git2r_fsck_problems;
+
+/**
+ * An object in a pack file
+ */
+typedef struct {
+    git_off_t offset;
+    const git_oid *id; /* in the index of the pack */
+} git2r_fsck_entry;
+
+/**
+ * A pack file to verify
+ */
+typedef struct {
+    struct git_pack_file *p;
+    char *name;
+    char *idx_name;
+    git_array_t(git2r_fsck_entry) entries;
+    git_time_t mtime;
+    git_off_t size;
+    int verified; /* verified since it was modified */
+} git2r_fsck_pack;
+
+/**
+ * A job of a worker: the checksums of a pack file, or a batch of
+ * the objects in a pack file or of the loose objects
+ */
+typedef struct {
+    git2r_fsck_pack *pack; /* NULL for loose objects */
+    int checksums;
+    size_t start;
+    size_t end;
+    git2r_fsck_problems problems;
+    int error;
+    char *message;
+} git2r_fsck_job;
+
+/**
+ * Data structure to hold the pack files, loose objects and jobs
+ */
+typedef struct {
+    git_buf objects;
+    git_array_t(git2r_fsck_pack) packs;
+    git_array_t(git_oid) loose;
+    git_array_t(git2r_fsck_job) jobs;
+    git_buf verified;
+    git2r_fsck_problems problems; /* the pack files that are not read */
+    git2r_fsck_problems missing; /* the objects that are not reachable */
+} git2r_fsck_data;
+
+/**
+ * Add a problem
+ *
+ * @param problems The problems.
+ * @param id The id of the object, or NULL.
+ * @param file The file, or NULL.
+ * @param message The message, with the libgit2 error appended if
+ * 'error' is not 0.
+ * @param error The libgit2 error code.
+ * @return 0 or an error code
+ */
+static int git2r_fsck_problem_add(
+    git2r_fsck_problems *problems,
+    const git_oid *id,
+    const char *file,
+    const char *message,
+    int error)
+{
+    git2r_fsck_problem *problem;
+    git_buf buf = GIT_BUF_INIT;
+    const git_error *e = error ? giterr_last() : NULL;
+
+    git_buf_puts(&buf, message);
+    if (error)
+        git_buf_printf(&buf, ": %s", e && e->message ? e->message : "unknown error");
+    giterr_clear();
+
+    problem = git_array_alloc(*problems);
+    if (!problem || git_buf_oom(&buf)) {
+        git_buf_free(&buf);
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+
+    memset(problem, 0, sizeof(git2r_fsck_problem));
+    if (id) {
+        git_oid_cpy(&problem->id, id);
+        problem->has_id = 1;
+    }
+    problem->file = file;
+    problem->message = git_buf_detach(&buf);
+
+    return 0;
+}
+
+/**
+ * Hash a file without its trailing checksum
+ *
+ * @param hash The hash of the file, without the last 20 bytes.
+ * @param trailer The last 40 bytes of the file.
+ * @param path The path to the file.
+ * @return 0 or an error code
+ */
+static int git2r_fsck_hash_file(
+    git_oid *hash,
+    unsigned char trailer[2 * GIT_OID_RAWSZ],
+    const char *path)
+{
+    int err = 0;
+    git_file fd;
+    struct stat st;
+    git_off_t remaining;
+    git_hash_ctx ctx;
+    char buffer[FILEIO_BUFSIZE];
+
+    if ((fd = git_futils_open_ro(path)) < 0)
+        return fd;
+
+    if (p_fstat(fd, &st) < 0) {
+        giterr_set(GITERR_OS, "failed to stat '%s'", path);
+        p_close(fd);
+        return GIT_ERROR;
+    }
+
+    if (st.st_size < 2 * GIT_OID_RAWSZ) {
+        giterr_set(GITERR_ODB, "file '%s' is truncated", path);
+        p_close(fd);
+        return GIT_ERROR;
+    }
+
+    if ((err = git_hash_ctx_init(&ctx)) < 0) {
+        p_close(fd);
+        return err;
+    }
+
+    remaining = st.st_size - GIT_OID_RAWSZ;
+    while (!err && remaining > 0) {
+        size_t len = remaining < (git_off_t)sizeof(buffer) ?
+            (size_t)remaining : sizeof(buffer);
+
+        if (p_read(fd, buffer, len) != (ssize_t)len) {
+            giterr_set(GITERR_OS, "failed to read '%s'", path);
+            err = GIT_ERROR;
+        } else {
+            err = git_hash_update(&ctx, buffer, len);
+            remaining -= len;
+        }
+    }
+
+    if (!err)
+        err = git_hash_final(hash, &ctx);
+
+    if (!err && (p_lseek(fd, st.st_size - 2 * GIT_OID_RAWSZ, SEEK_SET) < 0 ||
+                 p_read(fd, trailer, 2 * GIT_OID_RAWSZ) != 2 * GIT_OID_RAWSZ)) {
+        giterr_set(GITERR_OS, "failed to read '%s'", path);
+        err = GIT_ERROR;
+    }
+
+    git_hash_ctx_cleanup(&ctx);
+    p_close(fd);
+
+    return err;
+}
+
+/**
+ * Verify the checksums of a pack file and of its index
+ */
+static int git2r_fsck_pack_checksums(git2r_fsck_job *job)
+{
+    int err;
+    git2r_fsck_pack *pack = job->pack;
+    git_oid pack_hash, idx_hash, oid;
+    unsigned char pack_trailer[2 * GIT_OID_RAWSZ], idx_trailer[2 * GIT_OID_RAWSZ];
+    git_buf idx_path = GIT_BUF_INIT;
+
+    err = git2r_fsck_hash_file(&pack_hash, pack_trailer, pack->p->pack_name);
+    if (err)
+        return git2r_fsck_problem_add(&job->problems, NULL, pack->name,
+                                      "unreadable pack", err);
+
+    git_oid_fromraw(&oid, pack_trailer + GIT_OID_RAWSZ);
+    if (!git_oid_equal(&pack_hash, &oid)) {
+        err = git2r_fsck_problem_add(&job->problems, NULL, pack->name,
+                                     "pack checksum mismatch", 0);
+        if (err)
+            return err;
+    }
+
+    err = git_buf_puts(&idx_path, pack->p->pack_name);
+    if (err)
+        return err;
+    git_buf_truncate(&idx_path, idx_path.size - strlen(".pack"));
+    err = git_buf_puts(&idx_path, ".idx");
+    if (!err)
+        err = git2r_fsck_hash_file(&idx_hash, idx_trailer, idx_path.ptr);
+    git_buf_free(&idx_path);
+    if (err)
+        return git2r_fsck_problem_add(&job->problems, NULL, pack->idx_name,
+                                      "unreadable index", err);
+
+    git_oid_fromraw(&oid, idx_trailer + GIT_OID_RAWSZ);
+    if (!git_oid_equal(&idx_hash, &oid)) {
+        err = git2r_fsck_problem_add(&job->problems, NULL, pack->idx_name,
+                                     "index checksum mismatch", 0);
+        if (err)
+            return err;
+    }
+
+    /* The index holds the checksum of its pack file */
+    git_oid_fromraw(&oid, idx_trailer);
+    if (!git_oid_equal(&pack_hash, &oid))
+        return git2r_fsck_problem_add(&job->problems, NULL, pack->idx_name,
+                                      "index does not match pack", 0);
+
+    return 0;
+}
+
+/**
+ * Parse a commit, tree or tag the way a lookup does
+ *
+ * @return 0 or an error code
+ */
+static int git2r_fsck_parse(
+    const git_oid *id,
+    git_otype type,
+    void *data,
+    size_t len)
+{
+    int err = 0;
+    void *object;
+    git_odb_object obj;
+
+    /* The object is not in the cache, and is only referenced during
+     * the parse */
+    memset(&obj, 0, sizeof(obj));
+    git_oid_cpy(&obj.cached.oid, id);
+    obj.cached.type = type;
+    obj.cached.size = len;
+    obj.cached.flags = GIT_CACHE_STORE_RAW;
+    obj.cached.refcount.val = 1;
+    obj.buffer = data;
+
+    switch (type) {
+    case GIT_OBJ_COMMIT:
+        object = git__calloc(1, sizeof(git_commit));
+        GITERR_CHECK_ALLOC(object);
+        err = git_commit__parse(object, &obj);
+        git_commit__free(object);
+        break;
+    case GIT_OBJ_TREE:
+        object = git__calloc(1, sizeof(git_tree));
+        GITERR_CHECK_ALLOC(object);
+        err = git_tree__parse(object, &obj);
+        git_tree__free(object);
+        break;
+    case GIT_OBJ_TAG:
+        object = git__calloc(1, sizeof(git_tag));
+        GITERR_CHECK_ALLOC(object);
+        err = git_tag__parse(object, &obj);
+        git_tag__free(object);
+        break;
+    default:
+        break;
+    }
+
+    return err;
+}
+
+/**
+ * Verify an object that is read
+ *
+ * @return 0 or an error code
+ */
+static int git2r_fsck_verify(
+    git2r_fsck_job *job,
+    const git_oid *id,
+    const char *file,
+    git_otype type,
+    void *data,
+    size_t len)
+{
+    int err;
+    git_oid hash;
+
+    err = git_odb_hash(&hash, data, len, type);
+    if (err)
+        return git2r_fsck_problem_add(&job->problems, id, file, "corrupt object", err);
+    if (!git_oid_equal(&hash, id))
+        return git2r_fsck_problem_add(&job->problems, id, file, "hash mismatch", 0);
+
+    err = git2r_fsck_parse(id, type, data, len);
+    if (err) {
+        git_buf message = GIT_BUF_INIT;
+
+        git_buf_printf(&message, "invalid %s", git_object_type2string(type));
+        if (git_buf_oom(&message)) {
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            return GIT_ERROR;
+        }
+        err = git2r_fsck_problem_add(&job->problems, id, file, message.ptr, err);
+        git_buf_free(&message);
+    }
+
+    return err;
+}
+
+/**
+ * Inflate, hash and parse a batch of the objects in a pack file
+ */
+static int git2r_fsck_pack_objects(git2r_fsck_job *job)
+{
+    int err = 0;
+    size_t i;
+    git2r_fsck_pack *pack = job->pack;
+
+    for (i = job->start; i < job->end && !err; i++) {
+        git2r_fsck_entry *entry = git_array_get(pack->entries, i);
+        git_off_t offset = entry->offset;
+        git_rawobj raw;
+
+        if (git_packfile_unpack(&raw, pack->p, &offset) < 0) {
+            err = git2r_fsck_problem_add(&job->problems, entry->id, pack->name,
+                                         "corrupt object", -1);
+            continue;
+        }
+
+        err = git2r_fsck_verify(job, entry->id, pack->name, raw.type, raw.data, raw.len);
+        git__free(raw.data);
+    }
+
+    return err;
+}
+
+/**
+ * Inflate, hash and parse a batch of the loose objects
+ */
+static int git2r_fsck_loose_objects(git2r_fsck_job *job, git2r_fsck_data *data)
+{
+    int err;
+    size_t i;
+    git_odb *odb = NULL;
+    git_odb_backend *backend = NULL;
+
+    /* Only the loose objects, in an odb of the worker */
+    if ((err = git_odb_new(&odb)) < 0 ||
+        (err = git_odb_backend_loose(&backend, data->objects.ptr, -1, 0, 0, 0)) < 0)
+        goto cleanup;
+    if ((err = git_odb_add_backend(odb, backend, 1)) < 0) {
+        backend->free(backend);
+        goto cleanup;
+    }
+
+    for (i = job->start; i < job->end && !err; i++) {
+        const git_oid *id = git_array_get(data->loose, i);
+        git_odb_object *obj = NULL;
+
+        err = git_odb_read(&obj, odb, id);
+        if (GIT_EMISMATCH == err) {
+            err = git2r_fsck_problem_add(&job->problems, id, NULL, "hash mismatch", 0);
+        } else if (err) {
+            err = git2r_fsck_problem_add(&job->problems, id, NULL, "corrupt object", err);
+        } else {
+            err = git2r_fsck_verify(job, id, NULL, git_odb_object_type(obj),
+                                    (void *)git_odb_object_data(obj),
+                                    git_odb_object_size(obj));
+        }
+
+        git_odb_object_free(obj);
+    }
+
+    for (i = 0; i < git_array_size(job->problems); i++)
+        git_array_get(job->problems, i)->loose = 1;
+
+cleanup:
+    git_odb_free(odb);
+
+    return err;
+}
+
+/**
+ * Run a job, called from a worker
+ */
+static void git2r_fsck_cb(size_t i, void *payload)
+{
+    int err;
+    git2r_fsck_data *data = payload;
+    git2r_fsck_job *job = git_array_get(data->jobs, i);
+
+    if (!job->pack)
+        err = git2r_fsck_loose_objects(job, data);
+    else if (job->checksums)
+        err = git2r_fsck_pack_checksums(job);
+    else
+        err = git2r_fsck_pack_objects(job);
+
+    if (err) {
+        const git_error *e = giterr_last();
+
+        job->error = err;
+        job->message = strdup(e && e->message ? e->message : "unknown error");
+    }
+}
+
+static int git2r_fsck_entry_cmp(const void *a, const void *b)
+{
+    git_off_t x = ((const git2r_fsck_entry *)a)->offset;
+    git_off_t y = ((const git2r_fsck_entry *)b)->offset;
+
+    return x < y ? -1 : x > y;
+}
+
+static int git2r_fsck_pack_entry_cb(const git_oid *oid, void *payload)
+{
+    int err;
+    git2r_fsck_pack *pack = payload;
+    git2r_fsck_entry *entry;
+    struct git_pack_entry e;
+
+    err = git_pack_entry_find(&e, pack->p, oid, GIT_OID_HEXSZ);
+    if (err)
+        return err;
+
+    entry = git_array_alloc(pack->entries);
+    if (!entry) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+
+    entry->offset = e.offset;
+    entry->id = oid;
+
+    return 0;
+}
+
+/**
+ * Check if a pack file is verified since it was modified
+ *
+ * @param verified The content of the file with the verified packs,
+ * with one line 'name mtime size' per pack file.
+ * @param pack The pack file.
+ * @return 1 if the pack file is verified, else 0
+ */
+static int git2r_fsck_pack_verified(const git_buf *verified, const git2r_fsck_pack *pack)
+{
+    git_buf line = GIT_BUF_INIT;
+    int found;
+
+    if (!verified->size)
+        return 0;
+
+    git_buf_printf(&line, "\n%s %"PRId64" %"PRId64"\n",
+                   pack->name, (int64_t)pack->mtime, (int64_t)pack->size);
+    if (git_buf_oom(&line))
+        return 0;
+
+    found = !git__prefixcmp(verified->ptr, line.ptr + 1) ||
+        strstr(verified->ptr, line.ptr) != NULL;
+    git_buf_free(&line);
+
+    return found;
+}
+
+/**
+ * Add a pack file, and its objects if it is not verified since it
+ * was modified
+ */
+static int git2r_fsck_pack_file(git2r_fsck_data *data, const char *path)
+{
+    int err;
+    struct stat st;
+    git2r_fsck_pack *pack;
+
+    pack = git_array_alloc(data->packs);
+    if (!pack) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+    memset(pack, 0, sizeof(git2r_fsck_pack));
+
+    pack->idx_name = git_path_basename(path);
+    GITERR_CHECK_ALLOC(pack->idx_name);
+    pack->name = git__malloc(strlen(pack->idx_name) + 2);
+    GITERR_CHECK_ALLOC(pack->name);
+    memcpy(pack->name, pack->idx_name, strlen(pack->idx_name) - strlen("idx"));
+    strcpy(pack->name + strlen(pack->idx_name) - strlen("idx"), "pack");
+
+    err = git_mwindow_get_pack(&pack->p, path);
+    if (err)
+        return git2r_fsck_problem_add(&data->problems, NULL, pack->idx_name,
+                                      "unreadable index", err);
+
+    if (p_stat(pack->p->pack_name, &st) < 0) {
+        giterr_set(GITERR_OS, "failed to stat '%s'", pack->p->pack_name);
+        return GIT_ERROR;
+    }
+    pack->mtime = st.st_mtime;
+    pack->size = st.st_size;
+
+    pack->verified = git2r_fsck_pack_verified(&data->verified, pack);
+    if (pack->verified)
+        return 0;
+
+    err = git_pack_foreach_entry(pack->p, git2r_fsck_pack_entry_cb, pack);
+    if (err)
+        return err;
+
+    if (git_array_size(pack->entries))
+        qsort(pack->entries.ptr, git_array_size(pack->entries),
+              sizeof(git2r_fsck_entry), git2r_fsck_entry_cmp);
+
+    return 0;
+}
+
+static int git2r_fsck_pack_dir_cb(void *payload, git_buf *path)
+{
+    if (git__suffixcmp(path->ptr, ".idx"))
+        return 0;
+
+    return git2r_fsck_pack_file(payload, path->ptr);
+}
+
+static int git2r_fsck_loose_cb(const git_oid *oid, void *payload)
+{
+    git_oid *id = git_array_alloc(((git2r_fsck_data *)payload)->loose);
+
+    if (!id) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+    git_oid_cpy(id, oid);
+
+    return 0;
+}
+
+/**
+ * List the loose objects
+ */
+static int git2r_fsck_loose(git2r_fsck_data *data)
+{
+    int err;
+    git_odb *odb = NULL;
+    git_odb_backend *backend = NULL;
+
+    if ((err = git_odb_new(&odb)) < 0 ||
+        (err = git_odb_backend_loose(&backend, data->objects.ptr, -1, 0, 0, 0)) < 0)
+        goto cleanup;
+    if ((err = git_odb_add_backend(odb, backend, 1)) < 0) {
+        backend->free(backend);
+        goto cleanup;
+    }
+
+    err = git_odb_foreach(odb, git2r_fsck_loose_cb, data);
+
+cleanup:
+    git_odb_free(odb);
+
+    return err;
+}
+
+static git2r_fsck_job *git2r_fsck_job_add(
+    git2r_fsck_data *data,
+    git2r_fsck_pack *pack,
+    int checksums,
+    size_t start,
+    size_t end)
+{
+    git2r_fsck_job *job = git_array_alloc(data->jobs);
+
+    if (!job) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return NULL;
+    }
+
+    memset(job, 0, sizeof(git2r_fsck_job));
+    job->pack = pack;
+    job->checksums = checksums;
+    job->start = start;
+    job->end = end;
+
+    return job;
+}
+
+/**
+ * Split the verification of the pack files and loose objects into
+ * jobs
+ */
+static int git2r_fsck_jobs(git2r_fsck_data *data)
+{
+    size_t i, j, n;
+
+    for (i = 0; i < git_array_size(data->packs); i++) {
+        git2r_fsck_pack *pack = git_array_get(data->packs, i);
+
+        if (!pack->p || pack->verified)
+            continue;
+
+        if (!git2r_fsck_job_add(data, pack, 1, 0, 0))
+            return GIT_ERROR;
+
+        n = git_array_size(pack->entries);
+        for (j = 0; j < n; j += GIT2R_FSCK_BATCH) {
+            if (!git2r_fsck_job_add(data, pack, 0, j, j + GIT2R_FSCK_BATCH < n ?
+                                    j + GIT2R_FSCK_BATCH : n))
+                return GIT_ERROR;
+        }
+    }
+
+    n = git_array_size(data->loose);
+    for (j = 0; j < n; j += GIT2R_FSCK_BATCH) {
+        if (!git2r_fsck_job_add(data, NULL, 0, j, j + GIT2R_FSCK_BATCH < n ?
+                                j + GIT2R_FSCK_BATCH : n))
+            return GIT_ERROR;
+    }
+
+    return 0;
+}
+
+/**
+ * Check the jobs after the workers are done
+ *
+ * @return 0 or the error of the first job that failed
+ */
+static int git2r_fsck_check_jobs(git2r_fsck_data *data)
+{
+    size_t i;
+
+    for (i = 0; i < git_array_size(data->jobs); i++) {
+        git2r_fsck_job *job = git_array_get(data->jobs, i);
+
+        if (job->error) {
+            giterr_set_str(GITERR_NONE, job->message);
+            return job->error;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * An object to visit in the connectivity check
+ */
+typedef struct {
+    const git_oid *id;
+    git_otype type; /* the type that is referenced */
+    const git_oid *from; /* the referencing object, or NULL */
+    const char *ref; /* the referencing reference, or NULL */
+} git2r_fsck_visit;
+
+/**
+ * Data structure to hold the state of the connectivity check
+ */
+typedef struct {
+    git_repository *repository;
+    git_odb *odb;
+    git_oidmap *seen;
+    git_oidmap *bad;
+    git_pool ids;
+    git_pool names;
+    git_array_t(git2r_fsck_visit) stack;
+    git2r_fsck_problems *missing;
+} git2r_fsck_connectivity;
+
+/**
+ * Push an object to visit, if it is not seen
+ */
+static int git2r_fsck_push(
+    git2r_fsck_connectivity *c,
+    const git_oid *id,
+    git_otype type,
+    const git_oid *from,
+    const char *ref)
+{
+    int err;
+    git_oid *key;
+    git2r_fsck_visit *visit;
+
+    if (git_oidmap_valid_index(c->seen, git_oidmap_lookup_index(c->seen, id)))
+        return 0;
+
+    key = git_pool_malloc(&c->ids, 1);
+    GITERR_CHECK_ALLOC(key);
+    git_oid_cpy(key, id);
+    git_oidmap_insert(c->seen, key, key, &err);
+    if (err < 0)
+        return err;
+
+    visit = git_array_alloc(c->stack);
+    if (!visit) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+    visit->id = key;
+    visit->type = type;
+    visit->from = from;
+    visit->ref = ref;
+
+    return 0;
+}
+
+/**
+ * Add a problem with an object and the object or reference that
+ * references it
+ */
+static int git2r_fsck_connectivity_problem(
+    git2r_fsck_connectivity *c,
+    const git2r_fsck_visit *visit,
+    const char *message,
+    int error)
+{
+    int err;
+    git_buf buf = GIT_BUF_INIT;
+    char sha[GIT_OID_HEXSZ + 1];
+
+    if (visit->from)
+        git_oid_tostr(sha, sizeof(sha), visit->from);
+    git_buf_printf(&buf, "%s, referenced by %s", message,
+                   visit->from ? sha : visit->ref);
+    if (git_buf_oom(&buf)) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+
+    err = git2r_fsck_problem_add(c->missing, visit->id, NULL, buf.ptr, error);
+    git_buf_free(&buf);
+
+    return err;
+}
+
+/**
+ * Visit an object: check that it exists with the referenced type,
+ * and push the objects that it references
+ */
+static int git2r_fsck_visit_object(git2r_fsck_connectivity *c, git2r_fsck_visit visit)
+{
+    int err;
+    size_t i, n, len;
+    git_otype type;
+    git_object *object = NULL;
+    git_buf message = GIT_BUF_INIT;
+
+    /* The object is already reported */
+    if (git_oidmap_valid_index(c->bad, git_oidmap_lookup_index(c->bad, visit.id)))
+        return 0;
+
+    if (GIT_OBJ_BLOB == visit.type)
+        err = git_odb_read_header(&len, &type, c->odb, visit.id);
+    else
+        err = git_object_lookup(&object, c->repository, visit.id, GIT_OBJ_ANY);
+
+    if (GIT_ENOTFOUND == err) {
+        git_buf_printf(&message, "missing %s", GIT_OBJ_ANY == visit.type ?
+                       "object" : git_object_type2string(visit.type));
+        err = 0;
+    } else if (err) {
+        git_buf_puts(&message, "corrupt object");
+    } else {
+        if (object)
+            type = git_object_type(object);
+        if (GIT_OBJ_ANY != visit.type && type != visit.type)
+            git_buf_printf(&message, "%s is not a %s", git_object_type2string(type),
+                           git_object_type2string(visit.type));
+    }
+
+    if (git_buf_oom(&message)) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        err = GIT_ERROR;
+        goto cleanup;
+    }
+
+    if (message.size) {
+        err = git2r_fsck_connectivity_problem(c, &visit, message.ptr, err);
+        goto cleanup;
+    }
+
+    if (!object)
+        goto cleanup;
+
+    switch (type) {
+    case GIT_OBJ_COMMIT:
+        err = git2r_fsck_push(c, git_commit_tree_id((git_commit *)object),
+                              GIT_OBJ_TREE, visit.id, NULL);
+        n = git_commit_parentcount((git_commit *)object);
+        for (i = 0; i < n && !err; i++) {
+            err = git2r_fsck_push(c, git_commit_parent_id((git_commit *)object, i),
+                                  GIT_OBJ_COMMIT, visit.id, NULL);
+        }
+        break;
+    case GIT_OBJ_TREE:
+        n = git_tree_entrycount((git_tree *)object);
+        for (i = 0; i < n && !err; i++) {
+            const git_tree_entry *entry = git_tree_entry_byindex((git_tree *)object, i);
+
+            /* A submodule is in another repository */
+            if (GIT_FILEMODE_COMMIT == git_tree_entry_filemode(entry))
+                continue;
+            err = git2r_fsck_push(c, git_tree_entry_id(entry),
+                                  git_tree_entry_type(entry), visit.id, NULL);
+        }
+        break;
+    case GIT_OBJ_TAG:
+        err = git2r_fsck_push(c, git_tag_target_id((git_tag *)object),
+                              git_tag_target_type((git_tag *)object), visit.id, NULL);
+        break;
+    default:
+        break;
+    }
+
+cleanup:
+    git_object_free(object);
+    git_buf_free(&message);
+
+    return err;
+}
+
+/**
+ * Check that the objects that are reachable from the references and
+ * HEAD exist
+ */
+static int git2r_fsck_check_connectivity(git_repository *repository, git2r_fsck_data *data)
+{
+    int err;
+    size_t i, j;
+    git_reference *ref = NULL;
+    git_reference_iterator *iter = NULL;
+    git2r_fsck_connectivity c;
+
+    memset(&c, 0, sizeof(c));
+    c.repository = repository;
+    c.missing = &data->missing;
+    git_pool_init(&c.ids, sizeof(git_oid));
+    git_pool_init(&c.names, 1);
+
+    c.seen = git_oidmap_alloc();
+    c.bad = git_oidmap_alloc();
+    if (!c.seen || !c.bad) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        err = GIT_ERROR;
+        goto cleanup;
+    }
+
+    err = git_repository_odb(&c.odb, repository);
+    if (err)
+        goto cleanup;
+
+    /* The objects with problems are not visited again */
+    for (i = 0; i < git_array_size(data->jobs); i++) {
+        git2r_fsck_job *job = git_array_get(data->jobs, i);
+
+        for (j = 0; j < git_array_size(job->problems); j++) {
+            git2r_fsck_problem *problem = git_array_get(job->problems, j);
+
+            if (!problem->has_id)
+                continue;
+            git_oidmap_insert(c.bad, &problem->id, problem, &err);
+            if (err < 0)
+                goto cleanup;
+        }
+    }
+
+    /* The roots: the references and a detached HEAD */
+    err = git_reference_iterator_new(&iter, repository);
+    if (err)
+        goto cleanup;
+    while (!(err = git_reference_next(&ref, iter))) {
+        if (GIT_REF_OID == git_reference_type(ref)) {
+            char *name = git_pool_strdup(&c.names, git_reference_name(ref));
+
+            if (!name) {
+                giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+                err = GIT_ERROR;
+                goto cleanup;
+            }
+            err = git2r_fsck_push(&c, git_reference_target(ref), GIT_OBJ_ANY, NULL, name);
+            if (err)
+                goto cleanup;
+        }
+        git_reference_free(ref);
+        ref = NULL;
+    }
+    if (GIT_ITEROVER != err)
+        goto cleanup;
+
+    err = git_reference_lookup(&ref, repository, GIT_HEAD_FILE);
+    if (err)
+        goto cleanup;
+    if (GIT_REF_OID == git_reference_type(ref)) {
+        err = git2r_fsck_push(&c, git_reference_target(ref), GIT_OBJ_ANY, NULL,
+                              GIT_HEAD_FILE);
+        if (err)
+            goto cleanup;
+    }
+
+    while (git_array_size(c.stack)) {
+        git2r_fsck_visit visit = *git_array_last(c.stack);
+
+        c.stack.size--;
+        err = git2r_fsck_visit_object(&c, visit);
+        if (err)
+            goto cleanup;
+    }
+
+cleanup:
+    git_reference_free(ref);
+    git_reference_iterator_free(iter);
+    git_odb_free(c.odb);
+    git_oidmap_free(c.seen);
+    git_oidmap_free(c.bad);
+    git_pool_clear(&c.ids);
+    git_pool_clear(&c.names);
+    git_array_clear(c.stack);
+
+    return err;
+}
+
+/**
+ * Record the pack files that are verified without problems, for
+ * the incremental mode
+ */
+static int git2r_fsck_write_verified(git2r_fsck_data *data, const char *path)
+{
+    int err;
+    size_t i;
+    git_buf buf = GIT_BUF_INIT;
+
+    for (i = 0; i < git_array_size(data->jobs); i++) {
+        git2r_fsck_job *job = git_array_get(data->jobs, i);
+
+        if (job->pack && git_array_size(job->problems))
+            job->pack->verified = -1;
+    }
+
+    for (i = 0; i < git_array_size(data->packs); i++) {
+        git2r_fsck_pack *pack = git_array_get(data->packs, i);
+
+        if (pack->p && pack->verified >= 0)
+            git_buf_printf(&buf, "%s %"PRId64" %"PRId64"\n", pack->name,
+                           (int64_t)pack->mtime, (int64_t)pack->size);
+    }
+
+    if (git_buf_oom(&buf)) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+
+    err = git_futils_writebuffer(&buf, path, O_CREAT | O_TRUNC | O_WRONLY, 0666);
+    git_buf_free(&buf);
+
+    return err;
+}
+
+static void git2r_fsck_problems_free(git2r_fsck_problems *problems)
+{
+    size_t i;
+
+    for (i = 0; i < git_array_size(*problems); i++)
+        git__free(git_array_get(*problems, i)->message);
+    git_array_clear(*problems);
+}
+
+static void git2r_fsck_data_free(git2r_fsck_data *data)
+{
+    size_t i;
+
+    for (i = 0; i < git_array_size(data->jobs); i++) {
+        git2r_fsck_job *job = git_array_get(data->jobs, i);
+
+        git2r_fsck_problems_free(&job->problems);
+        free(job->message);
+    }
+    git_array_clear(data->jobs);
+
+    for (i = 0; i < git_array_size(data->packs); i++) {
+        git2r_fsck_pack *pack = git_array_get(data->packs, i);
+
+        git_array_clear(pack->entries);
+        if (pack->p)
+            git_mwindow_put_pack(pack->p);
+        git__free(pack->name);
+        git__free(pack->idx_name);
+    }
+    git_array_clear(data->packs);
+
+    git_array_clear(data->loose);
+    git2r_fsck_problems_free(&data->problems);
+    git2r_fsck_problems_free(&data->missing);
+    git_buf_free(&data->objects);
+    git_buf_free(&data->verified);
+}
+
+/**
+ * Add problems to the result
+ */
+static size_t git2r_fsck_result(SEXP result, size_t k, git2r_fsck_problems *problems)
+{
+    size_t i;
+    char sha[GIT_OID_HEXSZ + 1];
+
+    for (i = 0; i < git_array_size(*problems); i++, k++) {
+        git2r_fsck_problem *problem = git_array_get(*problems, i);
+
+        if (problem->has_id) {
+            git_oid_tostr(sha, sizeof(sha), &problem->id);
+            SET_STRING_ELT(VECTOR_ELT(result, 0), k, Rf_mkChar(sha));
+        } else {
+            SET_STRING_ELT(VECTOR_ELT(result, 0), k, NA_STRING);
+        }
+
+        if (problem->file) {
+            SET_STRING_ELT(VECTOR_ELT(result, 1), k, Rf_mkChar(problem->file));
+        } else if (problem->loose) {
+            char file[GIT_OID_HEXSZ + 2];
+
+            snprintf(file, sizeof(file), "%.2s/%s", sha, sha + 2);
+            SET_STRING_ELT(VECTOR_ELT(result, 1), k, Rf_mkChar(file));
+        } else {
+            SET_STRING_ELT(VECTOR_ELT(result, 1), k, NA_STRING);
+        }
+
+        SET_STRING_ELT(VECTOR_ELT(result, 2), k, Rf_mkChar(problem->message));
+    }
+
+    return k;
+}
+
+/**
+ * Verify the object database of a repository
+ *
+ * The checksums of the pack files and their indexes are verified,
+ * and every object is inflated, hashed and parsed by parallel
+ * workers. Then the objects that are reachable from the references
+ * and HEAD are checked to exist. In the incremental mode, the pack
+ * files that are verified without problems since they were modified
+ * are not read again.
+ *
+ * @param repo S4 class git_repository
+ * @param jobs The number of workers.
+ * @param incremental Skip the pack files that are verified since
+ * they were modified.
+ * @return list with the columns 'sha', 'file' and 'problem', with
+ * one row for each problem.
+ */
+SEXP git2r_fsck(SEXP repo, SEXP jobs, SEXP incremental)
+{
+    int err;
+    size_t i, k, n_rows;
+    SEXP result = R_NilValue;
+    SEXP names;
+    git_buf path = GIT_BUF_INIT, pack_dir = GIT_BUF_INIT;
+    git_repository *repository = NULL;
+    git2r_fsck_data data;
+
+    if (git2r_arg_check_integer(jobs))
+        git2r_error(__func__, NULL, "'jobs'", git2r_err_integer_arg);
+    if (git2r_arg_check_logical(incremental))
+        git2r_error(__func__, NULL, "'incremental'", git2r_err_logical_arg);
+
+    memset(&data, 0, sizeof(data));
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    /* The pack files that are verified since they were modified */
+    err = git_buf_joinpath(&path, git_repository_path(repository),
+                           GIT2R_FSCK_VERIFIED_FILE);
+    if (err)
+        goto cleanup;
+    if (LOGICAL(incremental)[0] && git_path_isfile(path.ptr)) {
+        err = git_futils_readbuffer(&data.verified, path.ptr);
+        if (err)
+            goto cleanup;
+    }
+
+    /* The objects: first the pack files, then the loose objects */
+    err = git_repository_item_path(&data.objects, repository,
+                                   GIT_REPOSITORY_ITEM_OBJECTS);
+    if (err)
+        goto cleanup;
+    err = git_buf_joinpath(&pack_dir, data.objects.ptr, "pack");
+    if (err)
+        goto cleanup;
+    if (git_path_isdir(pack_dir.ptr)) {
+        err = git_path_direach(&pack_dir, 0, git2r_fsck_pack_dir_cb, &data);
+        if (err)
+            goto cleanup;
+    }
+    err = git2r_fsck_loose(&data);
+    if (err)
+        goto cleanup;
+
+    err = git2r_fsck_jobs(&data);
+    if (err)
+        goto cleanup;
+    git2r_parallel_for(git_array_size(data.jobs), INTEGER(jobs)[0], git2r_fsck_cb, &data);
+    err = git2r_fsck_check_jobs(&data);
+    if (err)
+        goto cleanup;
+
+    err = git2r_fsck_check_connectivity(repository, &data);
+    if (err)
+        goto cleanup;
+
+    /* A repository that cannot be written to, e.g. a read-only
+     * mirror, is still verified. */
+    if (LOGICAL(incremental)[0] && git2r_fsck_write_verified(&data, path.ptr)) {
+        err = git2r_fsck_problem_add(
+            &data.problems, NULL, GIT2R_FSCK_VERIFIED_FILE,
+            "failed to record the verified pack files", GIT_ERROR);
+        if (err)
+            goto cleanup;
+    }
+
+    n_rows = git_array_size(data.problems) + git_array_size(data.missing);
+    for (i = 0; i < git_array_size(data.jobs); i++)
+        n_rows += git_array_size(git_array_get(data.jobs, i)->problems);
+
+    PROTECT(result = Rf_allocVector(VECSXP, 3));
+    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 3));
+    SET_VECTOR_ELT(result, 0, Rf_allocVector(STRSXP, n_rows));
+    SET_STRING_ELT(names,  0, Rf_mkChar("sha"));
+    SET_VECTOR_ELT(result, 1, Rf_allocVector(STRSXP, n_rows));
+    SET_STRING_ELT(names,  1, Rf_mkChar("file"));
+    SET_VECTOR_ELT(result, 2, Rf_allocVector(STRSXP, n_rows));
+    SET_STRING_ELT(names,  2, Rf_mkChar("problem"));
+
+    k = git2r_fsck_result(result, 0, &data.problems);
+    for (i = 0; i < git_array_size(data.jobs); i++)
+        k = git2r_fsck_result(result, k, &git_array_get(data.jobs, i)->problems);
+    git2r_fsck_result(result, k, &data.missing);
+
+cleanup:
+    git2r_fsck_data_free(&data);
+    git_buf_free(&path);
+    git_buf_free(&pack_dir);
+    git_repository_free(repository);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
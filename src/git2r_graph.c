@@ -21,6 +21,7 @@
 
 #include "git2r_arg.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_oid.h"
 #include "git2r_repository.h"
 
@@ -47,8 +48,8 @@ SEXP git2r_graph_ahead_behind(SEXP local, SEXP upstream)
     if (git2r_arg_check_commit(upstream))
         git2r_error(__func__, NULL, "'upstream'", git2r_err_commit_arg);
 
-    local_repo = GET_SLOT(local, Rf_install("repo"));
-    upstream_repo = GET_SLOT(upstream, Rf_install("repo"));
+    local_repo = GET_SLOT(local, git2r_sym(repo));
+    upstream_repo = GET_SLOT(upstream, git2r_sym(repo));
     if (git2r_arg_check_same_repo(local_repo, upstream_repo))
         git2r_error(__func__, NULL, "'local' and 'upstream' not from same repository", NULL);
 
@@ -56,10 +57,10 @@ SEXP git2r_graph_ahead_behind(SEXP local, SEXP upstream)
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    local_sha = GET_SLOT(local, Rf_install("sha"));
+    local_sha = GET_SLOT(local, git2r_sym(sha));
     git2r_oid_from_sha_sexp(local_sha, &local_oid);
 
-    upstream_sha = GET_SLOT(upstream, Rf_install("sha"));
+    upstream_sha = GET_SLOT(upstream, git2r_sym(sha));
     git2r_oid_from_sha_sexp(upstream_sha, &upstream_oid);
 
     err = git_graph_ahead_behind(&ahead, &behind, repository, &local_oid,
@@ -105,8 +106,8 @@ SEXP git2r_graph_descendant_of(SEXP commit, SEXP ancestor)
     if (git2r_arg_check_commit(ancestor))
         git2r_error(__func__, NULL, "'ancestor'", git2r_err_commit_arg);
 
-    commit_repo = GET_SLOT(commit, Rf_install("repo"));
-    ancestor_repo = GET_SLOT(ancestor, Rf_install("repo"));
+    commit_repo = GET_SLOT(commit, git2r_sym(repo));
+    ancestor_repo = GET_SLOT(ancestor, git2r_sym(repo));
     if (git2r_arg_check_same_repo(commit_repo, ancestor_repo))
         git2r_error(__func__, NULL, "'commit' and 'ancestor' not from same repository", NULL);
 
@@ -114,10 +115,10 @@ SEXP git2r_graph_descendant_of(SEXP commit, SEXP ancestor)
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    commit_sha = GET_SLOT(commit, Rf_install("sha"));
+    commit_sha = GET_SLOT(commit, git2r_sym(sha));
     git2r_oid_from_sha_sexp(commit_sha, &commit_oid);
 
-    ancestor_sha = GET_SLOT(ancestor, Rf_install("sha"));
+    ancestor_sha = GET_SLOT(ancestor, git2r_sym(sha));
     git2r_oid_from_sha_sexp(ancestor_sha, &ancestor_oid);
 
     err = git_graph_descendant_of(repository, &commit_oid, &ancestor_oid);
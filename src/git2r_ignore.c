@@ -0,0 +1,277 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <Rdefines.h>
+#include "git2.h"
+#include "attr_file.h"
+#include "ignore.h"
+
+#include "git2r_arg.h"
+#include "git2r_error.h"
+#include "git2r_ignore.h"
+#include "git2r_repository.h"
+
+/**
+ * A path and its position in the argument
+ */
+typedef struct {
+    const char *path;
+    size_t dir_len;
+    size_t index;
+} git2r_sorted_path;
+
+/**
+ * Sort by directory and then by name
+ *
+ * Paths in the same directory are next to each other, also when the
+ * directory has subdirectories.
+ */
+static int git2r_sorted_path_cmp(const void *a, const void *b)
+{
+    const git2r_sorted_path *pa = a, *pb = b;
+    size_t len = pa->dir_len < pb->dir_len ? pa->dir_len : pb->dir_len;
+    int cmp = memcmp(pa->path, pb->path, len);
+
+    if (cmp)
+        return cmp;
+    if (pa->dir_len != pb->dir_len)
+        return pa->dir_len < pb->dir_len ? -1 : 1;
+    return strcmp(pa->path, pb->path);
+}
+
+/**
+ * Sort the paths that are not NA by directory
+ *
+ * @param out The sorted paths. Free with free().
+ * @param paths Character vector with paths
+ * @param n_out The number of sorted paths
+ * @param names The sorted paths, for the libgit2 batch functions. Free
+ * with free().
+ * @return 0 or an error code
+ */
+static int git2r_sort_paths(
+    git2r_sorted_path **out,
+    const char ***names,
+    size_t *n_out,
+    SEXP paths)
+{
+    size_t i, n = 0, len = Rf_length(paths);
+
+    *out = calloc(len ? len : 1, sizeof(git2r_sorted_path));
+    *names = calloc(len ? len : 1, sizeof(char*));
+    if (!*out || !*names) {
+        free(*out);
+        free(*names);
+        *out = NULL;
+        *names = NULL;
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+
+    for (i = 0; i < len; i++) {
+        const char *path;
+        size_t dir_len;
+
+        if (STRING_ELT(paths, i) == NA_STRING)
+            continue;
+
+        /* The directory ends at the last slash before the name */
+        path = CHAR(STRING_ELT(paths, i));
+        dir_len = strlen(path);
+        while (dir_len > 0 && path[dir_len - 1] == '/')
+            dir_len--;
+        while (dir_len > 0 && path[dir_len - 1] != '/')
+            dir_len--;
+
+        (*out)[n].path = path;
+        (*out)[n].dir_len = dir_len;
+        (*out)[n].index = i;
+        n++;
+    }
+
+    qsort(*out, n, sizeof(git2r_sorted_path), git2r_sorted_path_cmp);
+    for (i = 0; i < n; i++)
+        (*names)[i] = (*out)[i].path;
+    *n_out = n;
+
+    return 0;
+}
+
+/**
+ * Check if paths are ignored
+ *
+ * The paths are sorted by directory, and the ignore files of a
+ * directory are read once for all paths in it.
+ * @param repo S4 class git_repository
+ * @param paths Character vector with paths relative to the working
+ * directory.
+ * @return Logical vector, TRUE if the path is ignored and NA if the
+ * path is NA.
+ */
+SEXP git2r_check_ignore(SEXP repo, SEXP paths)
+{
+    int err = 0;
+    size_t i, n = 0;
+    int *ignored = NULL;
+    const char **names = NULL;
+    git2r_sorted_path *sorted = NULL;
+    SEXP result = R_NilValue;
+    git_repository *repository = NULL;
+
+    if (git2r_arg_check_string_vec(paths))
+        git2r_error(__func__, NULL, "'paths'", git2r_err_string_vec_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    err = git2r_sort_paths(&sorted, &names, &n, paths);
+    if (err)
+        goto cleanup;
+
+    ignored = calloc(n ? n : 1, sizeof(int));
+    if (!ignored) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        err = GIT_ERROR;
+        goto cleanup;
+    }
+
+    err = git_ignore__path_is_ignored_many(ignored, repository, names, n);
+    if (err)
+        goto cleanup;
+
+    PROTECT(result = Rf_allocVector(LGLSXP, Rf_length(paths)));
+    for (i = 0; i < (size_t)Rf_length(paths); i++)
+        LOGICAL(result)[i] = NA_LOGICAL;
+    for (i = 0; i < n; i++)
+        LOGICAL(result)[sorted[i].index] = ignored[i] ? 1 : 0;
+
+cleanup:
+    free(ignored);
+    free(names);
+    free(sorted);
+    git_repository_free(repository);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
+
+/**
+ * Get the attributes of paths
+ *
+ * The paths are sorted by directory, and the attribute files of a
+ * directory are read once for all paths in it.
+ * @param repo S4 class git_repository
+ * @param paths Character vector with paths relative to the working
+ * directory.
+ * @param attrs Character vector with the names of the attributes.
+ * @return A list with one character vector per attribute with the
+ * value for each path: "set", "unset", the value of the attribute or
+ * NA if it is unspecified.
+ */
+SEXP git2r_check_attr(SEXP repo, SEXP paths, SEXP attrs)
+{
+    int err = 0;
+    size_t i, j, n = 0, n_attr;
+    const char **values = NULL, **names = NULL, **attr_names = NULL;
+    git2r_sorted_path *sorted = NULL;
+    SEXP result = R_NilValue;
+    git_repository *repository = NULL;
+
+    if (git2r_arg_check_string_vec(paths))
+        git2r_error(__func__, NULL, "'paths'", git2r_err_string_vec_arg);
+    if (git2r_arg_check_string_vec(attrs))
+        git2r_error(__func__, NULL, "'attrs'", git2r_err_string_vec_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    err = git2r_sort_paths(&sorted, &names, &n, paths);
+    if (err)
+        goto cleanup;
+
+    n_attr = Rf_length(attrs);
+    attr_names = calloc(n_attr ? n_attr : 1, sizeof(char*));
+    values = calloc((n && n_attr) ? n * n_attr : 1, sizeof(char*));
+    if (!attr_names || !values) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        err = GIT_ERROR;
+        goto cleanup;
+    }
+    for (j = 0; j < n_attr; j++)
+        attr_names[j] = CHAR(STRING_ELT(attrs, j));
+
+    err = git_attr__get_many_paths(
+        values, repository, GIT_ATTR_CHECK_FILE_THEN_INDEX,
+        names, n, n_attr, attr_names);
+    if (err)
+        goto cleanup;
+
+    PROTECT(result = Rf_allocVector(VECSXP, n_attr));
+    Rf_setAttrib(result, R_NamesSymbol, attrs);
+    for (j = 0; j < n_attr; j++) {
+        SEXP column = Rf_allocVector(STRSXP, Rf_length(paths));
+        SET_VECTOR_ELT(result, j, column);
+
+        for (i = 0; i < (size_t)Rf_length(paths); i++)
+            SET_STRING_ELT(column, i, NA_STRING);
+
+        for (i = 0; i < n; i++) {
+            const char *value = values[i * n_attr + j];
+            SEXP item;
+
+            switch (git_attr_value(value)) {
+            case GIT_ATTR_TRUE_T:
+                item = Rf_mkChar("set");
+                break;
+            case GIT_ATTR_FALSE_T:
+                item = Rf_mkChar("unset");
+                break;
+            case GIT_ATTR_VALUE_T:
+                item = Rf_mkChar(value);
+                break;
+            default:
+                item = NA_STRING;
+                break;
+            }
+
+            SET_STRING_ELT(column, sorted[i].index, item);
+        }
+    }
+
+cleanup:
+    free(values);
+    free(attr_names);
+    free(names);
+    free(sorted);
+    git_repository_free(repository);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
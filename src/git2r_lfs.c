@@ -0,0 +1,1229 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <Rdefines.h>
+#include <inttypes.h>
+#include <string.h>
+#include "git2.h"
+#include "git2/sys/filter.h"
+#include "buffer.h"
+#include "fileops.h"
+#include "path.h"
+
+#include "git2r_arg.h"
+#include "git2r_error.h"
+#include "git2r_lfs.h"
+#include "git2r_parallel.h"
+#include "git2r_repository.h"
+
+/**
+ * The first line of a Git LFS pointer file
+ */
+#define GIT2R_LFS_VERSION "version https://git-lfs.github.com/spec/v1\n"
+
+/**
+ * A pointer file is never larger than this
+ */
+#define GIT2R_LFS_POINTER_MAX 1024
+
+/**
+ * Size of the chunks read from and written to the stores
+ */
+#define GIT2R_LFS_BUFSIZE 65536
+
+/**
+ * SHA-256 of the content, the object id used by the stores
+ */
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    unsigned char block[64];
+    size_t used;
+} git2r_sha256_ctx;
+
+static const uint32_t git2r_sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+#define GIT2R_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void git2r_sha256_block(git2r_sha256_ctx *ctx, const unsigned char *p)
+{
+    uint32_t w[64], s[8], t1, t2;
+    int i;
+
+    for (i = 0; i < 16; i++) {
+        w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[4 * i + 1] << 16) |
+            ((uint32_t)p[4 * i + 2] << 8) | (uint32_t)p[4 * i + 3];
+    }
+
+    for (i = 16; i < 64; i++) {
+        w[i] = w[i - 16] + w[i - 7] +
+            (GIT2R_ROTR(w[i - 15], 7) ^ GIT2R_ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3)) +
+            (GIT2R_ROTR(w[i - 2], 17) ^ GIT2R_ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10));
+    }
+
+    memcpy(s, ctx->state, sizeof(s));
+    for (i = 0; i < 64; i++) {
+        t1 = s[7] + (GIT2R_ROTR(s[4], 6) ^ GIT2R_ROTR(s[4], 11) ^ GIT2R_ROTR(s[4], 25)) +
+            ((s[4] & s[5]) ^ (~s[4] & s[6])) + git2r_sha256_k[i] + w[i];
+        t2 = (GIT2R_ROTR(s[0], 2) ^ GIT2R_ROTR(s[0], 13) ^ GIT2R_ROTR(s[0], 22)) +
+            ((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+        memmove(s + 1, s, 7 * sizeof(uint32_t));
+        s[4] += t1;
+        s[0] = t1 + t2;
+    }
+
+    for (i = 0; i < 8; i++)
+        ctx->state[i] += s[i];
+}
+
+static void git2r_sha256_init(git2r_sha256_ctx *ctx)
+{
+    static const uint32_t init[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+    memcpy(ctx->state, init, sizeof(init));
+    ctx->length = 0;
+    ctx->used = 0;
+}
+
+static void git2r_sha256_update(git2r_sha256_ctx *ctx, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+
+    ctx->length += len;
+
+    if (ctx->used) {
+        size_t n = 64 - ctx->used < len ? 64 - ctx->used : len;
+        memcpy(ctx->block + ctx->used, p, n);
+        ctx->used += n;
+        p += n;
+        len -= n;
+        if (ctx->used < 64)
+            return;
+        git2r_sha256_block(ctx, ctx->block);
+        ctx->used = 0;
+    }
+
+    for (; len >= 64; p += 64, len -= 64)
+        git2r_sha256_block(ctx, p);
+
+    memcpy(ctx->block, p, len);
+    ctx->used = len;
+}
+
+/**
+ * Finish the hash and write it as 64 hexadecimal digits and a '\0'
+ */
+static void git2r_sha256_final(char *out, git2r_sha256_ctx *ctx)
+{
+    static const char hex[] = "0123456789abcdef";
+    uint64_t bits = ctx->length * 8;
+    unsigned char pad[72] = {0x80};
+    size_t n = (ctx->used < 56 ? 56 : 120) - ctx->used;
+    int i;
+
+    for (i = 0; i < 8; i++)
+        pad[n + i] = (unsigned char)(bits >> (56 - 8 * i));
+    git2r_sha256_update(ctx, pad, n + 8);
+
+    for (i = 0; i < 32; i++) {
+        unsigned char c = (unsigned char)(ctx->state[i / 4] >> (24 - 8 * (i % 4)));
+        out[2 * i] = hex[c >> 4];
+        out[2 * i + 1] = hex[c & 15];
+    }
+    out[64] = '\0';
+}
+
+/**
+ * The content of a pointer file
+ */
+typedef struct {
+    char oid[65];
+    git_off_t size;
+} git2r_lfs_pointer;
+
+/**
+ * Parse a pointer file
+ *
+ * @param out The object id and size of the content
+ * @param data The data to parse
+ * @param len The length of data
+ * @return 0 if data is a pointer file, else -1
+ */
+static int git2r_lfs_pointer_parse(
+    git2r_lfs_pointer *out,
+    const char *data,
+    size_t len)
+{
+    const char *line, *eol, *end = data + len;
+    size_t version_len = strlen(GIT2R_LFS_VERSION), i;
+    int has_oid = 0, has_size = 0;
+
+    if (len > GIT2R_LFS_POINTER_MAX || len < version_len ||
+        memcmp(data, GIT2R_LFS_VERSION, version_len))
+        return -1;
+
+    for (line = data + version_len; line < end; line = eol + 1) {
+        if (!(eol = memchr(line, '\n', end - line)))
+            return -1;
+
+        if (eol - line == 75 && !memcmp(line, "oid sha256:", 11)) {
+            for (i = 0; i < 64; i++) {
+                char c = line[11 + i];
+                if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+                    return -1;
+                out->oid[i] = c;
+            }
+            out->oid[64] = '\0';
+            has_oid = 1;
+        } else if (eol - line > 5 && eol - line < 24 && !memcmp(line, "size ", 5)) {
+            /* At most 18 digits, so the size can't overflow */
+            out->size = 0;
+            for (i = 5; line + i < eol; i++) {
+                if (line[i] < '0' || line[i] > '9')
+                    return -1;
+                out->size = out->size * 10 + (line[i] - '0');
+            }
+            has_size = 1;
+        }
+
+        /* Other keys, e.g. extensions, are not used. */
+    }
+
+    return (has_oid && has_size) ? 0 : -1;
+}
+
+static int git2r_lfs_pointer_format(git_buf *out, const git2r_lfs_pointer *pointer)
+{
+    return git_buf_printf(out, GIT2R_LFS_VERSION "oid sha256:%s\nsize %" PRId64 "\n",
+                          pointer->oid, (int64_t)pointer->size);
+}
+
+/**
+ * The path to the local store
+ *
+ * The 'lfs' directory in the git directory, or the 'lfs.storage'
+ * config, like Git LFS.
+ */
+static int git2r_lfs_storage(git_buf *out, git_repository *repo)
+{
+    int error;
+    const char *value;
+    git_config *cfg = NULL;
+
+    if ((error = git_repository_config_snapshot(&cfg, repo)) < 0)
+        return error;
+
+    error = git_config_get_string(&value, cfg, "lfs.storage");
+    if (error == GIT_ENOTFOUND) {
+        giterr_clear();
+        error = git_buf_joinpath(out, git_repository_path(repo), "lfs");
+    } else if (!error) {
+        error = git_path_join_unrooted(out, value, git_repository_path(repo), NULL);
+    }
+
+    git_config_free(cfg);
+
+    return error;
+}
+
+/**
+ * The path to the mirror store
+ *
+ * A 'file://' url in the 'lfs.url' config. Other urls are not used.
+ *
+ * @return 0, GIT_ENOTFOUND if there is no mirror or an error code
+ */
+static int git2r_lfs_mirror(git_buf *out, git_repository *repo)
+{
+    int error;
+    const char *value;
+    git_config *cfg = NULL;
+
+    if ((error = git_repository_config_snapshot(&cfg, repo)) < 0)
+        return error;
+
+    error = git_config_get_string(&value, cfg, "lfs.url");
+    if (!error) {
+        if (git__prefixcmp(value, "file://")) {
+            error = GIT_ENOTFOUND;
+        } else {
+            value += strlen("file://");
+#ifdef GIT_WIN32
+            /* file:///C:/path */
+            if (value[0] == '/' && value[1] && value[2] == ':')
+                value++;
+#endif
+            error = git_buf_sets(out, value);
+        }
+    }
+
+    if (error == GIT_ENOTFOUND)
+        giterr_clear();
+
+    git_config_free(cfg);
+
+    return error;
+}
+
+static int git2r_lfs_object_path(git_buf *out, const char *store, const char *oid)
+{
+    git_buf_clear(out);
+    return git_buf_printf(out, "%s/objects/%.2s/%.2s/%s", store, oid, oid + 2, oid);
+}
+
+static int git2r_lfs_mkdir_parent(const char *path)
+{
+    int error;
+    git_buf dir = GIT_BUF_INIT;
+
+    if ((error = git_path_dirname_r(&dir, path)) >= 0)
+        error = git_futils_mkdir(dir.ptr, 0777, GIT_MKDIR_PATH);
+
+    git_buf_free(&dir);
+
+    return error < 0 ? error : 0;
+}
+
+/**
+ * Copy an object from one store to another
+ *
+ * The content is written to 'tmp' and renamed to 'to' when its id
+ * and size are verified. Only uses the plain file functions, that
+ * don't set the libgit2 error, so that it can run in a worker thread.
+ *
+ * @param from The path to the object to copy
+ * @param to The path to write the object to
+ * @param tmp The path to the temporary file
+ * @param oid The id of the object
+ * @param size The size of the object, or -1 if unknown
+ * @param message Buffer for an error message
+ * @param message_len The size of message
+ * @return 0 on success, else -1
+ */
+static int git2r_lfs_copy(
+    const char *from,
+    const char *to,
+    const char *tmp,
+    const char *oid,
+    git_off_t size,
+    char *message,
+    size_t message_len)
+{
+    char buf[GIT2R_LFS_BUFSIZE], hashed[65];
+    git2r_sha256_ctx ctx;
+    git_off_t total = 0;
+    ssize_t n;
+    int fd_from, fd_to, error = 0;
+
+    if ((fd_from = p_open(from, O_RDONLY | O_BINARY)) < 0) {
+        snprintf(message, message_len, "failed to open '%s'", from);
+        return -1;
+    }
+
+    p_unlink(tmp);
+    if ((fd_to = p_open(tmp, O_WRONLY | O_CREAT | O_EXCL | O_BINARY, 0444)) < 0) {
+        snprintf(message, message_len, "failed to create '%s'", tmp);
+        p_close(fd_from);
+        return -1;
+    }
+
+    git2r_sha256_init(&ctx);
+    while ((n = p_read(fd_from, buf, sizeof(buf))) > 0) {
+        git2r_sha256_update(&ctx, buf, n);
+        total += n;
+        if (p_write(fd_to, buf, n) < 0) {
+            snprintf(message, message_len, "failed to write '%s'", tmp);
+            error = -1;
+            break;
+        }
+    }
+
+    if (!error && n < 0) {
+        snprintf(message, message_len, "failed to read '%s'", from);
+        error = -1;
+    }
+
+    p_close(fd_from);
+    if (p_close(fd_to) < 0 && !error) {
+        snprintf(message, message_len, "failed to write '%s'", tmp);
+        error = -1;
+    }
+
+    if (!error) {
+        git2r_sha256_final(hashed, &ctx);
+        if (strcmp(hashed, oid) || (size >= 0 && size != total)) {
+            snprintf(message, message_len, "object '%s' is corrupt", from);
+            error = -1;
+        }
+    }
+
+    if (!error && p_rename(tmp, to) < 0) {
+        snprintf(message, message_len, "failed to rename '%s' to '%s'", tmp, to);
+        error = -1;
+    }
+
+    if (error)
+        p_unlink(tmp);
+
+    return error;
+}
+
+/**
+ * Make a copy of an object from the mirror in the local store
+ */
+static int git2r_lfs_fetch_object(
+    git_repository *repo,
+    const git2r_lfs_pointer *pointer,
+    const char *to)
+{
+    int error;
+    char message[512];
+    git_buf mirror = GIT_BUF_INIT, from = GIT_BUF_INIT, tmp = GIT_BUF_INIT;
+
+    if ((error = git2r_lfs_mirror(&mirror, repo)) < 0 ||
+        (error = git2r_lfs_object_path(&from, mirror.ptr, pointer->oid)) < 0)
+        goto cleanup;
+
+    if (!git_path_isfile(from.ptr)) {
+        error = GIT_ENOTFOUND;
+        goto cleanup;
+    }
+
+    if ((error = git2r_lfs_mkdir_parent(to)) < 0 ||
+        (error = git_buf_printf(&tmp, "%s.tmp", to)) < 0)
+        goto cleanup;
+
+    if (git2r_lfs_copy(from.ptr, to, tmp.ptr, pointer->oid, pointer->size,
+                       message, sizeof(message))) {
+        giterr_set_str(GITERR_OS, message);
+        error = GIT_ERROR;
+    }
+
+cleanup:
+    git_buf_free(&mirror);
+    git_buf_free(&from);
+    git_buf_free(&tmp);
+
+    return error;
+}
+
+/**
+ * Read the content of a pointer in chunks
+ *
+ * The object is copied from the mirror to the local store if it's
+ * only in the mirror.
+ *
+ * @return 0, GIT_ENOTFOUND if the object is in neither store or an
+ * error code
+ */
+static int git2r_lfs_read(
+    git_repository *repo,
+    const git2r_lfs_pointer *pointer,
+    int (*cb)(const char *data, size_t len, void *payload),
+    void *payload)
+{
+    char buf[GIT2R_LFS_BUFSIZE];
+    git_buf storage = GIT_BUF_INIT, path = GIT_BUF_INIT;
+    git_off_t total = 0;
+    ssize_t n = 0;
+    int fd = -1, error;
+
+    if ((error = git2r_lfs_storage(&storage, repo)) < 0 ||
+        (error = git2r_lfs_object_path(&path, storage.ptr, pointer->oid)) < 0)
+        goto cleanup;
+
+    if (!git_path_isfile(path.ptr) &&
+        (error = git2r_lfs_fetch_object(repo, pointer, path.ptr)) < 0)
+        goto cleanup;
+
+    if ((fd = git_futils_open_ro(path.ptr)) < 0) {
+        error = fd;
+        goto cleanup;
+    }
+
+    while ((n = p_read(fd, buf, sizeof(buf))) > 0) {
+        total += n;
+        if ((error = cb(buf, n, payload)) < 0)
+            goto cleanup;
+    }
+
+    if (n < 0) {
+        giterr_set(GITERR_OS, "failed to read '%s'", path.ptr);
+        error = GIT_ERROR;
+    } else if (total != pointer->size) {
+        giterr_set(GITERR_FILTER, "size of '%s' does not match the pointer", path.ptr);
+        error = GIT_ERROR;
+    }
+
+cleanup:
+    if (fd >= 0)
+        p_close(fd);
+    git_buf_free(&storage);
+    git_buf_free(&path);
+
+    return error;
+}
+
+/**
+ * Stream for the 'clean' direction: the content is hashed and
+ * written to the local store, and the pointer is written to the
+ * object database. Content that is a pointer already is kept.
+ */
+typedef struct {
+    git_writestream parent;
+    git_writestream *next;
+    git_repository *repo;
+    git2r_sha256_ctx hash;
+    git_off_t size;
+    char head[GIT2R_LFS_POINTER_MAX];
+    git_buf tmp_path;
+    git_file fd;
+} git2r_lfs_clean_stream;
+
+static int git2r_lfs_clean_open(git2r_lfs_clean_stream *s)
+{
+    int error;
+    git_buf tmp = GIT_BUF_INIT;
+
+    if ((error = git2r_lfs_storage(&tmp, s->repo)) < 0 ||
+        (error = git_buf_joinpath(&tmp, tmp.ptr, "tmp")) < 0 ||
+        (error = git_futils_mkdir(tmp.ptr, 0777, GIT_MKDIR_PATH)) < 0 ||
+        (error = git_buf_joinpath(&tmp, tmp.ptr, "object")) < 0)
+        goto cleanup;
+
+    if ((s->fd = git_futils_mktmp(&s->tmp_path, tmp.ptr, 0444)) < 0) {
+        error = s->fd;
+        goto cleanup;
+    }
+
+    if (p_write(s->fd, s->head, (size_t)s->size) < 0) {
+        giterr_set(GITERR_OS, "failed to write '%s'", s->tmp_path.ptr);
+        error = GIT_ERROR;
+    }
+
+cleanup:
+    git_buf_free(&tmp);
+
+    return error < 0 ? error : 0;
+}
+
+static int git2r_lfs_clean_write(git_writestream *stream, const char *buffer, size_t len)
+{
+    int error;
+    git2r_lfs_clean_stream *s = (git2r_lfs_clean_stream *)stream;
+
+    git2r_sha256_update(&s->hash, buffer, len);
+
+    if (s->fd < 0 && s->size + len <= GIT2R_LFS_POINTER_MAX) {
+        memcpy(s->head + s->size, buffer, len);
+        s->size += len;
+        return 0;
+    }
+
+    if (s->fd < 0 && (error = git2r_lfs_clean_open(s)) < 0)
+        return error;
+
+    if (p_write(s->fd, buffer, len) < 0) {
+        giterr_set(GITERR_OS, "failed to write '%s'", s->tmp_path.ptr);
+        return GIT_ERROR;
+    }
+
+    s->size += len;
+    return 0;
+}
+
+static int git2r_lfs_clean_close(git_writestream *stream)
+{
+    int error = 0;
+    git2r_lfs_clean_stream *s = (git2r_lfs_clean_stream *)stream;
+    git2r_lfs_pointer pointer;
+    git_buf storage = GIT_BUF_INIT, path = GIT_BUF_INIT, out = GIT_BUF_INIT;
+
+    /* An empty file is its own pointer */
+    if (s->size == 0)
+        return s->next->close(s->next);
+
+    if (s->fd < 0 && !git2r_lfs_pointer_parse(&pointer, s->head, (size_t)s->size)) {
+        if ((error = s->next->write(s->next, s->head, (size_t)s->size)) < 0)
+            return error;
+        return s->next->close(s->next);
+    }
+
+    if (s->fd < 0 && (error = git2r_lfs_clean_open(s)) < 0)
+        return error;
+
+    p_close(s->fd);
+    s->fd = -1;
+
+    git2r_sha256_final(pointer.oid, &s->hash);
+    pointer.size = s->size;
+
+    if ((error = git2r_lfs_storage(&storage, s->repo)) < 0 ||
+        (error = git2r_lfs_object_path(&path, storage.ptr, pointer.oid)) < 0)
+        goto cleanup;
+
+    if (git_path_isfile(path.ptr)) {
+        p_unlink(s->tmp_path.ptr);
+    } else {
+        if ((error = git2r_lfs_mkdir_parent(path.ptr)) < 0)
+            goto cleanup;
+        if (p_rename(s->tmp_path.ptr, path.ptr) < 0) {
+            giterr_set(GITERR_OS, "failed to rename '%s' to '%s'",
+                       s->tmp_path.ptr, path.ptr);
+            error = GIT_ERROR;
+            goto cleanup;
+        }
+    }
+    git_buf_clear(&s->tmp_path);
+
+    if ((error = git2r_lfs_pointer_format(&out, &pointer)) < 0 ||
+        (error = s->next->write(s->next, out.ptr, out.size)) < 0)
+        goto cleanup;
+
+    error = s->next->close(s->next);
+
+cleanup:
+    git_buf_free(&storage);
+    git_buf_free(&path);
+    git_buf_free(&out);
+
+    return error;
+}
+
+static void git2r_lfs_clean_free(git_writestream *stream)
+{
+    git2r_lfs_clean_stream *s = (git2r_lfs_clean_stream *)stream;
+
+    if (s->fd >= 0)
+        p_close(s->fd);
+    if (git_buf_len(&s->tmp_path))
+        p_unlink(s->tmp_path.ptr);
+    git_buf_free(&s->tmp_path);
+    git__free(s);
+}
+
+/**
+ * Stream for the 'smudge' direction: a pointer is replaced with the
+ * content from the stores. The pointer is kept if the content isn't
+ * available, the content is then read when it's needed, see
+ * git2r_lfs_blob_content.
+ */
+typedef struct {
+    git_writestream parent;
+    git_writestream *next;
+    git_repository *repo;
+    char head[GIT2R_LFS_POINTER_MAX];
+    size_t head_len;
+    int passthrough;
+} git2r_lfs_smudge_stream;
+
+static int git2r_lfs_smudge_write(git_writestream *stream, const char *buffer, size_t len)
+{
+    int error;
+    git2r_lfs_smudge_stream *s = (git2r_lfs_smudge_stream *)stream;
+
+    if (!s->passthrough && s->head_len + len <= GIT2R_LFS_POINTER_MAX) {
+        memcpy(s->head + s->head_len, buffer, len);
+        s->head_len += len;
+        return 0;
+    }
+
+    /* Too large to be a pointer */
+    if (!s->passthrough) {
+        s->passthrough = 1;
+        if (s->head_len && (error = s->next->write(s->next, s->head, s->head_len)) < 0)
+            return error;
+    }
+
+    return s->next->write(s->next, buffer, len);
+}
+
+static int git2r_lfs_write_cb(const char *data, size_t len, void *payload)
+{
+    git_writestream *next = payload;
+    return next->write(next, data, len);
+}
+
+static int git2r_lfs_smudge_close(git_writestream *stream)
+{
+    int error = GIT_ENOTFOUND;
+    git2r_lfs_smudge_stream *s = (git2r_lfs_smudge_stream *)stream;
+    git2r_lfs_pointer pointer;
+
+    if (!s->passthrough) {
+        if (!git2r_lfs_pointer_parse(&pointer, s->head, s->head_len))
+            error = git2r_lfs_read(s->repo, &pointer, git2r_lfs_write_cb, s->next);
+
+        if (error == GIT_ENOTFOUND) {
+            giterr_clear();
+            error = s->head_len ? s->next->write(s->next, s->head, s->head_len) : 0;
+        }
+
+        if (error < 0)
+            return error;
+    }
+
+    return s->next->close(s->next);
+}
+
+static void git2r_lfs_smudge_free(git_writestream *stream)
+{
+    git__free(stream);
+}
+
+static int git2r_lfs_stream(
+    git_writestream **out,
+    git_filter *self,
+    void **payload,
+    const git_filter_source *src,
+    git_writestream *next)
+{
+    GIT_UNUSED(self);
+    GIT_UNUSED(payload);
+
+    if (git_filter_source_mode(src) == GIT_FILTER_CLEAN) {
+        git2r_lfs_clean_stream *s = git__calloc(1, sizeof(git2r_lfs_clean_stream));
+        GITERR_CHECK_ALLOC(s);
+
+        s->parent.write = git2r_lfs_clean_write;
+        s->parent.close = git2r_lfs_clean_close;
+        s->parent.free = git2r_lfs_clean_free;
+        s->next = next;
+        s->repo = git_filter_source_repo(src);
+        s->fd = -1;
+        git2r_sha256_init(&s->hash);
+        *out = (git_writestream *)s;
+    } else {
+        git2r_lfs_smudge_stream *s = git__calloc(1, sizeof(git2r_lfs_smudge_stream));
+        GITERR_CHECK_ALLOC(s);
+
+        s->parent.write = git2r_lfs_smudge_write;
+        s->parent.close = git2r_lfs_smudge_close;
+        s->parent.free = git2r_lfs_smudge_free;
+        s->next = next;
+        s->repo = git_filter_source_repo(src);
+        *out = (git_writestream *)s;
+    }
+
+    return 0;
+}
+
+static git_filter git2r_lfs_filter;
+
+/**
+ * Register the 'lfs' filter
+ *
+ * Files with the attribute 'filter=lfs' are stored as Git LFS
+ * pointer files in the repository, and their content in the local
+ * store.
+ */
+void git2r_lfs_init(void)
+{
+    git_filter_init(&git2r_lfs_filter, GIT_FILTER_VERSION);
+    git2r_lfs_filter.attributes = "filter=lfs";
+    git2r_lfs_filter.stream = git2r_lfs_stream;
+
+    if (git_filter_register("lfs", &git2r_lfs_filter, GIT_FILTER_DRIVER_PRIORITY) < 0)
+        giterr_clear();
+}
+
+/**
+ * Unregister the 'lfs' filter
+ */
+void git2r_lfs_shutdown(void)
+{
+    git_filter_unregister("lfs");
+}
+
+static int git2r_lfs_buf_cb(const char *data, size_t len, void *payload)
+{
+    return git_buf_put((git_buf *)payload, data, len);
+}
+
+/**
+ * Get the content of a blob that is a pointer file
+ *
+ * @param out The content from the stores
+ * @param repo The repository of the blob
+ * @param blob The blob
+ * @return 0, GIT_ENOTFOUND if the blob isn't a pointer or the
+ * content is in neither store, or an error code
+ */
+int git2r_lfs_blob_content(git_buf *out, git_repository *repo, git_blob *blob)
+{
+    int error;
+    git2r_lfs_pointer pointer;
+
+    if (git_blob_rawsize(blob) > GIT2R_LFS_POINTER_MAX ||
+        git2r_lfs_pointer_parse(&pointer, git_blob_rawcontent(blob),
+                                (size_t)git_blob_rawsize(blob)))
+        return GIT_ENOTFOUND;
+
+    if (pointer.size >= INT_MAX) {
+        giterr_set(GITERR_INVALID, "content of '%s' is too large", pointer.oid);
+        return GIT_ERROR;
+    }
+
+    error = git2r_lfs_read(repo, &pointer, git2r_lfs_buf_cb, out);
+    if (error == GIT_ENOTFOUND)
+        giterr_clear();
+
+    return error;
+}
+
+/**
+ * An object to copy between the stores
+ */
+typedef struct {
+    git_buf from;
+    git_buf to;
+    git_buf tmp;
+    char oid[65];
+    git_off_t size;
+    int error;
+    char message[512];
+} git2r_lfs_job;
+
+/**
+ * The objects to copy
+ */
+typedef struct {
+    git2r_lfs_job *jobs;
+    size_t n;
+    size_t alloc;
+} git2r_lfs_queue;
+
+static void git2r_lfs_queue_free(git2r_lfs_queue *queue)
+{
+    size_t i;
+
+    for (i = 0; i < queue->n; i++) {
+        git_buf_free(&queue->jobs[i].from);
+        git_buf_free(&queue->jobs[i].to);
+        git_buf_free(&queue->jobs[i].tmp);
+    }
+    free(queue->jobs);
+}
+
+/**
+ * Queue a copy of an object from one store to the other, unless the
+ * destination has it already
+ */
+static int git2r_lfs_queue_add(
+    git2r_lfs_queue *queue,
+    const char *from_store,
+    const char *to_store,
+    const char *oid,
+    git_off_t size)
+{
+    int error;
+    git2r_lfs_job *job;
+
+    if (queue->n == queue->alloc) {
+        size_t alloc = queue->alloc ? 2 * queue->alloc : 16;
+        git2r_lfs_job *jobs = realloc(queue->jobs, alloc * sizeof(git2r_lfs_job));
+        if (!jobs) {
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            return GIT_ERROR;
+        }
+        queue->jobs = jobs;
+        queue->alloc = alloc;
+    }
+
+    job = &queue->jobs[queue->n];
+    memset(job, 0, sizeof(git2r_lfs_job));
+    git_buf_init(&job->from, 0);
+    git_buf_init(&job->to, 0);
+    git_buf_init(&job->tmp, 0);
+    memcpy(job->oid, oid, sizeof(job->oid));
+    job->size = size;
+
+    if ((error = git2r_lfs_object_path(&job->to, to_store, oid)) < 0 ||
+        git_path_isfile(job->to.ptr) ||
+        (error = git2r_lfs_object_path(&job->from, from_store, oid)) < 0 ||
+        (error = git_buf_printf(&job->tmp, "%s.%lu.tmp", job->to.ptr,
+                                (unsigned long)queue->n)) < 0 ||
+        (error = git2r_lfs_mkdir_parent(job->to.ptr)) < 0) {
+        git_buf_free(&job->from);
+        git_buf_free(&job->to);
+        git_buf_free(&job->tmp);
+        return error;
+    }
+
+    queue->n++;
+
+    return 0;
+}
+
+static void git2r_lfs_copy_cb(size_t i, void *payload)
+{
+    git2r_lfs_job *job = &((git2r_lfs_queue *)payload)->jobs[i];
+
+    job->error = git2r_lfs_copy(job->from.ptr, job->to.ptr, job->tmp.ptr,
+                                job->oid, job->size,
+                                job->message, sizeof(job->message));
+}
+
+/**
+ * Copy the queued objects with 'n_jobs' parallel workers
+ *
+ * @return 0 or the error of the first job that failed
+ */
+static int git2r_lfs_transfer(git2r_lfs_queue *queue, int n_jobs)
+{
+    size_t i;
+
+    git2r_parallel_for(queue->n, n_jobs, git2r_lfs_copy_cb, queue);
+
+    for (i = 0; i < queue->n; i++) {
+        if (queue->jobs[i].error) {
+            giterr_set_str(GITERR_OS, queue->jobs[i].message);
+            return GIT_ERROR;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * The ids of the copied objects
+ */
+static SEXP git2r_lfs_transferred(git2r_lfs_queue *queue)
+{
+    size_t i;
+    SEXP result;
+
+    PROTECT(result = Rf_allocVector(STRSXP, queue->n));
+    for (i = 0; i < queue->n; i++)
+        SET_STRING_ELT(result, i, Rf_mkChar(queue->jobs[i].oid));
+    UNPROTECT(1);
+
+    return result;
+}
+
+/**
+ * Data structure to hold information when listing the local store
+ */
+typedef struct {
+    git2r_lfs_queue *queue;
+    const char *from;
+    const char *to;
+} git2r_lfs_push_cb_data;
+
+static int git2r_lfs_push_object_cb(void *payload, git_buf *path)
+{
+    git2r_lfs_push_cb_data *data = payload;
+    const char *name = git_path_basename(path->ptr);
+    git2r_lfs_pointer pointer;
+    int error = 0;
+    size_t i;
+
+    if (name && strlen(name) == 64) {
+        for (i = 0; i < 64 && strchr("0123456789abcdef", name[i]); i++);
+        if (i == 64) {
+            memcpy(pointer.oid, name, 65);
+            error = git2r_lfs_queue_add(data->queue, data->from, data->to,
+                                        pointer.oid, -1);
+        }
+    }
+
+    git__free((char *)name);
+
+    return error;
+}
+
+static int git2r_lfs_push_dir_cb(void *payload, git_buf *path)
+{
+    if (!git_path_isdir(path->ptr))
+        return 0;
+    return git_path_direach(path, 0, git2r_lfs_push_object_cb, payload);
+}
+
+static int git2r_lfs_push_top_cb(void *payload, git_buf *path)
+{
+    if (!git_path_isdir(path->ptr))
+        return 0;
+    return git_path_direach(path, 0, git2r_lfs_push_dir_cb, payload);
+}
+
+/**
+ * Copy the objects in the local store that are missing in the
+ * mirror to the mirror
+ *
+ * @param repo S4 class git_repository
+ * @param jobs The number of objects to copy in parallel
+ * @return Character vector with the ids of the copied objects
+ */
+SEXP git2r_lfs_push(SEXP repo, SEXP jobs)
+{
+    int err;
+    SEXP result = R_NilValue;
+    git_buf storage = GIT_BUF_INIT, mirror = GIT_BUF_INIT, objects = GIT_BUF_INIT;
+    git_repository *repository = NULL;
+    git2r_lfs_queue queue;
+    git2r_lfs_push_cb_data data;
+
+    if (git2r_arg_check_integer(jobs))
+        git2r_error(__func__, NULL, "'jobs'", git2r_err_integer_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    memset(&queue, 0, sizeof(queue));
+
+    err = git2r_lfs_mirror(&mirror, repository);
+    if (err == GIT_ENOTFOUND) {
+        giterr_set_str(GITERR_INVALID, git2r_err_lfs_mirror);
+        err = GIT_ERROR;
+    }
+    if (err)
+        goto cleanup;
+
+    err = git2r_lfs_storage(&storage, repository);
+    if (err)
+        goto cleanup;
+
+    err = git_buf_joinpath(&objects, storage.ptr, "objects");
+    if (err)
+        goto cleanup;
+
+    if (git_path_isdir(objects.ptr)) {
+        data.queue = &queue;
+        data.from = storage.ptr;
+        data.to = mirror.ptr;
+        err = git_path_direach(&objects, 0, git2r_lfs_push_top_cb, &data);
+        if (err)
+            goto cleanup;
+    }
+
+    err = git2r_lfs_transfer(&queue, INTEGER(jobs)[0]);
+    if (err)
+        goto cleanup;
+
+    PROTECT(result = git2r_lfs_transferred(&queue));
+
+cleanup:
+    git2r_lfs_queue_free(&queue);
+    git_buf_free(&storage);
+    git_buf_free(&mirror);
+    git_buf_free(&objects);
+
+    if (repository)
+        git_repository_free(repository);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
+
+/**
+ * Replace files in the working tree that contain a pointer with the
+ * content, if it's in the local store now
+ */
+static int git2r_lfs_checkout_pointers(
+    git_repository *repository,
+    git_index *index,
+    const char *storage)
+{
+    int err = 0;
+    size_t i, n = git_index_entrycount(index);
+    git_buf path = GIT_BUF_INIT, object = GIT_BUF_INIT, content = GIT_BUF_INIT;
+    git_vector paths = GIT_VECTOR_INIT;
+    git_checkout_options opts = GIT_CHECKOUT_OPTIONS_INIT;
+    git2r_lfs_pointer pointer;
+
+    for (i = 0; i < n; i++) {
+        const git_index_entry *entry = git_index_get_byindex(index, i);
+
+        if (!S_ISREG(entry->mode) || entry->file_size > GIT2R_LFS_POINTER_MAX)
+            continue;
+
+        git_buf_clear(&content);
+        if ((err = git_buf_joinpath(&path, git_repository_workdir(repository),
+                                    entry->path)) < 0)
+            goto cleanup;
+        if (!git_path_isfile(path.ptr) ||
+            git_futils_readbuffer(&content, path.ptr) < 0) {
+            giterr_clear();
+            continue;
+        }
+
+        if (git2r_lfs_pointer_parse(&pointer, content.ptr, content.size))
+            continue;
+        if ((err = git2r_lfs_object_path(&object, storage, pointer.oid)) < 0)
+            goto cleanup;
+        if (!git_path_isfile(object.ptr))
+            continue;
+
+        if ((err = p_unlink(path.ptr)) < 0 ||
+            (err = git_vector_insert(&paths, (char *)entry->path)) < 0)
+            goto cleanup;
+    }
+
+    if (paths.length) {
+        opts.checkout_strategy = GIT_CHECKOUT_FORCE | GIT_CHECKOUT_DISABLE_PATHSPEC_MATCH;
+        opts.paths.strings = (char **)paths.contents;
+        opts.paths.count = paths.length;
+        err = git_checkout_index(repository, index, &opts);
+    }
+
+cleanup:
+    if (err < 0 && !giterr_last())
+        giterr_set(GITERR_OS, "failed to remove '%s'", path.ptr);
+    git_vector_free(&paths);
+    git_buf_free(&path);
+    git_buf_free(&object);
+    git_buf_free(&content);
+
+    return err;
+}
+
+/**
+ * Copy the objects of the pointers in the index that are missing in
+ * the local store from the mirror, and check them out
+ *
+ * @param repo S4 class git_repository
+ * @param jobs The number of objects to copy in parallel
+ * @return Character vector with the ids of the copied objects
+ */
+SEXP git2r_lfs_fetch(SEXP repo, SEXP jobs)
+{
+    int err;
+    size_t i, j, n;
+    SEXP result = R_NilValue;
+    git_buf storage = GIT_BUF_INIT, mirror = GIT_BUF_INIT;
+    git_repository *repository = NULL;
+    git_index *index = NULL;
+    git_odb *odb = NULL;
+    git2r_lfs_queue queue;
+
+    if (git2r_arg_check_integer(jobs))
+        git2r_error(__func__, NULL, "'jobs'", git2r_err_integer_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    memset(&queue, 0, sizeof(queue));
+
+    err = git2r_lfs_mirror(&mirror, repository);
+    if (err == GIT_ENOTFOUND) {
+        giterr_set_str(GITERR_INVALID, git2r_err_lfs_mirror);
+        err = GIT_ERROR;
+    }
+    if (err)
+        goto cleanup;
+
+    err = git2r_lfs_storage(&storage, repository);
+    if (err)
+        goto cleanup;
+
+    err = git_repository_index(&index, repository);
+    if (err)
+        goto cleanup;
+
+    err = git_repository_odb(&odb, repository);
+    if (err)
+        goto cleanup;
+
+    n = git_index_entrycount(index);
+    for (i = 0; i < n; i++) {
+        const git_index_entry *entry = git_index_get_byindex(index, i);
+        git2r_lfs_pointer pointer;
+        git_odb_object *obj = NULL;
+        size_t len;
+        git_otype type;
+
+        if (!S_ISREG(entry->mode))
+            continue;
+
+        err = git_odb_read_header(&len, &type, odb, &entry->id);
+        if (err)
+            goto cleanup;
+        if (len > GIT2R_LFS_POINTER_MAX)
+            continue;
+
+        err = git_odb_read(&obj, odb, &entry->id);
+        if (err)
+            goto cleanup;
+
+        if (!git2r_lfs_pointer_parse(&pointer, git_odb_object_data(obj), len)) {
+            /* The same content can be in many files */
+            for (j = 0; j < queue.n && strcmp(queue.jobs[j].oid, pointer.oid); j++);
+            if (j == queue.n)
+                err = git2r_lfs_queue_add(&queue, mirror.ptr, storage.ptr,
+                                          pointer.oid, pointer.size);
+        }
+
+        git_odb_object_free(obj);
+        if (err)
+            goto cleanup;
+    }
+
+    err = git2r_lfs_transfer(&queue, INTEGER(jobs)[0]);
+    if (err)
+        goto cleanup;
+
+    if (!git_repository_is_bare(repository)) {
+        err = git2r_lfs_checkout_pointers(repository, index, storage.ptr);
+        if (err)
+            goto cleanup;
+    }
+
+    PROTECT(result = git2r_lfs_transferred(&queue));
+
+cleanup:
+    git2r_lfs_queue_free(&queue);
+    git_buf_free(&storage);
+    git_buf_free(&mirror);
+
+    if (odb)
+        git_odb_free(odb);
+
+    if (index)
+        git_index_free(index);
+
+    if (repository)
+        git_repository_free(repository);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
@@ -0,0 +1,32 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INCLUDE_git2r_lfs_h
+#define INCLUDE_git2r_lfs_h
+
+#include <R.h>
+#include <Rinternals.h>
+#include <git2.h>
+
+void git2r_lfs_init(void);
+void git2r_lfs_shutdown(void);
+int git2r_lfs_blob_content(git_buf *out, git_repository *repo, git_blob *blob);
+SEXP git2r_lfs_fetch(SEXP repo, SEXP jobs);
+SEXP git2r_lfs_push(SEXP repo, SEXP jobs);
+
+#endif
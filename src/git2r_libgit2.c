@@ -16,7 +16,12 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "git2.h"
+#include "transports/pool.h"
+
 #include "git2r_arg.h"
 #include "git2r_error.h"
 #include "git2r_libgit2.h"
@@ -117,3 +122,131 @@ SEXP git2r_ssl_cert_locations(SEXP filename, SEXP path)
 
     return R_NilValue;
 }
+
+/**
+ * The mode set by git2r_fsync_mode
+ */
+static int git2r_fsync = 0;
+
+/**
+ * Set how files in the git directory are synced to permanent storage
+ *
+ * @param mode 0 to not sync the files, 1 to sync each file when it's
+ * written and 2 to sync the files in batches. R_NilValue to only
+ * return the mode.
+ * @return The previous mode
+ */
+SEXP git2r_fsync_mode(SEXP mode)
+{
+    int previous = git2r_fsync;
+
+    if (!Rf_isNull(mode)) {
+        if (git2r_arg_check_integer(mode))
+            git2r_error(__func__, NULL, "'mode'", git2r_err_integer_arg);
+
+        if (git_libgit2_opts(GIT_OPT_ENABLE_FSYNC_GITDIR,
+                             INTEGER(mode)[0] > 0) ||
+            git_libgit2_opts(GIT_OPT_ENABLE_FSYNC_BATCH,
+                             INTEGER(mode)[0] > 1))
+            git2r_error(__func__, giterr_last(), NULL, NULL);
+
+        git2r_fsync = INTEGER(mode)[0];
+    }
+
+    return Rf_ScalarInteger(previous);
+}
+
+/**
+ * The idle connections of the transport pool. The callback is called
+ * after the pool is unlocked, but the R objects are allocated after
+ * the iteration, so an R error can't skip its cleanup.
+ */
+typedef struct {
+    size_t n;
+    size_t size;
+    char **url;
+    int *idle;
+} git2r_transport_pool_cb_data;
+
+static int git2r_transport_pool_cb(const char *key, int idle, void *payload)
+{
+    git2r_transport_pool_cb_data *data = payload;
+
+    if (data->n == data->size) {
+        size_t size = data->size ? 2 * data->size : 16;
+        char **url;
+        int *seconds;
+
+        if (!(url = realloc(data->url, size * sizeof(char *))))
+            return -1;
+        data->url = url;
+        if (!(seconds = realloc(data->idle, size * sizeof(int))))
+            return -1;
+        data->idle = seconds;
+        data->size = size;
+    }
+
+    data->url[data->n] = strdup(key);
+    if (!data->url[data->n])
+        return -1;
+    data->idle[data->n++] = idle;
+
+    return 0;
+}
+
+/**
+ * Set the idle timeout of the transport pool and list the idle
+ * connections
+ *
+ * @param timeout The number of seconds to keep an idle connection,
+ * 0 to close the idle connections and not keep any. R_NilValue to
+ * only list the connections.
+ * @return list with the columns url and idle
+ */
+SEXP git2r_transport_pool(SEXP timeout)
+{
+    int err;
+    size_t i;
+    SEXP result = R_NilValue;
+    SEXP names = R_NilValue;
+    git2r_transport_pool_cb_data data = {0, 0, NULL, NULL};
+
+    if (!Rf_isNull(timeout)) {
+        if (git2r_arg_check_integer_gte_zero(timeout))
+            git2r_error(__func__, NULL, "'timeout'", git2r_err_integer_gte_zero_arg);
+
+        if (git_libgit2_opts(GIT_OPT_SET_TRANSPORT_POOL_TIMEOUT,
+                             INTEGER(timeout)[0]))
+            git2r_error(__func__, giterr_last(), NULL, NULL);
+    }
+
+    err = git_transport_pool_foreach(git2r_transport_pool_cb, &data);
+    if (err)
+        goto cleanup;
+
+    PROTECT(result = Rf_allocVector(VECSXP, 2));
+    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 2));
+    SET_VECTOR_ELT(result, 0, Rf_allocVector(STRSXP, data.n));
+    SET_STRING_ELT(names,  0, Rf_mkChar("url"));
+    SET_VECTOR_ELT(result, 1, Rf_allocVector(INTSXP, data.n));
+    SET_STRING_ELT(names,  1, Rf_mkChar("idle"));
+
+    for (i = 0; i < data.n; i++) {
+        SET_STRING_ELT(VECTOR_ELT(result, 0), i, Rf_mkChar(data.url[i]));
+        INTEGER(VECTOR_ELT(result, 1))[i] = data.idle[i];
+    }
+
+cleanup:
+    for (i = 0; i < data.n; i++)
+        free(data.url[i]);
+    free(data.url);
+    free(data.idle);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, NULL, git2r_err_alloc_memory_buffer, NULL);
+
+    return result;
+}
@@ -22,8 +22,10 @@
 #include <R.h>
 #include <Rinternals.h>
 
+SEXP git2r_fsync_mode(SEXP mode);
 SEXP git2r_libgit2_features(void);
 SEXP git2r_libgit2_version(void);
 SEXP git2r_ssl_cert_locations(SEXP filename, SEXP path);
+SEXP git2r_transport_pool(SEXP timeout);
 
 #endif
@@ -0,0 +1,639 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <Rdefines.h>
+#include <string.h>
+#include "git2.h"
+#include "array.h"
+#include "buffer.h"
+#include "path.h"
+#include "pool.h"
+
+#include "git2r_arg.h"
+#include "git2r_error.h"
+#include "git2r_log.h"
+#include "git2r_parallel.h"
+#include "git2r_repository.h"
+
+/**
+ * The number of commits that a worker takes at a time. The worker
+ * opens the repository once per batch.
+ */
+#define GIT2R_LOG_STATS_BATCH 64
+
+/**
+ * The change of one path in one commit
+ */
+typedef struct {
+    size_t commit;
+    const char *path;
+    int insertions; /* -1 for binary files */
+    int deletions;
+} git2r_log_stats_row;
+
+/**
+ * The changes of a batch of commits, filled by a worker
+ */
+typedef struct {
+    git_array_t(git2r_log_stats_row) rows;
+    git_pool paths;
+    int error;
+    char *message;
+} git2r_log_stats_batch;
+
+/**
+ * Data structure to hold the commits to work on
+ *
+ * Each worker opens the repository at 'path', since a repository
+ * can't be used from many threads at the same time.
+ */
+typedef struct {
+    const char *path;
+    const git_oid *commits;
+    size_t n;
+    char **pathspec;
+    size_t n_pathspec;
+    git2r_log_stats_batch *batches;
+    size_t n_batches;
+} git2r_log_stats_data;
+
+/**
+ * The state of a worker while it diffs the trees of one commit
+ */
+typedef struct {
+    git2r_log_stats_data *data;
+    git2r_log_stats_batch *batch;
+    git_repository *repository;
+    size_t commit;
+    git_buf path;
+    git_diff_options opts;
+} git2r_log_stats_walk;
+
+enum {
+    git2r_log_stats_match__none,
+    git2r_log_stats_match__descend,
+    git2r_log_stats_match__all};
+
+/**
+ * Match the path of a tree entry against the pathspec
+ *
+ * A pathspec is a file or a directory. Everything below a directory
+ * matches.
+ *
+ * @param data The data with the pathspec.
+ * @param path The path of the entry.
+ * @param is_tree 1 if the entry is a tree, else 0.
+ * @return 'all' if the entry, and everything below it, matches;
+ * 'descend' if the entry is a tree with a pathspec below it, else
+ * 'none'.
+ */
+static int git2r_log_stats_match(
+    git2r_log_stats_data *data,
+    const char *path,
+    int is_tree)
+{
+    size_t i, len = strlen(path);
+    int match = git2r_log_stats_match__none;
+
+    if (!data->n_pathspec)
+        return git2r_log_stats_match__all;
+
+    for (i = 0; i < data->n_pathspec; i++) {
+        const char *spec = data->pathspec[i];
+        size_t spec_len = strlen(spec);
+
+        if (len >= spec_len && !strncmp(path, spec, spec_len) &&
+            (path[spec_len] == '\0' || path[spec_len] == '/'))
+            return git2r_log_stats_match__all;
+
+        if (is_tree && spec_len > len && !strncmp(path, spec, len) &&
+            spec[len] == '/')
+            match = git2r_log_stats_match__descend;
+    }
+
+    return match;
+}
+
+/**
+ * Count the lines added and deleted in a changed file
+ *
+ * @param walk The state of the worker, with the path of the file.
+ * @param old_entry The entry before the change, or NULL if the file
+ * is added.
+ * @param new_entry The entry after the change, or NULL if the file
+ * is deleted.
+ * @return 0 or an error code
+ */
+static int git2r_log_stats_file(
+    git2r_log_stats_walk *walk,
+    const git_tree_entry *old_entry,
+    const git_tree_entry *new_entry)
+{
+    int err = 0;
+    git2r_log_stats_row *row;
+    git_blob *old_blob = NULL, *new_blob = NULL;
+    git_patch *patch = NULL;
+    size_t insertions = 0, deletions = 0;
+
+    row = git_array_alloc(walk->batch->rows);
+    if (!row) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+    row->commit = walk->commit;
+    row->path = git_pool_strndup(&walk->batch->paths,
+                                 walk->path.ptr, walk->path.size);
+    if (!row->path) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+
+    /* A submodule is one line with its commit, like in 'git diff' */
+    if ((old_entry && git_tree_entry_type(old_entry) != GIT_OBJ_BLOB) ||
+        (new_entry && git_tree_entry_type(new_entry) != GIT_OBJ_BLOB)) {
+        if (old_entry && new_entry &&
+            git_tree_entry_type(old_entry) != git_tree_entry_type(new_entry)) {
+            row->insertions = row->deletions = -1;
+        } else {
+            row->insertions = new_entry ? 1 : 0;
+            row->deletions = old_entry ? 1 : 0;
+        }
+        return 0;
+    }
+
+    /* Only the mode changed */
+    if (old_entry && new_entry &&
+        git_oid_equal(git_tree_entry_id(old_entry), git_tree_entry_id(new_entry))) {
+        row->insertions = row->deletions = 0;
+        return 0;
+    }
+
+    if (old_entry)
+        err = git_blob_lookup(&old_blob, walk->repository, git_tree_entry_id(old_entry));
+    if (!err && new_entry)
+        err = git_blob_lookup(&new_blob, walk->repository, git_tree_entry_id(new_entry));
+    if (!err)
+        err = git_patch_from_blobs(&patch, old_blob, walk->path.ptr,
+                                   new_blob, walk->path.ptr, &walk->opts);
+    if (!err)
+        err = git_patch_line_stats(NULL, &insertions, &deletions, patch);
+
+    if (!err) {
+        if (git_patch_get_delta(patch)->flags & GIT_DIFF_FLAG_BINARY) {
+            row->insertions = row->deletions = -1;
+        } else {
+            row->insertions = (int)insertions;
+            row->deletions = (int)deletions;
+        }
+    }
+
+    git_patch_free(patch);
+    git_blob_free(old_blob);
+    git_blob_free(new_blob);
+
+    return err;
+}
+
+static int git2r_log_stats_tree(
+    git2r_log_stats_walk *walk,
+    const git_tree *old_tree,
+    const git_tree *new_tree,
+    int match);
+
+/**
+ * Diff one entry that is not the same in both trees
+ *
+ * @param walk The state of the worker, with the path of the parent
+ * tree.
+ * @param old_entry The entry in the old tree, or NULL.
+ * @param new_entry The entry in the new tree, or NULL.
+ * @param match The match of the parent tree against the pathspec.
+ * @return 0 or an error code
+ */
+static int git2r_log_stats_entry(
+    git2r_log_stats_walk *walk,
+    const git_tree_entry *old_entry,
+    const git_tree_entry *new_entry,
+    int match)
+{
+    int err;
+    size_t len = walk->path.size;
+    const git_tree_entry *entry = new_entry ? new_entry : old_entry;
+    int is_tree = git_tree_entry_type(entry) == GIT_OBJ_TREE;
+    git_tree *old_tree = NULL, *new_tree = NULL;
+
+    err = git_buf_puts(&walk->path, git_tree_entry_name(entry));
+    if (err)
+        return err;
+
+    if (match != git2r_log_stats_match__all)
+        match = git2r_log_stats_match(walk->data, walk->path.ptr, is_tree);
+    if (match == git2r_log_stats_match__none)
+        goto cleanup;
+
+    if (!is_tree) {
+        err = git2r_log_stats_file(walk, old_entry, new_entry);
+        goto cleanup;
+    }
+
+    if (old_entry)
+        err = git_tree_lookup(&old_tree, walk->repository, git_tree_entry_id(old_entry));
+    if (!err && new_entry)
+        err = git_tree_lookup(&new_tree, walk->repository, git_tree_entry_id(new_entry));
+    if (!err)
+        err = git_buf_putc(&walk->path, '/');
+    if (!err)
+        err = git2r_log_stats_tree(walk, old_tree, new_tree, match);
+
+cleanup:
+    git_tree_free(old_tree);
+    git_tree_free(new_tree);
+    git_buf_truncate(&walk->path, len);
+
+    return err;
+}
+
+/**
+ * Diff two trees
+ *
+ * The entries of the trees are sorted, so they are matched in one
+ * pass. Entries with the same id are skipped without reading them,
+ * so only the subtrees that changed are read.
+ *
+ * @param walk The state of the worker, with the path of the trees.
+ * @param old_tree The old tree, or NULL for an empty tree.
+ * @param new_tree The new tree, or NULL for an empty tree.
+ * @param match The match of the trees against the pathspec.
+ * @return 0 or an error code
+ */
+static int git2r_log_stats_tree(
+    git2r_log_stats_walk *walk,
+    const git_tree *old_tree,
+    const git_tree *new_tree,
+    int match)
+{
+    int err = 0;
+    size_t i = 0, j = 0;
+    size_t n_old = old_tree ? git_tree_entrycount(old_tree) : 0;
+    size_t n_new = new_tree ? git_tree_entrycount(new_tree) : 0;
+
+    while (!err && (i < n_old || j < n_new)) {
+        const git_tree_entry *old_entry = NULL, *new_entry = NULL;
+        int cmp;
+
+        if (i < n_old)
+            old_entry = git_tree_entry_byindex(old_tree, i);
+        if (j < n_new)
+            new_entry = git_tree_entry_byindex(new_tree, j);
+
+        if (old_entry && new_entry) {
+            const char *old_name = git_tree_entry_name(old_entry);
+            const char *new_name = git_tree_entry_name(new_entry);
+
+            cmp = git_path_cmp(
+                old_name, strlen(old_name),
+                git_tree_entry_type(old_entry) == GIT_OBJ_TREE,
+                new_name, strlen(new_name),
+                git_tree_entry_type(new_entry) == GIT_OBJ_TREE,
+                strncmp);
+        } else {
+            cmp = old_entry ? -1 : 1;
+        }
+
+        if (cmp < 0) {
+            err = git2r_log_stats_entry(walk, old_entry, NULL, match);
+            i++;
+        } else if (cmp > 0) {
+            err = git2r_log_stats_entry(walk, NULL, new_entry, match);
+            j++;
+        } else {
+            if (!git_oid_equal(git_tree_entry_id(old_entry), git_tree_entry_id(new_entry)) ||
+                git_tree_entry_filemode(old_entry) != git_tree_entry_filemode(new_entry))
+                err = git2r_log_stats_entry(walk, old_entry, new_entry, match);
+            i++;
+            j++;
+        }
+    }
+
+    return err;
+}
+
+/**
+ * Diff one commit against its first parent
+ */
+static int git2r_log_stats_commit(git2r_log_stats_walk *walk)
+{
+    int err;
+    git_commit *commit = NULL, *parent = NULL;
+    git_tree *tree = NULL, *parent_tree = NULL;
+
+    err = git_commit_lookup(&commit, walk->repository, &walk->data->commits[walk->commit]);
+    if (err)
+        goto cleanup;
+
+    /* Compare the ids before the trees are read */
+    if (git_commit_parentcount(commit)) {
+        err = git_commit_parent(&parent, commit, 0);
+        if (err)
+            goto cleanup;
+        if (git_oid_equal(git_commit_tree_id(parent), git_commit_tree_id(commit)))
+            goto cleanup;
+        err = git_commit_tree(&parent_tree, parent);
+        if (err)
+            goto cleanup;
+    }
+
+    err = git_commit_tree(&tree, commit);
+    if (err)
+        goto cleanup;
+
+    git_buf_clear(&walk->path);
+    err = git2r_log_stats_tree(walk, parent_tree, tree,
+                               git2r_log_stats_match__descend);
+
+cleanup:
+    git_tree_free(parent_tree);
+    git_tree_free(tree);
+    git_commit_free(parent);
+    git_commit_free(commit);
+
+    return err;
+}
+
+/**
+ * Diff one batch of commits, called from a worker
+ */
+static void git2r_log_stats_cb(size_t i, void *payload)
+{
+    int err;
+    git2r_log_stats_data *data = payload;
+    git2r_log_stats_batch *batch = &data->batches[i];
+    git2r_log_stats_walk walk;
+    size_t end = (i + 1) * GIT2R_LOG_STATS_BATCH;
+
+    memset(&walk, 0, sizeof(walk));
+    walk.data = data;
+    walk.batch = batch;
+    git_buf_init(&walk.path, 0);
+
+    /* Only the counts of lines are used */
+    err = git_diff_init_options(&walk.opts, GIT_DIFF_OPTIONS_VERSION);
+    if (err)
+        goto cleanup;
+    walk.opts.context_lines = 0;
+    walk.opts.interhunk_lines = 0;
+
+    err = git_repository_open(&walk.repository, data->path);
+    if (err)
+        goto cleanup;
+
+    if (end > data->n)
+        end = data->n;
+    for (walk.commit = i * GIT2R_LOG_STATS_BATCH; walk.commit < end; walk.commit++) {
+        err = git2r_log_stats_commit(&walk);
+        if (err)
+            break;
+    }
+
+cleanup:
+    if (err) {
+        const git_error *e = giterr_last();
+
+        batch->error = err;
+        batch->message = strdup(e && e->message ? e->message : "unknown error");
+    }
+
+    git_buf_free(&walk.path);
+    git_repository_free(walk.repository);
+}
+
+/**
+ * Check the batches after the workers are done
+ *
+ * @return 0 or the error of the first batch that failed
+ */
+static int git2r_log_stats_check_batches(git2r_log_stats_data *data)
+{
+    size_t i;
+
+    for (i = 0; i < data->n_batches; i++) {
+        if (data->batches[i].error) {
+            giterr_set_str(GITERR_NONE, data->batches[i].message);
+            return data->batches[i].error;
+        }
+    }
+
+    return 0;
+}
+
+static void git2r_log_stats_data_free(git2r_log_stats_data *data)
+{
+    size_t i;
+
+    for (i = 0; i < data->n_batches; i++) {
+        git_array_clear(data->batches[i].rows);
+        git_pool_clear(&data->batches[i].paths);
+        free(data->batches[i].message);
+    }
+    free(data->batches);
+
+    for (i = 0; i < data->n_pathspec; i++)
+        free(data->pathspec[i]);
+    free(data->pathspec);
+}
+
+/**
+ * Count the lines added and deleted in each file changed by a
+ * commit
+ *
+ * Each commit is diffed against its first parent, and a root commit
+ * against an empty tree. The commits are diffed in batches by
+ * parallel workers.
+ *
+ * @param repo S4 class git_repository
+ * @param range NULL or a range 'from..to' of commits, else the
+ * commits reachable from HEAD.
+ * @param path NULL or a character vector with the files and
+ * directories to count the changes of.
+ * @param jobs The number of workers.
+ * @return list with the columns 'sha', 'path', 'insertions' and
+ * 'deletions', with one row for each file changed by a commit.
+ */
+SEXP git2r_log_stats(SEXP repo, SEXP range, SEXP path, SEXP jobs)
+{
+    int err = GIT_OK;
+    SEXP result = R_NilValue;
+    SEXP names, sha = R_NilValue;
+    size_t i, j, k, n_rows = 0;
+    git_revwalk *walker = NULL;
+    git_repository *repository = NULL;
+    git_array_t(git_oid) oids = GIT_ARRAY_INIT;
+    git2r_log_stats_data data;
+    git_oid oid;
+
+    if (!Rf_isNull(range) && git2r_arg_check_string(range))
+        git2r_error(__func__, NULL, "'range'", git2r_err_string_arg);
+    if (!Rf_isNull(path) && git2r_arg_check_string_vec(path))
+        git2r_error(__func__, NULL, "'path'", git2r_err_string_vec_arg);
+    if (git2r_arg_check_integer(jobs))
+        git2r_error(__func__, NULL, "'jobs'", git2r_err_integer_arg);
+
+    memset(&data, 0, sizeof(data));
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    if (!git_repository_is_empty(repository)) {
+        err = git_revwalk_new(&walker, repository);
+        if (err)
+            goto cleanup;
+        git_revwalk_sorting(walker, GIT_SORT_TOPOLOGICAL | GIT_SORT_TIME);
+
+        if (!Rf_isNull(range))
+            err = git_revwalk_push_range(walker, CHAR(STRING_ELT(range, 0)));
+        else
+            err = git_revwalk_push_head(walker);
+        if (err)
+            goto cleanup;
+
+        while (!(err = git_revwalk_next(&oid, walker))) {
+            git_oid *item = git_array_alloc(oids);
+            if (!item) {
+                giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+                err = GIT_ERROR;
+                goto cleanup;
+            }
+            git_oid_cpy(item, &oid);
+        }
+        if (GIT_ITEROVER != err)
+            goto cleanup;
+        err = GIT_OK;
+    }
+
+    /* The workers don't use the R API, so copy the pathspec. A
+     * trailing '/' of a directory is removed. */
+    if (!Rf_isNull(path)) {
+        size_t n = Rf_length(path);
+
+        data.pathspec = calloc(n ? n : 1, sizeof(char *));
+        if (!data.pathspec) {
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            err = GIT_ERROR;
+            goto cleanup;
+        }
+
+        for (i = 0; i < n; i++) {
+            char *spec;
+            size_t len;
+
+            if (NA_STRING == STRING_ELT(path, i))
+                continue;
+            spec = strdup(CHAR(STRING_ELT(path, i)));
+            if (!spec) {
+                giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+                err = GIT_ERROR;
+                goto cleanup;
+            }
+            for (len = strlen(spec); len > 0 && spec[len - 1] == '/'; len--)
+                spec[len - 1] = '\0';
+            data.pathspec[data.n_pathspec++] = spec;
+        }
+    }
+
+    data.path = git_repository_path(repository);
+    data.commits = oids.ptr;
+    data.n = git_array_size(oids);
+    data.n_batches = (data.n + GIT2R_LOG_STATS_BATCH - 1) / GIT2R_LOG_STATS_BATCH;
+    if (data.n_batches) {
+        data.batches = calloc(data.n_batches, sizeof(git2r_log_stats_batch));
+        if (!data.batches) {
+            data.n_batches = 0;
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            err = GIT_ERROR;
+            goto cleanup;
+        }
+        for (i = 0; i < data.n_batches; i++)
+            git_pool_init(&data.batches[i].paths, 1);
+    }
+
+    /* The path filter matches nothing if it is empty or only holds
+     * NA */
+    if (Rf_isNull(path) || data.n_pathspec) {
+        git2r_parallel_for(data.n_batches, INTEGER(jobs)[0], git2r_log_stats_cb, &data);
+        err = git2r_log_stats_check_batches(&data);
+        if (err)
+            goto cleanup;
+    }
+
+    for (i = 0; i < data.n_batches; i++)
+        n_rows += git_array_size(data.batches[i].rows);
+
+    PROTECT(result = Rf_allocVector(VECSXP, 4));
+    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 4));
+    SET_VECTOR_ELT(result, 0, Rf_allocVector(STRSXP, n_rows));
+    SET_STRING_ELT(names,  0, Rf_mkChar("sha"));
+    SET_VECTOR_ELT(result, 1, Rf_allocVector(STRSXP, n_rows));
+    SET_STRING_ELT(names,  1, Rf_mkChar("path"));
+    SET_VECTOR_ELT(result, 2, Rf_allocVector(INTSXP, n_rows));
+    SET_STRING_ELT(names,  2, Rf_mkChar("insertions"));
+    SET_VECTOR_ELT(result, 3, Rf_allocVector(INTSXP, n_rows));
+    SET_STRING_ELT(names,  3, Rf_mkChar("deletions"));
+
+    for (i = 0, k = 0; i < data.n_batches; i++) {
+        size_t commit = data.n;
+
+        for (j = 0; j < git_array_size(data.batches[i].rows); j++, k++) {
+            git2r_log_stats_row *row = git_array_get(data.batches[i].rows, j);
+
+            /* The rows of a commit share the sha */
+            if (row->commit != commit) {
+                char hex[GIT_OID_HEXSZ + 1];
+
+                commit = row->commit;
+                git_oid_tostr(hex, sizeof(hex), &data.commits[commit]);
+                sha = Rf_mkChar(hex);
+            }
+
+            SET_STRING_ELT(VECTOR_ELT(result, 0), k, sha);
+            SET_STRING_ELT(VECTOR_ELT(result, 1), k, Rf_mkChar(row->path));
+            INTEGER(VECTOR_ELT(result, 2))[k] =
+                row->insertions < 0 ? NA_INTEGER : row->insertions;
+            INTEGER(VECTOR_ELT(result, 3))[k] =
+                row->deletions < 0 ? NA_INTEGER : row->deletions;
+        }
+    }
+
+cleanup:
+    git2r_log_stats_data_free(&data);
+    git_array_clear(oids);
+
+    if (walker)
+        git_revwalk_free(walker);
+
+    if (repository)
+        git_repository_free(repository);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
@@ -59,8 +59,8 @@ SEXP git2r_merge_base(SEXP one, SEXP two)
     if (git2r_arg_check_commit(two))
         git2r_error(__func__, NULL, "'two'", git2r_err_commit_arg);
 
-    repo_one = GET_SLOT(one, Rf_install("repo"));
-    repo_two = GET_SLOT(two, Rf_install("repo"));
+    repo_one = GET_SLOT(one, git2r_sym(repo));
+    repo_two = GET_SLOT(two, git2r_sym(repo));
     if (git2r_arg_check_same_repo(repo_one, repo_two))
         git2r_error(__func__, NULL, "'one' and 'two' not from same repository", NULL);
 
@@ -68,12 +68,12 @@ SEXP git2r_merge_base(SEXP one, SEXP two)
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    sha = GET_SLOT(one, Rf_install("sha"));
+    sha = GET_SLOT(one, git2r_sym(sha));
     err = git_oid_fromstr(&oid_one, CHAR(STRING_ELT(sha, 0)));
     if (err)
         goto cleanup;
 
-    sha = GET_SLOT(two, Rf_install("sha"));
+    sha = GET_SLOT(two, git2r_sym(sha));
     err = git_oid_fromstr(&oid_two, CHAR(STRING_ELT(sha, 0)));
     if (err)
         goto cleanup;
@@ -89,7 +89,7 @@ SEXP git2r_merge_base(SEXP one, SEXP two)
     if (err)
         goto cleanup;
 
-    PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_commit")));
+    PROTECT(result = git2r_S4_new(git2r_S4_class__git_commit));
     git2r_commit_init(commit, repo_one, result);
 
 cleanup:
@@ -489,12 +489,12 @@ SEXP git2r_merge_branch(SEXP branch, SEXP merger, SEXP commit_on_success)
     if (err)
         goto cleanup;
 
-    repository = git2r_repository_open(GET_SLOT(branch, Rf_install("repo")));
+    repository = git2r_repository_open(GET_SLOT(branch, git2r_sym(repo)));
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    name = CHAR(STRING_ELT(GET_SLOT(branch, Rf_install("name")), 0));
-    type = INTEGER(GET_SLOT(branch, Rf_install("type")))[0];
+    name = CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0));
+    type = INTEGER(GET_SLOT(branch, git2r_sym(type)))[0];
     err = git_branch_lookup(&reference, repository, name, type);
     if (err)
         goto cleanup;
@@ -516,10 +516,9 @@ SEXP git2r_merge_branch(SEXP branch, SEXP merger, SEXP commit_on_success)
     if (err)
         goto cleanup;
 
-    PROTECT(result = Rf_mkNamed(VECSXP, git2r_S3_items__git_merge_result));
+    PROTECT(result = git2r_S3_new(git2r_S3_class__git_merge_result,
+                                  git2r_S3_items__git_merge_result));
     nprotect++;
-    Rf_setAttrib(result, R_ClassSymbol,
-                 Rf_mkString(git2r_S3_class__git_merge_result));
     err = git2r_merge(
         result,
         repository,
@@ -586,15 +585,15 @@ static int git2r_merge_heads_from_fetch_heads(
 
         err = git_oid_fromstr(
             &oid,
-            CHAR(STRING_ELT(GET_SLOT(fh, Rf_install("sha")), 0)));
+            CHAR(STRING_ELT(GET_SLOT(fh, git2r_sym(sha)), 0)));
         if (err)
             goto cleanup;
 
         err = git_annotated_commit_from_fetchhead(
             &((*merge_heads)[i]),
             repository,
-            CHAR(STRING_ELT(GET_SLOT(fh, Rf_install("ref_name")), 0)),
-            CHAR(STRING_ELT(GET_SLOT(fh, Rf_install("remote_url")), 0)),
+            CHAR(STRING_ELT(GET_SLOT(fh, git2r_sym(ref_name)), 0)),
+            CHAR(STRING_ELT(GET_SLOT(fh, git2r_sym(remote_url)), 0)),
             &oid);
         if (err)
             goto cleanup;
@@ -638,7 +637,7 @@ SEXP git2r_merge_fetch_heads(SEXP fetch_heads, SEXP merger)
 
     n = LENGTH(fetch_heads);
     if (n) {
-        SEXP repo = GET_SLOT(VECTOR_ELT(fetch_heads, 0), Rf_install("repo"));
+        SEXP repo = GET_SLOT(VECTOR_ELT(fetch_heads, 0), git2r_sym(repo));
         repository = git2r_repository_open(repo);
         if (!repository)
             git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
@@ -652,10 +651,9 @@ SEXP git2r_merge_fetch_heads(SEXP fetch_heads, SEXP merger)
     if (err)
         goto cleanup;
 
-    PROTECT(result = Rf_mkNamed(VECSXP, git2r_S3_items__git_merge_result));
+    PROTECT(result = git2r_S3_new(git2r_S3_class__git_merge_result,
+                                  git2r_S3_items__git_merge_result));
     nprotect++;
-    Rf_setAttrib(result, R_ClassSymbol,
-                 Rf_mkString(git2r_S3_class__git_merge_result));
     err = git2r_merge(
         result,
         repository,
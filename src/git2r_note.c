@@ -23,6 +23,7 @@
 #include "git2r_arg.h"
 #include "git2r_error.h"
 #include "git2r_note.h"
+#include "git2r_objects.h"
 #include "git2r_repository.h"
 #include "git2r_signature.h"
 
@@ -59,11 +60,11 @@ static int git2r_note_init(
     int err;
     git_note *note = NULL;
     char sha[GIT_OID_HEXSZ + 1];
-    SEXP s_sha = Rf_install("sha");
-    SEXP s_annotated = Rf_install("annotated");
-    SEXP s_message = Rf_install("message");
-    SEXP s_refname = Rf_install("refname");
-    SEXP s_repo = Rf_install("repo");
+    SEXP s_sha = git2r_sym(sha);
+    SEXP s_annotated = git2r_sym(annotated);
+    SEXP s_message = git2r_sym(message);
+    SEXP s_refname = git2r_sym(refname);
+    SEXP s_repo = git2r_sym(repo);
 
     err = git_note_read(&note, repository, notes_ref, annotated_object_id);
     if (err)
@@ -160,7 +161,7 @@ SEXP git2r_note_create(
     if (err)
         goto cleanup;
 
-    PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_note")));
+    PROTECT(result = git2r_S4_new(git2r_S4_class__git_note));
     err = git2r_note_init(&note_oid,
                           &object_oid,
                           repository,
@@ -251,7 +252,7 @@ static int git2r_note_foreach_cb(
         SET_VECTOR_ELT(
             cb_data->list,
             cb_data->n,
-            note = NEW_OBJECT(MAKE_CLASS("git_note")));
+            note = git2r_S4_new(git2r_S4_class__git_note));
 
         err = git2r_note_init(
             blob_id,
@@ -365,7 +366,7 @@ SEXP git2r_note_remove(SEXP note, SEXP author, SEXP committer)
     if (git2r_arg_check_signature(committer))
         git2r_error(__func__, NULL, "'committer'", git2r_err_signature_arg);
 
-    repo = GET_SLOT(note, Rf_install("repo"));
+    repo = GET_SLOT(note, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
@@ -378,14 +379,14 @@ SEXP git2r_note_remove(SEXP note, SEXP author, SEXP committer)
     if (err)
         goto cleanup;
 
-    annotated = GET_SLOT(note, Rf_install("annotated"));
+    annotated = GET_SLOT(note, git2r_sym(annotated));
     err = git_oid_fromstr(&note_oid, CHAR(STRING_ELT(annotated, 0)));
     if (err)
         goto cleanup;
 
     err = git_note_remove(
         repository,
-        CHAR(STRING_ELT(GET_SLOT(note, Rf_install("refname")), 0)),
+        CHAR(STRING_ELT(GET_SLOT(note, git2r_sym(refname)), 0)),
         sig_author,
         sig_committer,
         &note_oid);
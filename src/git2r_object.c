@@ -66,24 +66,23 @@ SEXP git2r_object_lookup(SEXP repo, SEXP sha)
 
     switch (git_object_type(object)) {
     case GIT_OBJ_COMMIT:
-        PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_commit")));
+        PROTECT(result = git2r_S4_new(git2r_S4_class__git_commit));
         nprotect++;
         git2r_commit_init((git_commit*)object, repo, result);
         break;
     case GIT_OBJ_TREE:
-        PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_tree")));
+        PROTECT(result = git2r_S4_new(git2r_S4_class__git_tree));
         nprotect++;
         git2r_tree_init((git_tree*)object, repo, result);
         break;
     case GIT_OBJ_BLOB:
-        PROTECT(result = Rf_mkNamed(VECSXP, git2r_S3_items__git_blob));
+        PROTECT(result = git2r_S3_new(git2r_S3_class__git_blob,
+                                      git2r_S3_items__git_blob));
         nprotect++;
-        Rf_setAttrib(result, R_ClassSymbol,
-                     Rf_mkString(git2r_S3_class__git_blob));
         git2r_blob_init((git_blob*)object, repo, result);
         break;
     case GIT_OBJ_TAG:
-        PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_tag")));
+        PROTECT(result = git2r_S4_new(git2r_S4_class__git_tag));
         nprotect++;
         git2r_tag_init((git_tag*)object, repo, result);
         break;
@@ -18,7 +18,10 @@
 
 #include <string.h>
 
+#include <Rdefines.h>
+
 #include "git2r_objects.h"
+#include "git2r_stats.h"
 
 const char *git2r_S3_class__git_blob = "git_blob";
 const char *git2r_S3_items__git_blob[] = {
@@ -28,12 +31,172 @@ const char *git2r_S3_class__git_merge_result = "git_merge_result";
 const char *git2r_S3_items__git_merge_result[] = {
     "up_to_date", "fast_forward", "conflicts", "sha", ""};
 
+const char *git2r_S3_class__git_push_stats = "git_push_stats";
+const char *git2r_S3_items__git_push_stats[] = {
+    "commits", "objects", "bases", "deltas", "thin_deltas", ""};
+
 const char *git2r_S3_class__git_transfer_progress = "git_transfer_progress";
 const char *git2r_S3_items__git_transfer_progress[] = {
     "total_objects", "indexed_objects", "received_objects",
     "local_objects", "total_deltas", "indexed_deltas",
     "received_bytes", ""};
 
+SEXP git2r_symbols[git2r_symbol__count];
+static const char *git2r_symbol_names[] = {
+    "annotated", "author", "boundary", "committer", "content", "dropped",
+    "email", "filemode", "files", "final_commit_id", "final_signature",
+    "final_start_line_number", "header", "hunks", "id", "index",
+    "is_merge", "lines", "lines_in_hunk", "message", "name", "new",
+    "new_file", "new_lineno", "new_lines", "new_start", "num_lines",
+    "offset", "old", "old_file", "old_lineno", "old_lines", "old_start",
+    "orig_commit_id", "orig_path", "orig_signature",
+    "orig_start_line_number", "origin", "path", "ref_name", "refname",
+    "remote_url", "repo", "sha", "shorthand", "summary", "tagger",
+    "target", "time", "type", "when", ""};
+
+const char *git2r_S4_classes[] = {
+    "git_blame", "git_blame_hunk", "git_branch", "git_commit",
+    "git_diff", "git_diff_file", "git_diff_hunk", "git_diff_line",
+    "git_fetch_head", "git_note", "git_reference", "git_reflog_entry",
+    "git_signature", "git_stash", "git_tag", "git_tree", ""};
+
+/* Prototype object of each S4 class, see git2r_S4_new */
+static SEXP git2r_S4_prototypes[git2r_S4_class__count];
+
+/* Names and class attribute of each S3 class, see git2r_S3_new */
+#define GIT2R_S3_CLASSES 8
+static struct {
+    const char **items;
+    SEXP names;
+    SEXP klass;
+} git2r_S3_cache[GIT2R_S3_CLASSES];
+
+#ifndef MARK_NOT_MUTABLE
+# define MARK_NOT_MUTABLE(x) SET_NAMED(x, 2)
+#endif
+
+/**
+ * Install the symbols in git2r_symbols. Called from R_init_git2r.
+ *
+ * @return void
+ */
+void git2r_objects_init(void)
+{
+    int i;
+
+    for (i = 0; i < git2r_symbol__count; i++)
+        git2r_symbols[i] = Rf_install(git2r_symbol_names[i]);
+}
+
+/**
+ * Release the cached prototypes and attributes. Called from
+ * R_unload_git2r.
+ *
+ * @return void
+ */
+void git2r_objects_release(void)
+{
+    int i;
+
+    for (i = 0; i < git2r_S4_class__count; i++) {
+        if (git2r_S4_prototypes[i]) {
+            R_ReleaseObject(git2r_S4_prototypes[i]);
+            git2r_S4_prototypes[i] = NULL;
+        }
+    }
+
+    for (i = 0; i < GIT2R_S3_CLASSES; i++) {
+        if (git2r_S3_cache[i].items) {
+            R_ReleaseObject(git2r_S3_cache[i].names);
+            R_ReleaseObject(git2r_S3_cache[i].klass);
+            git2r_S3_cache[i].items = NULL;
+        }
+    }
+}
+
+/**
+ * Create a new S4 object.
+ *
+ * The class definition is looked up and a prototype object created
+ * the first time a class is used. The object is then a copy of the
+ * prototype, which avoids the class lookup for each object.
+ *
+ * @param klass The class, one of the git2r_S4_class__ values.
+ * @return A new S4 object of the class.
+ */
+SEXP git2r_S4_new(int klass)
+{
+    SEXP prototype = git2r_S4_prototypes[klass];
+
+    git2r_stats_r_object();
+
+    if (!prototype) {
+        PROTECT(prototype = NEW_OBJECT(MAKE_CLASS(git2r_S4_classes[klass])));
+        R_PreserveObject(prototype);
+        git2r_S4_prototypes[klass] = prototype;
+        UNPROTECT(1);
+    }
+
+    return Rf_duplicate(prototype);
+}
+
+/**
+ * Create a new S3 object, a named list with a class attribute.
+ *
+ * The names and the class attribute are created the first time and
+ * then shared between all objects of the class.
+ *
+ * @param klass The class name, e.g. git2r_S3_class__git_blob
+ * @param items The item names, e.g. git2r_S3_items__git_blob
+ * @return A new list with the items set to NULL.
+ */
+SEXP git2r_S3_new(const char *klass, const char **items)
+{
+    int i, n = 0;
+    SEXP result;
+
+    git2r_stats_r_object();
+
+    for (i = 0; i < GIT2R_S3_CLASSES; i++) {
+        if (!git2r_S3_cache[i].items || git2r_S3_cache[i].items == items)
+            break;
+    }
+
+    if (i == GIT2R_S3_CLASSES) {
+        /* The cache is full, create the attributes. */
+        PROTECT(result = Rf_mkNamed(VECSXP, items));
+        Rf_setAttrib(result, R_ClassSymbol, Rf_mkString(klass));
+        UNPROTECT(1);
+        return result;
+    }
+
+    if (!git2r_S3_cache[i].items) {
+        SEXP names, class_attr;
+
+        while (items[n][0])
+            n++;
+        PROTECT(names = Rf_allocVector(STRSXP, n));
+        for (n = 0; items[n][0]; n++)
+            SET_STRING_ELT(names, n, Rf_mkChar(items[n]));
+        PROTECT(class_attr = Rf_mkString(klass));
+        MARK_NOT_MUTABLE(names);
+        MARK_NOT_MUTABLE(class_attr);
+        R_PreserveObject(names);
+        R_PreserveObject(class_attr);
+        UNPROTECT(2);
+        git2r_S3_cache[i].names = names;
+        git2r_S3_cache[i].klass = class_attr;
+        git2r_S3_cache[i].items = items;
+    }
+
+    PROTECT(result = Rf_allocVector(VECSXP, Rf_length(git2r_S3_cache[i].names)));
+    Rf_setAttrib(result, R_NamesSymbol, git2r_S3_cache[i].names);
+    Rf_setAttrib(result, R_ClassSymbol, git2r_S3_cache[i].klass);
+    UNPROTECT(1);
+
+    return result;
+}
+
 /**
  * Get the list element named str, or return NULL.
  *
@@ -37,6 +37,15 @@ enum {
     git2r_S3_item__git_merge_result__sha};
 
 
+extern const char *git2r_S3_class__git_push_stats;
+extern const char *git2r_S3_items__git_push_stats[];
+enum {
+    git2r_S3_item__git_push_stats__commits,
+    git2r_S3_item__git_push_stats__objects,
+    git2r_S3_item__git_push_stats__bases,
+    git2r_S3_item__git_push_stats__deltas,
+    git2r_S3_item__git_push_stats__thin_deltas};
+
 extern const char *git2r_S3_class__git_transfer_progress;
 extern const char *git2r_S3_items__git_transfer_progress[];
 enum {
@@ -48,6 +57,95 @@ enum {
     git2r_S3_item__git_transfer_progress__indexed_deltas,
     git2r_S3_item__git_transfer_progress__received_bytes};
 
+/**
+ * Symbols of slot and list item names. Installed once when the
+ * package is loaded, use git2r_sym(name) instead of Rf_install.
+ */
+extern SEXP git2r_symbols[];
+enum {
+    git2r_symbol__annotated,
+    git2r_symbol__author,
+    git2r_symbol__boundary,
+    git2r_symbol__committer,
+    git2r_symbol__content,
+    git2r_symbol__dropped,
+    git2r_symbol__email,
+    git2r_symbol__filemode,
+    git2r_symbol__files,
+    git2r_symbol__final_commit_id,
+    git2r_symbol__final_signature,
+    git2r_symbol__final_start_line_number,
+    git2r_symbol__header,
+    git2r_symbol__hunks,
+    git2r_symbol__id,
+    git2r_symbol__index,
+    git2r_symbol__is_merge,
+    git2r_symbol__lines,
+    git2r_symbol__lines_in_hunk,
+    git2r_symbol__message,
+    git2r_symbol__name,
+    git2r_symbol__new,
+    git2r_symbol__new_file,
+    git2r_symbol__new_lineno,
+    git2r_symbol__new_lines,
+    git2r_symbol__new_start,
+    git2r_symbol__num_lines,
+    git2r_symbol__offset,
+    git2r_symbol__old,
+    git2r_symbol__old_file,
+    git2r_symbol__old_lineno,
+    git2r_symbol__old_lines,
+    git2r_symbol__old_start,
+    git2r_symbol__orig_commit_id,
+    git2r_symbol__orig_path,
+    git2r_symbol__orig_signature,
+    git2r_symbol__orig_start_line_number,
+    git2r_symbol__origin,
+    git2r_symbol__path,
+    git2r_symbol__ref_name,
+    git2r_symbol__refname,
+    git2r_symbol__remote_url,
+    git2r_symbol__repo,
+    git2r_symbol__sha,
+    git2r_symbol__shorthand,
+    git2r_symbol__summary,
+    git2r_symbol__tagger,
+    git2r_symbol__target,
+    git2r_symbol__time,
+    git2r_symbol__type,
+    git2r_symbol__when,
+    git2r_symbol__count};
+
+#define git2r_sym(name) (git2r_symbols[git2r_symbol__##name])
+
+/**
+ * S4 classes constructed from C. The prototype of each class is
+ * created on first use and cloned for new objects.
+ */
+extern const char *git2r_S4_classes[];
+enum {
+    git2r_S4_class__git_blame,
+    git2r_S4_class__git_blame_hunk,
+    git2r_S4_class__git_branch,
+    git2r_S4_class__git_commit,
+    git2r_S4_class__git_diff,
+    git2r_S4_class__git_diff_file,
+    git2r_S4_class__git_diff_hunk,
+    git2r_S4_class__git_diff_line,
+    git2r_S4_class__git_fetch_head,
+    git2r_S4_class__git_note,
+    git2r_S4_class__git_reference,
+    git2r_S4_class__git_reflog_entry,
+    git2r_S4_class__git_signature,
+    git2r_S4_class__git_stash,
+    git2r_S4_class__git_tag,
+    git2r_S4_class__git_tree,
+    git2r_S4_class__count};
+
+SEXP git2r_S4_new(int klass);
+SEXP git2r_S3_new(const char *klass, const char **items);
 SEXP git2r_get_list_element(SEXP list, const char *str);
+void git2r_objects_init(void);
+void git2r_objects_release(void);
 
 #endif
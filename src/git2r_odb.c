@@ -18,7 +18,15 @@
 
 #include <Rdefines.h>
 #include "git2.h"
+#include "git2/sys/odb_backend.h"
+#include "array.h"
 #include "buffer.h"
+#include "delta.h"
+#include "mwindow.h"
+#include "oidmap.h"
+#include "pack.h"
+#include "path.h"
+#include "pool.h"
 
 #include "git2r_arg.h"
 #include "git2r_error.h"
@@ -264,66 +272,59 @@ cleanup:
  * Data structure to hold information when iterating over blobs.
  */
 typedef struct {
-    size_t n;
-    SEXP list;
+    git2r_odb_blobs_data *data;
     git_repository *repository;
     git_odb *odb;
 } git2r_odb_blobs_cb_data;
 
 /**
- * Add blob entry to list
+ * Add blob entry to the collected blobs
  *
  * @param entry The tree entry (blob) to add
  * @param odb The object database
- * @param list The list to hold the blob information
- * @param i The vector index of the list items to use for the blob information
- * @param path The path to the tree relative to the repository workdir
+ * @param data The collected blobs
+ * @param path The path to the tree relative to the repository
+ * workdir, in the string pool of data
  * @param commit The commit that contains the root tree of the iteration
- * @param author The author of the commit
+ * @param author The author of the commit, in the string pool of data
  * @param when Time of the commit
  * @return 0 or error code
  */
 static int git2r_odb_add_blob(
     const git_tree_entry *entry,
     git_odb *odb,
-    SEXP list,
-    size_t i,
+    git2r_odb_blobs_data *data,
     const char *path,
-    const char *commit,
+    const git_oid *commit,
     const char *author,
     double when)
 {
     int err;
-    int j = 0;
     size_t len;
     git_otype type;
-    char sha[GIT_OID_HEXSZ + 1];
+    git2r_odb_blob *blob;
 
-    /* Sha */
-    git_oid_fmt(sha, git_tree_entry_id(entry));
-    sha[GIT_OID_HEXSZ] = '\0';
-    SET_STRING_ELT(VECTOR_ELT(list, j++), i, Rf_mkChar(sha));
-
-    /* Path */
-    SET_STRING_ELT(VECTOR_ELT(list, j++), i, Rf_mkChar(path));
-
-    /* Name */
-    SET_STRING_ELT(VECTOR_ELT(list, j++), i, Rf_mkChar(git_tree_entry_name(entry)));
-
-    /* Length */
     err = git_odb_read_header(&len, &type, odb, git_tree_entry_id(entry));
     if (err)
         return err;
-    INTEGER(VECTOR_ELT(list, j++))[i] = len;
 
-    /* Commit sha */
-    SET_STRING_ELT(VECTOR_ELT(list, j++), i, Rf_mkChar(commit));
-
-    /* Author */
-    SET_STRING_ELT(VECTOR_ELT(list, j++), i, Rf_mkChar(author));
+    blob = git_array_alloc(data->blobs);
+    if (!blob) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
 
-    /* When */
-    REAL(VECTOR_ELT(list, j++))[i] = when;
+    git_oid_cpy(&blob->id, git_tree_entry_id(entry));
+    git_oid_cpy(&blob->commit, commit);
+    blob->path = path;
+    blob->name = git_pool_strdup(&data->strings, git_tree_entry_name(entry));
+    blob->author = author;
+    blob->when = when;
+    blob->len = len;
+    if (!blob->name) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
 
     return GIT_OK;
 }
@@ -332,7 +333,8 @@ static int git2r_odb_add_blob(
  * Recursively iterate over all tree's
  *
  * @param tree The tree to iterate over
- * @param path The path to the tree relative to the repository workdir
+ * @param path The path to the tree relative to the repository
+ * workdir, in the string pool of the collected blobs
  * @param commit The commit that contains the root tree of the iteration
  * @param author The author of the commit
  * @param when Time of the commit
@@ -342,7 +344,7 @@ static int git2r_odb_add_blob(
 static int git2r_odb_tree_blobs(
     const git_tree *tree,
     const char *path,
-    const char *commit,
+    const git_oid *commit,
     const char *author,
     double when,
     git2r_odb_blobs_cb_data *data)
@@ -360,6 +362,7 @@ static int git2r_odb_tree_blobs(
         {
             git_buf buf = GIT_BUF_INIT;
             git_tree *sub_tree = NULL;
+            char *sub_path = NULL;
 
             err = git_tree_lookup(
                 &sub_tree,
@@ -369,11 +372,19 @@ static int git2r_odb_tree_blobs(
                 return err;
 
             err = git_buf_joinpath(&buf, path, git_tree_entry_name(entry));
+            if (GIT_OK == err) {
+                sub_path = git_pool_strndup(&data->data->strings,
+                                            buf.ptr, buf.size);
+                if (!sub_path) {
+                    giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+                    err = GIT_ERROR;
+                }
+            }
 
             if (GIT_OK == err) {
                 err = git2r_odb_tree_blobs(
                     sub_tree,
-                    buf.ptr,
+                    sub_path,
                     commit,
                     author,
                     when,
@@ -391,20 +402,16 @@ static int git2r_odb_tree_blobs(
             break;
         }
         case GIT_OBJ_BLOB:
-            if (!Rf_isNull(data->list)) {
-                err = git2r_odb_add_blob(
-                    entry,
-                    data->odb,
-                    data->list,
-                    data->n,
-                    path,
-                    commit,
-                    author,
-                    when);
-                if (err)
-                    return err;
-            }
-            data->n += 1;
+            err = git2r_odb_add_blob(
+                entry,
+                data->odb,
+                data->data,
+                path,
+                commit,
+                author,
+                when);
+            if (err)
+                return err;
             break;
         default:
             break;
@@ -428,15 +435,22 @@ static int git2r_odb_blobs_cb(const git_oid *oid, void *payload)
     git_otype type;
     git2r_odb_blobs_cb_data *p = (git2r_odb_blobs_cb_data*)payload;
 
+    p->data->n_objects++;
+    if (p->data->progress) {
+        err = p->data->progress(p->data->n_objects, p->data->payload);
+        if (err)
+            return err;
+    }
+
     err = git_odb_read_header(&len, &type, p->odb, oid);
     if (err)
         return err;
 
     if (GIT_OBJ_COMMIT == type) {
         const git_signature *author;
+        const char *name;
         git_commit *commit = NULL;
         git_tree *tree = NULL;
-        char sha[GIT_OID_HEXSZ + 1];
 
         err = git_commit_lookup(&commit, p->repository, oid);
         if (err)
@@ -446,17 +460,20 @@ static int git2r_odb_blobs_cb(const git_oid *oid, void *payload)
         if (err)
             goto cleanup;
 
-        git_oid_fmt(sha, oid);
-        sha[GIT_OID_HEXSZ] = '\0';
-
         author = git_commit_author(commit);
+        name = git_pool_strdup(&p->data->strings, author->name);
+        if (!name) {
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            err = GIT_ERROR;
+            goto cleanup;
+        }
 
         /* Recursively iterate over all tree's */
         err = git2r_odb_tree_blobs(
             tree,
             "",
-            sha,
-            author->name,
+            oid,
+            name,
             (double)(author->when.time) + 60 * (double)(author->when.offset),
             p);
 
@@ -471,6 +488,114 @@ static int git2r_odb_blobs_cb(const git_oid *oid, void *payload)
     return err;
 }
 
+/**
+ * Initialize the data to collect blobs in
+ *
+ * @param data The data to initialize. Free with git2r_odb_blobs_free.
+ */
+void git2r_odb_blobs_init(git2r_odb_blobs_data *data)
+{
+    memset(data, 0, sizeof(git2r_odb_blobs_data));
+    git_array_init(data->blobs);
+    git_pool_init(&data->strings, 1);
+}
+
+/**
+ * Free the collected blobs
+ *
+ * @param data The collected blobs.
+ */
+void git2r_odb_blobs_free(git2r_odb_blobs_data *data)
+{
+    git_array_clear(data->blobs);
+    git_pool_clear(&data->strings);
+}
+
+/**
+ * Collect the blobs reachable from the commits in the object
+ * database
+ *
+ * Does not call the R API, and can be used on a worker thread.
+ *
+ * @param data The data to collect the blobs in, initialized with
+ * git2r_odb_blobs_init.
+ * @param repository The repository.
+ * @return 0 or error code
+ */
+int git2r_odb_blobs_collect(
+    git2r_odb_blobs_data *data,
+    git_repository *repository)
+{
+    int err;
+    git_odb *odb = NULL;
+    git2r_odb_blobs_cb_data cb_data;
+
+    err = git_repository_odb(&odb, repository);
+    if (err)
+        return err;
+
+    cb_data.data = data;
+    cb_data.repository = repository;
+    cb_data.odb = odb;
+    err = git_odb_foreach(odb, &git2r_odb_blobs_cb, &cb_data);
+
+    git_odb_free(odb);
+
+    return err;
+}
+
+/**
+ * Create a list with the collected blobs
+ *
+ * @param data The collected blobs.
+ * @return A list with blob entries
+ */
+SEXP git2r_odb_blobs_list(const git2r_odb_blobs_data *data)
+{
+    size_t i, n = git_array_size(data->blobs);
+    int j;
+    SEXP result, names;
+
+    PROTECT(result = Rf_allocVector(VECSXP, 7));
+    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 7));
+
+    j = 0;
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP,  n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("sha"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP,  n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("path"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP,  n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("name"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(INTSXP,  n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("len"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP,  n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("commit"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP,  n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("author"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(REALSXP, n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("when"));
+
+    for (i = 0; i < n; i++) {
+        const git2r_odb_blob *blob = git_array_get(data->blobs, i);
+        char sha[GIT_OID_HEXSZ + 1];
+
+        j = 0;
+        git_oid_tostr(sha, sizeof(sha), &blob->id);
+        SET_STRING_ELT(VECTOR_ELT(result, j++), i, Rf_mkChar(sha));
+        SET_STRING_ELT(VECTOR_ELT(result, j++), i, Rf_mkChar(blob->path));
+        SET_STRING_ELT(VECTOR_ELT(result, j++), i, Rf_mkChar(blob->name));
+        INTEGER(VECTOR_ELT(result, j++))[i] = blob->len;
+        git_oid_tostr(sha, sizeof(sha), &blob->commit);
+        SET_STRING_ELT(VECTOR_ELT(result, j++), i, Rf_mkChar(sha));
+        SET_STRING_ELT(VECTOR_ELT(result, j++), i, Rf_mkChar(blob->author));
+        REAL(VECTOR_ELT(result, j++))[i] = blob->when;
+    }
+
+    UNPROTECT(1);
+
+    return result;
+}
+
 /**
  * List all blobs available in the database
  *
@@ -482,57 +607,980 @@ static int git2r_odb_blobs_cb(const git_oid *oid, void *payload)
  */
 SEXP git2r_odb_blobs(SEXP repo)
 {
-    int i, err;
+    int err;
     SEXP result = R_NilValue;
-    SEXP names = R_NilValue;
-    git2r_odb_blobs_cb_data cb_data = {0, R_NilValue, NULL, NULL};
-    git_odb *odb = NULL;
+    git2r_odb_blobs_data data;
     git_repository *repository = NULL;
 
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    err = git_repository_odb(&odb, repository);
+    git2r_odb_blobs_init(&data);
+    err = git2r_odb_blobs_collect(&data, repository);
+    git_repository_free(repository);
+
+    if (!err)
+        result = git2r_odb_blobs_list(&data);
+
+    git2r_odb_blobs_free(&data);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
+
+/**
+ * An object in one of the tables of 'git2r_odb_stats', ranked by
+ * 'key'
+ */
+typedef struct {
+    git_oid id;
+    double key;
+    size_t size;
+    size_t count; /* entries of a tree, depth of a delta chain or
+                   * parents of a commit */
+    git_otype type;
+    char *path;
+} git2r_odb_stats_item;
+
+/**
+ * The items with the largest keys, largest first
+ */
+typedef struct {
+    git2r_odb_stats_item *items;
+    size_t n;
+    size_t max;
+} git2r_odb_stats_top;
+
+/**
+ * The objects of one pack file, or the loose objects
+ */
+typedef struct {
+    char *name;
+    size_t objects;
+    size_t deltas;
+    double size;
+    double uncompressed;
+} git2r_odb_stats_pack;
+
+/**
+ * An object in a pack file, ordered by offset
+ */
+typedef struct {
+    git_off_t offset;
+    const git_oid *id; /* in the index of the pack */
+    git_otype type; /* GIT_OBJ_BAD until it's resolved */
+    unsigned int depth;
+} git2r_odb_stats_entry;
+
+/**
+ * A tree that is seen in the traversal
+ */
+typedef struct git2r_odb_stats_tree {
+    git_oid id;
+    size_t depth; /* components of the deepest path in the tree */
+    const char *deepest; /* first component of the deepest path */
+    struct git2r_odb_stats_tree *deepest_tree;
+    int root;
+} git2r_odb_stats_tree;
+
+/**
+ * A root tree and the first commit that is seen with it
+ */
+typedef struct {
+    git2r_odb_stats_tree *tree;
+    git_oid commit;
+} git2r_odb_stats_root;
+
+/**
+ * Data structure to hold the statistics of the object database
+ */
+typedef struct {
+    git_repository *repository;
+    size_t count[GIT_OBJ_TAG];
+    double size[GIT_OBJ_TAG];
+    git_array_t(git2r_odb_stats_pack) packs;
+    git2r_odb_stats_top blobs;
+    git2r_odb_stats_top trees;
+    git2r_odb_stats_top commits;
+    git2r_odb_stats_top deltas;
+    git2r_odb_stats_top paths;
+    git_odb *loose;
+    git_buf loose_path;
+    git2r_odb_stats_pack *loose_pack;
+    git_oidmap *blob_paths;
+    git_oidmap *seen_trees;
+    git_pool tree_pool;
+    git_pool name_pool;
+    git_array_t(git2r_odb_stats_root) roots;
+    git_buf path;
+} git2r_odb_stats_data;
+
+static int git2r_odb_stats_top_init(git2r_odb_stats_top *top, size_t max)
+{
+    top->n = 0;
+    top->max = max;
+    top->items = calloc(max ? max : 1, sizeof(git2r_odb_stats_item));
+    if (!top->items) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+
+    return 0;
+}
+
+static void git2r_odb_stats_top_free(git2r_odb_stats_top *top)
+{
+    size_t i;
+
+    for (i = 0; i < top->n; i++)
+        free(top->items[i].path);
+    free(top->items);
+    top->items = NULL;
+    top->n = 0;
+}
+
+/**
+ * Add an object to the items with the largest keys
+ *
+ * @param top The items.
+ * @param id The id of the object.
+ * @param key The key of the object.
+ * @return The item to fill in, or NULL if the object is not among
+ * the largest or is an item already.
+ */
+static git2r_odb_stats_item *git2r_odb_stats_top_add(
+    git2r_odb_stats_top *top,
+    const git_oid *id,
+    double key)
+{
+    size_t i, pos;
+
+    if (top->n == top->max && (!top->max || key <= top->items[top->n - 1].key))
+        return NULL;
+
+    for (i = 0; i < top->n; i++) {
+        if (git_oid_equal(&top->items[i].id, id))
+            return NULL;
+    }
+
+    for (pos = 0; pos < top->n && top->items[pos].key >= key; pos++)
+        ;
+
+    if (top->n == top->max)
+        free(top->items[--top->n].path);
+    memmove(top->items + pos + 1, top->items + pos,
+            (top->n - pos) * sizeof(git2r_odb_stats_item));
+    top->n++;
+
+    memset(&top->items[pos], 0, sizeof(git2r_odb_stats_item));
+    git_oid_cpy(&top->items[pos].id, id);
+    top->items[pos].key = key;
+
+    return &top->items[pos];
+}
+
+/**
+ * Count an object in the statistics of its type and rank it among
+ * the largest objects
+ */
+static void git2r_odb_stats_object(
+    git2r_odb_stats_data *data,
+    git2r_odb_stats_pack *pack,
+    const git_oid *id,
+    git_otype type,
+    size_t size,
+    unsigned int depth)
+{
+    git2r_odb_stats_item *item = NULL;
+
+    if (type < GIT_OBJ_COMMIT || type > GIT_OBJ_TAG)
+        return;
+
+    data->count[type - 1]++;
+    data->size[type - 1] += size;
+    pack->objects++;
+    pack->uncompressed += size;
+
+    if (depth) {
+        pack->deltas++;
+        item = git2r_odb_stats_top_add(&data->deltas, id, depth);
+        if (item) {
+            item->size = size;
+            item->count = depth;
+            item->type = type;
+        }
+    }
+
+    if (GIT_OBJ_BLOB == type)
+        item = git2r_odb_stats_top_add(&data->blobs, id, size);
+    else if (GIT_OBJ_COMMIT == type)
+        item = git2r_odb_stats_top_add(&data->commits, id, size);
+    else
+        item = NULL;
+    if (item) {
+        item->size = size;
+        item->type = type;
+    }
+}
+
+static int git2r_odb_stats_pack_entry_cmp(const void *a, const void *b)
+{
+    git_off_t x = ((const git2r_odb_stats_entry *)a)->offset;
+    git_off_t y = ((const git2r_odb_stats_entry *)b)->offset;
+
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Find the entry of a pack file at an offset
+ *
+ * @return The index of the entry, or n if there is no entry at the
+ * offset.
+ */
+static size_t git2r_odb_stats_pack_find(
+    const git2r_odb_stats_entry *entries,
+    size_t n,
+    git_off_t offset)
+{
+    size_t lo = 0, hi = n;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (entries[mid].offset < offset)
+            lo = mid + 1;
+        else if (entries[mid].offset > offset)
+            hi = mid;
+        else
+            return mid;
+    }
+
+    return n;
+}
+
+/**
+ * Read the type, size and depth of the delta chain of an object in
+ * a pack file from the headers of the object and of its delta
+ * bases. The content is not inflated, except for the header of a
+ * delta.
+ *
+ * The base of an offset delta is before the delta in the pack file,
+ * so it's resolved already when the entries are resolved in order
+ * of offset. The base of a ref delta is resolved first, if needed.
+ *
+ * @param p The pack file.
+ * @param entries The objects in the pack file, ordered by offset.
+ * @param n The number of objects in the pack file.
+ * @param i The index of the object to resolve.
+ * @param size_out The size of the object.
+ * @return 0 or an error code
+ */
+static int git2r_odb_stats_pack_resolve(
+    struct git_pack_file *p,
+    git2r_odb_stats_entry *entries,
+    size_t n,
+    size_t i,
+    size_t *size_out)
+{
+    int err;
+    git_mwindow *w_curs = NULL;
+    git_off_t curpos = entries[i].offset, base_offset;
+    git_packfile_stream stream;
+    size_t size, base_size, j;
+    git_otype type;
+
+    err = git_packfile_unpack_header(&size, &type, &p->mwf, &w_curs, &curpos);
+    if (err < 0) {
+        git_mwindow_close(&w_curs);
+        return err;
+    }
+
+    if (type != GIT_OBJ_OFS_DELTA && type != GIT_OBJ_REF_DELTA) {
+        git_mwindow_close(&w_curs);
+        entries[i].type = type;
+        entries[i].depth = 0;
+        *size_out = size;
+        return 0;
+    }
+
+    base_offset = get_delta_base(p, &w_curs, &curpos, type, entries[i].offset);
+    git_mwindow_close(&w_curs);
+    if (base_offset <= 0 ||
+        (j = git2r_odb_stats_pack_find(entries, n, base_offset)) == n) {
+        giterr_set(GITERR_ODB, "bad delta base of object in '%s'", p->pack_name);
+        return GIT_ERROR;
+    }
+
+    err = git_packfile_stream_open(&stream, p, curpos);
+    if (err < 0)
+        return err;
+    err = git_delta_read_header_fromstream(&base_size, size_out, &stream);
+    git_packfile_stream_free(&stream);
+    if (err < 0)
+        return err;
+
+    if (GIT_OBJ_ANY == entries[j].type) {
+        giterr_set(GITERR_ODB, "delta cycle in '%s'", p->pack_name);
+        return GIT_ERROR;
+    }
+
+    if (GIT_OBJ_BAD == entries[j].type) {
+        entries[i].type = GIT_OBJ_ANY;
+        err = git2r_odb_stats_pack_resolve(p, entries, n, j, &base_size);
+        if (err < 0)
+            return err;
+    }
+
+    entries[i].type = entries[j].type;
+    entries[i].depth = entries[j].depth + 1;
+
+    return 0;
+}
+
+/**
+ * Data structure to hold the objects of a pack file when iterating
+ * over its index
+ */
+typedef struct {
+    struct git_pack_file *p;
+    git_array_t(git2r_odb_stats_entry) entries;
+} git2r_odb_stats_pack_data;
+
+static int git2r_odb_stats_pack_cb(const git_oid *oid, void *payload)
+{
+    int err;
+    git2r_odb_stats_pack_data *p = payload;
+    git2r_odb_stats_entry *entry;
+    struct git_pack_entry e;
+
+    err = git_pack_entry_find(&e, p->p, oid, GIT_OID_HEXSZ);
+    if (err)
+        return err;
+
+    entry = git_array_alloc(p->entries);
+    if (!entry) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+
+    entry->offset = e.offset;
+    entry->id = oid;
+    entry->type = GIT_OBJ_BAD;
+    entry->depth = 0;
+
+    return 0;
+}
+
+/**
+ * Add the objects in a pack file to the statistics
+ *
+ * @param data The statistics.
+ * @param path The path to the index of the pack file.
+ * @return 0 or an error code
+ */
+static int git2r_odb_stats_pack_file(git2r_odb_stats_data *data, const char *path)
+{
+    int err;
+    size_t i, n;
+    git2r_odb_stats_pack_data pack_data = {NULL, GIT_ARRAY_INIT};
+    git2r_odb_stats_pack *pack;
+
+    err = git_mwindow_get_pack(&pack_data.p, path);
     if (err)
+        return err;
+
+    pack = git_array_alloc(data->packs);
+    if (!pack) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        err = GIT_ERROR;
         goto cleanup;
-    cb_data.odb = odb;
+    }
+    memset(pack, 0, sizeof(git2r_odb_stats_pack));
+    pack->name = git_path_basename(pack_data.p->pack_name);
+    pack->size = pack_data.p->mwf.size;
 
-    /* Count number of blobs before creating the list */
-    cb_data.repository = repository;
-    err = git_odb_foreach(odb, &git2r_odb_blobs_cb, &cb_data);
+    err = git_pack_foreach_entry(pack_data.p, git2r_odb_stats_pack_cb, &pack_data);
     if (err)
         goto cleanup;
 
+    n = git_array_size(pack_data.entries);
+    if (n)
+        qsort(pack_data.entries.ptr, n, sizeof(git2r_odb_stats_entry),
+              git2r_odb_stats_pack_entry_cmp);
+
+    for (i = 0; i < n; i++) {
+        git2r_odb_stats_entry *entry = git_array_get(pack_data.entries, i);
+        size_t size;
+
+        err = git2r_odb_stats_pack_resolve(pack_data.p, pack_data.entries.ptr, n, i, &size);
+        if (err)
+            goto cleanup;
+
+        git2r_odb_stats_object(data, pack, entry->id, entry->type, size, entry->depth);
+    }
+
+cleanup:
+    git_array_clear(pack_data.entries);
+    git_mwindow_put_pack(pack_data.p);
+
+    return err;
+}
+
+static int git2r_odb_stats_pack_dir_cb(void *payload, git_buf *path)
+{
+    if (git__suffixcmp(path->ptr, ".idx"))
+        return 0;
+
+    return git2r_odb_stats_pack_file(payload, path->ptr);
+}
+
+/**
+ * Add a loose object to the statistics
+ */
+static int git2r_odb_stats_loose_cb(const git_oid *oid, void *payload)
+{
+    int err;
+    git2r_odb_stats_data *data = payload;
+    size_t size, len = data->loose_path.size;
+    git_otype type;
+    char sha[GIT_OID_HEXSZ + 1];
+    struct stat st;
+
+    err = git_odb_read_header(&size, &type, data->loose, oid);
+    if (err)
+        return err;
+
+    git_oid_tostr(sha, sizeof(sha), oid);
+    err = git_buf_printf(&data->loose_path, "%.2s/%s", sha, sha + 2);
+    if (err)
+        return err;
+    if (!p_stat(data->loose_path.ptr, &st))
+        data->loose_pack->size += st.st_size;
+    git_buf_truncate(&data->loose_path, len);
+
+    git2r_odb_stats_object(data, data->loose_pack, oid, type, size, 0);
+
+    return 0;
+}
+
+/**
+ * Add the loose objects to the statistics
+ *
+ * @param data The statistics.
+ * @param objects The path to the objects directory.
+ * @return 0 or an error code
+ */
+static int git2r_odb_stats_loose(git2r_odb_stats_data *data, const char *objects)
+{
+    int err;
+    git_odb_backend *backend = NULL;
+
+    data->loose_pack = git_array_alloc(data->packs);
+    if (!data->loose_pack) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+    memset(data->loose_pack, 0, sizeof(git2r_odb_stats_pack));
+
+    err = git_odb_new(&data->loose);
+    if (err)
+        return err;
+    err = git_odb_backend_loose(&backend, objects, -1, 0, 0, 0);
+    if (err)
+        return err;
+    err = git_odb_add_backend(data->loose, backend, 1);
+    if (err) {
+        backend->free(backend);
+        return err;
+    }
+
+    err = git_buf_puts(&data->loose_path, objects);
+    if (!err)
+        err = git_path_to_dir(&data->loose_path);
+    if (err)
+        return err;
+
+    return git_odb_foreach(data->loose, git2r_odb_stats_loose_cb, data);
+}
+
+/**
+ * Visit a tree, and its subtrees, once
+ *
+ * Record the deepest path in the tree, the path of the largest
+ * blobs and rank the tree among the widest trees.
+ *
+ * @param data The statistics, with the path of the tree.
+ * @param id The id of the tree.
+ * @param out The tree that is seen.
+ * @return 0 or an error code
+ */
+static int git2r_odb_stats_visit_tree(
+    git2r_odb_stats_data *data,
+    const git_oid *id,
+    git2r_odb_stats_tree **out)
+{
+    int err = 0;
+    size_t i, n, size = 0, deepest = 0, len = data->path.size;
+    git_tree *tree = NULL;
+    git2r_odb_stats_tree *info;
+    git2r_odb_stats_item *item;
+
+    i = git_oidmap_lookup_index(data->seen_trees, id);
+    if (git_oidmap_valid_index(data->seen_trees, i)) {
+        *out = git_oidmap_value_at(data->seen_trees, i);
+        return 0;
+    }
+
+    info = git_pool_mallocz(&data->tree_pool, 1);
+    if (!info) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+    git_oid_cpy(&info->id, id);
+    git_oidmap_insert(data->seen_trees, &info->id, info, &err);
+    if (err < 0)
+        return GIT_ERROR;
+    *out = info;
+
+    err = git_tree_lookup(&tree, data->repository, id);
+    if (err)
+        return err;
+
+    n = git_tree_entrycount(tree);
+    for (i = 0; i < n && !err; i++) {
+        const git_tree_entry *entry = git_tree_entry_byindex(tree, i);
+        const char *name = git_tree_entry_name(entry);
+        git2r_odb_stats_tree *subtree = NULL;
+        size_t depth = 1;
+
+        /* The size of the entry in the tree object */
+        size += (git_tree_entry_filemode(entry) == GIT_FILEMODE_TREE ? 5 : 6) +
+            strlen(name) + 2 + GIT_OID_RAWSZ;
+
+        err = git_buf_puts(&data->path, name);
+        if (err)
+            break;
+
+        if (git_tree_entry_type(entry) == GIT_OBJ_TREE) {
+            err = git_buf_putc(&data->path, '/');
+            if (!err)
+                err = git2r_odb_stats_visit_tree(data, git_tree_entry_id(entry), &subtree);
+            if (!err)
+                depth = subtree->depth + 1;
+            /* An empty subtree ends the path, like a blob */
+            if (!err && !subtree->depth)
+                subtree = NULL;
+        } else if (git_tree_entry_type(entry) == GIT_OBJ_BLOB) {
+            size_t k = git_oidmap_lookup_index(data->blob_paths, git_tree_entry_id(entry));
+
+            if (git_oidmap_valid_index(data->blob_paths, k)) {
+                item = git_oidmap_value_at(data->blob_paths, k);
+                if (!item->path && !(item->path = strdup(data->path.ptr))) {
+                    giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+                    err = GIT_ERROR;
+                }
+            }
+        }
+
+        if (depth > info->depth) {
+            info->depth = depth;
+            info->deepest_tree = subtree;
+            deepest = i;
+        }
+
+        git_buf_truncate(&data->path, len);
+    }
+
+    if (!err && info->depth) {
+        info->deepest = git_pool_strdup(&data->name_pool,
+            git_tree_entry_name(git_tree_entry_byindex(tree, deepest)));
+        if (!info->deepest) {
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            err = GIT_ERROR;
+        }
+    }
+
+    if (!err && (item = git2r_odb_stats_top_add(&data->trees, id, n))) {
+        item->size = size;
+        item->count = n;
+        item->type = GIT_OBJ_TREE;
+        item->path = git__strndup(data->path.ptr, len ? len - 1 : 0);
+        if (!item->path) {
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            err = GIT_ERROR;
+        }
+    }
+
+    git_tree_free(tree);
+
+    return err;
+}
+
+/**
+ * Visit the trees of all commits that are reachable from the
+ * references once
+ */
+static int git2r_odb_stats_visit_commits(git2r_odb_stats_data *data)
+{
+    int err;
+    size_t i;
+    git_revwalk *walker = NULL;
+    git_oid oid;
+
+    for (i = 0; i < data->blobs.n; i++) {
+        git_oidmap_insert(data->blob_paths, &data->blobs.items[i].id,
+                          &data->blobs.items[i], &err);
+        if (err < 0)
+            return GIT_ERROR;
+    }
+
+    err = git_revwalk_new(&walker, data->repository);
+    if (err)
+        goto cleanup;
+
+    err = git_revwalk_push_glob(walker, "*");
+    if (err)
+        goto cleanup;
+    if (!git_repository_head_unborn(data->repository)) {
+        err = git_revwalk_push_head(walker);
+        if (err)
+            goto cleanup;
+    }
+
+    while (!(err = git_revwalk_next(&oid, walker))) {
+        git_commit *commit = NULL;
+        git2r_odb_stats_tree *tree;
+
+        err = git_commit_lookup(&commit, data->repository, &oid);
+        if (err)
+            break;
+
+        git_buf_clear(&data->path);
+        err = git2r_odb_stats_visit_tree(data, git_commit_tree_id(commit), &tree);
+        git_commit_free(commit);
+        if (err)
+            break;
+
+        if (!tree->root) {
+            git2r_odb_stats_root *root = git_array_alloc(data->roots);
+            if (!root) {
+                giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+                err = GIT_ERROR;
+                break;
+            }
+
+            tree->root = 1;
+            root->tree = tree;
+            git_oid_cpy(&root->commit, &oid);
+        }
+    }
+    if (GIT_ITEROVER == err)
+        err = 0;
+
+cleanup:
+    git_revwalk_free(walker);
+
+    return err;
+}
+
+/**
+ * Rank the deepest path of each root tree, once per path
+ */
+static int git2r_odb_stats_deepest_paths(git2r_odb_stats_data *data)
+{
+    int err = 0;
+    size_t i, j;
+    git_buf path = GIT_BUF_INIT;
+
+    for (i = 0; i < git_array_size(data->roots) && !err; i++) {
+        git2r_odb_stats_root *root = git_array_get(data->roots, i);
+        git2r_odb_stats_tree *tree;
+        git2r_odb_stats_item *item;
+        int seen = 0;
+
+        if (!root->tree->depth)
+            continue;
+        if (data->paths.n == data->paths.max &&
+            (!data->paths.max || root->tree->depth <= data->paths.items[data->paths.n - 1].key))
+            continue;
+
+        git_buf_clear(&path);
+        for (tree = root->tree; tree && tree->deepest && !err; tree = tree->deepest_tree) {
+            err = git_buf_puts(&path, tree->deepest);
+            if (!err && tree->deepest_tree)
+                err = git_buf_putc(&path, '/');
+        }
+        if (err)
+            break;
+
+        for (j = 0; j < data->paths.n && !seen; j++)
+            seen = !strcmp(data->paths.items[j].path, path.ptr);
+        if (seen)
+            continue;
+
+        item = git2r_odb_stats_top_add(&data->paths, &root->commit, root->tree->depth);
+        if (item) {
+            item->count = root->tree->depth;
+            item->type = GIT_OBJ_COMMIT;
+            item->path = git_buf_detach(&path);
+        }
+    }
+
+    git_buf_free(&path);
+
+    return err;
+}
+
+static void git2r_odb_stats_data_free(git2r_odb_stats_data *data)
+{
+    size_t i;
+
+    for (i = 0; i < git_array_size(data->packs); i++)
+        git__free(git_array_get(data->packs, i)->name);
+    git_array_clear(data->packs);
+    git2r_odb_stats_top_free(&data->blobs);
+    git2r_odb_stats_top_free(&data->trees);
+    git2r_odb_stats_top_free(&data->commits);
+    git2r_odb_stats_top_free(&data->deltas);
+    git2r_odb_stats_top_free(&data->paths);
+    git_odb_free(data->loose);
+    git_buf_free(&data->loose_path);
+    git_oidmap_free(data->blob_paths);
+    git_oidmap_free(data->seen_trees);
+    git_pool_clear(&data->tree_pool);
+    git_pool_clear(&data->name_pool);
+    git_array_clear(data->roots);
+    git_buf_free(&data->path);
+}
+
+/**
+ * Allocate a table with named columns
+ *
+ * @param names The names of the columns, separated by ','.
+ * @param types The types of the columns.
+ * @param n The number of rows.
+ * @return list with one vector per column
+ */
+static SEXP git2r_odb_stats_table(const char *names, const SEXPTYPE *types, size_t n)
+{
+    SEXP table, table_names;
+    size_t i, n_columns = 1;
+    const char *name;
+
+    for (name = names; *name; name++)
+        n_columns += (*name == ',');
+
+    PROTECT(table = Rf_allocVector(VECSXP, n_columns));
+    Rf_setAttrib(table, R_NamesSymbol, table_names = Rf_allocVector(STRSXP, n_columns));
+    for (i = 0, name = names; i < n_columns; i++) {
+        const char *end = strchr(name, ',');
+        size_t len = end ? (size_t)(end - name) : strlen(name);
+
+        SET_STRING_ELT(table_names, i, Rf_mkCharLen(name, len));
+        SET_VECTOR_ELT(table, i, Rf_allocVector(types[i], n));
+        name += len + 1;
+    }
+    UNPROTECT(1);
+
+    return table;
+}
+
+static SEXP git2r_odb_stats_sha(const git_oid *oid)
+{
+    char sha[GIT_OID_HEXSZ + 1];
+
+    git_oid_tostr(sha, sizeof(sha), oid);
+    return Rf_mkChar(sha);
+}
+
+static SEXP git2r_odb_stats_string(const char *str)
+{
+    return str ? Rf_mkChar(str) : NA_STRING;
+}
+
+/**
+ * Statistics of the object database
+ *
+ * The type and size of the objects in the pack files are read from
+ * the index and the headers of the objects, and the objects are not
+ * inflated. The trees that are reachable from the references are
+ * traversed once, each tree is read once.
+ *
+ * @param repo S4 class git_repository
+ * @param n The number of objects in the tables of largest objects.
+ * @return named list with the tables 'objects', 'packs', 'blobs',
+ * 'trees', 'commits', 'deltas' and 'paths'
+ */
+SEXP git2r_odb_stats(SEXP repo, SEXP n)
+{
+    int err;
+    size_t i;
+    SEXP result = R_NilValue;
+    SEXP names, table;
+    git_buf objects = GIT_BUF_INIT;
+    git2r_odb_stats_data data;
+    static const char *types[] = {"commit", "tree", "blob", "tag"};
+    static const SEXPTYPE objects_types[] = {STRSXP, INTSXP, REALSXP};
+    static const SEXPTYPE packs_types[] = {STRSXP, INTSXP, INTSXP, REALSXP, REALSXP};
+    static const SEXPTYPE blobs_types[] = {STRSXP, REALSXP, STRSXP};
+    static const SEXPTYPE trees_types[] = {STRSXP, INTSXP, REALSXP, STRSXP};
+    static const SEXPTYPE commits_types[] = {STRSXP, REALSXP, INTSXP};
+    static const SEXPTYPE deltas_types[] = {STRSXP, STRSXP, INTSXP, REALSXP};
+    static const SEXPTYPE paths_types[] = {STRSXP, INTSXP, STRSXP};
+
+    if (git2r_arg_check_integer_gte_zero(n))
+        git2r_error(__func__, NULL, "'n'", git2r_err_integer_gte_zero_arg);
+
+    memset(&data, 0, sizeof(data));
+    git_pool_init(&data.tree_pool, sizeof(git2r_odb_stats_tree));
+    git_pool_init(&data.name_pool, 1);
+
+    data.repository = git2r_repository_open(repo);
+    if (!data.repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    if ((err = git2r_odb_stats_top_init(&data.blobs, INTEGER(n)[0])) ||
+        (err = git2r_odb_stats_top_init(&data.trees, INTEGER(n)[0])) ||
+        (err = git2r_odb_stats_top_init(&data.commits, INTEGER(n)[0])) ||
+        (err = git2r_odb_stats_top_init(&data.deltas, INTEGER(n)[0])) ||
+        (err = git2r_odb_stats_top_init(&data.paths, INTEGER(n)[0])))
+        goto cleanup;
+
+    data.blob_paths = git_oidmap_alloc();
+    data.seen_trees = git_oidmap_alloc();
+    if (!data.blob_paths || !data.seen_trees) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        err = GIT_ERROR;
+        goto cleanup;
+    }
+
+    /* The objects: first the pack files, then the loose objects */
+    err = git_repository_item_path(&objects, data.repository,
+                                   GIT_REPOSITORY_ITEM_OBJECTS);
+    if (err)
+        goto cleanup;
+    err = git_buf_joinpath(&data.path, objects.ptr, "pack");
+    if (err)
+        goto cleanup;
+    if (git_path_isdir(data.path.ptr)) {
+        err = git_path_direach(&data.path, 0, git2r_odb_stats_pack_dir_cb, &data);
+        if (err)
+            goto cleanup;
+    }
+    err = git2r_odb_stats_loose(&data, objects.ptr);
+    if (err)
+        goto cleanup;
+
+    /* The trees */
+    err = git2r_odb_stats_visit_commits(&data);
+    if (err)
+        goto cleanup;
+    err = git2r_odb_stats_deepest_paths(&data);
+    if (err)
+        goto cleanup;
+
+    for (i = 0; i < data.commits.n; i++) {
+        git_commit *commit = NULL;
+
+        err = git_commit_lookup(&commit, data.repository, &data.commits.items[i].id);
+        if (err)
+            goto cleanup;
+        data.commits.items[i].count = git_commit_parentcount(commit);
+        git_commit_free(commit);
+    }
+
     PROTECT(result = Rf_allocVector(VECSXP, 7));
     Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 7));
 
-    i = 0;
-    SET_VECTOR_ELT(result, i,   Rf_allocVector(STRSXP,  cb_data.n));
-    SET_STRING_ELT(names,  i++, Rf_mkChar("sha"));
-    SET_VECTOR_ELT(result, i,   Rf_allocVector(STRSXP,  cb_data.n));
-    SET_STRING_ELT(names,  i++, Rf_mkChar("path"));
-    SET_VECTOR_ELT(result, i,   Rf_allocVector(STRSXP,  cb_data.n));
-    SET_STRING_ELT(names,  i++, Rf_mkChar("name"));
-    SET_VECTOR_ELT(result, i,   Rf_allocVector(INTSXP,  cb_data.n));
-    SET_STRING_ELT(names,  i++, Rf_mkChar("len"));
-    SET_VECTOR_ELT(result, i,   Rf_allocVector(STRSXP,  cb_data.n));
-    SET_STRING_ELT(names,  i++, Rf_mkChar("commit"));
-    SET_VECTOR_ELT(result, i,   Rf_allocVector(STRSXP,  cb_data.n));
-    SET_STRING_ELT(names,  i++, Rf_mkChar("author"));
-    SET_VECTOR_ELT(result, i,   Rf_allocVector(REALSXP, cb_data.n));
-    SET_STRING_ELT(names,  i++, Rf_mkChar("when"));
+    SET_VECTOR_ELT(result, 0, table = git2r_odb_stats_table(
+                       "type,count,size", objects_types, GIT_OBJ_TAG));
+    SET_STRING_ELT(names, 0, Rf_mkChar("objects"));
+    for (i = 0; i < GIT_OBJ_TAG; i++) {
+        SET_STRING_ELT(VECTOR_ELT(table, 0), i, Rf_mkChar(types[i]));
+        INTEGER(VECTOR_ELT(table, 1))[i] = data.count[i];
+        REAL(VECTOR_ELT(table, 2))[i] = data.size[i];
+    }
 
-    cb_data.list = result;
-    cb_data.n = 0;
-    err = git_odb_foreach(odb, &git2r_odb_blobs_cb, &cb_data);
+    SET_VECTOR_ELT(result, 1, table = git2r_odb_stats_table(
+                       "name,objects,deltas,size,uncompressed", packs_types,
+                       git_array_size(data.packs)));
+    SET_STRING_ELT(names, 1, Rf_mkChar("packs"));
+    for (i = 0; i < git_array_size(data.packs); i++) {
+        git2r_odb_stats_pack *pack = git_array_get(data.packs, i);
+
+        SET_STRING_ELT(VECTOR_ELT(table, 0), i, git2r_odb_stats_string(pack->name));
+        INTEGER(VECTOR_ELT(table, 1))[i] = pack->objects;
+        INTEGER(VECTOR_ELT(table, 2))[i] = pack->deltas;
+        REAL(VECTOR_ELT(table, 3))[i] = pack->size;
+        REAL(VECTOR_ELT(table, 4))[i] = pack->uncompressed;
+    }
+
+    SET_VECTOR_ELT(result, 2, table = git2r_odb_stats_table(
+                       "sha,size,path", blobs_types, data.blobs.n));
+    SET_STRING_ELT(names, 2, Rf_mkChar("blobs"));
+    for (i = 0; i < data.blobs.n; i++) {
+        git2r_odb_stats_item *item = &data.blobs.items[i];
+
+        SET_STRING_ELT(VECTOR_ELT(table, 0), i, git2r_odb_stats_sha(&item->id));
+        REAL(VECTOR_ELT(table, 1))[i] = item->size;
+        SET_STRING_ELT(VECTOR_ELT(table, 2), i, git2r_odb_stats_string(item->path));
+    }
+
+    SET_VECTOR_ELT(result, 3, table = git2r_odb_stats_table(
+                       "sha,entries,size,path", trees_types, data.trees.n));
+    SET_STRING_ELT(names, 3, Rf_mkChar("trees"));
+    for (i = 0; i < data.trees.n; i++) {
+        git2r_odb_stats_item *item = &data.trees.items[i];
+
+        SET_STRING_ELT(VECTOR_ELT(table, 0), i, git2r_odb_stats_sha(&item->id));
+        INTEGER(VECTOR_ELT(table, 1))[i] = item->count;
+        REAL(VECTOR_ELT(table, 2))[i] = item->size;
+        SET_STRING_ELT(VECTOR_ELT(table, 3), i, git2r_odb_stats_string(item->path));
+    }
+
+    SET_VECTOR_ELT(result, 4, table = git2r_odb_stats_table(
+                       "sha,size,parents", commits_types, data.commits.n));
+    SET_STRING_ELT(names, 4, Rf_mkChar("commits"));
+    for (i = 0; i < data.commits.n; i++) {
+        git2r_odb_stats_item *item = &data.commits.items[i];
+
+        SET_STRING_ELT(VECTOR_ELT(table, 0), i, git2r_odb_stats_sha(&item->id));
+        REAL(VECTOR_ELT(table, 1))[i] = item->size;
+        INTEGER(VECTOR_ELT(table, 2))[i] = item->count;
+    }
+
+    SET_VECTOR_ELT(result, 5, table = git2r_odb_stats_table(
+                       "sha,type,depth,size", deltas_types, data.deltas.n));
+    SET_STRING_ELT(names, 5, Rf_mkChar("deltas"));
+    for (i = 0; i < data.deltas.n; i++) {
+        git2r_odb_stats_item *item = &data.deltas.items[i];
+
+        SET_STRING_ELT(VECTOR_ELT(table, 0), i, git2r_odb_stats_sha(&item->id));
+        SET_STRING_ELT(VECTOR_ELT(table, 1), i, Rf_mkChar(types[item->type - 1]));
+        INTEGER(VECTOR_ELT(table, 2))[i] = item->count;
+        REAL(VECTOR_ELT(table, 3))[i] = item->size;
+    }
+
+    SET_VECTOR_ELT(result, 6, table = git2r_odb_stats_table(
+                       "path,depth,commit", paths_types, data.paths.n));
+    SET_STRING_ELT(names, 6, Rf_mkChar("paths"));
+    for (i = 0; i < data.paths.n; i++) {
+        git2r_odb_stats_item *item = &data.paths.items[i];
+
+        SET_STRING_ELT(VECTOR_ELT(table, 0), i, Rf_mkChar(item->path));
+        INTEGER(VECTOR_ELT(table, 1))[i] = item->count;
+        SET_STRING_ELT(VECTOR_ELT(table, 2), i, git2r_odb_stats_sha(&item->id));
+    }
 
 cleanup:
-    if (repository)
-        git_repository_free(repository);
+    git2r_odb_stats_data_free(&data);
+    git_buf_free(&objects);
 
-    if (odb)
-        git_odb_free(odb);
+    if (data.repository)
+        git_repository_free(data.repository);
 
     if (!Rf_isNull(result))
         UNPROTECT(1);
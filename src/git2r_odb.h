@@ -22,9 +22,47 @@
 #include <R.h>
 #include <Rinternals.h>
 
+#include "git2.h"
+#include "array.h"
+#include "pool.h"
+
+/**
+ * A blob in the tree of a commit
+ */
+typedef struct {
+    git_oid id;
+    git_oid commit;
+    const char *path;
+    const char *name;
+    const char *author;
+    double when;
+    size_t len;
+} git2r_odb_blob;
+
+/**
+ * The blobs collected by git2r_odb_blobs_collect
+ *
+ * If 'progress' is set, it is called with the number of objects seen
+ * so far; a non-zero return value stops the collection.
+ */
+typedef struct {
+    git_array_t(git2r_odb_blob) blobs;
+    git_pool strings;
+    size_t n_objects;
+    int (*progress)(size_t n_objects, void *payload);
+    void *payload;
+} git2r_odb_blobs_data;
+
+void git2r_odb_blobs_init(git2r_odb_blobs_data *data);
+void git2r_odb_blobs_free(git2r_odb_blobs_data *data);
+int git2r_odb_blobs_collect(
+    git2r_odb_blobs_data *data,
+    git_repository *repository);
+SEXP git2r_odb_blobs_list(const git2r_odb_blobs_data *data);
 SEXP git2r_odb_blobs(SEXP repo);
 SEXP git2r_odb_hash(SEXP data);
 SEXP git2r_odb_hashfile(SEXP path);
 SEXP git2r_odb_objects(SEXP repo);
+SEXP git2r_odb_stats(SEXP repo, SEXP n);
 
 #endif
@@ -0,0 +1,105 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "common.h"
+#include "thread-utils.h"
+
+#include "git2r_parallel.h"
+
+/**
+ * The items to work on, taken in order by the workers
+ */
+typedef struct {
+    size_t n;
+    size_t next;
+    git2r_parallel_cb cb;
+    void *payload;
+    git_mutex lock;
+} git2r_parallel_data;
+
+static void *git2r_parallel_worker(void *payload)
+{
+    git2r_parallel_data *data = payload;
+
+    for (;;) {
+        size_t i;
+
+        git_mutex_lock(&data->lock);
+        i = data->next++;
+        git_mutex_unlock(&data->lock);
+
+        if (i >= data->n)
+            break;
+
+        data->cb(i, data->payload);
+    }
+
+    return NULL;
+}
+
+/**
+ * Call 'cb' for each item 0 to n - 1 with at most 'jobs' parallel
+ * workers
+ *
+ * The calling thread is one of the workers. The items are done in
+ * order, one by one, when libgit2 is built without threads (no
+ * GIT_THREADS), or if no thread could be created.
+ *
+ * @param n The number of items
+ * @param jobs The maximum number of parallel workers
+ * @param cb The function to call for each item
+ * @param payload Passed to cb
+ */
+void git2r_parallel_for(size_t n, int jobs, git2r_parallel_cb cb, void *payload)
+{
+    git2r_parallel_data data;
+    git_thread *threads = NULL;
+    size_t i, n_threads = 0;
+
+    if (git_mutex_init(&data.lock)) {
+        for (i = 0; i < n; i++)
+            cb(i, payload);
+        return;
+    }
+
+    data.n = n;
+    data.next = 0;
+    data.cb = cb;
+    data.payload = payload;
+
+#ifdef GIT_THREADS
+    if (jobs > 1 && n > 1) {
+        size_t max_threads = ((size_t)jobs < n ? (size_t)jobs : n) - 1;
+
+        threads = calloc(max_threads, sizeof(git_thread));
+        while (threads && n_threads < max_threads &&
+               !git_thread_create(&threads[n_threads], git2r_parallel_worker, &data))
+            n_threads++;
+    }
+#else
+    GIT_UNUSED(jobs);
+#endif
+
+    git2r_parallel_worker(&data);
+
+    while (n_threads > 0)
+        git_thread_join(&threads[--n_threads], NULL);
+
+    free(threads);
+    git_mutex_free(&data.lock);
+}
@@ -18,10 +18,13 @@
 
 #include <Rdefines.h>
 #include "git2.h"
+#include "push.h"
+#include "remote.h"
 
 #include "git2r_arg.h"
 #include "git2r_cred.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_push.h"
 #include "git2r_repository.h"
 #include "git2r_signature.h"
@@ -57,11 +60,12 @@ static int git2r_nothing_to_push(SEXP refspec)
  * @param name The remote to push to
  * @param refspec The string vector of refspec to push
  * @param credentials The credentials for remote repository access.
- * @return R_NilValue
+ * @return R_NilValue if nothing to push, else S3 class git_push_stats
  */
 SEXP git2r_push(SEXP repo, SEXP name, SEXP refspec, SEXP credentials)
 {
-    int err;
+    int err, nprotect = 0;
+    SEXP result = R_NilValue;
     git_remote *remote = NULL;
     git_repository *repository = NULL;
     git_strarray c_refspecs = {0};
@@ -95,6 +99,22 @@ SEXP git2r_push(SEXP repo, SEXP name, SEXP refspec, SEXP credentials)
         goto cleanup;
 
     err = git_remote_push(remote, &c_refspecs, &opts);
+    if (err || !remote->push)
+        goto cleanup;
+
+    PROTECT(result = git2r_S3_new(git2r_S3_class__git_push_stats,
+                                  git2r_S3_items__git_push_stats));
+    nprotect++;
+    SET_VECTOR_ELT(result, git2r_S3_item__git_push_stats__commits,
+                   Rf_ScalarInteger(remote->push->stats.commits));
+    SET_VECTOR_ELT(result, git2r_S3_item__git_push_stats__objects,
+                   Rf_ScalarInteger(remote->push->stats.objects));
+    SET_VECTOR_ELT(result, git2r_S3_item__git_push_stats__bases,
+                   Rf_ScalarInteger(remote->push->stats.bases));
+    SET_VECTOR_ELT(result, git2r_S3_item__git_push_stats__deltas,
+                   Rf_ScalarInteger(remote->push->stats.deltas));
+    SET_VECTOR_ELT(result, git2r_S3_item__git_push_stats__thin_deltas,
+                   Rf_ScalarInteger(remote->push->stats.thin_deltas));
 
 cleanup:
     if (c_refspecs.strings)
@@ -109,11 +129,14 @@ cleanup:
     if (repository)
         git_repository_free(repository);
 
+    if (nprotect)
+        UNPROTECT(nprotect);
+
     if (err)
         git2r_error(
             __func__,
             giterr_last(),
             git2r_err_unable_to_authenticate, NULL);
 
-    return R_NilValue;
+    return result;
 }
@@ -0,0 +1,649 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <Rdefines.h>
+#include "git2.h"
+#include "buffer.h"
+
+#include "git2r_arg.h"
+#include "git2r_error.h"
+#include "git2r_objects.h"
+#include "git2r_rebase.h"
+#include "git2r_repository.h"
+#include "git2r_signature.h"
+
+/**
+ * The commits that are applied in memory, one row for each commit,
+ * and the paths of the conflicts that stopped it.
+ */
+typedef struct {
+    SEXP commit;
+    SEXP sha;
+    SEXP status;
+    size_t n;
+    SEXP conflicts;
+} git2r_rebase_data;
+
+/**
+ * Allocate the columns for n commits
+ *
+ * @param data The columns of the result
+ * @param n The number of commits
+ * @return The number of protected objects
+ */
+static int git2r_rebase_data_init(git2r_rebase_data *data, size_t n)
+{
+    PROTECT(data->commit = Rf_allocVector(STRSXP, n));
+    PROTECT(data->sha = Rf_allocVector(STRSXP, n));
+    PROTECT(data->status = Rf_allocVector(STRSXP, n));
+    data->n = 0;
+    data->conflicts = R_NilValue;
+
+    return 3;
+}
+
+/**
+ * Add a commit to the result
+ *
+ * @param data The columns of the result
+ * @param commit The id of the commit that was applied
+ * @param sha The id of the new commit, or NULL if none was created
+ * @param status One of "applied", "empty" or "conflict"
+ * @return void
+ */
+static void git2r_rebase_data_add(
+    git2r_rebase_data *data,
+    const git_oid *commit,
+    const git_oid *sha,
+    const char *status)
+{
+    char hex[GIT_OID_HEXSZ + 1];
+
+    git_oid_tostr(hex, sizeof(hex), commit);
+    SET_STRING_ELT(data->commit, data->n, Rf_mkChar(hex));
+    if (sha) {
+        git_oid_tostr(hex, sizeof(hex), sha);
+        SET_STRING_ELT(data->sha, data->n, Rf_mkChar(hex));
+    } else {
+        SET_STRING_ELT(data->sha, data->n, NA_STRING);
+    }
+    SET_STRING_ELT(data->status, data->n, Rf_mkChar(status));
+    data->n++;
+}
+
+/**
+ * Add the conflicts in an index to the result
+ *
+ * @param data The columns of the result
+ * @param commit The id of the commit that conflicted
+ * @param index The index with conflicts
+ * @param nprotect Incremented with the number of protected objects,
+ * the conflicts are protected until the caller unprotects them.
+ * @return 0 on success, or error code
+ */
+static int git2r_rebase_data_conflicts(
+    git2r_rebase_data *data,
+    const git_oid *commit,
+    git_index *index,
+    int *nprotect)
+{
+    int err;
+    size_t i, n = 0;
+    char hex[GIT_OID_HEXSZ + 1];
+    const git_index_entry *ancestor, *ours, *theirs;
+    git_index_conflict_iterator *iter = NULL;
+    SEXP names, commits, paths;
+
+    git2r_rebase_data_add(data, commit, NULL, "conflict");
+
+    err = git_index_conflict_iterator_new(&iter, index);
+    if (err)
+        return err;
+    while (!(err = git_index_conflict_next(&ancestor, &ours, &theirs, iter)))
+        n++;
+    git_index_conflict_iterator_free(iter);
+    iter = NULL;
+    if (err != GIT_ITEROVER)
+        return err;
+
+    git_oid_tostr(hex, sizeof(hex), commit);
+    PROTECT(data->conflicts = Rf_allocVector(VECSXP, 2));
+    (*nprotect)++;
+    Rf_setAttrib(data->conflicts, R_NamesSymbol, names = Rf_allocVector(STRSXP, 2));
+    SET_STRING_ELT(names, 0, Rf_mkChar("commit"));
+    SET_STRING_ELT(names, 1, Rf_mkChar("path"));
+    SET_VECTOR_ELT(data->conflicts, 0, commits = Rf_allocVector(STRSXP, n));
+    SET_VECTOR_ELT(data->conflicts, 1, paths = Rf_allocVector(STRSXP, n));
+
+    err = git_index_conflict_iterator_new(&iter, index);
+    if (err)
+        return err;
+    for (i = 0; i < n; i++) {
+        const git_index_entry *entry;
+
+        err = git_index_conflict_next(&ancestor, &ours, &theirs, iter);
+        if (err)
+            break;
+
+        entry = ours ? ours : (theirs ? theirs : ancestor);
+        SET_STRING_ELT(commits, i, Rf_mkChar(hex));
+        SET_STRING_ELT(paths, i, Rf_mkChar(entry->path));
+    }
+    git_index_conflict_iterator_free(iter);
+
+    return err;
+}
+
+/**
+ * Create the result list from the columns
+ *
+ * @param data The columns of the result
+ * @return A list with the items 'commits' and 'conflicts'
+ */
+static SEXP git2r_rebase_data_result(git2r_rebase_data *data)
+{
+    SEXP result, names, commits;
+
+    PROTECT(result = Rf_allocVector(VECSXP, 2));
+    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 2));
+    SET_STRING_ELT(names, 0, Rf_mkChar("commits"));
+    SET_STRING_ELT(names, 1, Rf_mkChar("conflicts"));
+
+    SET_VECTOR_ELT(result, 0, commits = Rf_allocVector(VECSXP, 3));
+    Rf_setAttrib(commits, R_NamesSymbol, names = Rf_allocVector(STRSXP, 3));
+    SET_STRING_ELT(names, 0, Rf_mkChar("commit"));
+    SET_STRING_ELT(names, 1, Rf_mkChar("sha"));
+    SET_STRING_ELT(names, 2, Rf_mkChar("status"));
+    SET_VECTOR_ELT(commits, 0, Rf_lengthgets(data->commit, data->n));
+    SET_VECTOR_ELT(commits, 1, Rf_lengthgets(data->sha, data->n));
+    SET_VECTOR_ELT(commits, 2, Rf_lengthgets(data->status, data->n));
+
+    if (Rf_isNull(data->conflicts)) {
+        SEXP conflicts;
+
+        SET_VECTOR_ELT(result, 1, conflicts = Rf_allocVector(VECSXP, 2));
+        Rf_setAttrib(conflicts, R_NamesSymbol, names = Rf_allocVector(STRSXP, 2));
+        SET_STRING_ELT(names, 0, Rf_mkChar("commit"));
+        SET_STRING_ELT(names, 1, Rf_mkChar("path"));
+        SET_VECTOR_ELT(conflicts, 0, Rf_allocVector(STRSXP, 0));
+        SET_VECTOR_ELT(conflicts, 1, Rf_allocVector(STRSXP, 0));
+    } else {
+        SET_VECTOR_ELT(result, 1, data->conflicts);
+    }
+
+    UNPROTECT(1);
+
+    return result;
+}
+
+/**
+ * Lookup the commit of a revision
+ *
+ * @param out Pointer to the looked up commit
+ * @param repository The repository
+ * @param revision The revision string, e.g. a sha
+ * @return 0 on success, or error code
+ */
+static int git2r_rebase_lookup(
+    git_commit **out,
+    git_repository *repository,
+    const char *revision)
+{
+    int err;
+    git_object *object = NULL;
+
+    err = git_revparse_single(&object, repository, revision);
+    if (err)
+        return err;
+
+    err = git_object_peel((git_object**)out, object, GIT_OBJ_COMMIT);
+    git_object_free(object);
+
+    return err;
+}
+
+/**
+ * Lookup the local branch of an S4 class git_branch that is updated
+ * in memory. The working tree is not updated, so the branch must not
+ * be checked out.
+ *
+ * @param out Pointer to the looked up reference
+ * @param repository The repository
+ * @param branch S4 class git_branch
+ * @return 0 on success, or error code
+ */
+static int git2r_rebase_branch(
+    git_reference **out,
+    git_repository *repository,
+    SEXP branch)
+{
+    int err;
+    const char *name;
+
+    name = CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0));
+    err = git_branch_lookup(out, repository, name, GIT_BRANCH_LOCAL);
+    if (err)
+        return err;
+
+    if (!git_repository_is_bare(repository) && git_branch_is_checked_out(*out)) {
+        giterr_set_str(GITERR_NONE, git2r_err_branch_checked_out);
+        return GIT_ERROR;
+    }
+
+    return 0;
+}
+
+/**
+ * Cherry-pick or revert commits in memory
+ *
+ * Each commit is applied on top of the previous, starting at the tip
+ * of the branch. The branch is moved to the last new commit if all
+ * commits applied without conflicts.
+ *
+ * @param data The columns of the result
+ * @param repository The repository
+ * @param reference The branch
+ * @param commits The revisions of the commits to apply
+ * @param revert Revert the commits instead of cherry-picking them
+ * @param committer Who is committing the new commits
+ * @param nprotect Incremented with the number of protected objects
+ * @return 0 on success, or error code
+ */
+static int git2r_rebase_apply(
+    git2r_rebase_data *data,
+    git_repository *repository,
+    git_reference *reference,
+    SEXP commits,
+    int revert,
+    const git_signature *committer,
+    int *nprotect)
+{
+    int err;
+    size_t i, n;
+    git_buf message = GIT_BUF_INIT;
+    git_commit *head = NULL;
+    git_reference *new_ref = NULL;
+
+    err = git_reference_peel((git_object**)&head, reference, GIT_OBJ_COMMIT);
+    if (err)
+        return err;
+
+    n = Rf_length(commits);
+    for (i = 0; i < n; i++) {
+        git_oid oid;
+        git_commit *commit = NULL, *new_head = NULL;
+        git_index *index = NULL;
+        git_tree *tree = NULL;
+        const git_signature *author;
+
+        err = git2r_rebase_lookup(
+            &commit,
+            repository,
+            CHAR(STRING_ELT(commits, i)));
+        if (err)
+            goto cleanup;
+
+        if (revert)
+            err = git_revert_commit(&index, repository, commit, head, 0, NULL);
+        else
+            err = git_cherrypick_commit(&index, repository, commit, head, 0, NULL);
+        if (err)
+            goto next;
+
+        if (git_index_has_conflicts(index)) {
+            err = git2r_rebase_data_conflicts(
+                data, git_commit_id(commit), index, nprotect);
+            git_index_free(index);
+            git_commit_free(commit);
+            goto cleanup;
+        }
+
+        err = git_index_write_tree_to(&oid, index, repository);
+        if (err)
+            goto next;
+
+        if (git_oid_equal(&oid, git_commit_tree_id(head))) {
+            git2r_rebase_data_add(data, git_commit_id(commit), NULL, "empty");
+            goto next;
+        }
+
+        err = git_tree_lookup(&tree, repository, &oid);
+        if (err)
+            goto next;
+
+        git_buf_clear(&message);
+        if (revert) {
+            char hex[GIT_OID_HEXSZ + 1];
+
+            git_oid_tostr(hex, sizeof(hex), git_commit_id(commit));
+            git_buf_printf(&message, "Revert \"%s\"\n\nThis reverts commit %s.\n",
+                           git_commit_summary(commit), hex);
+            author = committer;
+        } else {
+            git_buf_puts(&message, git_commit_message(commit));
+            author = git_commit_author(commit);
+        }
+        if (git_buf_oom(&message)) {
+            err = GIT_ERROR;
+            goto next;
+        }
+
+        err = git_commit_create(
+            &oid,
+            repository,
+            NULL,
+            author,
+            committer,
+            revert ? NULL : git_commit_message_encoding(commit),
+            message.ptr,
+            tree,
+            1,
+            (const git_commit**)&head);
+        if (err)
+            goto next;
+
+        err = git_commit_lookup(&new_head, repository, &oid);
+        if (err)
+            goto next;
+
+        git2r_rebase_data_add(data, git_commit_id(commit), &oid, "applied");
+        git_commit_free(head);
+        head = new_head;
+
+    next:
+        git_tree_free(tree);
+        git_index_free(index);
+        git_commit_free(commit);
+        if (err)
+            goto cleanup;
+    }
+
+    if (!git_oid_equal(git_commit_id(head), git_reference_target(reference))) {
+        git_buf_clear(&message);
+        git_buf_printf(&message, "%s: %lu commits",
+                       revert ? "revert" : "cherry-pick",
+                       (unsigned long)n);
+        err = git_reference_set_target(
+            &new_ref,
+            reference,
+            git_commit_id(head),
+            message.ptr);
+    }
+
+cleanup:
+    git_buf_free(&message);
+    git_reference_free(new_ref);
+    git_commit_free(head);
+
+    return err;
+}
+
+/**
+ * Cherry-pick or revert commits in memory, see git2r_rebase_apply.
+ */
+static SEXP git2r_rebase_apply_commits(
+    const char *func,
+    SEXP commits,
+    SEXP branch,
+    SEXP committer,
+    int revert)
+{
+    int err, nprotect = 0;
+    SEXP result = R_NilValue;
+    git2r_rebase_data data;
+    git_reference *reference = NULL;
+    git_repository *repository = NULL;
+    git_signature *c_committer = NULL;
+
+    if (git2r_arg_check_string_vec(commits))
+        git2r_error(func, NULL, "'commits'", git2r_err_string_vec_arg);
+    if (git2r_arg_check_branch(branch))
+        git2r_error(func, NULL, "'branch'", git2r_err_branch_arg);
+    if (git2r_arg_check_signature(committer))
+        git2r_error(func, NULL, "'committer'", git2r_err_signature_arg);
+
+    repository = git2r_repository_open(GET_SLOT(branch, git2r_sym(repo)));
+    if (!repository)
+        git2r_error(func, NULL, git2r_err_invalid_repository, NULL);
+
+    err = git2r_signature_from_arg(&c_committer, committer);
+    if (err)
+        goto cleanup;
+
+    err = git2r_rebase_branch(&reference, repository, branch);
+    if (err)
+        goto cleanup;
+
+    nprotect += git2r_rebase_data_init(&data, Rf_length(commits));
+    err = git2r_rebase_apply(
+        &data,
+        repository,
+        reference,
+        commits,
+        revert,
+        c_committer,
+        &nprotect);
+    if (err)
+        goto cleanup;
+
+    PROTECT(result = git2r_rebase_data_result(&data));
+    nprotect++;
+
+cleanup:
+    git_signature_free(c_committer);
+    git_reference_free(reference);
+    git_repository_free(repository);
+
+    if (nprotect)
+        UNPROTECT(nprotect);
+
+    if (err)
+        git2r_error(func, giterr_last(), NULL, NULL);
+
+    return result;
+}
+
+/**
+ * Cherry-pick commits onto a branch in memory
+ *
+ * @param commits Character vector with the revisions of the commits
+ * to cherry-pick, in the order to apply them.
+ * @param branch S4 class git_branch, a local branch that is not
+ * checked out.
+ * @param committer S4 class git_signature
+ * @return A list with the items 'commits' and 'conflicts'.
+ */
+SEXP git2r_cherrypick(SEXP commits, SEXP branch, SEXP committer)
+{
+    return git2r_rebase_apply_commits(__func__, commits, branch, committer, 0);
+}
+
+/**
+ * Revert commits on a branch in memory
+ *
+ * @param commits Character vector with the revisions of the commits
+ * to revert, in the order to revert them.
+ * @param branch S4 class git_branch, a local branch that is not
+ * checked out.
+ * @param committer S4 class git_signature
+ * @return A list with the items 'commits' and 'conflicts'.
+ */
+SEXP git2r_revert(SEXP commits, SEXP branch, SEXP committer)
+{
+    return git2r_rebase_apply_commits(__func__, commits, branch, committer, 1);
+}
+
+/**
+ * Rebase a branch in memory
+ *
+ * The commits of the branch that are not in upstream are applied on
+ * top of onto. The branch is moved to the last new commit if all
+ * commits applied without conflicts.
+ *
+ * @param branch S4 class git_branch, a local branch that is not
+ * checked out.
+ * @param upstream The revision of the upstream commit.
+ * @param onto The revision to rebase onto, or R_NilValue to rebase
+ * onto upstream.
+ * @param committer S4 class git_signature
+ * @return A list with the items 'commits' and 'conflicts'.
+ */
+SEXP git2r_rebase(SEXP branch, SEXP upstream, SEXP onto, SEXP committer)
+{
+    int err, nprotect = 0;
+    SEXP result = R_NilValue;
+    git_oid tip;
+    git2r_rebase_data data;
+    git_commit *commit = NULL;
+    git_annotated_commit *branch_head = NULL;
+    git_annotated_commit *upstream_head = NULL;
+    git_annotated_commit *onto_head = NULL;
+    git_rebase *rebase = NULL;
+    git_rebase_operation *operation;
+    git_rebase_options opts = GIT_REBASE_OPTIONS_INIT;
+    git_reference *reference = NULL, *new_ref = NULL;
+    git_repository *repository = NULL;
+    git_signature *c_committer = NULL;
+
+    if (git2r_arg_check_branch(branch))
+        git2r_error(__func__, NULL, "'branch'", git2r_err_branch_arg);
+    if (git2r_arg_check_string(upstream))
+        git2r_error(__func__, NULL, "'upstream'", git2r_err_string_arg);
+    if (!Rf_isNull(onto) && git2r_arg_check_string(onto))
+        git2r_error(__func__, NULL, "'onto'", git2r_err_string_arg);
+    if (git2r_arg_check_signature(committer))
+        git2r_error(__func__, NULL, "'committer'", git2r_err_signature_arg);
+
+    repository = git2r_repository_open(GET_SLOT(branch, git2r_sym(repo)));
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    err = git2r_signature_from_arg(&c_committer, committer);
+    if (err)
+        goto cleanup;
+
+    err = git2r_rebase_branch(&reference, repository, branch);
+    if (err)
+        goto cleanup;
+
+    err = git_annotated_commit_from_ref(&branch_head, repository, reference);
+    if (err)
+        goto cleanup;
+
+    err = git2r_rebase_lookup(&commit, repository, CHAR(STRING_ELT(upstream, 0)));
+    if (err)
+        goto cleanup;
+    err = git_annotated_commit_lookup(&upstream_head, repository, git_commit_id(commit));
+    git_commit_free(commit);
+    commit = NULL;
+    if (err)
+        goto cleanup;
+    git_oid_cpy(&tip, git_annotated_commit_id(upstream_head));
+
+    if (!Rf_isNull(onto)) {
+        err = git2r_rebase_lookup(&commit, repository, CHAR(STRING_ELT(onto, 0)));
+        if (err)
+            goto cleanup;
+        err = git_annotated_commit_lookup(&onto_head, repository, git_commit_id(commit));
+        git_commit_free(commit);
+        commit = NULL;
+        if (err)
+            goto cleanup;
+        git_oid_cpy(&tip, git_annotated_commit_id(onto_head));
+    }
+
+    opts.inmemory = 1;
+    err = git_rebase_init(
+        &rebase,
+        repository,
+        branch_head,
+        upstream_head,
+        onto_head,
+        &opts);
+    if (err)
+        goto cleanup;
+
+    nprotect += git2r_rebase_data_init(
+        &data,
+        git_rebase_operation_entrycount(rebase));
+
+    while (!(err = git_rebase_next(&operation, rebase))) {
+        git_oid oid;
+        git_index *index = NULL;
+
+        err = git_rebase_inmemory_index(&index, rebase);
+        if (err)
+            goto cleanup;
+
+        if (git_index_has_conflicts(index)) {
+            err = git2r_rebase_data_conflicts(
+                &data, &operation->id, index, &nprotect);
+            git_index_free(index);
+            goto cleanup;
+        }
+        git_index_free(index);
+
+        err = git_rebase_commit(&oid, rebase, NULL, c_committer, NULL, NULL);
+        if (err == GIT_EAPPLIED) {
+            giterr_clear();
+            git2r_rebase_data_add(&data, &operation->id, NULL, "empty");
+        } else if (err) {
+            goto cleanup;
+        } else {
+            git2r_rebase_data_add(&data, &operation->id, &oid, "applied");
+            git_oid_cpy(&tip, &oid);
+        }
+    }
+
+    if (err != GIT_ITEROVER)
+        goto cleanup;
+
+    err = git_rebase_finish(rebase, c_committer);
+    if (err)
+        goto cleanup;
+
+    if (!git_oid_equal(&tip, git_reference_target(reference))) {
+        err = git_reference_set_target(&new_ref, reference, &tip, "rebase: finished");
+        if (err)
+            goto cleanup;
+    }
+
+cleanup:
+    if (!err && nprotect) {
+        PROTECT(result = git2r_rebase_data_result(&data));
+        nprotect++;
+    }
+
+    git_commit_free(commit);
+    git_annotated_commit_free(branch_head);
+    git_annotated_commit_free(upstream_head);
+    git_annotated_commit_free(onto_head);
+    git_rebase_free(rebase);
+    git_reference_free(new_ref);
+    git_reference_free(reference);
+    git_signature_free(c_committer);
+    git_repository_free(repository);
+
+    if (nprotect)
+        UNPROTECT(nprotect);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
@@ -21,6 +21,7 @@
 
 #include "git2r_arg.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_reference.h"
 #include "git2r_repository.h"
 
@@ -82,11 +83,11 @@ cleanup:
 void git2r_reference_init(git_reference *source, SEXP dest)
 {
     char sha[GIT_OID_HEXSZ + 1];
-    SEXP s_name = Rf_install("name");
-    SEXP s_shorthand = Rf_install("shorthand");
-    SEXP s_type = Rf_install("type");
-    SEXP s_sha = Rf_install("sha");
-    SEXP s_target = Rf_install("target");
+    SEXP s_name = git2r_sym(name);
+    SEXP s_shorthand = git2r_sym(shorthand);
+    SEXP s_type = git2r_sym(type);
+    SEXP s_sha = git2r_sym(sha);
+    SEXP s_target = git2r_sym(target);
 
     SET_SLOT(dest, s_name, Rf_mkString(git_reference_name(source)));
     SET_SLOT(dest, s_shorthand, Rf_mkString(git_reference_shorthand(source)));
@@ -147,7 +148,7 @@ SEXP git2r_reference_list(SEXP repo)
         SET_VECTOR_ELT(
             result,
             i,
-            reference = NEW_OBJECT(MAKE_CLASS("git_reference")));
+            reference = git2r_S4_new(git2r_S4_class__git_reference));
         git2r_reference_init(ref, reference);
         SET_STRING_ELT(names, i, Rf_mkChar(ref_list.strings[i]));
 
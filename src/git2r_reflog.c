@@ -21,6 +21,7 @@
 
 #include "git2r_arg.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_reflog.h"
 #include "git2r_repository.h"
 #include "git2r_signature.h"
@@ -46,12 +47,12 @@ void git2r_reflog_entry_init(
     const char *message;
     const git_signature *committer;
     char sha[GIT_OID_HEXSZ + 1];
-    SEXP s_sha = Rf_install("sha");
-    SEXP s_index = Rf_install("index");
-    SEXP s_committer = Rf_install("committer");
-    SEXP s_message = Rf_install("message");
-    SEXP s_refname = Rf_install("refname");
-    SEXP s_repo = Rf_install("repo");
+    SEXP s_sha = git2r_sym(sha);
+    SEXP s_index = git2r_sym(index);
+    SEXP s_committer = git2r_sym(committer);
+    SEXP s_message = git2r_sym(message);
+    SEXP s_refname = git2r_sym(refname);
+    SEXP s_repo = git2r_sym(repo);
 
     git_oid_fmt(sha, git_reflog_entry_id_new(source));
     sha[GIT_OID_HEXSZ] = '\0';
@@ -110,7 +111,7 @@ SEXP git2r_reflog_list(SEXP repo, SEXP ref)
 
             SET_VECTOR_ELT(result,
                            i,
-                           item = NEW_OBJECT(MAKE_CLASS("git_reflog_entry")));
+                           item = git2r_S4_new(git2r_S4_class__git_reflog_entry));
             git2r_reflog_entry_init(entry, i, repo, ref, item);
         }
     }
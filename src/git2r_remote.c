@@ -196,10 +196,9 @@ SEXP git2r_remote_fetch(
         goto cleanup;
 
     stats = git_remote_stats(remote);
-    PROTECT(result = Rf_mkNamed(VECSXP, git2r_S3_items__git_transfer_progress));
+    PROTECT(result = git2r_S3_new(git2r_S3_class__git_transfer_progress,
+                                  git2r_S3_items__git_transfer_progress));
     nprotect++;
-    Rf_setAttrib(result, R_ClassSymbol,
-                 Rf_mkString(git2r_S3_class__git_transfer_progress));
     git2r_transfer_progress_init(stats, result);
 
 cleanup:
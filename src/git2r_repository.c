@@ -23,11 +23,16 @@
 #include "git2r_branch.h"
 #include "git2r_commit.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_repository.h"
 #include "git2r_signature.h"
+#include "git2r_status.h"
 #include "git2r_tag.h"
 #include "git2r_tree.h"
+#include "array.h"
 #include "buffer.h"
+#include "oidmap.h"
+#include "strmap.h"
 
 /**
  * Get repo slot from S4 class git_repository
@@ -43,7 +48,7 @@ git_repository* git2r_repository_open(SEXP repo)
     if (git2r_arg_check_repository(repo))
         return NULL;
 
-    path = GET_SLOT(repo, Rf_install("path"));
+    path = GET_SLOT(repo, git2r_sym(path));
     if (git2r_arg_check_string(path))
         return NULL;
 
@@ -86,13 +91,13 @@ static int git2r_repository_fetchhead_foreach_cb(
     if (!Rf_isNull(cb_data->list)) {
         char sha[GIT_OID_HEXSZ + 1];
         SEXP fetch_head;
-        SEXP s_ref_name = Rf_install("ref_name");
-        SEXP s_remote_url = Rf_install("remote_url");
-        SEXP s_sha = Rf_install("sha");
-        SEXP s_is_merge = Rf_install("is_merge");
-        SEXP s_repo = Rf_install("repo");
+        SEXP s_ref_name = git2r_sym(ref_name);
+        SEXP s_remote_url = git2r_sym(remote_url);
+        SEXP s_sha = git2r_sym(sha);
+        SEXP s_is_merge = git2r_sym(is_merge);
+        SEXP s_repo = git2r_sym(repo);
 
-        PROTECT(fetch_head = NEW_OBJECT(MAKE_CLASS("git_fetch_head")));
+        PROTECT(fetch_head = git2r_S4_new(git2r_S4_class__git_fetch_head));
         SET_VECTOR_ELT(cb_data->list, cb_data->n, fetch_head);
         SET_SLOT(fetch_head, s_ref_name, Rf_mkString(ref_name));
         SET_SLOT(fetch_head, s_remote_url, Rf_mkString(remote_url));
@@ -191,7 +196,7 @@ SEXP git2r_repository_head(SEXP repo)
         git_branch_t type = GIT_BRANCH_LOCAL;
         if (git_reference_is_remote(reference))
             type = GIT_BRANCH_REMOTE;
-        PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_branch")));
+        PROTECT(result = git2r_S4_new(git2r_S4_class__git_branch));
         err = git2r_branch_init(reference, type, repo, result);
     } else {
         err = git_commit_lookup(
@@ -200,7 +205,7 @@ SEXP git2r_repository_head(SEXP repo)
             git_reference_target(reference));
         if (err)
             goto cleanup;
-        PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_commit")));
+        PROTECT(result = git2r_S4_new(git2r_S4_class__git_commit));
         git2r_commit_init(commit, repo, result);
     }
 
@@ -455,11 +460,11 @@ SEXP git2r_repository_set_head_detached(SEXP commit)
     if (git2r_arg_check_commit(commit))
         git2r_error(__func__, NULL, "'commit'", git2r_err_commit_arg);
 
-    repository = git2r_repository_open(GET_SLOT(commit, Rf_install("repo")));
+    repository = git2r_repository_open(GET_SLOT(commit, git2r_sym(repo)));
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    sha = GET_SLOT(commit, Rf_install("sha"));
+    sha = GET_SLOT(commit, git2r_sym(sha));
     err = git_oid_fromstr(&oid, CHAR(STRING_ELT(sha, 0)));
     if (err)
         goto cleanup;
@@ -570,3 +575,424 @@ cleanup:
 
     return result;
 }
+
+/**
+ * Number of commits between checks of the deadline of the commit
+ * walk in the repository summary.
+ */
+#define GIT2R_SUMMARY_DEADLINE_BATCH 256
+
+typedef git_array_t(git_oid) git2r_oid_array;
+
+static int git2r_oid_cmp(const void *a, const void *b)
+{
+    return git_oid_cmp((const git_oid*)a, (const git_oid*)b);
+}
+
+/**
+ * Count the distinct ids in an array, the array is sorted.
+ *
+ * @param oids The array of ids.
+ * @return The number of distinct ids
+ */
+static size_t git2r_oid_array_count_unique(git2r_oid_array *oids)
+{
+    size_t i, n = 0;
+
+    qsort(oids->ptr, oids->size, sizeof(git_oid), git2r_oid_cmp);
+    for (i = 0; i < oids->size; i++) {
+        if (!i || git_oid_cmp(&oids->ptr[i - 1], &oids->ptr[i]))
+            n++;
+    }
+
+    return n;
+}
+
+/**
+ * Append the target of a direct reference to an array. Symbolic
+ * references are skipped.
+ *
+ * @param oids The array of ids.
+ * @param reference The reference.
+ * @return 0 or an error code
+ */
+static int git2r_oid_array_add_target(
+    git2r_oid_array *oids,
+    git_reference *reference)
+{
+    git_oid *oid;
+
+    if (git_reference_type(reference) != GIT_REF_OID)
+        return 0;
+
+    oid = git_array_alloc(*oids);
+    if (!oid) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+    git_oid_cpy(oid, git_reference_target(reference));
+
+    return 0;
+}
+
+/**
+ * Count the distinct targets of the branches and of the tags
+ *
+ * @param n_branches The number of distinct targets of the local
+ * and remote branches.
+ * @param n_tags The number of distinct targets of the tags.
+ * @param repository The repository.
+ * @return 0 or an error code
+ */
+static int git2r_repository_summary_refs(
+    size_t *n_branches,
+    size_t *n_tags,
+    git_repository *repository)
+{
+    int err;
+    git_branch_t type;
+    git_reference *reference = NULL;
+    git_branch_iterator *branches = NULL;
+    git_reference_iterator *tags = NULL;
+    git2r_oid_array oids = GIT_ARRAY_INIT;
+
+    err = git_branch_iterator_new(&branches, repository, GIT_BRANCH_ALL);
+    if (err)
+        goto cleanup;
+
+    while (!(err = git_branch_next(&reference, &type, branches))) {
+        err = git2r_oid_array_add_target(&oids, reference);
+        git_reference_free(reference);
+        if (err)
+            goto cleanup;
+    }
+    if (GIT_ITEROVER != err)
+        goto cleanup;
+
+    *n_branches = git2r_oid_array_count_unique(&oids);
+    git_array_clear(oids);
+
+    err = git_reference_iterator_glob_new(&tags, repository, "refs/tags/*");
+    if (err)
+        goto cleanup;
+
+    while (!(err = git_reference_next(&reference, tags))) {
+        err = git2r_oid_array_add_target(&oids, reference);
+        git_reference_free(reference);
+        if (err)
+            goto cleanup;
+    }
+    if (GIT_ITEROVER != err)
+        goto cleanup;
+
+    *n_tags = git2r_oid_array_count_unique(&oids);
+    err = 0;
+
+cleanup:
+    git_array_clear(oids);
+    git_branch_iterator_free(branches);
+    git_reference_iterator_free(tags);
+
+    return err;
+}
+
+/**
+ * Add a commit to the commits to visit, unless it's seen already
+ *
+ * @param pending The ids of the commits to visit.
+ * @param seen The ids of the commits that are seen.
+ * @param pool The pool to allocate the keys of 'seen' from.
+ * @param oid The id of the commit.
+ * @return 0 or an error code
+ */
+static int git2r_repository_summary_push(
+    git2r_oid_array *pending,
+    git_oidmap *seen,
+    git_pool *pool,
+    const git_oid *oid)
+{
+    int err;
+    git_oid *key, *item;
+
+    if (git_oidmap_exists(seen, oid))
+        return 0;
+
+    key = git_pool_malloc(pool, 1);
+    item = git_array_alloc(*pending);
+    if (!key || !item) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+
+    git_oid_cpy(key, oid);
+    git_oid_cpy(item, oid);
+    git_oidmap_insert(seen, key, NULL, &err);
+
+    return err < 0 ? GIT_ERROR : 0;
+}
+
+/**
+ * Count the commits reachable from HEAD and their distinct author
+ * names. The commits are visited in no particular order, each
+ * commit is read once and only its parents and signatures are
+ * parsed. Unlike a revwalk, the walk doesn't prepare the whole
+ * history before the first commit, so it can stop at a deadline.
+ *
+ * @param n_commits The number of commits.
+ * @param n_authors The number of distinct author names.
+ * @param complete Set to 0 if the deadline passed before the walk
+ * was finished, else 1.
+ * @param repository The repository.
+ * @param deadline The value of git__timer() when the walk is
+ * stopped, or a value <= 0 for no deadline.
+ * @return 0 or an error code
+ */
+static int git2r_repository_summary_commits(
+    size_t *n_commits,
+    size_t *n_authors,
+    int *complete,
+    git_repository *repository,
+    double deadline)
+{
+    int err;
+    git_oid head;
+    git_odb *odb = NULL;
+    git_oidmap *seen = NULL;
+    git_strmap *authors = NULL;
+    git2r_oid_array pending = GIT_ARRAY_INIT;
+    git_pool pool, oids, names;
+
+    *n_commits = 0;
+    *n_authors = 0;
+    *complete = 1;
+
+    /* Arena for the quick parsed commits, cleared once per batch */
+    git_pool_init(&pool, 1);
+    git_pool_init(&oids, sizeof(git_oid));
+    git_pool_init(&names, 1);
+
+    err = git_reference_name_to_id(&head, repository, "HEAD");
+    if (err) {
+        /* No commits on an unborn branch */
+        if (GIT_ENOTFOUND == err) {
+            giterr_clear();
+            err = 0;
+        }
+        goto cleanup;
+    }
+
+    err = git_repository_odb(&odb, repository);
+    if (err)
+        goto cleanup;
+
+    seen = git_oidmap_alloc();
+    err = git_strmap_alloc(&authors);
+    if (err || !seen) {
+        err = GIT_ERROR;
+        goto cleanup;
+    }
+
+    err = git2r_repository_summary_push(&pending, seen, &oids, &head);
+    if (err)
+        goto cleanup;
+
+    while (git_array_size(pending)) {
+        git_commit *commit;
+        git_oid oid;
+        const char *name;
+        unsigned int i, n;
+
+        if (deadline > 0 &&
+            (*n_commits % GIT2R_SUMMARY_DEADLINE_BATCH) == 0 &&
+            git__timer() > deadline) {
+            *complete = 0;
+            break;
+        }
+
+        git_oid_cpy(&oid, git_array_pop(pending));
+        err = git2r_commit_lookup_quick(&commit, odb, &oid, &pool);
+        if (err) {
+            /* The parents of the boundary commits of a shallow
+             * repository are missing */
+            if (GIT_ENOTFOUND == err &&
+                git_repository_is_shallow(repository) == 1) {
+                giterr_clear();
+                err = 0;
+                continue;
+            }
+            goto cleanup;
+        }
+
+        n = git_commit_parentcount(commit);
+        for (i = 0; i < n; i++) {
+            err = git2r_repository_summary_push(
+                &pending, seen, &oids, git_commit_parent_id(commit, i));
+            if (err)
+                goto cleanup;
+        }
+
+        name = git_commit_author(commit)->name;
+        if (!git_strmap_exists(authors, name)) {
+            char *key = git_pool_strdup(&names, name);
+
+            if (!key) {
+                err = GIT_ERROR;
+                goto cleanup;
+            }
+
+            git_strmap_insert(authors, key, NULL, &err);
+            if (err < 0)
+                goto cleanup;
+        }
+
+        *n_commits += 1;
+        if ((*n_commits % GIT2R_COMMIT_ARENA_BATCH) == 0)
+            git_pool_clear(&pool);
+    }
+
+    *n_authors = git_strmap_num_entries(authors);
+    err = 0;
+
+cleanup:
+    git_array_clear(pending);
+    git_pool_clear(&pool);
+    git_pool_clear(&oids);
+    git_pool_clear(&names);
+    git_oidmap_free(seen);
+    git_strmap_free(authors);
+
+    if (odb)
+        git_odb_free(odb);
+
+    return err;
+}
+
+/**
+ * Count the stashes
+ */
+static int git2r_repository_summary_stash_cb(
+    size_t index,
+    const char* message,
+    const git_oid *stash_id,
+    void *payload)
+{
+    GIT_UNUSED(index);
+    GIT_UNUSED(message);
+    GIT_UNUSED(stash_id);
+
+    *(size_t*)payload += 1;
+
+    return 0;
+}
+
+/**
+ * Get the deadline of a time budget
+ *
+ * @param budget NULL or the time budget in seconds.
+ * @return The value of git__timer() at the deadline, or 0 if
+ * there is no budget.
+ */
+static double git2r_repository_summary_deadline(SEXP budget)
+{
+    if (Rf_isNull(budget))
+        return 0;
+
+    /* A deadline in the past when the budget is zero */
+    return git__timer() + (REAL(budget)[0] > 0 ? REAL(budget)[0] : -1);
+}
+
+/**
+ * Summary of a repository, computed with one open repository
+ *
+ * The number of branches and tags are the number of distinct
+ * targets. The number of commits and contributors are counted from
+ * the commits reachable from HEAD, where only the signatures of the
+ * commits are parsed. The status counts are NA for a bare
+ * repository, or if the status didn't finish within its budget.
+ *
+ * @param repo S4 class git_repository
+ * @param commits_budget NULL or the time in seconds to count commits
+ * and contributors.
+ * @param status_budget NULL or the time in seconds to count the
+ * status of the files.
+ * @return list with the counts
+ */
+SEXP git2r_repository_summary(
+    SEXP repo,
+    SEXP commits_budget,
+    SEXP status_budget)
+{
+    int err, commits_complete = 1, status_complete = 1, has_status = 0;
+    size_t i, n_branches = 0, n_tags = 0, n_commits = 0, n_authors = 0;
+    size_t n_stashes = 0, status[4];
+    double deadline;
+    SEXP result = R_NilValue;
+    git_repository *repository = NULL;
+    const char *names[] = {
+        "branches", "tags", "commits", "authors", "stashes",
+        "staged", "unstaged", "untracked", "ignored",
+        "commits_complete", "status_complete", ""};
+
+    if (!Rf_isNull(commits_budget) && git2r_arg_check_real(commits_budget))
+        git2r_error(__func__, NULL, "'commits_budget'", git2r_err_real_arg);
+    if (!Rf_isNull(status_budget) && git2r_arg_check_real(status_budget))
+        git2r_error(__func__, NULL, "'status_budget'", git2r_err_real_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    err = git2r_repository_summary_refs(&n_branches, &n_tags, repository);
+    if (err)
+        goto cleanup;
+
+    err = git_stash_foreach(
+        repository, git2r_repository_summary_stash_cb, &n_stashes);
+    if (err)
+        goto cleanup;
+
+    deadline = git2r_repository_summary_deadline(commits_budget);
+    err = git2r_repository_summary_commits(
+        &n_commits, &n_authors, &commits_complete, repository, deadline);
+    if (err)
+        goto cleanup;
+
+    if (!git_repository_is_bare(repository)) {
+        deadline = git2r_repository_summary_deadline(status_budget);
+        err = git2r_status_count(status, repository, deadline);
+        if (GIT_EUSER == err) {
+            giterr_clear();
+            err = 0;
+            status_complete = 0;
+        } else if (err) {
+            goto cleanup;
+        } else {
+            has_status = 1;
+        }
+    }
+
+    PROTECT(result = Rf_mkNamed(VECSXP, names));
+    SET_VECTOR_ELT(result, 0, Rf_ScalarInteger(n_branches));
+    SET_VECTOR_ELT(result, 1, Rf_ScalarInteger(n_tags));
+    SET_VECTOR_ELT(result, 2, Rf_ScalarInteger(n_commits));
+    SET_VECTOR_ELT(result, 3, Rf_ScalarInteger(n_authors));
+    SET_VECTOR_ELT(result, 4, Rf_ScalarInteger(n_stashes));
+    for (i = 0; i < 4; i++) {
+        SET_VECTOR_ELT(result, 5 + i,
+                       Rf_ScalarInteger(has_status ? status[i] : NA_INTEGER));
+    }
+    SET_VECTOR_ELT(result, 9, Rf_ScalarLogical(commits_complete));
+    SET_VECTOR_ELT(result, 10, Rf_ScalarLogical(status_complete));
+
+cleanup:
+    if (repository)
+        git_repository_free(repository);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
@@ -36,6 +36,10 @@ SEXP git2r_repository_is_empty(SEXP repo);
 SEXP git2r_repository_is_shallow(SEXP repo);
 SEXP git2r_repository_set_head(SEXP repo, SEXP ref_name);
 SEXP git2r_repository_set_head_detached(SEXP commit);
+SEXP git2r_repository_summary(
+    SEXP repo,
+    SEXP commits_budget,
+    SEXP status_budget);
 SEXP git2r_repository_workdir(SEXP repo);
 
 #endif
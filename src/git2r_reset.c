@@ -22,6 +22,7 @@
 #include "git2r_arg.h"
 #include "git2r_commit.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_repository.h"
 #include "git2r_reset.h"
 #include "git2r_signature.h"
@@ -49,7 +50,7 @@ SEXP git2r_reset(SEXP commit, SEXP reset_type)
     if (git2r_arg_check_integer(reset_type))
         git2r_error(__func__, NULL, "'reset_type'", git2r_err_integer_arg);
 
-    repo = GET_SLOT(commit, Rf_install("repo"));
+    repo = GET_SLOT(commit, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
@@ -16,12 +16,17 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <string.h>
 #include <Rdefines.h>
 #include "git2.h"
+#include "array.h"
+#include "commit.h"
+#include "revwalk.h"
 
 #include "git2r_arg.h"
 #include "git2r_commit.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_repository.h"
 
 /**
@@ -47,9 +52,63 @@ static int git2r_revwalk_count(git_revwalk *walker, int max_n)
     return n;
 }
 
+/**
+ * Push or hide revisions in a walk
+ *
+ * @param walker The walker.
+ * @param revisions Character vector with revisions or reference
+ * globs. A glob contains '*', '?' or '['.
+ * @param hide Hide the revisions if 1, else push them.
+ * @return 0 or an error code
+ */
+static int git2r_revwalk_push_revisions(
+    git_revwalk *walker,
+    SEXP revisions,
+    int hide)
+{
+    int err = 0;
+    size_t i, n;
+    git_repository *repository = git_revwalk_repository(walker);
+
+    n = Rf_length(revisions);
+    for (i = 0; i < n && !err; i++) {
+        const char *spec;
+        git_object *object = NULL;
+
+        if (NA_STRING == STRING_ELT(revisions, i))
+            continue;
+        spec = CHAR(STRING_ELT(revisions, i));
+
+        if (strpbrk(spec, "*?[")) {
+            if (hide)
+                err = git_revwalk_hide_glob(walker, spec);
+            else
+                err = git_revwalk_push_glob(walker, spec);
+            continue;
+        }
+
+        err = git_revparse_single(&object, repository, spec);
+        if (err)
+            break;
+
+        if (hide)
+            err = git_revwalk_hide(walker, git_object_id(object));
+        else
+            err = git_revwalk_push(walker, git_object_id(object));
+        git_object_free(object);
+    }
+
+    return err;
+}
+
 /**
  * List revisions
  *
+ * The walk starts from HEAD, unless 'range' or 'include' is
+ * given. The revwalk stops once it has passed 'since' and the
+ * remaining commits are hidden, so the commits outside of a range
+ * are only visited up to where the range starts.
+ *
  * @param repo S4 class git_repository
  * @param topological Sort the commits by topological order; Can be
  * combined with time.
@@ -58,6 +117,17 @@ static int git2r_revwalk_count(git_revwalk *walker, int max_n)
  * @param reverse Sort the commits in reverse order
  * @param max_n n The upper limit of the number of commits to
  * output. Use max_n < 0 for unlimited number of commits.
+ * @param range NULL or a range 'from..to' of commits, i.e. the
+ * commits reachable from 'to' but not from 'from'.
+ * @param include NULL or a character vector with revisions or
+ * reference globs to walk from.
+ * @param exclude NULL or a character vector with revisions or
+ * reference globs to hide, with their ancestors.
+ * @param first_parent Only follow the first parent of merge commits.
+ * @param since NULL or the earliest commit time, in seconds from
+ * epoch.
+ * @param until NULL or the latest commit time, in seconds from
+ * epoch.
  * @return list with S4 class git_commit objects
  */
 SEXP git2r_revwalk_list(
@@ -65,14 +135,22 @@ SEXP git2r_revwalk_list(
     SEXP topological,
     SEXP time,
     SEXP reverse,
-    SEXP max_n)
+    SEXP max_n,
+    SEXP range,
+    SEXP include,
+    SEXP exclude,
+    SEXP first_parent,
+    SEXP since,
+    SEXP until)
 {
     int err = GIT_OK;
     SEXP result = R_NilValue;
-    int i, n;
+    size_t i, n;
     unsigned int sort_mode = GIT_SORT_NONE;
     git_revwalk *walker = NULL;
     git_repository *repository = NULL;
+    git_array_t(git_oid) oids = GIT_ARRAY_INIT;
+    git_oid oid;
 
     if (git2r_arg_check_logical(topological))
         git2r_error(__func__, NULL, "'topological'", git2r_err_logical_arg);
@@ -82,6 +160,18 @@ SEXP git2r_revwalk_list(
         git2r_error(__func__, NULL, "'reverse'", git2r_err_logical_arg);
     if (git2r_arg_check_integer(max_n))
         git2r_error(__func__, NULL, "'max_n'", git2r_err_integer_arg);
+    if (!Rf_isNull(range) && git2r_arg_check_string(range))
+        git2r_error(__func__, NULL, "'range'", git2r_err_string_arg);
+    if (!Rf_isNull(include) && git2r_arg_check_string_vec(include))
+        git2r_error(__func__, NULL, "'include'", git2r_err_string_vec_arg);
+    if (!Rf_isNull(exclude) && git2r_arg_check_string_vec(exclude))
+        git2r_error(__func__, NULL, "'exclude'", git2r_err_string_vec_arg);
+    if (git2r_arg_check_logical(first_parent))
+        git2r_error(__func__, NULL, "'first_parent'", git2r_err_logical_arg);
+    if (!Rf_isNull(since) && git2r_arg_check_real(since))
+        git2r_error(__func__, NULL, "'since'", git2r_err_real_arg);
+    if (!Rf_isNull(until) && git2r_arg_check_real(until))
+        git2r_error(__func__, NULL, "'until'", git2r_err_real_arg);
 
     repository = git2r_repository_open(repo);
     if (!repository)
@@ -101,29 +191,240 @@ SEXP git2r_revwalk_list(
         sort_mode |= GIT_SORT_REVERSE;
 
     err = git_revwalk_new(&walker, repository);
-    if (err)
-        goto cleanup;
-
-    err = git_revwalk_push_head(walker);
     if (err)
         goto cleanup;
     git_revwalk_sorting(walker, sort_mode);
 
-    /* Count number of revisions before creating the list */
-    n = git2r_revwalk_count(walker, INTEGER(max_n)[0]);
+    if (!Rf_isNull(range)) {
+        err = git_revwalk_push_range(walker, CHAR(STRING_ELT(range, 0)));
+        if (err)
+            goto cleanup;
+    }
 
-    /* Create list to store result */
-    PROTECT(result = Rf_allocVector(VECSXP, n));
+    if (!Rf_isNull(include)) {
+        err = git2r_revwalk_push_revisions(walker, include, 0);
+        if (err)
+            goto cleanup;
+    }
 
-    git_revwalk_reset(walker);
-    err = git_revwalk_push_head(walker);
+    if (Rf_isNull(range) && Rf_isNull(include)) {
+        err = git_revwalk_push_head(walker);
+        if (err)
+            goto cleanup;
+    }
+
+    if (!Rf_isNull(exclude)) {
+        err = git2r_revwalk_push_revisions(walker, exclude, 1);
+        if (err)
+            goto cleanup;
+    }
+
+    if (LOGICAL(first_parent)[0])
+        git_revwalk_simplify_first_parent(walker);
+    if (!Rf_isNull(since))
+        git_revwalk__since(walker, (int64_t)floor(REAL(since)[0]));
+    if (!Rf_isNull(until))
+        git_revwalk__until(walker, (int64_t)floor(REAL(until)[0]));
+
+    /* Walk once and keep the ids, instead of counting the revisions
+     * in a first walk before creating the list */
+    while (INTEGER(max_n)[0] < 0 ||
+           git_array_size(oids) < (size_t)INTEGER(max_n)[0]) {
+        git_oid *item;
+
+        err = git_revwalk_next(&oid, walker);
+        if (err) {
+            if (GIT_ITEROVER == err)
+                err = GIT_OK;
+            break;
+        }
+
+        item = git_array_alloc(oids);
+        if (!item) {
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            err = GIT_ERROR;
+            goto cleanup;
+        }
+        git_oid_cpy(item, &oid);
+    }
     if (err)
         goto cleanup;
-    git_revwalk_sorting(walker, sort_mode);
+
+    /* Create list to store result */
+    n = git_array_size(oids);
+    PROTECT(result = Rf_allocVector(VECSXP, n));
 
     for (i = 0; i < n; i++) {
         git_commit *commit;
         SEXP item;
+
+        err = git_commit_lookup(&commit, repository, git_array_get(oids, i));
+        if (err)
+            goto cleanup;
+
+        SET_VECTOR_ELT(result, i, item = git2r_S4_new(git2r_S4_class__git_commit));
+        git2r_commit_init(commit, repo, item);
+        git_commit_free(commit);
+    }
+
+cleanup:
+    git_array_clear(oids);
+
+    if (walker)
+        git_revwalk_free(walker);
+
+    if (repository)
+        git_repository_free(repository);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
+
+/**
+ * Columns that can be requested from 'git2r_revwalk_table'
+ */
+static const char *git2r_revwalk_table_fields[] = {
+    "sha", "summary", "message", "author", "email", "when", ""};
+enum {
+    git2r_revwalk_table_field__sha,
+    git2r_revwalk_table_field__summary,
+    git2r_revwalk_table_field__message,
+    git2r_revwalk_table_field__author,
+    git2r_revwalk_table_field__email,
+    git2r_revwalk_table_field__when,
+    git2r_revwalk_table_field__count};
+
+/**
+ * List revisions as columns
+ *
+ * Only the requested fields are materialized. The commit is not
+ * looked up if only the sha is requested, and the message is not
+ * read into memory unless 'summary' or 'message' is requested.
+ *
+ * @param repo S4 class git_repository
+ * @param topological Sort the commits by topological order; Can be
+ * combined with time.
+ * @param time Sort the commits by commit time; can be combined with
+ * topological.
+ * @param reverse Sort the commits in reverse order
+ * @param max_n n The upper limit of the number of commits to
+ * output. Use max_n < 0 for unlimited number of commits.
+ * @param fields Character vector with the columns to return, a
+ * subset of 'sha', 'summary', 'message', 'author', 'email' and
+ * 'when'.
+ * @return named list with one vector per field
+ */
+SEXP git2r_revwalk_table(
+    SEXP repo,
+    SEXP topological,
+    SEXP time,
+    SEXP reverse,
+    SEXP max_n,
+    SEXP fields)
+{
+    int err = GIT_OK;
+    SEXP result = R_NilValue;
+    SEXP names;
+    int i, j, n = 0, n_fields;
+    int column[git2r_revwalk_table_field__count];
+    int full_parse, quick_parse;
+    unsigned int sort_mode = GIT_SORT_NONE;
+    git_revwalk *walker = NULL;
+    git_repository *repository = NULL;
+    git_odb *odb = NULL;
+    git_pool pool;
+
+    if (git2r_arg_check_logical(topological))
+        git2r_error(__func__, NULL, "'topological'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(time))
+        git2r_error(__func__, NULL, "'time'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(reverse))
+        git2r_error(__func__, NULL, "'reverse'", git2r_err_logical_arg);
+    if (git2r_arg_check_integer(max_n))
+        git2r_error(__func__, NULL, "'max_n'", git2r_err_integer_arg);
+    if (git2r_arg_check_string_vec(fields))
+        git2r_error(__func__, NULL, "'fields'", git2r_err_string_vec_arg);
+
+    /* Map each requested field to its column in the result */
+    for (j = 0; j < git2r_revwalk_table_field__count; j++)
+        column[j] = -1;
+    n_fields = Rf_length(fields);
+    for (i = 0; i < n_fields; i++) {
+        for (j = 0; j < git2r_revwalk_table_field__count; j++) {
+            if (NA_STRING != STRING_ELT(fields, i) &&
+                !strcmp(CHAR(STRING_ELT(fields, i)),
+                        git2r_revwalk_table_fields[j]))
+                break;
+        }
+
+        if (j == git2r_revwalk_table_field__count || column[j] >= 0)
+            git2r_error(__func__, NULL, "'fields'", git2r_err_string_vec_arg);
+        column[j] = i;
+    }
+
+    full_parse = column[git2r_revwalk_table_field__summary] >= 0 ||
+        column[git2r_revwalk_table_field__message] >= 0;
+    quick_parse = column[git2r_revwalk_table_field__author] >= 0 ||
+        column[git2r_revwalk_table_field__email] >= 0 ||
+        column[git2r_revwalk_table_field__when] >= 0;
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    /* Arena for the quick parsed commits, cleared once per batch */
+    git_pool_init(&pool, 1);
+
+    if (!git_repository_is_empty(repository)) {
+        if (LOGICAL(topological)[0])
+            sort_mode |= GIT_SORT_TOPOLOGICAL;
+        if (LOGICAL(time)[0])
+            sort_mode |= GIT_SORT_TIME;
+        if (LOGICAL(reverse)[0])
+            sort_mode |= GIT_SORT_REVERSE;
+
+        err = git_repository_odb(&odb, repository);
+        if (err)
+            goto cleanup;
+
+        err = git_revwalk_new(&walker, repository);
+        if (err)
+            goto cleanup;
+
+        err = git_revwalk_push_head(walker);
+        if (err)
+            goto cleanup;
+        git_revwalk_sorting(walker, sort_mode);
+
+        /* Count number of revisions before creating the columns */
+        n = git2r_revwalk_count(walker, INTEGER(max_n)[0]);
+
+        git_revwalk_reset(walker);
+        err = git_revwalk_push_head(walker);
+        if (err)
+            goto cleanup;
+        git_revwalk_sorting(walker, sort_mode);
+    }
+
+    PROTECT(result = Rf_allocVector(VECSXP, n_fields));
+    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, n_fields));
+    for (j = 0; j < git2r_revwalk_table_field__count; j++) {
+        if (column[j] < 0)
+            continue;
+        SET_STRING_ELT(names, column[j], Rf_mkChar(git2r_revwalk_table_fields[j]));
+        SET_VECTOR_ELT(result, column[j],
+                       Rf_allocVector(j == git2r_revwalk_table_field__when ?
+                                      REALSXP : STRSXP, n));
+    }
+
+    for (i = 0; i < n; i++) {
+        git_commit *commit = NULL;
+        const git_signature *author = NULL;
         git_oid oid;
 
         err = git_revwalk_next(&oid, walker);
@@ -133,19 +434,78 @@ SEXP git2r_revwalk_list(
             goto cleanup;
         }
 
-        err = git_commit_lookup(&commit, repository, &oid);
-        if (err)
-            goto cleanup;
+        if (column[git2r_revwalk_table_field__sha] >= 0) {
+            char sha[GIT_OID_HEXSZ + 1];
 
-        SET_VECTOR_ELT(result, i, item = NEW_OBJECT(MAKE_CLASS("git_commit")));
-        git2r_commit_init(commit, repo, item);
-        git_commit_free(commit);
+            git_oid_fmt(sha, &oid);
+            sha[GIT_OID_HEXSZ] = '\0';
+            SET_STRING_ELT(
+                VECTOR_ELT(result, column[git2r_revwalk_table_field__sha]),
+                i, Rf_mkChar(sha));
+        }
+
+        if (full_parse) {
+            err = git_commit_lookup(&commit, repository, &oid);
+            if (err)
+                goto cleanup;
+
+            if (column[git2r_revwalk_table_field__summary] >= 0) {
+                const char *summary = git_commit_summary(commit);
+                SET_STRING_ELT(
+                    VECTOR_ELT(result, column[git2r_revwalk_table_field__summary]),
+                    i, summary ? Rf_mkChar(summary) : NA_STRING);
+            }
+
+            if (column[git2r_revwalk_table_field__message] >= 0) {
+                const char *message = git_commit_message(commit);
+                SET_STRING_ELT(
+                    VECTOR_ELT(result, column[git2r_revwalk_table_field__message]),
+                    i, message ? Rf_mkChar(message) : NA_STRING);
+            }
+        } else if (quick_parse) {
+            err = git2r_commit_lookup_quick(&commit, odb, &oid, &pool);
+            if (err)
+                goto cleanup;
+        }
+
+        if (commit)
+            author = git_commit_author(commit);
+
+        if (author) {
+            if (column[git2r_revwalk_table_field__author] >= 0) {
+                SET_STRING_ELT(
+                    VECTOR_ELT(result, column[git2r_revwalk_table_field__author]),
+                    i, Rf_mkChar(author->name));
+            }
+
+            if (column[git2r_revwalk_table_field__email] >= 0) {
+                SET_STRING_ELT(
+                    VECTOR_ELT(result, column[git2r_revwalk_table_field__email]),
+                    i, Rf_mkChar(author->email));
+            }
+
+            if (column[git2r_revwalk_table_field__when] >= 0) {
+                REAL(VECTOR_ELT(result, column[git2r_revwalk_table_field__when]))[i] =
+                    (double)(author->when.time) +
+                    60.0 * (double)(author->when.offset);
+            }
+        }
+
+        if (full_parse)
+            git_commit_free(commit);
+        else if (((i + 1) % GIT2R_COMMIT_ARENA_BATCH) == 0)
+            git_pool_clear(&pool);
     }
 
 cleanup:
+    git_pool_clear(&pool);
+
     if (walker)
         git_revwalk_free(walker);
 
+    if (odb)
+        git_odb_free(odb);
+
     if (repository)
         git_repository_free(repository);
 
@@ -185,6 +545,8 @@ SEXP git2r_revwalk_contributions(
     unsigned int sort_mode = GIT_SORT_NONE;
     git_revwalk *walker = NULL;
     git_repository *repository = NULL;
+    git_odb *odb = NULL;
+    git_pool pool;
 
     if (git2r_arg_check_logical(topological))
         git2r_error(__func__, NULL, "'topological'", git2r_err_logical_arg);
@@ -197,9 +559,16 @@ SEXP git2r_revwalk_contributions(
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
+    /* Arena for the quick parsed commits, cleared once per batch */
+    git_pool_init(&pool, 1);
+
     if (git_repository_is_empty(repository))
         goto cleanup;
 
+    err = git_repository_odb(&odb, repository);
+    if (err)
+        goto cleanup;
+
     if (LOGICAL(topological)[0])
         sort_mode |= GIT_SORT_TOPOLOGICAL;
     if (LOGICAL(time)[0])
@@ -247,7 +616,7 @@ SEXP git2r_revwalk_contributions(
             goto cleanup;
         }
 
-        err = git_commit_lookup(&commit, repository, &oid);
+        err = git2r_commit_lookup_quick(&commit, odb, &oid, &pool);
         if (err)
             goto cleanup;
 
@@ -257,13 +626,20 @@ SEXP git2r_revwalk_contributions(
             60.0 * (double)(c_author->when.offset);
         SET_STRING_ELT(author, i, Rf_mkChar(c_author->name));
         SET_STRING_ELT(author, i, Rf_mkChar(c_author->email));
-        git_commit_free(commit);
+
+        if (((i + 1) % GIT2R_COMMIT_ARENA_BATCH) == 0)
+            git_pool_clear(&pool);
     }
 
 cleanup:
+    git_pool_clear(&pool);
+
     if (walker)
         git_revwalk_free(walker);
 
+    if (odb)
+        git_odb_free(odb);
+
     if (repository)
         git_repository_free(repository);
 
@@ -23,6 +23,18 @@
 #include <Rinternals.h>
 
 SEXP git2r_revwalk_contributions(SEXP repo, SEXP topological, SEXP time, SEXP reverse);
-SEXP git2r_revwalk_list(SEXP repo, SEXP topological, SEXP time, SEXP reverse, SEXP max_n);
+SEXP git2r_revwalk_list(
+    SEXP repo,
+    SEXP topological,
+    SEXP time,
+    SEXP reverse,
+    SEXP max_n,
+    SEXP range,
+    SEXP include,
+    SEXP exclude,
+    SEXP first_parent,
+    SEXP since,
+    SEXP until);
+SEXP git2r_revwalk_table(SEXP repo, SEXP topological, SEXP time, SEXP reverse, SEXP max_n, SEXP fields);
 
 #endif
@@ -18,6 +18,7 @@
 
 #include <Rdefines.h>
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_repository.h"
 #include "git2r_signature.h"
 
@@ -42,7 +43,7 @@ SEXP git2r_signature_default(SEXP repo)
     if (err)
         goto cleanup;
 
-    PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_signature")));
+    PROTECT(result = git2r_S4_new(git2r_S4_class__git_signature));
     git2r_signature_init(signature, result);
 
 cleanup:
@@ -73,13 +74,13 @@ int git2r_signature_from_arg(git_signature **out, SEXP signature)
     int err;
     SEXP when;
 
-    when = GET_SLOT(signature, Rf_install("when"));
+    when = GET_SLOT(signature, git2r_sym(when));
     err = git_signature_new(
         out,
-        CHAR(STRING_ELT(GET_SLOT(signature, Rf_install("name")), 0)),
-        CHAR(STRING_ELT(GET_SLOT(signature, Rf_install("email")), 0)),
-        REAL(GET_SLOT(when, Rf_install("time")))[0],
-        REAL(GET_SLOT(when, Rf_install("offset")))[0]);
+        CHAR(STRING_ELT(GET_SLOT(signature, git2r_sym(name)), 0)),
+        CHAR(STRING_ELT(GET_SLOT(signature, git2r_sym(email)), 0)),
+        REAL(GET_SLOT(when, git2r_sym(time)))[0],
+        REAL(GET_SLOT(when, git2r_sym(offset)))[0]);
 
     return err;
 }
@@ -94,15 +95,15 @@ int git2r_signature_from_arg(git_signature **out, SEXP signature)
 void git2r_signature_init(const git_signature *source, SEXP dest)
 {
     SEXP when;
-    SEXP s_name = Rf_install("name");
-    SEXP s_email = Rf_install("email");
-    SEXP s_time = Rf_install("time");
-    SEXP s_offset = Rf_install("offset");
+    SEXP s_name = git2r_sym(name);
+    SEXP s_email = git2r_sym(email);
+    SEXP s_time = git2r_sym(time);
+    SEXP s_offset = git2r_sym(offset);
 
     SET_SLOT(dest, s_name, Rf_mkString(source->name));
     SET_SLOT(dest, s_email, Rf_mkString(source->email));
 
-    when = GET_SLOT(dest, Rf_install("when"));
+    when = GET_SLOT(dest, git2r_sym(when));
     SET_SLOT(when, s_time, Rf_ScalarReal((double)source->when.time));
     SET_SLOT(when, s_offset, Rf_ScalarReal((double)source->when.offset));
 }
@@ -23,6 +23,7 @@
 #include "git2r_arg.h"
 #include "git2r_commit.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_repository.h"
 #include "git2r_signature.h"
 #include "git2r_stash.h"
@@ -121,7 +122,7 @@ static int git2r_stash_list_cb(
         SET_VECTOR_ELT(
             cb_data->list,
             cb_data->n,
-            stash = NEW_OBJECT(MAKE_CLASS("git_stash")));
+            stash = git2r_S4_new(git2r_S4_class__git_stash));
         err = git2r_stash_init(
             stash_id,
             cb_data->repository,
@@ -244,7 +245,7 @@ SEXP git2r_stash_save(
         goto cleanup;
     }
 
-    PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_stash")));
+    PROTECT(result = git2r_S4_new(git2r_S4_class__git_stash));
     err = git2r_stash_init(&oid, repository, repo, result);
 
 cleanup:
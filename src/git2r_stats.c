@@ -0,0 +1,170 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <R.h>
+#include <Rinternals.h>
+
+#include "git2.h"
+#include "common.h"
+#include "stats.h"
+
+#include "git2r_arg.h"
+#include "git2r_error.h"
+#include "git2r_stats.h"
+
+/* The .Call entry points that have been called since the last reset */
+static git2r_stats_call *git2r_stats_calls = NULL;
+
+/* The number of R objects created by git2r_S3_new and git2r_S4_new */
+static double git2r_stats_r_objects = 0;
+
+/**
+ * Check if the instrumentation is enabled
+ *
+ * @return 1 if enabled, else 0
+ */
+int git2r_stats_enabled(void)
+{
+    return git_stats__enabled;
+}
+
+/**
+ * Count a call of a .Call entry point
+ *
+ * Only called from the main thread.
+ *
+ * @param call The entry point.
+ * @return The start time of the call.
+ */
+double git2r_stats_call_begin(git2r_stats_call *call)
+{
+    if (!call->listed) {
+        call->calls = 0;
+        call->seconds = 0;
+        call->listed = 1;
+        call->next = git2r_stats_calls;
+        git2r_stats_calls = call;
+    }
+
+    call->calls++;
+
+    return git__timer();
+}
+
+/**
+ * Add the time spent in a call of a .Call entry point
+ *
+ * @param call The entry point.
+ * @param start The start time from git2r_stats_call_begin.
+ */
+void git2r_stats_call_end(git2r_stats_call *call, double start)
+{
+    call->seconds += git__timer() - start;
+}
+
+/**
+ * Count an R object created by git2r
+ */
+void git2r_stats_r_object(void)
+{
+    if (git_stats__enabled)
+        git2r_stats_r_objects++;
+}
+
+/**
+ * Clear the counters and the timers
+ */
+static void git2r_stats_reset(void)
+{
+    git_stats__reset();
+    git2r_stats_r_objects = 0;
+
+    while (git2r_stats_calls) {
+        git2r_stats_call *call = git2r_stats_calls;
+
+        git2r_stats_calls = call->next;
+        call->listed = 0;
+        call->next = NULL;
+    }
+}
+
+/**
+ * Get the instrumentation counters and the timers of the .Call entry
+ * points
+ *
+ * @param enable NULL to keep the current setting, else TRUE or FALSE
+ * to enable or disable the instrumentation.
+ * @param reset Clear the counters and the timers after they are read.
+ * @return list with columns name, type, count and seconds.
+ */
+SEXP git2r_stats(SEXP enable, SEXP reset)
+{
+    int i, j, n;
+    SEXP result, names, name, type, count, seconds;
+    git2r_stats_call *call;
+
+    if (!Rf_isNull(enable) && git2r_arg_check_logical(enable))
+        git2r_error(__func__, NULL, "'enable'", git2r_err_logical_arg);
+    if (git2r_arg_check_logical(reset))
+        git2r_error(__func__, NULL, "'reset'", git2r_err_logical_arg);
+
+    n = GIT_STATS__COUNT + 1;
+    for (call = git2r_stats_calls; call; call = call->next)
+        n++;
+
+    PROTECT(result = Rf_allocVector(VECSXP, 4));
+    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 4));
+    SET_VECTOR_ELT(result, 0, name = Rf_allocVector(STRSXP, n));
+    SET_STRING_ELT(names, 0, Rf_mkChar("name"));
+    SET_VECTOR_ELT(result, 1, type = Rf_allocVector(STRSXP, n));
+    SET_STRING_ELT(names, 1, Rf_mkChar("type"));
+    SET_VECTOR_ELT(result, 2, count = Rf_allocVector(REALSXP, n));
+    SET_STRING_ELT(names, 2, Rf_mkChar("count"));
+    SET_VECTOR_ELT(result, 3, seconds = Rf_allocVector(REALSXP, n));
+    SET_STRING_ELT(names, 3, Rf_mkChar("seconds"));
+
+    for (i = 0; i < GIT_STATS__COUNT; i++) {
+        SET_STRING_ELT(name, i, Rf_mkChar(git_stats__name(i)));
+        SET_STRING_ELT(type, i, Rf_mkChar("counter"));
+        REAL(count)[i] = (double)git_stats__get(i);
+        REAL(seconds)[i] = NA_REAL;
+    }
+
+    SET_STRING_ELT(name, i, Rf_mkChar("r_objects"));
+    SET_STRING_ELT(type, i, Rf_mkChar("counter"));
+    REAL(count)[i] = git2r_stats_r_objects;
+    REAL(seconds)[i] = NA_REAL;
+
+    /* The calls are listed in the order of the first call */
+    for (call = git2r_stats_calls, j = n - 1; call; call = call->next, j--) {
+        SET_STRING_ELT(name, j, Rf_mkChar(call->name));
+        SET_STRING_ELT(type, j, Rf_mkChar("call"));
+        REAL(count)[j] = call->calls;
+        REAL(seconds)[j] = call->seconds;
+    }
+
+    if (LOGICAL(reset)[0])
+        git2r_stats_reset();
+
+    if (!Rf_isNull(enable))
+        git_stats__enabled = LOGICAL(enable)[0];
+
+    UNPROTECT(1);
+
+    return result;
+}
@@ -0,0 +1,98 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef INCLUDE_git2r_stats_h
+#define INCLUDE_git2r_stats_h
+
+#include <R.h>
+#include <Rinternals.h>
+
+/**
+ * The number of calls and the time spent in one .Call entry point
+ */
+typedef struct git2r_stats_call {
+    const char *name;
+    double calls;
+    double seconds;
+    int listed;
+    struct git2r_stats_call *next;
+} git2r_stats_call;
+
+int git2r_stats_enabled(void);
+double git2r_stats_call_begin(git2r_stats_call *call);
+void git2r_stats_call_end(git2r_stats_call *call, double start);
+void git2r_stats_r_object(void);
+SEXP git2r_stats(SEXP enable, SEXP reset);
+
+/**
+ * Define 'name__stats' that calls the .Call entry point 'name', and
+ * when the instrumentation is enabled, counts the call and the time
+ * spent. The time of a call that raises an R error is not counted.
+ */
+#define GIT2R_STATS_CALL(name, params, args)                        \
+    static git2r_stats_call name##__call = {#name, 0, 0, 0, NULL};  \
+    static SEXP name##__stats params                                \
+    {                                                               \
+        SEXP result;                                                \
+        double start;                                               \
+                                                                    \
+        if (!git2r_stats_enabled())                                 \
+            return name args;                                       \
+        start = git2r_stats_call_begin(&name##__call);              \
+        result = name args;                                         \
+        git2r_stats_call_end(&name##__call, start);                 \
+        return result;                                              \
+    }
+
+#define GIT2R_STATS_CALL_0(name) GIT2R_STATS_CALL(name, (void), ())
+#define GIT2R_STATS_CALL_1(name) GIT2R_STATS_CALL(name, (SEXP a1), (a1))
+#define GIT2R_STATS_CALL_2(name) GIT2R_STATS_CALL(      \
+        name, (SEXP a1, SEXP a2), (a1, a2))
+#define GIT2R_STATS_CALL_3(name) GIT2R_STATS_CALL(      \
+        name, (SEXP a1, SEXP a2, SEXP a3), (a1, a2, a3))
+#define GIT2R_STATS_CALL_4(name) GIT2R_STATS_CALL(      \
+        name, (SEXP a1, SEXP a2, SEXP a3, SEXP a4),     \
+        (a1, a2, a3, a4))
+#define GIT2R_STATS_CALL_5(name) GIT2R_STATS_CALL(              \
+        name, (SEXP a1, SEXP a2, SEXP a3, SEXP a4, SEXP a5),    \
+        (a1, a2, a3, a4, a5))
+#define GIT2R_STATS_CALL_6(name) GIT2R_STATS_CALL(                      \
+        name, (SEXP a1, SEXP a2, SEXP a3, SEXP a4, SEXP a5, SEXP a6),   \
+        (a1, a2, a3, a4, a5, a6))
+#define GIT2R_STATS_CALL_7(name) GIT2R_STATS_CALL(                      \
+        name, (SEXP a1, SEXP a2, SEXP a3, SEXP a4, SEXP a5, SEXP a6,    \
+               SEXP a7),                                                \
+        (a1, a2, a3, a4, a5, a6, a7))
+#define GIT2R_STATS_CALL_8(name) GIT2R_STATS_CALL(                      \
+        name, (SEXP a1, SEXP a2, SEXP a3, SEXP a4, SEXP a5, SEXP a6,    \
+               SEXP a7, SEXP a8),                                       \
+        (a1, a2, a3, a4, a5, a6, a7, a8))
+#define GIT2R_STATS_CALL_9(name) GIT2R_STATS_CALL(                      \
+        name, (SEXP a1, SEXP a2, SEXP a3, SEXP a4, SEXP a5, SEXP a6,    \
+               SEXP a7, SEXP a8, SEXP a9),                              \
+        (a1, a2, a3, a4, a5, a6, a7, a8, a9))
+#define GIT2R_STATS_CALL_10(name) GIT2R_STATS_CALL(                     \
+        name, (SEXP a1, SEXP a2, SEXP a3, SEXP a4, SEXP a5, SEXP a6,    \
+               SEXP a7, SEXP a8, SEXP a9, SEXP a10),                    \
+        (a1, a2, a3, a4, a5, a6, a7, a8, a9, a10))
+#define GIT2R_STATS_CALL_11(name) GIT2R_STATS_CALL(                     \
+        name, (SEXP a1, SEXP a2, SEXP a3, SEXP a4, SEXP a5, SEXP a6,    \
+               SEXP a7, SEXP a8, SEXP a9, SEXP a10, SEXP a11),          \
+        (a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11))
+
+#endif
@@ -16,6 +16,8 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include "status.h"
+
 #include "git2r_arg.h"
 #include "git2r_error.h"
 #include "git2r_repository.h"
@@ -338,6 +340,87 @@ static void git2r_status_list_untracked(
     }
 }
 
+/**
+ * Set the status options used by git2r_status_list
+ *
+ * @param opts The options to set.
+ * @param untracked Include untracked files and directories.
+ * @param all_untracked Shows individual files in untracked
+ * directories if 'untracked' is set.
+ * @param ignored Include ignored files.
+ */
+void git2r_status_options(
+    git_status_options *opts,
+    int untracked,
+    int all_untracked,
+    int ignored)
+{
+    opts->show  = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
+    opts->flags = GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX |
+        GIT_STATUS_OPT_SORT_CASE_SENSITIVELY;
+
+    if (untracked) {
+        opts->flags |= GIT_STATUS_OPT_INCLUDE_UNTRACKED;
+        if (all_untracked)
+            opts->flags |= GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS;
+    }
+    if (ignored)
+        opts->flags |= GIT_STATUS_OPT_INCLUDE_IGNORED;
+}
+
+/**
+ * Create a list with the entries of a status list
+ *
+ * @param status_list The status list.
+ * @param staged Include staged files.
+ * @param unstaged Include unstaged files.
+ * @param untracked Include untracked files and directories.
+ * @param ignored Include ignored files.
+ * @return VECSXP list with status
+ */
+SEXP git2r_status_list_value(
+    git_status_list *status_list,
+    int staged,
+    int unstaged,
+    int untracked,
+    int ignored)
+{
+    size_t i = 0, count;
+    SEXP list, list_names;
+
+    count = staged + unstaged + untracked + ignored;
+
+    PROTECT(list = Rf_allocVector(VECSXP, count));
+    Rf_setAttrib(list, R_NamesSymbol, list_names = Rf_allocVector(STRSXP, count));
+
+    if (staged) {
+        SET_STRING_ELT(list_names, i, Rf_mkChar("staged"));
+        git2r_status_list_staged(list, i, status_list);
+        i++;
+    }
+
+    if (unstaged) {
+        SET_STRING_ELT(list_names, i, Rf_mkChar("unstaged"));
+        git2r_status_list_unstaged(list, i, status_list);
+        i++;
+    }
+
+    if (untracked) {
+        SET_STRING_ELT(list_names, i, Rf_mkChar("untracked"));
+        git2r_status_list_untracked(list, i, status_list);
+        i++;
+    }
+
+    if (ignored) {
+        SET_STRING_ELT(list_names, i, Rf_mkChar("ignored"));
+        git2r_status_list_ignored(list, i, status_list);
+    }
+
+    UNPROTECT(1);
+
+    return list;
+}
+
 /**
  * Get state of the repository working directory and the staging area.
  *
@@ -359,9 +442,7 @@ SEXP git2r_status_list(
     SEXP ignored)
 {
     int err;
-    size_t i=0, count;
     SEXP list = R_NilValue;
-    SEXP list_names = R_NilValue;
     git_repository *repository;
     git_status_list *status_list = NULL;
     git_status_options opts = GIT_STATUS_OPTIONS_INIT;
@@ -381,52 +462,19 @@ SEXP git2r_status_list(
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    opts.show  = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
-    opts.flags = GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX |
-        GIT_STATUS_OPT_SORT_CASE_SENSITIVELY;
-
-    if (LOGICAL(untracked)[0]) {
-        opts.flags |= GIT_STATUS_OPT_INCLUDE_UNTRACKED;
-        if (LOGICAL(all_untracked)[0])
-            opts.flags |= GIT_STATUS_OPT_RECURSE_UNTRACKED_DIRS;
-    }
-    if (LOGICAL(ignored)[0])
-        opts.flags |= GIT_STATUS_OPT_INCLUDE_IGNORED;
+    git2r_status_options(&opts,
+                         LOGICAL(untracked)[0],
+                         LOGICAL(all_untracked)[0],
+                         LOGICAL(ignored)[0]);
     err = git_status_list_new(&status_list, repository, &opts);
     if (err)
         goto cleanup;
 
-    count = LOGICAL(staged)[0] +
-        LOGICAL(unstaged)[0] +
-        LOGICAL(untracked)[0] +
-        LOGICAL(ignored)[0];
-
-    PROTECT(list = Rf_allocVector(VECSXP, count));
-    Rf_setAttrib(list, R_NamesSymbol, list_names = Rf_allocVector(STRSXP, count));
-
-    if (LOGICAL(staged)[0]) {
-        SET_STRING_ELT(list_names, i, Rf_mkChar("staged"));
-        git2r_status_list_staged(list, i, status_list);
-        i++;
-    }
-
-    if (LOGICAL(unstaged)[0]) {
-        SET_STRING_ELT(list_names, i, Rf_mkChar("unstaged"));
-        git2r_status_list_unstaged(list, i, status_list);
-        i++;
-    }
-
-    if (LOGICAL(untracked)[0]) {
-        SET_STRING_ELT(list_names, i, Rf_mkChar("untracked"));
-        git2r_status_list_untracked(list, i, status_list);
-        i++;
-    }
-
-    if (LOGICAL(ignored)[0]) {
-        SET_STRING_ELT(list_names, i, Rf_mkChar("ignored"));
-        git2r_status_list_ignored(list, i, status_list);
-    }
-
+    PROTECT(list = git2r_status_list_value(status_list,
+                                           LOGICAL(staged)[0],
+                                           LOGICAL(unstaged)[0],
+                                           LOGICAL(untracked)[0],
+                                           LOGICAL(ignored)[0]));
 
 cleanup:
     if (status_list)
@@ -443,3 +491,71 @@ cleanup:
 
     return list;
 }
+
+/**
+ * Stop the status when the deadline has passed
+ *
+ * @param diff_so_far Unused
+ * @param old_path Unused
+ * @param new_path Unused
+ * @param payload Pointer to the deadline.
+ * @return 0 or GIT_EUSER if the deadline has passed
+ */
+static int git2r_status_deadline_cb(
+    const git_diff *diff_so_far,
+    const char *old_path,
+    const char *new_path,
+    void *payload)
+{
+    GIT_UNUSED(diff_so_far);
+    GIT_UNUSED(old_path);
+    GIT_UNUSED(new_path);
+
+    if (git__timer() > *(double*)payload)
+        return GIT_EUSER;
+    return 0;
+}
+
+/**
+ * Count the staged, unstaged, untracked and ignored files without
+ * building the lists of paths, see git2r_status_list.
+ *
+ * @param counts Array with four elements for the number of staged,
+ * unstaged, untracked and ignored files.
+ * @param repository The repository.
+ * @param deadline The value of git__timer() when the status is
+ * stopped, or a value <= 0 for no deadline.
+ * @return 0, GIT_EUSER if the deadline passed or an error code
+ */
+int git2r_status_count(
+    size_t *counts,
+    git_repository *repository,
+    double deadline)
+{
+    int err;
+    git_status_list *status_list = NULL;
+    git_status_options opts = GIT_STATUS_OPTIONS_INIT;
+
+    opts.show  = GIT_STATUS_SHOW_INDEX_AND_WORKDIR;
+    opts.flags = GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX |
+        GIT_STATUS_OPT_INCLUDE_UNTRACKED |
+        GIT_STATUS_OPT_INCLUDE_IGNORED;
+
+    err = git_status_list__new(
+        &status_list,
+        repository,
+        &opts,
+        deadline > 0 ? git2r_status_deadline_cb : NULL,
+        &deadline);
+    if (err)
+        return err;
+
+    counts[0] = git2r_status_count_staged(status_list);
+    counts[1] = git2r_status_count_unstaged(status_list);
+    counts[2] = git2r_status_count_untracked(status_list);
+    counts[3] = git2r_status_count_ignored(status_list);
+
+    git_status_list_free(status_list);
+
+    return 0;
+}
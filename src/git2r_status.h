@@ -22,6 +22,23 @@
 #include <R.h>
 #include <Rinternals.h>
 
+#include "git2.h"
+
+int git2r_status_count(
+    size_t *counts,
+    git_repository *repository,
+    double deadline);
+void git2r_status_options(
+    git_status_options *opts,
+    int untracked,
+    int all_untracked,
+    int ignored);
+SEXP git2r_status_list_value(
+    git_status_list *status_list,
+    int staged,
+    int unstaged,
+    int untracked,
+    int ignored);
 SEXP git2r_status_list(
     SEXP repo,
     SEXP staged,
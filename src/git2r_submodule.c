@@ -0,0 +1,434 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <Rdefines.h>
+#include <string.h>
+#include "git2.h"
+#include "common.h"
+
+#include "git2r_arg.h"
+#include "git2r_cred.h"
+#include "git2r_error.h"
+#include "git2r_parallel.h"
+#include "git2r_repository.h"
+#include "git2r_submodule.h"
+
+/**
+ * The status of a submodule, or the update of a submodule, filled
+ * by a worker
+ */
+typedef struct {
+    char *name;
+    char *path;
+    char *url;
+    char *branch;
+    git_oid head_id;
+    git_oid index_id;
+    git_oid wd_id;
+    int has_head_id;
+    int has_index_id;
+    int has_wd_id;
+    unsigned int status;
+    int initialized;
+    int error;
+    char *message;
+} git2r_submodule_job;
+
+/**
+ * Data structure to hold the submodules of a repository
+ *
+ * Each worker opens the repository at 'path' to work on one
+ * submodule, since a repository can't be used from many threads at
+ * the same time.
+ */
+typedef struct {
+    const char *path;
+    git2r_submodule_job *jobs;
+    size_t n;
+    size_t alloc;
+    git2r_cred_data *cred;
+} git2r_submodule_data;
+
+static void git2r_submodule_data_free(git2r_submodule_data *data)
+{
+    size_t i;
+
+    for (i = 0; i < data->n; i++) {
+        free(data->jobs[i].name);
+        free(data->jobs[i].path);
+        free(data->jobs[i].url);
+        free(data->jobs[i].branch);
+        free(data->jobs[i].message);
+    }
+    free(data->jobs);
+}
+
+/**
+ * Callback to list the names of the submodules
+ */
+static int git2r_submodule_list_cb(git_submodule *sm, const char *name, void *payload)
+{
+    git2r_submodule_data *data = payload;
+
+    GIT_UNUSED(sm);
+
+    if (data->n == data->alloc) {
+        size_t alloc = data->alloc ? 2 * data->alloc : 16;
+        git2r_submodule_job *jobs = realloc(data->jobs, alloc * sizeof(git2r_submodule_job));
+        if (!jobs) {
+            giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+            return GIT_ERROR;
+        }
+        data->jobs = jobs;
+        data->alloc = alloc;
+    }
+
+    memset(&data->jobs[data->n], 0, sizeof(git2r_submodule_job));
+    if (!(data->jobs[data->n].name = strdup(name))) {
+        giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+        return GIT_ERROR;
+    }
+    data->n++;
+
+    return 0;
+}
+
+/**
+ * List the submodules of a repository
+ */
+static int git2r_submodule_list(git2r_submodule_data *data, git_repository *repository)
+{
+    memset(data, 0, sizeof(git2r_submodule_data));
+    data->path = git_repository_workdir(repository);
+    if (!data->path)
+        data->path = git_repository_path(repository);
+
+    return git_submodule_foreach(repository, git2r_submodule_list_cb, data);
+}
+
+static char *git2r_submodule_strdup(const char *str)
+{
+    return str ? strdup(str) : NULL;
+}
+
+/**
+ * Keep the message of the libgit2 error of a worker
+ */
+static void git2r_submodule_job_error(git2r_submodule_job *job, int error)
+{
+    const git_error *e = giterr_last();
+
+    job->error = error;
+    job->message = strdup(e && e->message ? e->message : "unknown error");
+}
+
+/**
+ * Get the status of one submodule, called from a worker
+ */
+static void git2r_submodule_status_cb(size_t i, void *payload)
+{
+    int error;
+    git2r_submodule_data *data = payload;
+    git2r_submodule_job *job = &data->jobs[i];
+    git_repository *repository = NULL;
+    git_submodule *sm = NULL;
+    git_config *cfg = NULL;
+    git_config_entry *entry = NULL;
+    git_buf key = GIT_BUF_INIT;
+    const git_oid *oid;
+
+    if ((error = git_repository_open(&repository, data->path)) < 0 ||
+        (error = git_submodule_lookup(&sm, repository, job->name)) < 0 ||
+        (error = git_submodule_status(&job->status, repository, job->name,
+                                      GIT_SUBMODULE_IGNORE_UNSPECIFIED)) < 0)
+        goto cleanup;
+
+    /* The url is copied to the config of the repository when the
+     * submodule is initialized */
+    if ((error = git_repository_config_snapshot(&cfg, repository)) < 0 ||
+        (error = git_buf_printf(&key, "submodule.%s.url", job->name)) < 0)
+        goto cleanup;
+    job->initialized = git_config_get_entry(&entry, cfg, key.ptr) == 0;
+    giterr_clear();
+
+    job->path = git2r_submodule_strdup(git_submodule_path(sm));
+    job->url = git2r_submodule_strdup(git_submodule_url(sm));
+    job->branch = git2r_submodule_strdup(git_submodule_branch(sm));
+
+    if ((oid = git_submodule_head_id(sm))) {
+        git_oid_cpy(&job->head_id, oid);
+        job->has_head_id = 1;
+    }
+
+    if ((oid = git_submodule_index_id(sm))) {
+        git_oid_cpy(&job->index_id, oid);
+        job->has_index_id = 1;
+    }
+
+    /* Opens the repository of the submodule, if it's cloned */
+    if ((oid = git_submodule_wd_id(sm))) {
+        git_oid_cpy(&job->wd_id, oid);
+        job->has_wd_id = 1;
+    }
+    giterr_clear();
+
+cleanup:
+    if (error < 0)
+        git2r_submodule_job_error(job, error);
+
+    git_buf_free(&key);
+    git_config_entry_free(entry);
+    git_config_free(cfg);
+    git_submodule_free(sm);
+    git_repository_free(repository);
+}
+
+/**
+ * Clone or fetch and checkout one submodule, called from a worker
+ */
+static void git2r_submodule_update_cb(size_t i, void *payload)
+{
+    int error;
+    git2r_submodule_data *data = payload;
+    git2r_submodule_job *job = &data->jobs[i];
+    git2r_cred_data cred = *data->cred;
+    git_repository *repository = NULL;
+    git_submodule *sm = NULL;
+    git_submodule_update_options opts = GIT_SUBMODULE_UPDATE_OPTIONS_INIT;
+
+    /* Each worker tries the ssh-agent once */
+    cred.ssh_key_agent_tried = 0;
+    opts.fetch_opts.callbacks.credentials = &git2r_cred_data_acquire_cb;
+    opts.fetch_opts.callbacks.payload = &cred;
+
+    if ((error = git_repository_open(&repository, data->path)) < 0 ||
+        (error = git_submodule_lookup(&sm, repository, job->name)) < 0 ||
+        (error = git_submodule_update(sm, 0, &opts)) < 0)
+        git2r_submodule_job_error(job, error);
+
+    git_submodule_free(sm);
+    git_repository_free(repository);
+}
+
+/**
+ * Check the jobs after the workers are done
+ *
+ * @return 0 or the error of the first job that failed
+ */
+static int git2r_submodule_check_jobs(git2r_submodule_data *data)
+{
+    size_t i;
+
+    for (i = 0; i < data->n; i++) {
+        if (data->jobs[i].error) {
+            giterr_set(GITERR_SUBMODULE, "submodule '%s': %s",
+                       data->jobs[i].name, data->jobs[i].message);
+            return data->jobs[i].error;
+        }
+    }
+
+    return 0;
+}
+
+static SEXP git2r_submodule_sha(const git_oid *oid, int has_oid)
+{
+    char sha[GIT_OID_HEXSZ + 1];
+
+    if (!has_oid)
+        return NA_STRING;
+
+    git_oid_tostr(sha, sizeof(sha), oid);
+    return Rf_mkChar(sha);
+}
+
+static SEXP git2r_submodule_string(const char *str)
+{
+    return str ? Rf_mkChar(str) : NA_STRING;
+}
+
+/**
+ * Get the status of the submodules of a repository
+ *
+ * @param repo S4 class git_repository
+ * @param jobs The number of submodules to get the status of in
+ * parallel.
+ * @return list with the columns of the status table
+ */
+SEXP git2r_submodule_status(SEXP repo, SEXP jobs)
+{
+    int err;
+    size_t i, j;
+    SEXP result = R_NilValue;
+    SEXP names = R_NilValue;
+    git_repository *repository = NULL;
+    git2r_submodule_data data;
+    static const unsigned int modified =
+        GIT_SUBMODULE_STATUS_INDEX_ADDED |
+        GIT_SUBMODULE_STATUS_INDEX_DELETED |
+        GIT_SUBMODULE_STATUS_INDEX_MODIFIED |
+        GIT_SUBMODULE_STATUS_WD_ADDED |
+        GIT_SUBMODULE_STATUS_WD_DELETED |
+        GIT_SUBMODULE_STATUS_WD_MODIFIED |
+        GIT_SUBMODULE_STATUS_WD_INDEX_MODIFIED |
+        GIT_SUBMODULE_STATUS_WD_WD_MODIFIED |
+        GIT_SUBMODULE_STATUS_WD_UNTRACKED;
+
+    if (git2r_arg_check_integer(jobs))
+        git2r_error(__func__, NULL, "'jobs'", git2r_err_integer_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    err = git2r_submodule_list(&data, repository);
+    if (err)
+        goto cleanup;
+
+    git2r_parallel_for(data.n, INTEGER(jobs)[0], git2r_submodule_status_cb, &data);
+    err = git2r_submodule_check_jobs(&data);
+    if (err)
+        goto cleanup;
+
+    PROTECT(result = Rf_allocVector(VECSXP, 10));
+    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 10));
+
+    j = 0;
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP, data.n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("name"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP, data.n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("path"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP, data.n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("url"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP, data.n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("branch"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP, data.n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("head_sha"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP, data.n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("index_sha"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP, data.n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("workdir_sha"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(LGLSXP, data.n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("initialized"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(LGLSXP, data.n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("cloned"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(LGLSXP, data.n));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("modified"));
+
+    for (i = 0; i < data.n; i++) {
+        git2r_submodule_job *job = &data.jobs[i];
+        unsigned int status = job->status;
+
+        SET_STRING_ELT(VECTOR_ELT(result, 0), i, Rf_mkChar(job->name));
+        SET_STRING_ELT(VECTOR_ELT(result, 1), i, git2r_submodule_string(job->path));
+        SET_STRING_ELT(VECTOR_ELT(result, 2), i, git2r_submodule_string(job->url));
+        SET_STRING_ELT(VECTOR_ELT(result, 3), i, git2r_submodule_string(job->branch));
+        SET_STRING_ELT(VECTOR_ELT(result, 4), i, git2r_submodule_sha(&job->head_id, job->has_head_id));
+        SET_STRING_ELT(VECTOR_ELT(result, 5), i, git2r_submodule_sha(&job->index_id, job->has_index_id));
+        SET_STRING_ELT(VECTOR_ELT(result, 6), i, git2r_submodule_sha(&job->wd_id, job->has_wd_id));
+        LOGICAL(VECTOR_ELT(result, 7))[i] = job->initialized;
+        LOGICAL(VECTOR_ELT(result, 8))[i] = !(status & GIT_SUBMODULE_STATUS_WD_UNINITIALIZED) &&
+            (status & GIT_SUBMODULE_STATUS_IN_WD);
+        LOGICAL(VECTOR_ELT(result, 9))[i] = (status & modified) != 0;
+    }
+
+cleanup:
+    git2r_submodule_data_free(&data);
+
+    if (repository)
+        git_repository_free(repository);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
+
+/**
+ * Clone, or fetch, and checkout the submodules of a repository
+ *
+ * Like 'git submodule update', each submodule is checked out at the
+ * commit in the index of the repository.
+ *
+ * @param repo S4 class git_repository
+ * @param init Initialize the submodules that are not, i.e. copy
+ * their url from '.gitmodules' to the config of the repository.
+ * @param credentials The credentials for remote repository access.
+ * @param jobs The number of submodules to update in parallel.
+ * @return R_NilValue
+ */
+SEXP git2r_submodule_update(SEXP repo, SEXP init, SEXP credentials, SEXP jobs)
+{
+    int err;
+    size_t i;
+    git_repository *repository = NULL;
+    git2r_submodule_data data;
+    git2r_cred_data cred;
+
+    if (git2r_arg_check_logical(init))
+        git2r_error(__func__, NULL, "'init'", git2r_err_logical_arg);
+    if (git2r_arg_check_credentials(credentials))
+        git2r_error(__func__, NULL, "'credentials'", git2r_err_credentials_arg);
+    if (git2r_arg_check_integer(jobs))
+        git2r_error(__func__, NULL, "'jobs'", git2r_err_integer_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    git2r_cred_data_init(&cred, credentials);
+
+    err = git2r_submodule_list(&data, repository);
+    if (err)
+        goto cleanup;
+    data.cred = &cred;
+
+    /* The config of the repository is written here, before the
+     * workers start */
+    if (LOGICAL(init)[0]) {
+        for (i = 0; i < data.n; i++) {
+            git_submodule *sm = NULL;
+
+            err = git_submodule_lookup(&sm, repository, data.jobs[i].name);
+            if (!err)
+                err = git_submodule_init(sm, 0);
+            git_submodule_free(sm);
+            if (err)
+                goto cleanup;
+        }
+    }
+
+    git2r_parallel_for(data.n, INTEGER(jobs)[0], git2r_submodule_update_cb, &data);
+    err = git2r_submodule_check_jobs(&data);
+    if (err)
+        goto cleanup;
+
+cleanup:
+    git2r_submodule_data_free(&data);
+    git2r_cred_data_free(&cred);
+
+    if (repository)
+        git_repository_free(repository);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return R_NilValue;
+}
@@ -44,12 +44,12 @@ void git2r_tag_init(git_tag *source, SEXP repo, SEXP dest)
     const git_oid *oid;
     char sha[GIT_OID_HEXSZ + 1];
     char target[GIT_OID_HEXSZ + 1];
-    SEXP s_sha = Rf_install("sha");
-    SEXP s_message = Rf_install("message");
-    SEXP s_name = Rf_install("name");
-    SEXP s_tagger = Rf_install("tagger");
-    SEXP s_target = Rf_install("target");
-    SEXP s_repo = Rf_install("repo");
+    SEXP s_sha = git2r_sym(sha);
+    SEXP s_message = git2r_sym(message);
+    SEXP s_name = git2r_sym(name);
+    SEXP s_tagger = git2r_sym(tagger);
+    SEXP s_target = git2r_sym(target);
+    SEXP s_repo = git2r_sym(repo);
 
     oid = git_tag_id(source);
     git_oid_tostr(sha, sizeof(sha), oid);
@@ -122,7 +122,7 @@ SEXP git2r_tag_create(SEXP repo, SEXP name, SEXP message, SEXP tagger)
     if (err)
         goto cleanup;
 
-    PROTECT(result = NEW_OBJECT(MAKE_CLASS("git_tag")));
+    PROTECT(result = git2r_S4_new(git2r_S4_class__git_tag));
     git2r_tag_init(tag, repo, result);
 
 cleanup:
@@ -215,30 +215,29 @@ static int git2r_tag_foreach_cb(const char *name, git_oid *oid, void *payload)
             SET_VECTOR_ELT(
                 cb_data->tags,
                 cb_data->n,
-                item = NEW_OBJECT(MAKE_CLASS("git_commit")));
+                item = git2r_S4_new(git2r_S4_class__git_commit));
             git2r_commit_init((git_commit*)object, cb_data->repo, item);
             break;
         case GIT_OBJ_TREE:
             SET_VECTOR_ELT(
                 cb_data->tags,
                 cb_data->n,
-                item = NEW_OBJECT(MAKE_CLASS("git_tree")));
+                item = git2r_S4_new(git2r_S4_class__git_tree));
             git2r_tree_init((git_tree*)object, cb_data->repo, item);
             break;
         case GIT_OBJ_BLOB:
             SET_VECTOR_ELT(
                 cb_data->tags,
                 cb_data->n,
-                item = Rf_mkNamed(VECSXP, git2r_S3_items__git_blob));
-            Rf_setAttrib(item, R_ClassSymbol,
-                         Rf_mkString(git2r_S3_class__git_blob));
+                item = git2r_S3_new(git2r_S3_class__git_blob,
+                                    git2r_S3_items__git_blob));
             git2r_blob_init((git_blob*)object, cb_data->repo, item);
             break;
         case GIT_OBJ_TAG:
             SET_VECTOR_ELT(
                 cb_data->tags,
                 cb_data->n,
-                item = NEW_OBJECT(MAKE_CLASS("git_tag")));
+                item = git2r_S4_new(git2r_S4_class__git_tag));
             git2r_tag_init((git_tag*)object, cb_data->repo, item);
             break;
         default:
@@ -0,0 +1,302 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <R.h>
+#include <Rinternals.h>
+
+#include "git2.h"
+#include "git2/trace.h"
+#include "common.h"
+
+#include "git2r_arg.h"
+#include "git2r_error.h"
+#include "git2r_objects.h"
+#include "git2r_trace.h"
+
+/* The longest message kept, longer messages are truncated */
+#define GIT2R_TRACE_MESSAGE_SIZE 240
+
+/* The number of messages in the ring buffer if no size is given */
+#define GIT2R_TRACE_DEFAULT_SIZE 10000
+
+/**
+ * A trace message in the ring buffer
+ *
+ * The seq field is 0 while the entry is written, and then the index
+ * of the message plus one. A reader that sees the same seq before
+ * and after it copies the entry has a complete message.
+ */
+typedef struct {
+    git_atomic_ssize seq;
+    double time;
+    int level;
+    char message[GIT2R_TRACE_MESSAGE_SIZE];
+} git2r_trace_entry;
+
+typedef struct {
+    size_t size;
+    git_atomic_ssize next;
+    git2r_trace_entry entries[GIT_FLEX_ARRAY];
+} git2r_trace_ring;
+
+/*
+ * The ring buffer that the trace callback writes to. The callback can
+ * run on any thread, so it claims an entry with an atomic add and
+ * never takes a lock. The buffer is drained and replaced on the main
+ * thread only.
+ */
+static git2r_trace_ring *git2r_trace_buffer = NULL;
+static git_atomic git2r_trace_writers = {0};
+static int git2r_trace_level = GIT_TRACE_NONE;
+
+/* The index of the next message to drain */
+static ssize_t git2r_trace_read = 0;
+
+/* The number of messages that were overwritten before they were drained */
+static double git2r_trace_dropped = 0;
+
+static const char *git2r_trace_levels[] = {
+    "none", "fatal", "error", "warn", "info", "debug", "trace"};
+
+/**
+ * The trace callback
+ *
+ * @param level The level of the message.
+ * @param msg The message.
+ */
+static void git2r_trace_cb(git_trace_level_t level, const char *msg)
+{
+    git2r_trace_ring *ring;
+    git2r_trace_entry *entry;
+    ssize_t i;
+
+    git_atomic_inc(&git2r_trace_writers);
+    ring = git2r_trace_buffer;
+    if (ring) {
+        i = git_atomic_ssize_add(&ring->next, 1) - 1;
+        entry = &ring->entries[i % ring->size];
+        entry->seq.val = 0;
+        GIT_MEMORY_BARRIER;
+        entry->time = git__timer();
+        entry->level = level;
+        strncpy(entry->message, msg, GIT2R_TRACE_MESSAGE_SIZE - 1);
+        entry->message[GIT2R_TRACE_MESSAGE_SIZE - 1] = '\0';
+        GIT_MEMORY_BARRIER;
+        entry->seq.val = i + 1;
+    }
+    git_atomic_dec(&git2r_trace_writers);
+}
+
+/**
+ * Replace the ring buffer
+ *
+ * The callback must already be removed, so that a new writer sees
+ * NULL. Waits for the writers that read the old buffer before it is
+ * freed.
+ *
+ * @param ring The new ring buffer, or NULL.
+ */
+static void git2r_trace_replace(git2r_trace_ring *ring)
+{
+    git2r_trace_ring *old = git2r_trace_buffer;
+
+    git2r_trace_buffer = NULL;
+    GIT_MEMORY_BARRIER;
+    while (git_atomic_get(&git2r_trace_writers))
+        ;
+    git__free(old);
+
+    git2r_trace_read = 0;
+    git2r_trace_dropped = 0;
+    git2r_trace_buffer = ring;
+    GIT_MEMORY_BARRIER;
+}
+
+/**
+ * Copy the messages that are not drained from the ring buffer
+ *
+ * A message that is still written is left for the next drain.
+ *
+ * @param out The messages, free with git__free.
+ * @param n The number of messages.
+ * @return 0 or an error code.
+ */
+static int git2r_trace_drain(git2r_trace_entry **out, size_t *n)
+{
+    ssize_t next, seq;
+    git2r_trace_ring *ring = git2r_trace_buffer;
+    git2r_trace_entry *entries;
+
+    *out = NULL;
+    *n = 0;
+    if (!ring)
+        return 0;
+
+    next = git_atomic_ssize_add(&ring->next, 0);
+    if (next - git2r_trace_read > (ssize_t)ring->size) {
+        git2r_trace_dropped += next - ring->size - git2r_trace_read;
+        git2r_trace_read = next - ring->size;
+    }
+
+    entries = git__calloc(next - git2r_trace_read + 1, sizeof(git2r_trace_entry));
+    GITERR_CHECK_ALLOC(entries);
+
+    for (; git2r_trace_read < next; git2r_trace_read++) {
+        git2r_trace_entry *entry = &ring->entries[git2r_trace_read % ring->size];
+
+        seq = entry->seq.val;
+        GIT_MEMORY_BARRIER;
+        if (seq <= git2r_trace_read)
+            break;
+        memcpy(&entries[*n], entry, sizeof(git2r_trace_entry));
+        GIT_MEMORY_BARRIER;
+        if (seq == git2r_trace_read + 1 && entry->seq.val == seq)
+            (*n)++;
+        else
+            git2r_trace_dropped++;
+    }
+
+    *out = entries;
+
+    return 0;
+}
+
+/**
+ * Drain the trace messages from the ring buffer
+ *
+ * @return list with columns age, the seconds since the message was
+ * written, level and message. The number of messages that were
+ * overwritten before they were drained is in the attribute
+ * 'dropped'.
+ */
+SEXP git2r_trace_log(void)
+{
+    int error, nprotect = 0;
+    size_t i, n;
+    double now;
+    git2r_trace_entry *entries = NULL;
+    SEXP result = R_NilValue, names, age, level, message;
+
+    if ((error = git2r_trace_drain(&entries, &n)))
+        goto cleanup;
+
+    now = git__timer();
+    PROTECT(result = Rf_allocVector(VECSXP, 3));
+    nprotect++;
+    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 3));
+    SET_VECTOR_ELT(result, 0, age = Rf_allocVector(REALSXP, n));
+    SET_STRING_ELT(names, 0, Rf_mkChar("age"));
+    SET_VECTOR_ELT(result, 1, level = Rf_allocVector(STRSXP, n));
+    SET_STRING_ELT(names, 1, Rf_mkChar("level"));
+    SET_VECTOR_ELT(result, 2, message = Rf_allocVector(STRSXP, n));
+    SET_STRING_ELT(names, 2, Rf_mkChar("message"));
+    Rf_setAttrib(result, git2r_sym(dropped), Rf_ScalarReal(git2r_trace_dropped));
+    git2r_trace_dropped = 0;
+
+    for (i = 0; i < n; i++) {
+        REAL(age)[i] = now - entries[i].time;
+        SET_STRING_ELT(level, i, Rf_mkChar(git2r_trace_levels[entries[i].level]));
+        SET_STRING_ELT(message, i, Rf_mkChar(entries[i].message));
+    }
+
+cleanup:
+    git__free(entries);
+
+    if (nprotect)
+        UNPROTECT(nprotect);
+
+    if (error)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
+
+/**
+ * Set the libgit2 trace level and the size of the ring buffer
+ *
+ * @param level The trace level, 0 (none) to 6 (trace), or NULL to
+ * keep the current level.
+ * @param size The number of messages to keep in the ring buffer, or
+ * NULL to keep the current size. The messages that are not drained
+ * are lost if the size changes. A size of 0 frees the buffer.
+ * @return The previous trace level.
+ */
+SEXP git2r_trace_set(SEXP level, SEXP size)
+{
+    int err = 0, previous = git2r_trace_level, value = git2r_trace_level;
+    size_t n = git2r_trace_buffer ? git2r_trace_buffer->size : 0;
+    git2r_trace_ring *ring = NULL;
+
+    if (!Rf_isNull(level)) {
+        if (git2r_arg_check_integer_gte_zero(level) ||
+            INTEGER(level)[0] > GIT_TRACE_TRACE)
+            git2r_error(__func__, NULL, "'level'", git2r_err_trace_level_arg);
+        value = INTEGER(level)[0];
+    }
+
+    if (!Rf_isNull(size)) {
+        if (git2r_arg_check_integer_gte_zero(size))
+            git2r_error(__func__, NULL, "'size'", git2r_err_integer_gte_zero_arg);
+        n = INTEGER(size)[0];
+    } else if (!n && value != GIT_TRACE_NONE) {
+        n = GIT2R_TRACE_DEFAULT_SIZE;
+    }
+
+    if (!n && value != GIT_TRACE_NONE)
+        git2r_error(__func__, NULL, "'size'", git2r_err_integer_gt_zero_arg);
+
+    if (n != (git2r_trace_buffer ? git2r_trace_buffer->size : 0)) {
+        /* Remove the callback while the buffer is replaced. */
+        if (git2r_trace_level != GIT_TRACE_NONE) {
+            git_trace_set(GIT_TRACE_NONE, NULL);
+            git2r_trace_level = GIT_TRACE_NONE;
+        }
+
+        if (n) {
+            ring = git__calloc(1, sizeof(git2r_trace_ring) +
+                               n * sizeof(git2r_trace_entry));
+            if (!ring) {
+                giterr_set_str(GITERR_NONE, git2r_err_alloc_memory_buffer);
+                err = -1;
+                goto cleanup;
+            }
+            ring->size = n;
+        }
+
+        git2r_trace_replace(ring);
+    }
+
+    if (value != git2r_trace_level) {
+        if (value == GIT_TRACE_NONE)
+            err = git_trace_set(GIT_TRACE_NONE, NULL);
+        else
+            err = git_trace_set(value, git2r_trace_cb);
+        if (!err)
+            git2r_trace_level = value;
+    }
+
+cleanup:
+    if (err) {
+        /* Free the buffer if libgit2 was built without tracing. */
+        if (git2r_trace_level == GIT_TRACE_NONE)
+            git2r_trace_replace(NULL);
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+    }
+
+    return Rf_ScalarInteger(previous);
+}
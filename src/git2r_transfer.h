@@ -32,10 +32,19 @@ typedef struct {
     int received_done;
     int verbose;
     int ssh_key_agent_tried;
+    int cred_cache;
     SEXP credentials;
 } git2r_transfer_data;
 
-#define GIT2R_TRANSFER_DATA_INIT {0, 0, 0, 0, R_NilValue}
+#define GIT2R_TRANSFER_DATA_INIT {0, 0, 0, 0, GIT2R_CRED_CACHE_NONE, R_NilValue}
+
+/**
+ * The use of the credentials cache during a transfer, see
+ * git2r_cred_acquire_cb.
+ */
+#define GIT2R_CRED_CACHE_NONE   0
+#define GIT2R_CRED_CACHE_HIT    1
+#define GIT2R_CRED_CACHE_FAILED 2
 
 void git2r_transfer_progress_init(
     const git_transfer_progress *source,
@@ -21,6 +21,7 @@
 
 #include "git2r_arg.h"
 #include "git2r_error.h"
+#include "git2r_objects.h"
 #include "git2r_repository.h"
 #include "git2r_tree.h"
 
@@ -40,12 +41,12 @@ void git2r_tree_init(const git_tree *source, SEXP repo, SEXP dest)
     const git_oid *oid;
     char sha[GIT_OID_HEXSZ + 1];
     const git_tree_entry *entry;
-    SEXP s_sha = Rf_install("sha");
-    SEXP s_filemode = Rf_install("filemode");
-    SEXP s_id = Rf_install("id");
-    SEXP s_type = Rf_install("type");
-    SEXP s_name = Rf_install("name");
-    SEXP s_repo = Rf_install("repo");
+    SEXP s_sha = git2r_sym(sha);
+    SEXP s_filemode = git2r_sym(filemode);
+    SEXP s_id = git2r_sym(id);
+    SEXP s_type = git2r_sym(type);
+    SEXP s_name = git2r_sym(name);
+    SEXP s_repo = git2r_sym(repo);
 
     oid = git_tree_id(source);
     git_oid_tostr(sha, sizeof(sha), oid);
@@ -172,12 +173,12 @@ SEXP git2r_tree_walk(SEXP tree, SEXP recursive)
     if (git2r_arg_check_logical(recursive))
         git2r_error(__func__, NULL, "'recursive'", git2r_err_logical_arg);
 
-    repo = GET_SLOT(tree, Rf_install("repo"));
+    repo = GET_SLOT(tree, git2r_sym(repo));
     repository = git2r_repository_open(repo);
     if (!repository)
         git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
 
-    sha = GET_SLOT(tree, Rf_install("sha"));
+    sha = GET_SLOT(tree, git2r_sym(sha));
     git_oid_fromstr(&oid, CHAR(STRING_ELT(sha, 0)));
     err = git_tree_lookup(&tree_obj, repository, &oid);
     if (err)
@@ -0,0 +1,271 @@
+/*
+ *  git2r, R bindings to the libgit2 library.
+ *  Copyright (C) 2013-2018 The git2r contributors
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License, version 2,
+ *  as published by the Free Software Foundation.
+ *
+ *  git2r is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <Rdefines.h>
+#include "git2.h"
+#include "path.h"
+#include "worktree.h"
+
+#include "git2r_arg.h"
+#include "git2r_error.h"
+#include "git2r_objects.h"
+#include "git2r_repository.h"
+#include "git2r_worktree.h"
+
+/**
+ * Add a worktree
+ *
+ * The worktree shares the object database and references of the
+ * repository, and has its own HEAD, index and working directory.
+ *
+ * @param repo S4 class git_repository
+ * @param name The name of the worktree.
+ * @param path The path to create the worktree at.
+ * @param branch The local branch to checkout in the worktree, or
+ * R_NilValue to create the branch 'name' at HEAD.
+ * @param lock Lock the worktree.
+ * @return R_NilValue
+ */
+SEXP git2r_worktree_add(SEXP repo, SEXP name, SEXP path, SEXP branch, SEXP lock)
+{
+    int err = 0;
+    git_repository *repository = NULL;
+    git_reference *reference = NULL;
+    git_worktree *worktree = NULL;
+    git_worktree_add_options opts = GIT_WORKTREE_ADD_OPTIONS_INIT;
+
+    if (git2r_arg_check_string(name))
+        git2r_error(__func__, NULL, "'name'", git2r_err_string_arg);
+    if (git2r_arg_check_string(path))
+        git2r_error(__func__, NULL, "'path'", git2r_err_string_arg);
+    if (!Rf_isNull(branch)) {
+        if (git2r_arg_check_branch(branch))
+            git2r_error(__func__, NULL, "'branch'", git2r_err_branch_arg);
+        if (INTEGER(GET_SLOT(branch, git2r_sym(type)))[0] != GIT_BRANCH_LOCAL)
+            git2r_error(__func__, NULL, git2r_err_branch_not_local, NULL);
+    }
+    if (git2r_arg_check_logical(lock))
+        git2r_error(__func__, NULL, "'lock'", git2r_err_logical_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    if (!Rf_isNull(branch)) {
+        err = git_branch_lookup(
+            &reference,
+            repository,
+            CHAR(STRING_ELT(GET_SLOT(branch, git2r_sym(name)), 0)),
+            GIT_BRANCH_LOCAL);
+        if (err)
+            goto cleanup;
+        opts.ref = reference;
+    }
+
+    opts.lock = LOGICAL(lock)[0];
+    err = git_worktree_add(
+        &worktree,
+        repository,
+        CHAR(STRING_ELT(name, 0)),
+        CHAR(STRING_ELT(path, 0)),
+        &opts);
+
+cleanup:
+    if (worktree)
+        git_worktree_free(worktree);
+
+    if (reference)
+        git_reference_free(reference);
+
+    if (repository)
+        git_repository_free(repository);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return R_NilValue;
+}
+
+/**
+ * List the worktrees of a repository
+ *
+ * @param repo S4 class git_repository
+ * @return list with the columns name, path, locked and valid
+ */
+SEXP git2r_worktree_list(SEXP repo)
+{
+    int err;
+    size_t i, j;
+    SEXP result = R_NilValue;
+    SEXP names = R_NilValue;
+    git_repository *repository = NULL;
+    git_strarray list = {0};
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    err = git_worktree_list(&list, repository);
+    if (err)
+        goto cleanup;
+
+    PROTECT(result = Rf_allocVector(VECSXP, 4));
+    Rf_setAttrib(result, R_NamesSymbol, names = Rf_allocVector(STRSXP, 4));
+
+    j = 0;
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP, list.count));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("name"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(STRSXP, list.count));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("path"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(LGLSXP, list.count));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("locked"));
+    SET_VECTOR_ELT(result, j,   Rf_allocVector(LGLSXP, list.count));
+    SET_STRING_ELT(names,  j++, Rf_mkChar("valid"));
+
+    for (i = 0; i < list.count; i++) {
+        git_worktree *worktree = NULL;
+        char *path;
+
+        err = git_worktree_lookup(&worktree, repository, list.strings[i]);
+        if (err)
+            goto cleanup;
+
+        SET_STRING_ELT(VECTOR_ELT(result, 0), i, Rf_mkChar(list.strings[i]));
+
+        /* The worktree is the directory of its '.git' file */
+        path = git_path_dirname(worktree->gitlink_path);
+        SET_STRING_ELT(VECTOR_ELT(result, 1), i, path ? Rf_mkChar(path) : NA_STRING);
+        git__free(path);
+
+        LOGICAL(VECTOR_ELT(result, 2))[i] = git_worktree_is_locked(NULL, worktree) > 0;
+        LOGICAL(VECTOR_ELT(result, 3))[i] = git_worktree_validate(worktree) == 0;
+        giterr_clear();
+
+        git_worktree_free(worktree);
+    }
+
+cleanup:
+    git_strarray_free(&list);
+
+    if (repository)
+        git_repository_free(repository);
+
+    if (!Rf_isNull(result))
+        UNPROTECT(1);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return result;
+}
+
+/**
+ * Check if a worktree has changes, including untracked files
+ */
+static int git2r_worktree_has_changes(int *out, git_worktree *worktree)
+{
+    int err;
+    git_repository *repository = NULL;
+    git_status_list *status = NULL;
+    git_status_options opts = GIT_STATUS_OPTIONS_INIT;
+
+    *out = 0;
+
+    /* The working directory is removed already */
+    if (git_worktree_validate(worktree)) {
+        giterr_clear();
+        return 0;
+    }
+
+    opts.flags = GIT_STATUS_OPT_INCLUDE_UNTRACKED;
+
+    err = git_repository_open_from_worktree(&repository, worktree);
+    if (err)
+        goto cleanup;
+
+    err = git_status_list_new(&status, repository, &opts);
+    if (err)
+        goto cleanup;
+
+    *out = git_status_list_entrycount(status) > 0;
+
+cleanup:
+    git_status_list_free(status);
+    git_repository_free(repository);
+
+    return err;
+}
+
+/**
+ * Remove a worktree
+ *
+ * The working directory and the administrative files of the
+ * worktree in the repository are removed. The branch of the
+ * worktree is kept.
+ *
+ * @param repo S4 class git_repository
+ * @param name The name of the worktree.
+ * @param force Remove the worktree if it's locked or has changes.
+ * @return R_NilValue
+ */
+SEXP git2r_worktree_remove(SEXP repo, SEXP name, SEXP force)
+{
+    int err, changes = 0;
+    git_repository *repository = NULL;
+    git_worktree *worktree = NULL;
+    git_worktree_prune_options opts = GIT_WORKTREE_PRUNE_OPTIONS_INIT;
+
+    if (git2r_arg_check_string(name))
+        git2r_error(__func__, NULL, "'name'", git2r_err_string_arg);
+    if (git2r_arg_check_logical(force))
+        git2r_error(__func__, NULL, "'force'", git2r_err_logical_arg);
+
+    repository = git2r_repository_open(repo);
+    if (!repository)
+        git2r_error(__func__, NULL, git2r_err_invalid_repository, NULL);
+
+    err = git_worktree_lookup(&worktree, repository, CHAR(STRING_ELT(name, 0)));
+    if (err)
+        goto cleanup;
+
+    opts.flags = GIT_WORKTREE_PRUNE_VALID | GIT_WORKTREE_PRUNE_WORKING_TREE;
+    if (LOGICAL(force)[0]) {
+        opts.flags |= GIT_WORKTREE_PRUNE_LOCKED;
+    } else {
+        err = git2r_worktree_has_changes(&changes, worktree);
+        if (err || changes)
+            goto cleanup;
+    }
+
+    err = git_worktree_prune(worktree, &opts);
+
+cleanup:
+    if (worktree)
+        git_worktree_free(worktree);
+
+    if (repository)
+        git_repository_free(repository);
+
+    if (changes)
+        git2r_error(__func__, NULL, git2r_err_worktree_changes, NULL);
+
+    if (err)
+        git2r_error(__func__, giterr_last(), NULL, NULL);
+
+    return R_NilValue;
+}
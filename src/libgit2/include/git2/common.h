@@ -185,6 +185,8 @@ typedef enum {
 	GIT_OPT_GET_WINDOWS_SHAREMODE,
 	GIT_OPT_SET_WINDOWS_SHAREMODE,
 	GIT_OPT_ENABLE_STRICT_HASH_VERIFICATION,
+	GIT_OPT_ENABLE_FSYNC_BATCH,
+	GIT_OPT_SET_TRANSPORT_POOL_TIMEOUT,
 } git_libgit2_opt_t;
 
 /**
@@ -340,6 +342,27 @@ typedef enum {
  *		> is written to permanent storage, not simply cached.  This
  *		> defaults to disabled.
  *
+ *	* opts(GIT_OPT_ENABLE_FSYNC_BATCH, int enabled)
+ *
+ *		> Batch the `fsync` calls of synchronized writes.  Object files
+ *		> are not synced one at a time, but all at once before the
+ *		> next reference is written, and the directories of the new
+ *		> files are synced when the repository is freed.  An object is
+ *		> thus on permanent storage before a reference can point to
+ *		> it.  Disabling the option syncs the pending files.  This
+ *		> defaults to disabled, and has no effect on Windows.
+ *
+ *	* opts(GIT_OPT_SET_TRANSPORT_POOL_TIMEOUT, int seconds)
+ *
+ *		> Keep idle HTTP keep-alive connections and authenticated SSH
+ *		> sessions for up to `seconds`, so the next transport to the
+ *		> same host can use them instead of connecting again.  An SSH
+ *		> session is only used if the credentials callback returns
+ *		> the same credentials.  The certificate check callback is not
+ *		> called for a connection that is used again.  A timeout of 0
+ *		> closes the idle connections and disables the pool, which is
+ *		> the default.
+ *
  *	 opts(GIT_OPT_ENABLE_STRICT_HASH_VERIFICATION, int enabled)
  *
  *		> Enable strict verification of object hashsums when reading
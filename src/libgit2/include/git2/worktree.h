@@ -78,10 +78,11 @@ typedef struct git_worktree_add_options {
 	unsigned int version;
 
 	int lock; /**< lock newly created worktree */
+	git_reference *ref; /**< reference to use for the new worktree HEAD */
 } git_worktree_add_options;
 
 #define GIT_WORKTREE_ADD_OPTIONS_VERSION 1
-#define GIT_WORKTREE_ADD_OPTIONS_INIT {GIT_WORKTREE_ADD_OPTIONS_VERSION,0}
+#define GIT_WORKTREE_ADD_OPTIONS_INIT {GIT_WORKTREE_ADD_OPTIONS_VERSION,0,NULL}
 
 /**
  * Initializes a `git_worktree_add_options` with default vaules.
@@ -100,7 +101,8 @@ int git_worktree_add_init_options(git_worktree_add_options *opts,
  *
  * Add a new working tree for the repository, that is create the
  * required data structures inside the repository and check out
- * the current HEAD at `path`
+ * the branch `opts->ref` at `path`, or a new branch `name` at the
+ * current HEAD
  *
  * @param out Output pointer containing new working tree
  * @param repo Repository to create working tree for
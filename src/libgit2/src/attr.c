@@ -89,41 +89,26 @@ typedef struct {
 	git_attr_assignment *found;
 } attr_get_many_info;
 
-int git_attr_get_many_with_session(
+/* Look up the attributes of the path in the files, from the first file */
+static void attr_lookup_many(
 	const char **values,
-	git_repository *repo,
-	git_attr_session *attr_session,
-	uint32_t flags,
-	const char *pathname,
+	git_vector *files,
+	git_attr_path *path,
 	size_t num_attr,
-	const char **names)
+	const char **names,
+	attr_get_many_info *info)
 {
-	int error;
-	git_attr_path path;
-	git_vector files = GIT_VECTOR_INIT;
 	size_t i, j, k;
 	git_attr_file *file;
 	git_attr_rule *rule;
-	attr_get_many_info *info = NULL;
 	size_t num_found = 0;
 
-	if (!num_attr)
-		return 0;
-
-	assert(values && repo && names);
-
-	if (git_attr_path__init(&path, pathname, git_repository_workdir(repo), GIT_DIR_FLAG_UNKNOWN) < 0)
-		return -1;
-
-	if ((error = collect_attr_files(repo, attr_session, flags, pathname, &files)) < 0)
-		goto cleanup;
-
-	info = git__calloc(num_attr, sizeof(attr_get_many_info));
-	GITERR_CHECK_ALLOC(info);
+	for (k = 0; k < num_attr; k++)
+		info[k].found = NULL;
 
-	git_vector_foreach(&files, i, file) {
+	git_vector_foreach(files, i, file) {
 
-		git_attr_file__foreach_matching_rule(file, &path, j, rule) {
+		git_attr_file__foreach_matching_rule(file, path, j, rule) {
 
 			for (k = 0; k < num_attr; k++) {
 				size_t pos;
@@ -142,7 +127,7 @@ int git_attr_get_many_with_session(
 					values[k] = info[k].found->value;
 
 					if (++num_found == num_attr)
-						goto cleanup;
+						return;
 				}
 			}
 		}
@@ -152,6 +137,37 @@ int git_attr_get_many_with_session(
 		if (!info[k].found)
 			values[k] = NULL;
 	}
+}
+
+int git_attr_get_many_with_session(
+	const char **values,
+	git_repository *repo,
+	git_attr_session *attr_session,
+	uint32_t flags,
+	const char *pathname,
+	size_t num_attr,
+	const char **names)
+{
+	int error;
+	git_attr_path path;
+	git_vector files = GIT_VECTOR_INIT;
+	attr_get_many_info *info = NULL;
+
+	if (!num_attr)
+		return 0;
+
+	assert(values && repo && names);
+
+	if (git_attr_path__init(&path, pathname, git_repository_workdir(repo), GIT_DIR_FLAG_UNKNOWN) < 0)
+		return -1;
+
+	if ((error = collect_attr_files(repo, attr_session, flags, pathname, &files)) < 0)
+		goto cleanup;
+
+	info = git__calloc(num_attr, sizeof(attr_get_many_info));
+	GITERR_CHECK_ALLOC(info);
+
+	attr_lookup_many(values, &files, &path, num_attr, names, info);
 
 cleanup:
 	release_attr_files(&files);
@@ -161,6 +177,82 @@ cleanup:
 	return error;
 }
 
+int git_attr__get_many_paths(
+	const char **values,
+	git_repository *repo,
+	uint32_t flags,
+	const char **pathnames,
+	size_t num_paths,
+	size_t num_attr,
+	const char **names)
+{
+	int error = 0;
+	const char *workdir = git_repository_workdir(repo);
+	git_attr_session attr_session;
+	git_attr_path path;
+	git_vector files = GIT_VECTOR_INIT;
+	git_buf dir = GIT_BUF_INIT, prev = GIT_BUF_INIT;
+	attr_get_many_info *info = NULL;
+	bool collected = false;
+	size_t i;
+
+	if (!num_attr || !num_paths)
+		return 0;
+
+	assert(values && repo && pathnames && names);
+
+	info = git__calloc(num_attr, sizeof(attr_get_many_info));
+	GITERR_CHECK_ALLOC(info);
+
+	memset(&attr_session, 0, sizeof(attr_session));
+	if ((error = git_attr_session__init(&attr_session, repo)) < 0) {
+		git__free(info);
+		return error;
+	}
+
+	for (i = 0; i < num_paths; i++) {
+		if ((error = git_attr_path__init(&path, pathnames[i], workdir, GIT_DIR_FLAG_UNKNOWN)) < 0)
+			break;
+
+		/* the attribute files only depend on the directory of the path */
+		git_buf_clear(&dir);
+		if (workdir != NULL)
+			error = git_path_find_dir(&dir, pathnames[i], workdir);
+		else
+			error = git_path_dirname_r(&dir, pathnames[i]);
+
+		if (error >= 0 && (!collected || git_buf_cmp(&dir, &prev))) {
+			release_attr_files(&files);
+			collected = false;
+
+			error = collect_attr_files(
+				repo, &attr_session, flags, pathnames[i], &files);
+			if (error >= 0) {
+				git_buf_swap(&dir, &prev);
+				collected = true;
+			}
+		}
+
+		if (error >= 0) {
+			error = 0;
+			attr_lookup_many(&values[i * num_attr], &files, &path,
+				num_attr, names, info);
+		}
+
+		git_attr_path__free(&path);
+		if (error < 0)
+			break;
+	}
+
+	release_attr_files(&files);
+	git_buf_free(&dir);
+	git_buf_free(&prev);
+	git__free(info);
+	git_attr_session__free(&attr_session);
+
+	return error;
+}
+
 int git_attr_get_many(
 	const char **values,
 	git_repository *repo,
@@ -6,8 +6,11 @@
 #include "git2/blob.h"
 #include "git2/tree.h"
 #include "index.h"
+#include "array.h"
 #include <ctype.h>
 
+static void matcher_free(git_attr_matcher *matcher);
+
 static void attr_file_free(git_attr_file *file)
 {
 	bool unlock = !git_mutex_lock(&file->lock);
@@ -57,6 +60,9 @@ int git_attr_file__clear_rules(git_attr_file *file, bool need_lock)
 		git_attr_rule__free(rule);
 	git_vector_free(&file->rules);
 
+	matcher_free(file->matcher);
+	file->matcher = NULL;
+
 	if (need_lock)
 		git_mutex_unlock(&file->lock);
 
@@ -275,6 +281,9 @@ int git_attr_file__parse_buffer(
 		}
 	}
 
+	if (!error)
+		error = git_attr_file__compile(attrs);
+
 	git_mutex_unlock(&attrs->lock);
 	git_attr_rule__free(rule);
 
@@ -444,6 +453,443 @@ bool git_attr_rule__match(
 	return matched;
 }
 
+/*
+ * Compiled matcher
+ *
+ * Rules whose pattern is a literal string are looked up in hash
+ * tables instead of being matched one at a time:
+ *
+ *   names       "name"      compared to the basename
+ *   dirs        "name/"     compared to the basename of directories
+ *   suffixes    "*suffix"   compared to the end of the basename
+ *   paths       "/path"     compared to the relative path
+ *   leadingdirs "path/\*"   compared to each leading directory of the
+ *                           relative path
+ *
+ * A table entry is only a candidate: the answer is the last matching
+ * rule, so the remaining rules (wildcards, negations, rules from
+ * another directory, ...) are evaluated with fnmatch, but only those
+ * after the best candidate. Directory rules are in the "dirs" table
+ * for directories and evaluated with fnmatch for files.
+ */
+
+typedef struct {
+	const char *key;
+	size_t len;
+	uint32_t hash;
+	size_t rule;
+} git_attr_matcher_entry;
+
+typedef struct {
+	git_attr_matcher_entry *entries;
+	size_t size;
+	size_t count;
+} git_attr_matcher_table;
+
+struct git_attr_matcher {
+	const char *containing_dir;
+	size_t containing_dir_length;
+	int icase;
+	int primed;
+	git_attr_matcher_table names;
+	git_attr_matcher_table dirs;
+	git_attr_matcher_table suffixes;
+	git_attr_matcher_table paths;
+	git_attr_matcher_table leadingdirs;
+	git_array_t(size_t) suffix_lengths;
+	git_array_t(size_t) others;
+	git_array_t(size_t) dir_rules;
+};
+
+static uint32_t matcher_hash(const char *key, size_t len, int icase)
+{
+	uint32_t h = 5381;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		int c = (unsigned char)key[i];
+		h = ((h << 5) + h) + (icase ? git__tolower(c) : c);
+	}
+
+	return h;
+}
+
+static bool matcher_key_equal(
+	const char *a, const char *b, size_t len, int icase)
+{
+	size_t i;
+
+	if (!icase)
+		return !memcmp(a, b, len);
+
+	for (i = 0; i < len; i++) {
+		if (git__tolower((unsigned char)a[i]) !=
+			git__tolower((unsigned char)b[i]))
+			return false;
+	}
+
+	return true;
+}
+
+static void matcher_table_free(git_attr_matcher_table *table)
+{
+	git__free(table->entries);
+	memset(table, 0, sizeof(*table));
+}
+
+static int matcher_table_grow(git_attr_matcher_table *table)
+{
+	git_attr_matcher_entry *entries;
+	size_t size = table->size ? table->size * 2 : 16, i;
+
+	entries = git__calloc(size, sizeof(git_attr_matcher_entry));
+	GITERR_CHECK_ALLOC(entries);
+
+	for (i = 0; i < table->size; i++) {
+		git_attr_matcher_entry *entry = &table->entries[i];
+		size_t pos;
+
+		if (!entry->key)
+			continue;
+
+		pos = entry->hash & (size - 1);
+		while (entries[pos].key)
+			pos = (pos + 1) & (size - 1);
+		entries[pos] = *entry;
+	}
+
+	git__free(table->entries);
+	table->entries = entries;
+	table->size = size;
+
+	return 0;
+}
+
+static int matcher_table_insert(
+	git_attr_matcher_table *table,
+	const char *key,
+	size_t len,
+	size_t rule,
+	int icase)
+{
+	uint32_t hash = matcher_hash(key, len, icase);
+	size_t pos;
+
+	if ((table->count + 1) * 2 > table->size &&
+		matcher_table_grow(table) < 0)
+		return -1;
+
+	pos = hash & (table->size - 1);
+	while (table->entries[pos].key)
+		pos = (pos + 1) & (table->size - 1);
+
+	table->entries[pos].key = key;
+	table->entries[pos].len = len;
+	table->entries[pos].hash = hash;
+	table->entries[pos].rule = rule;
+	table->count++;
+
+	return 0;
+}
+
+/*
+ * Update best (one past the position of a rule) with the last rule
+ * before position `before` that is stored under key. Rules with the
+ * same key are all in the probe sequence up to the first empty slot.
+ */
+static void matcher_table_lookup(
+	size_t *best,
+	const git_attr_matcher_table *table,
+	const char *key,
+	size_t len,
+	size_t before,
+	int icase)
+{
+	uint32_t hash;
+	size_t pos;
+
+	if (!table->count)
+		return;
+
+	hash = matcher_hash(key, len, icase);
+	pos = hash & (table->size - 1);
+
+	while (table->entries[pos].key) {
+		const git_attr_matcher_entry *entry = &table->entries[pos];
+
+		if (entry->hash == hash && entry->len == len &&
+			entry->rule < before && entry->rule + 1 > *best &&
+			matcher_key_equal(entry->key, key, len, icase))
+			*best = entry->rule + 1;
+
+		pos = (pos + 1) & (table->size - 1);
+	}
+}
+
+static bool matcher_is_literal(const char *pattern, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		switch (pattern[i]) {
+		case '*':
+		case '?':
+		case '[':
+		case '\\':
+			return false;
+		}
+	}
+
+	return len > 0;
+}
+
+static bool matcher_rule_match(
+	git_attr_file *file, size_t pos, git_attr_path *path, bool negate)
+{
+	git_attr_fnmatch *match = git_vector_get(&file->rules, pos);
+	bool matched = git_attr_fnmatch__match(match, path);
+
+	if (negate && (match->flags & GIT_ATTR_FNMATCH_NEGATIVE))
+		matched = !matched;
+
+	return matched;
+}
+
+/* Evaluate the rules in (best, before) of an ascending list. */
+static size_t matcher_scan(
+	git_attr_file *file,
+	const size_t *rules,
+	size_t count,
+	git_attr_path *path,
+	size_t best,
+	size_t before,
+	bool negate)
+{
+	size_t lo = 0, hi = count;
+
+	/* find the first rule that is not before `before` */
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (rules[mid] < before)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	while (lo > 0 && rules[lo - 1] + 1 > best) {
+		lo--;
+		if (matcher_rule_match(file, rules[lo], path, negate))
+			return rules[lo] + 1;
+	}
+
+	return best;
+}
+
+static void matcher_free(git_attr_matcher *matcher)
+{
+	if (!matcher)
+		return;
+
+	matcher_table_free(&matcher->names);
+	matcher_table_free(&matcher->dirs);
+	matcher_table_free(&matcher->suffixes);
+	matcher_table_free(&matcher->paths);
+	matcher_table_free(&matcher->leadingdirs);
+	git_array_clear(matcher->suffix_lengths);
+	git_array_clear(matcher->others);
+	git_array_clear(matcher->dir_rules);
+	git__free(matcher);
+}
+
+static int matcher_add_suffix_length(git_attr_matcher *matcher, size_t len)
+{
+	size_t i, *entry;
+
+	for (i = 0; i < git_array_size(matcher->suffix_lengths); i++) {
+		if (*git_array_get(matcher->suffix_lengths, i) == len)
+			return 0;
+	}
+
+	entry = git_array_alloc(matcher->suffix_lengths);
+	GITERR_CHECK_ALLOC(entry);
+	*entry = len;
+
+	return 0;
+}
+
+static int matcher_add_rule(
+	git_attr_matcher *matcher, git_attr_fnmatch *match, size_t pos)
+{
+	const unsigned int special = GIT_ATTR_FNMATCH_NEGATIVE |
+		GIT_ATTR_FNMATCH_MACRO | GIT_ATTR_FNMATCH_MATCH_ALL;
+	unsigned int flags = match->flags;
+	int icase = (flags & GIT_ATTR_FNMATCH_ICASE) != 0;
+	size_t *entry;
+
+	if ((flags & special) != 0 || !match->pattern)
+		goto other;
+
+	/* the first indexed rule decides the directory and case of all */
+	if (!matcher->primed) {
+		matcher->containing_dir = match->containing_dir;
+		matcher->containing_dir_length = match->containing_dir_length;
+		matcher->icase = icase;
+		matcher->primed = 1;
+	}
+
+	/* rules that can't be indexed are evaluated with fnmatch */
+	if (icase != matcher->icase ||
+		(match->containing_dir == NULL) !=
+			(matcher->containing_dir == NULL) ||
+		(match->containing_dir &&
+			strcmp(match->containing_dir, matcher->containing_dir)))
+		goto other;
+
+	if (flags & GIT_ATTR_FNMATCH_FULLPATH) {
+		if ((flags & GIT_ATTR_FNMATCH_DIRECTORY) ||
+			!matcher_is_literal(match->pattern, match->length))
+			goto other;
+
+		return matcher_table_insert(
+			(flags & GIT_ATTR_FNMATCH_LEADINGDIR) ?
+				&matcher->leadingdirs : &matcher->paths,
+			match->pattern, match->length, pos, icase);
+	}
+
+	if (match->pattern[0] == '*' &&
+		matcher_is_literal(match->pattern + 1, match->length - 1) &&
+		!(flags & GIT_ATTR_FNMATCH_DIRECTORY)) {
+		if (matcher_add_suffix_length(matcher, match->length - 1) < 0)
+			return -1;
+
+		return matcher_table_insert(&matcher->suffixes,
+			match->pattern + 1, match->length - 1, pos, icase);
+	}
+
+	if (!matcher_is_literal(match->pattern, match->length) ||
+		memchr(match->pattern, '/', match->length) != NULL)
+		goto other;
+
+	if (flags & GIT_ATTR_FNMATCH_DIRECTORY) {
+		entry = git_array_alloc(matcher->dir_rules);
+		GITERR_CHECK_ALLOC(entry);
+		*entry = pos;
+
+		return matcher_table_insert(
+			&matcher->dirs, match->pattern, match->length, pos, icase);
+	}
+
+	return matcher_table_insert(
+		&matcher->names, match->pattern, match->length, pos, icase);
+
+other:
+	entry = git_array_alloc(matcher->others);
+	GITERR_CHECK_ALLOC(entry);
+	*entry = pos;
+
+	return 0;
+}
+
+int git_attr_file__compile(git_attr_file *file)
+{
+	git_attr_matcher *matcher;
+	git_attr_fnmatch *match;
+	size_t i;
+
+	matcher_free(file->matcher);
+	file->matcher = NULL;
+
+	matcher = git__calloc(1, sizeof(git_attr_matcher));
+	GITERR_CHECK_ALLOC(matcher);
+
+	git_vector_foreach(&file->rules, i, match) {
+		if (matcher_add_rule(matcher, match, i) < 0) {
+			matcher_free(matcher);
+			return -1;
+		}
+	}
+
+	file->matcher = matcher;
+
+	return 0;
+}
+
+size_t git_attr_file__prev_match(
+	git_attr_file *file,
+	git_attr_path *path,
+	size_t before,
+	bool negate)
+{
+	git_attr_matcher *matcher = file->matcher;
+	const char *relpath = path->path;
+	size_t best = 0, i, len;
+
+	if (before > file->rules.length)
+		before = file->rules.length;
+
+	if (!matcher) {
+		for (i = before; i > 0; i--) {
+			if (matcher_rule_match(file, i - 1, path, negate))
+				return i;
+		}
+
+		return 0;
+	}
+
+	if (matcher->containing_dir) {
+		if (matcher->icase ?
+			git__strncasecmp(relpath, matcher->containing_dir,
+				matcher->containing_dir_length) :
+			git__prefixcmp(relpath, matcher->containing_dir))
+			relpath = NULL;
+		else
+			relpath += matcher->containing_dir_length;
+	}
+
+	if (relpath) {
+		int icase = matcher->icase;
+		const char *scan;
+
+		len = strlen(path->basename);
+		matcher_table_lookup(&best, &matcher->names,
+			path->basename, len, before, icase);
+
+		if (path->is_dir)
+			matcher_table_lookup(&best, &matcher->dirs,
+				path->basename, len, before, icase);
+
+		for (i = 0; i < git_array_size(matcher->suffix_lengths); i++) {
+			size_t suffix_len = *git_array_get(matcher->suffix_lengths, i);
+
+			if (suffix_len <= len)
+				matcher_table_lookup(&best, &matcher->suffixes,
+					path->basename + len - suffix_len, suffix_len,
+					before, icase);
+		}
+
+		len = strlen(relpath);
+		matcher_table_lookup(&best, &matcher->paths,
+			relpath, len, before, icase);
+
+		if (matcher->leadingdirs.count) {
+			for (scan = relpath; (scan = strchr(scan, '/')) != NULL; scan++)
+				matcher_table_lookup(&best, &matcher->leadingdirs,
+					relpath, scan - relpath, before, icase);
+			matcher_table_lookup(&best, &matcher->leadingdirs,
+				relpath, len, before, icase);
+		}
+	}
+
+	best = matcher_scan(file, matcher->others.ptr,
+		git_array_size(matcher->others), path, best, before, negate);
+
+	if (!path->is_dir)
+		best = matcher_scan(file, matcher->dir_rules.ptr,
+			git_array_size(matcher->dir_rules), path, best, before, negate);
+
+	return best;
+}
+
 git_attr_assignment *git_attr_rule__lookup_assignment(
 	git_attr_rule *rule, const char *name)
 {
@@ -76,6 +76,7 @@ typedef struct {
 } git_attr_assignment;
 
 typedef struct git_attr_file_entry git_attr_file_entry;
+typedef struct git_attr_matcher git_attr_matcher;
 
 typedef struct {
 	git_refcount rc;
@@ -83,6 +84,7 @@ typedef struct {
 	git_attr_file_entry *entry;
 	git_attr_file_source source;
 	git_vector rules;			/* vector of <rule*> or <fnmatch*> */
+	git_attr_matcher *matcher;	/* index of rules, may be NULL */
 	git_pool pool;
 	unsigned int nonexistent:1;
 	int session_key;
@@ -129,6 +131,19 @@ extern int git_attr_get_many_with_session(
 	size_t num_attr,
 	const char **names);
 
+/* Look up the attributes of each of the paths, num_attr values per path.
+ * The attribute files of a directory are reused for the next path in the
+ * same directory, so sorting the paths by directory is faster.
+ */
+extern int git_attr__get_many_paths(
+	const char **values_out,
+	git_repository *repo,
+	uint32_t flags,
+	const char **paths,
+	size_t num_paths,
+	size_t num_attr,
+	const char **names);
+
 typedef int (*git_attr_file_parser)(
 	git_repository *repo,
 	git_attr_file *file,
@@ -171,10 +186,33 @@ int git_attr_file__lookup_one(
 	const char *attr,
 	const char **value);
 
-/* loop over rules in file from bottom to top */
+/*
+ * Compile the rules of the file into a matcher that looks up literal
+ * names, paths, leading directories and "*suffix" patterns in hash
+ * tables; all other rules are evaluated with fnmatch.
+ */
+int git_attr_file__compile(git_attr_file *file);
+
+/*
+ * Find the last rule before position `before` that matches the path.
+ * Returns one plus the position of that rule, or 0 if no rule
+ * matches. With `negate` the result of negative rules is inverted as
+ * in git_attr_rule__match, otherwise git_attr_fnmatch__match is used.
+ */
+size_t git_attr_file__prev_match(
+	git_attr_file *file,
+	git_attr_path *path,
+	size_t before,
+	bool negate);
+
+/* loop over rules in file from bottom to top, iter is one past the rule */
 #define git_attr_file__foreach_matching_rule(file, path, iter, rule)	\
-	git_vector_rforeach(&(file)->rules, (iter), (rule)) \
-		if (git_attr_rule__match((rule), (path)))
+	for ((iter) = git_attr_file__prev_match(	\
+			(file), (path), (file)->rules.length, true);	\
+		(iter) > 0 &&	\
+			((rule) = git_vector_get(&(file)->rules, (iter) - 1)) != NULL; \
+		(iter) = git_attr_file__prev_match(	\
+			(file), (path), (iter) - 1, true))
 
 uint32_t git_attr_file__name_hash(const char *name);
 
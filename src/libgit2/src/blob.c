@@ -107,26 +107,50 @@ static int write_file_stream(
 	return error;
 }
 
+static int write_spool_cb(const char *data, size_t len, void *payload)
+{
+	return git_odb_stream_write((git_odb_stream *)payload, data, len);
+}
+
+/*
+ * The filtered content is streamed into a spool, which keeps small
+ * results in memory and writes large ones to a temporary file. The
+ * final size is then known, so the blob can be streamed to the ODB.
+ */
 static int write_file_filtered(
 	git_oid *id,
 	git_off_t *size,
 	git_odb *odb,
+	git_repository *repo,
 	const char *full_path,
 	git_filter_list *fl)
 {
 	int error;
-	git_buf tgt = GIT_BUF_INIT;
+	git_filter_spool spool;
+	git_odb_stream *stream = NULL;
 
-	error = git_filter_list_apply_to_file(&tgt, fl, NULL, full_path);
+	git_filter_spool__init(&spool, repo);
 
-	/* Write the file to disk if it was properly filtered */
-	if (!error) {
-		*size = tgt.size;
+	if ((error = git_filter_list_stream_file(fl, NULL, full_path, &spool.parent)) < 0)
+		goto done;
 
-		error = git_odb_write(id, odb, tgt.ptr, tgt.size, GIT_OBJ_BLOB);
+	*size = spool.size;
+
+	/* Write the file to disk if it was properly filtered */
+	if (spool.fd < 0) {
+		error = git_odb_write(id, odb, spool.buf.ptr, spool.buf.size, GIT_OBJ_BLOB);
+		goto done;
 	}
 
-	git_buf_free(&tgt);
+	if ((error = git_odb_open_wstream(&stream, odb, spool.size, GIT_OBJ_BLOB)) < 0 ||
+		(error = git_filter_spool__foreach(&spool, write_spool_cb, stream)) < 0)
+		goto done;
+
+	error = git_odb_stream_finalize_write(id, stream);
+
+done:
+	git_odb_stream_free(stream);
+	git_filter_spool__free(&spool);
 	return error;
 }
 
@@ -216,24 +240,10 @@ int git_blob__create_from_paths(
 			error = write_file_stream(id, odb, content_path, size);
 		else {
 			/* We need to apply one or more filters */
-			error = write_file_filtered(id, &size, odb, content_path, fl);
+			error = write_file_filtered(id, &size, odb, repo, content_path, fl);
 
 			git_filter_list_free(fl);
 		}
-
-		/*
-		 * TODO: eventually support streaming filtered files, for files
-		 * which are bigger than a given threshold. This is not a priority
-		 * because applying a filter in streaming mode changes the final
-		 * size of the blob, and without knowing its final size, the blob
-		 * cannot be written in stream mode to the ODB.
-		 *
-		 * The plan is to do streaming writes to a tempfile on disk and then
-		 * opening streaming that file to the ODB, using
-		 * `write_file_stream`.
-		 *
-		 * CAREFULLY DESIGNED APIS YO
-		 */
 	}
 
 done:
@@ -13,6 +13,7 @@
 #include "cache.h"
 #include "odb.h"
 #include "object.h"
+#include "stats.h"
 #include "git2/oid.h"
 
 bool git_cache__enabled = true;
@@ -167,6 +168,8 @@ static void *cache_get(git_cache *cache, const git_oid *oid, unsigned int flags)
 
 	git_rwlock_rdunlock(&cache->lock);
 
+	GIT_STATS_INC(entry ? GIT_STATS_CACHE_HIT : GIT_STATS_CACHE_MISS);
+
 	return entry;
 }
 
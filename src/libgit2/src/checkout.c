@@ -34,6 +34,7 @@
 #include "attr.h"
 #include "pool.h"
 #include "strmap.h"
+#include "trace.h"
 
 /* See docs/checkout-internals.md for more information */
 
@@ -1308,6 +1309,15 @@ static int checkout_get_actions(
 
 		actions[i] = act;
 
+		if (act)
+			git_trace(GIT_TRACE_TRACE, "checkout:%s%s%s%s%s %s",
+				(act & CHECKOUT_ACTION__REMOVE) ? " remove" : "",
+				(act & CHECKOUT_ACTION__UPDATE_BLOB) ? " update" : "",
+				(act & CHECKOUT_ACTION__UPDATE_SUBMODULE) ? " submodule" : "",
+				(act & CHECKOUT_ACTION__CONFLICT) ? " conflict" : "",
+				(act & CHECKOUT_ACTION__DEFER_REMOVE) ? " defer-remove" : "",
+				delta->old_file.path ? delta->old_file.path : delta->new_file.path);
+
 		if (act & CHECKOUT_ACTION__REMOVE)
 			counts[CHECKOUT_ACTION__REMOVE]++;
 		if (act & CHECKOUT_ACTION__UPDATE_BLOB)
@@ -1324,6 +1334,14 @@ static int checkout_get_actions(
 
 	counts[CHECKOUT_ACTION__REMOVE] += data->removes.length;
 
+	git_trace(GIT_TRACE_DEBUG,
+		"checkout: %"PRIuZ" deltas, %"PRIuZ" removes, %"PRIuZ" updates, "
+		"%"PRIuZ" submodules, %"PRIuZ" conflicts",
+		deltas->length, counts[CHECKOUT_ACTION__REMOVE],
+		counts[CHECKOUT_ACTION__UPDATE_BLOB],
+		counts[CHECKOUT_ACTION__UPDATE_SUBMODULE],
+		counts[CHECKOUT_ACTION__CONFLICT]);
+
 	if (counts[CHECKOUT_ACTION__CONFLICT] > 0 &&
 		(data->strategy & GIT_CHECKOUT_ALLOW_CONFLICTS) == 0)
 	{
@@ -1469,10 +1487,17 @@ static void checkout_stream_free(git_writestream *s)
 	GIT_UNUSED(s);
 }
 
+/*
+ * Write the content of a blob to a file. The content is either given
+ * as a loaded `blob` or, when `blob` is NULL, read in chunks from the
+ * odb `stream` of the object `oid`.
+ */
 static int blob_content_to_file(
 	checkout_data *data,
 	struct stat *st,
 	git_blob *blob,
+	git_odb_stream *stream,
+	const git_oid *oid,
 	const char *path,
 	const char *hint_path,
 	mode_t entry_filemode)
@@ -1523,7 +1548,10 @@ static int blob_content_to_file(
 	writer.fd = fd;
 	writer.open = 1;
 
-	error = git_filter_list_stream_blob(fl, blob, &writer.base);
+	if (blob)
+		error = git_filter_list_stream_blob(fl, blob, &writer.base);
+	else
+		error = git_filter_list__stream_odb(fl, stream, oid, &writer.base);
 
 	assert(writer.open == 0);
 
@@ -1711,16 +1739,34 @@ static int checkout_write_content(
 {
 	int error = 0;
 	git_blob *blob;
+	git_odb *odb;
+	git_odb_stream *stream = NULL;
 
-	if ((error = git_blob_lookup(&blob, data->repo, oid)) < 0)
-		return error;
+	/*
+	 * Stream the content of files from the odb when possible, so
+	 * that large blobs are never loaded whole in memory. Objects
+	 * that can't be streamed (e.g. deltified in a pack) are loaded.
+	 */
+	if (!S_ISLNK(mode) &&
+		git_repository_odb__weakptr(&odb, data->repo) == 0 &&
+		git_odb_open_rstream(&stream, odb, oid) == 0) {
+		error = blob_content_to_file(
+			data, st, NULL, stream, oid, full_path, hint_path, mode);
+		git_odb_stream_free(stream);
+	} else {
+		giterr_clear();
 
-	if (S_ISLNK(mode))
-		error = blob_content_to_link(data, st, blob, full_path);
-	else
-		error = blob_content_to_file(data, st, blob, full_path, hint_path, mode);
+		if ((error = git_blob_lookup(&blob, data->repo, oid)) < 0)
+			return error;
 
-	git_blob_free(blob);
+		if (S_ISLNK(mode))
+			error = blob_content_to_link(data, st, blob, full_path);
+		else
+			error = blob_content_to_file(
+				data, st, blob, NULL, oid, full_path, hint_path, mode);
+
+		git_blob_free(blob);
+	}
 
 	/* if we try to create the blob and an existing directory blocks it from
 	 * being written, then there must have been a typechange conflict in a
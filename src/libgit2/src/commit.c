@@ -19,6 +19,7 @@
 #include "refs.h"
 #include "object.h"
 #include "oidarray.h"
+#include "stats.h"
 
 void git_commit__free(void *_commit)
 {
@@ -381,9 +382,8 @@ int git_commit_amend(
 	return error;
 }
 
-int git_commit__parse(void *_commit, git_odb_object *odb_obj)
+static int commit_parse(git_commit *commit, git_odb_object *odb_obj, unsigned int flags, git_pool *pool)
 {
-	git_commit *commit = _commit;
 	const char *buffer_start = git_odb_object_data(odb_obj), *buffer;
 	const char *buffer_end = buffer_start + git_odb_object_size(odb_obj);
 	git_oid parent_id;
@@ -392,14 +392,29 @@ int git_commit__parse(void *_commit, git_odb_object *odb_obj)
 
 	buffer = buffer_start;
 
-	/* Allocate for one, which will allow not to realloc 90% of the time  */
-	git_array_init_to_size(commit->parent_ids, 1);
-	GITERR_CHECK_ARRAY(commit->parent_ids);
-
 	/* The tree is always the first field */
 	if (git_oid__parse(&commit->tree_id, &buffer, buffer_end, "tree ") < 0)
 		goto bad_buffer;
 
+	if (pool) {
+		/* Size the parents exactly, the array is never grown */
+		const char *parents_start = buffer;
+		size_t parents = 0;
+
+		while (git_oid__parse(&parent_id, &buffer, buffer_end, "parent ") == 0)
+			parents++;
+		buffer = parents_start;
+
+		commit->parent_ids.ptr = git_pool_malloc(
+			pool, (uint32_t)((parents ? parents : 1) * sizeof(git_oid)));
+		GITERR_CHECK_ALLOC(commit->parent_ids.ptr);
+		commit->parent_ids.asize = parents;
+	} else {
+		/* Allocate for one, which will allow not to realloc 90% of the time  */
+		git_array_init_to_size(commit->parent_ids, 1);
+		GITERR_CHECK_ARRAY(commit->parent_ids);
+	}
+
 	/*
 	 * TODO: commit grafts!
 	 */
@@ -411,14 +426,26 @@ int git_commit__parse(void *_commit, git_odb_object *odb_obj)
 		git_oid_cpy(new_id, &parent_id);
 	}
 
-	commit->author = git__malloc(sizeof(git_signature));
+	if (pool)
+		commit->author = git_pool_malloc(pool, sizeof(git_signature));
+	else
+		commit->author = git__malloc(sizeof(git_signature));
 	GITERR_CHECK_ALLOC(commit->author);
 
-	if (git_signature__parse(commit->author, &buffer, buffer_end, "author ", '\n') < 0)
+	if (pool ?
+		git_signature__parse_pool(commit->author, &buffer, buffer_end, "author ", '\n', pool) < 0 :
+		git_signature__parse(commit->author, &buffer, buffer_end, "author ", '\n') < 0)
 		return -1;
 
 	/* Some tools create multiple author fields, ignore the extra ones */
 	while ((size_t)(buffer_end - buffer) >= strlen("author ") && !git__prefixcmp(buffer, "author ")) {
+		if (pool) {
+			if (git_signature__parse_pool(&dummy_sig, &buffer, buffer_end, "author ", '\n', pool) < 0)
+				return -1;
+
+			continue;
+		}
+
 		if (git_signature__parse(&dummy_sig, &buffer, buffer_end, "author ", '\n') < 0)
 			return -1;
 
@@ -427,12 +454,21 @@ int git_commit__parse(void *_commit, git_odb_object *odb_obj)
 	}
 
 	/* Always parse the committer; we need the commit time */
-	commit->committer = git__malloc(sizeof(git_signature));
+	if (pool)
+		commit->committer = git_pool_malloc(pool, sizeof(git_signature));
+	else
+		commit->committer = git__malloc(sizeof(git_signature));
 	GITERR_CHECK_ALLOC(commit->committer);
 
-	if (git_signature__parse(commit->committer, &buffer, buffer_end, "committer ", '\n') < 0)
+	if (pool ?
+		git_signature__parse_pool(commit->committer, &buffer, buffer_end, "committer ", '\n', pool) < 0 :
+		git_signature__parse(commit->committer, &buffer, buffer_end, "committer ", '\n') < 0)
 		return -1;
 
+	/* A quick parse leaves the encoding, header and message unset */
+	if (flags & GIT_COMMIT_PARSE_QUICK)
+		return 0;
+
 	/* Parse add'l header entries */
 	while (buffer < buffer_end) {
 		const char *eoln = buffer;
@@ -468,6 +504,8 @@ int git_commit__parse(void *_commit, git_odb_object *odb_obj)
 		commit->raw_message = git__strdup("");
 	GITERR_CHECK_ALLOC(commit->raw_message);
 
+	GIT_STATS_INC(GIT_STATS_COMMIT_MESSAGE);
+
 	return 0;
 
 bad_buffer:
@@ -475,6 +513,40 @@ bad_buffer:
 	return -1;
 }
 
+int git_commit__parse(void *_commit, git_odb_object *odb_obj)
+{
+	return commit_parse(_commit, odb_obj, 0, NULL);
+}
+
+int git_commit__parse_ext(git_commit *commit, git_odb_object *odb_obj, unsigned int flags)
+{
+	return commit_parse(commit, odb_obj, flags, NULL);
+}
+
+int git_commit__parse_pool(git_commit **out, git_odb_object *odb_obj, git_pool *pool)
+{
+	git_commit *commit;
+	int error;
+
+	assert(out && odb_obj && pool && pool->item_size == sizeof(char));
+
+	*out = NULL;
+
+	commit = git_pool_mallocz(pool, sizeof(git_commit));
+	GITERR_CHECK_ALLOC(commit);
+
+	git_oid_cpy(&commit->object.cached.oid, git_odb_object_id(odb_obj));
+	commit->object.cached.type = GIT_OBJ_COMMIT;
+
+	/* Only a quick parse; the lazily computed summary and body are
+	 * allocated outside of the pool */
+	if ((error = commit_parse(commit, odb_obj, GIT_COMMIT_PARSE_QUICK, pool)) < 0)
+		return error;
+
+	*out = commit;
+	return 0;
+}
+
 #define GIT_COMMIT_GETTER(_rvalue, _name, _return) \
 	_rvalue git_commit_##_name(const git_commit *commit) \
 	{\
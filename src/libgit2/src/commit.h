@@ -31,7 +31,20 @@ struct git_commit {
 	char *body;
 };
 
+typedef enum {
+	/** Only parse the tree, parents, author and committer */
+	GIT_COMMIT_PARSE_QUICK = (1 << 0),
+} git_commit__parse_flags;
+
 void git_commit__free(void *commit);
 int git_commit__parse(void *commit, git_odb_object *obj);
+int git_commit__parse_ext(git_commit *commit, git_odb_object *obj, unsigned int flags);
+
+/*
+ * Quick parse of a commit where the commit, its parents and its
+ * signatures are allocated from `pool`. The commit must not be freed
+ * with git_commit__free, it is released when the pool is cleared.
+ */
+int git_commit__parse_pool(git_commit **out, git_odb_object *obj, git_pool *pool);
 
 #endif
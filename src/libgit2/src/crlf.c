@@ -76,33 +76,33 @@ static int crlf_input_action(struct crlf_attrs *ca)
 	return ca->crlf_action;
 }
 
-static int has_cr_in_index(const git_filter_source *src)
+static int has_cr_in_blob(git_repository *repo, const git_oid *id)
 {
-	git_repository *repo = git_filter_source_repo(src);
-	const char *path = git_filter_source_path(src);
-	git_index *index;
-	const git_index_entry *entry;
+	git_odb *odb;
+	git_odb_stream *stream;
 	git_blob *blob;
 	const void *blobcontent;
 	git_off_t blobsize;
-	bool found_cr;
+	char buffer[FILTERIO_BUFSIZE];
+	int readlen = 0;
+	bool found_cr = false;
 
-	if (!path)
-		return false;
+	/* scan large blobs in chunks instead of loading them whole */
+	if (git_repository_odb__weakptr(&odb, repo) == 0 &&
+		git_odb_open_rstream(&stream, odb, id) == 0) {
+		while (!found_cr &&
+			(readlen = git_odb_stream_read(stream, buffer, sizeof(buffer))) > 0)
+			found_cr = (memchr(buffer, '\r', (size_t)readlen) != NULL);
 
-	if (git_repository_index__weakptr(&index, repo) < 0) {
-		giterr_clear();
-		return false;
-	}
+		git_odb_stream_free(stream);
 
-	if (!(entry = git_index_get_bypath(index, path, 0)) &&
-		!(entry = git_index_get_bypath(index, path, 1)))
-		return false;
+		if (readlen >= 0)
+			return found_cr;
+	}
 
-	if (!S_ISREG(entry->mode)) /* don't crlf filter non-blobs */
-		return true;
+	giterr_clear();
 
-	if (git_blob_lookup(&blob, repo, &entry->id) < 0)
+	if (git_blob_lookup(&blob, repo, id) < 0)
 		return false;
 
 	blobcontent = git_blob_rawcontent(blob);
@@ -118,6 +118,31 @@ static int has_cr_in_index(const git_filter_source *src)
 	return found_cr;
 }
 
+static int has_cr_in_index(const git_filter_source *src)
+{
+	git_repository *repo = git_filter_source_repo(src);
+	const char *path = git_filter_source_path(src);
+	git_index *index;
+	const git_index_entry *entry;
+
+	if (!path)
+		return false;
+
+	if (git_repository_index__weakptr(&index, repo) < 0) {
+		giterr_clear();
+		return false;
+	}
+
+	if (!(entry = git_index_get_bypath(index, path, 0)) &&
+		!(entry = git_index_get_bypath(index, path, 1)))
+		return false;
+
+	if (!S_ISREG(entry->mode)) /* don't crlf filter non-blobs */
+		return true;
+
+	return has_cr_in_blob(repo, &entry->id);
+}
+
 static int crlf_apply_to_odb(
 	struct crlf_attrs *ca,
 	git_buf *to,
@@ -357,6 +382,305 @@ static int crlf_apply(
 		return crlf_apply_to_odb(*payload, to, from, src);
 }
 
+/*
+ * Streaming version of the filter. When the attributes leave no
+ * choice the conversion is applied chunk by chunk as the data is
+ * written. For 'auto' and the guessed conversions the decision
+ * depends on statistics of the whole content, which is spooled
+ * (see git_filter_spool) while the statistics are gathered and
+ * replayed through the conversion when the stream is closed.
+ */
+
+typedef enum {
+	CRLF_STREAM_PASSTHROUGH = 0,
+	CRLF_STREAM_TO_LF,
+	CRLF_STREAM_TO_CRLF,
+} crlf_stream_action;
+
+struct crlf_stream_stats {
+	uint64_t nul, cr, lf, crlf;
+	uint64_t printable, nonprintable;
+};
+
+struct crlf_stream {
+	git_writestream parent;
+	git_writestream *next;
+	struct crlf_attrs *ca;
+	const git_filter_source *src;
+	crlf_stream_action action;
+	int spooling;
+	git_filter_spool spool;
+	struct crlf_stream_stats stats;
+	unsigned char held, last_counted;
+	int has_held;
+	char last; /* last byte seen by the conversion */
+	int pending_cr; /* a '\r' ends the data converted to LF so far */
+	git_buf out;
+};
+
+static void crlf_stream_count(struct crlf_stream *s, unsigned char c)
+{
+	struct crlf_stream_stats *stats = &s->stats;
+
+	if (c > 0x1F && c != 0x7F)
+		stats->printable++;
+	else switch (c) {
+		case '\0':
+			stats->nul++;
+			stats->nonprintable++;
+			break;
+		case '\n':
+			stats->lf++;
+			if (s->last_counted == '\r')
+				stats->crlf++;
+			break;
+		case '\r':
+			stats->cr++;
+			break;
+		case '\t': case '\f': case '\v': case '\b': case 0x1b: /*ESC*/
+			stats->printable++;
+			break;
+		default:
+			stats->nonprintable++;
+			break;
+		}
+
+	s->last_counted = c;
+}
+
+/*
+ * Same statistics as git_buf_text_gather_stats, gathered one chunk
+ * at a time. The last byte is held back since a trailing EOF
+ * character is not counted.
+ */
+static void crlf_stream_gather(
+	struct crlf_stream *s, const char *buffer, size_t len)
+{
+	const unsigned char *scan = (const unsigned char *)buffer;
+	const unsigned char *end = scan + len;
+
+	for (; scan < end; scan++) {
+		if (s->has_held)
+			crlf_stream_count(s, s->held);
+		s->held = *scan;
+		s->has_held = 1;
+	}
+}
+
+static bool crlf_stream_is_binary(struct crlf_stream *s)
+{
+	if (s->has_held && s->held != '\032')
+		crlf_stream_count(s, s->held);
+	s->has_held = 0;
+
+	return (s->stats.nul > 0 ||
+		((s->stats.printable >> 7) < s->stats.nonprintable));
+}
+
+/* Make the same decision as crlf_apply_to_odb on the whole content */
+static int crlf_stream_decide_odb(struct crlf_stream *s)
+{
+	struct crlf_attrs *ca = s->ca;
+	struct crlf_stream_stats *stats = &s->stats;
+
+	if (crlf_stream_is_binary(s) || !stats->cr)
+		return CRLF_STREAM_PASSTHROUGH;
+
+	if (stats->cr != stats->crlf || stats->lf != stats->crlf) {
+		switch (ca->safe_crlf) {
+		case GIT_SAFE_CRLF_FAIL:
+			giterr_set(
+				GITERR_FILTER, "LF would be replaced by CRLF in '%s'",
+				git_filter_source_path(s->src));
+			return -1;
+		case GIT_SAFE_CRLF_WARN:
+			/* TODO: issue warning when warning API is available */;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (stats->cr != stats->crlf)
+		return CRLF_STREAM_PASSTHROUGH;
+
+	if (ca->crlf_action == GIT_CRLF_GUESS && has_cr_in_index(s->src))
+		return CRLF_STREAM_PASSTHROUGH;
+
+	return CRLF_STREAM_TO_LF;
+}
+
+/* Make the same decision as crlf_apply_to_workdir on the whole content */
+static int crlf_stream_decide_workdir(struct crlf_stream *s)
+{
+	struct crlf_attrs *ca = s->ca;
+	struct crlf_stream_stats *stats = &s->stats;
+	bool is_binary = crlf_stream_is_binary(s);
+
+	if (stats->lf == 0 || stats->lf == stats->crlf)
+		return CRLF_STREAM_PASSTHROUGH;
+
+	if (ca->crlf_action == GIT_CRLF_GUESS && stats->cr > 0 && stats->crlf > 0)
+		return CRLF_STREAM_PASSTHROUGH;
+
+	if (stats->cr != stats->crlf || is_binary)
+		return CRLF_STREAM_PASSTHROUGH;
+
+	return CRLF_STREAM_TO_CRLF;
+}
+
+static int crlf_stream_convert(const char *buffer, size_t len, void *payload)
+{
+	struct crlf_stream *s = payload;
+	const char *scan = buffer, *end = buffer + len, *next;
+	git_buf *out = &s->out;
+
+	if (s->action == CRLF_STREAM_PASSTHROUGH || len == 0)
+		return len ? s->next->write(s->next, buffer, len) : 0;
+
+	git_buf_clear(out);
+
+	if (s->action == CRLF_STREAM_TO_LF) {
+		/* Do not drop \r unless it is followed by \n */
+		if (s->pending_cr && *scan != '\n')
+			git_buf_putc(out, '\r');
+		s->pending_cr = 0;
+
+		while ((next = memchr(scan, '\r', end - scan)) != NULL) {
+			git_buf_put(out, scan, next - scan);
+			scan = next + 1;
+
+			if (scan == end)
+				s->pending_cr = 1;
+			else if (*scan != '\n')
+				git_buf_putc(out, '\r');
+		}
+	} else {
+		while ((next = memchr(scan, '\n', end - scan)) != NULL) {
+			char prev = (next > buffer) ? next[-1] : s->last;
+
+			git_buf_put(out, scan, next - scan);
+
+			/* if we find mixed line endings, carry on */
+			if (prev == '\r')
+				git_buf_putc(out, '\n');
+			else
+				git_buf_put(out, "\r\n", 2);
+
+			scan = next + 1;
+		}
+	}
+
+	git_buf_put(out, scan, end - scan);
+	s->last = end[-1];
+
+	if (git_buf_oom(out))
+		return -1;
+
+	return out->size ? s->next->write(s->next, out->ptr, out->size) : 0;
+}
+
+static int crlf_stream_write(
+	git_writestream *stream, const char *buffer, size_t len)
+{
+	struct crlf_stream *s = (struct crlf_stream *)stream;
+
+	if (!s->spooling)
+		return crlf_stream_convert(buffer, len, s);
+
+	crlf_stream_gather(s, buffer, len);
+	return s->spool.parent.write(&s->spool.parent, buffer, len);
+}
+
+static int crlf_stream_close(git_writestream *stream)
+{
+	struct crlf_stream *s = (struct crlf_stream *)stream;
+	int error = 0;
+
+	if (s->spooling && s->spool.size > 0) {
+		if (git_filter_source_mode(s->src) == GIT_FILTER_SMUDGE)
+			error = crlf_stream_decide_workdir(s);
+		else
+			error = crlf_stream_decide_odb(s);
+
+		if (error >= 0) {
+			s->action = error;
+			error = git_filter_spool__foreach(
+				&s->spool, crlf_stream_convert, s);
+		}
+	}
+
+	if (!error && s->pending_cr)
+		error = s->next->write(s->next, "\r", 1);
+
+	if (!error)
+		error = s->next->close(s->next);
+
+	return error;
+}
+
+static void crlf_stream_free(git_writestream *stream)
+{
+	struct crlf_stream *s = (struct crlf_stream *)stream;
+
+	git_filter_spool__free(&s->spool);
+	git_buf_free(&s->out);
+	git__free(s);
+}
+
+static int crlf_stream(
+	git_writestream **out,
+	git_filter *self,
+	void **payload,
+	const git_filter_source *src,
+	git_writestream *next)
+{
+	struct crlf_stream *s;
+	struct crlf_attrs *ca;
+	const char *workdir_ending;
+
+	/* initialize payload in case `check` was bypassed */
+	if (!*payload) {
+		int error = crlf_check(self, payload, src, NULL);
+		if (error < 0)
+			return error;
+	}
+	ca = *payload;
+
+	s = git__calloc(1, sizeof(struct crlf_stream));
+	GITERR_CHECK_ALLOC(s);
+
+	s->parent.write = crlf_stream_write;
+	s->parent.close = crlf_stream_close;
+	s->parent.free = crlf_stream_free;
+	s->next = next;
+	s->ca = ca;
+	s->src = src;
+	git_filter_spool__init(&s->spool, git_filter_source_repo(src));
+
+	if (git_filter_source_mode(src) == GIT_FILTER_SMUDGE) {
+		if ((workdir_ending = line_ending(ca)) == NULL) {
+			git__free(s);
+			return -1;
+		}
+
+		/* only LF->CRLF conversion is supported, do nothing on LF platforms */
+		if (strcmp(workdir_ending, "\r\n") != 0)
+			s->action = CRLF_STREAM_PASSTHROUGH;
+		else
+			s->action = CRLF_STREAM_TO_CRLF;
+	} else {
+		s->action = CRLF_STREAM_TO_LF;
+	}
+
+	s->spooling = (s->action != CRLF_STREAM_PASSTHROUGH &&
+		(ca->crlf_action == GIT_CRLF_AUTO ||
+		 ca->crlf_action == GIT_CRLF_GUESS));
+
+	*out = (git_writestream *)s;
+	return 0;
+}
+
 static void crlf_cleanup(
 	git_filter *self,
 	void       *payload)
@@ -377,6 +701,7 @@ git_filter *git_crlf_filter_new(void)
 	f->f.shutdown = git_filter_free;
 	f->f.check    = crlf_check;
 	f->f.apply    = crlf_apply;
+	f->f.stream   = crlf_stream;
 	f->f.cleanup  = crlf_cleanup;
 
 	return (git_filter *)f;
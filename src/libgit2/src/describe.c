@@ -12,6 +12,7 @@
 #include "common.h"
 #include "commit.h"
 #include "commit_list.h"
+#include "describe.h"
 #include "oidmap.h"
 #include "refs.h"
 #include "revwalk.h"
@@ -182,6 +183,16 @@ struct get_name_data
 	git_repository *repo;
 	git_oidmap *names;
 	git_describe_result *result;
+
+	/* Set when describing a batch of commits, see git_describe__batch */
+	git_revwalk *walk;
+	git_vector *touched;
+};
+
+struct git_describe__batch {
+	git_describe_options opts;
+	struct get_name_data data;
+	git_vector touched;
 };
 
 static int commit_name_dup(struct commit_name **out, struct commit_name *in)
@@ -293,9 +304,28 @@ static int compare_pt(const void *a_, const void *b_)
 
 #define SEEN (1u << 0)
 
+/*
+ * Set flags on a node. When the walker is shared between several
+ * commits, nodes that get flags are recorded so that they can be
+ * reset before the next commit is described.
+ */
+static int add_flags(
+	git_vector *touched,
+	git_commit_list_node *node,
+	unsigned int flags)
+{
+	if (touched && !node->flags && flags &&
+	    git_vector_insert(touched, node) < 0)
+		return -1;
+
+	node->flags |= flags;
+	return 0;
+}
+
 static unsigned long finish_depth_computation(
 	git_pqueue *list,
 	git_revwalk *walk,
+	git_vector *touched,
 	struct possible_tag *best)
 {
 	unsigned long seen_commits = 0;
@@ -323,7 +353,8 @@ static unsigned long finish_depth_computation(
 			if (!(p->flags & SEEN))
 				if ((error = git_pqueue_insert(list, p)) < 0)
 					return error;
-			p->flags |= c->flags;
+			if ((error = add_flags(touched, p, c->flags)) < 0)
+				return error;
 		}
 	}
 	return seen_commits;
@@ -474,7 +505,9 @@ static int describe(
 		goto cleanup;
 	}
 
-	if ((error = git_revwalk_new(&walk, git_commit_owner(commit))) < 0)
+	if (data->walk)
+		walk = data->walk;
+	else if ((error = git_revwalk_new(&walk, git_commit_owner(commit))) < 0)
 		goto cleanup;
 
 	if ((cmit = git_revwalk__commit_lookup(walk, git_commit_id(commit))) == NULL)
@@ -483,7 +516,8 @@ static int describe(
 	if ((error = git_commit_list_parse(walk, cmit)) < 0)
 		goto cleanup;
 
-	cmit->flags = SEEN;
+	if ((error = add_flags(data->touched, cmit, SEEN)) < 0)
+		goto cleanup;
 
 	if ((error = git_pqueue_insert(&list, cmit)) < 0)
 		goto cleanup;
@@ -512,7 +546,8 @@ static int describe(
 				t->depth = seen_commits - 1;
 				t->flag_within = 1u << match_cnt;
 				t->found_order = match_cnt;
-				c->flags |= t->flag_within;
+				if ((error = add_flags(data->touched, c, t->flag_within)) < 0)
+					goto cleanup;
 				if (n->prio == 2)
 					annotated_cnt++;
 			}
@@ -546,7 +581,8 @@ static int describe(
 			if (!(p->flags & SEEN))
 				if ((error = git_pqueue_insert(&list, p)) < 0)
 					goto cleanup;
-			p->flags |= c->flags;
+			if ((error = add_flags(data->touched, p, c->flags)) < 0)
+				goto cleanup;
 
 			if (data->opts->only_follow_first_parent)
 				break;
@@ -585,7 +621,7 @@ static int describe(
 		seen_commits--;
 	}
 	if ((error = finish_depth_computation(
-		&list, walk, best)) < 0)
+		&list, walk, data->touched, best)) < 0)
 		goto cleanup;
 
 	seen_commits += error;
@@ -632,10 +668,32 @@ cleanup:
 	}
 	git_vector_free(&all_matches);
 	git_pqueue_free(&list);
-	git_revwalk_free(walk);
+	if (data->walk) {
+		size_t i;
+		git_commit_list_node *node;
+		git_vector_foreach(data->touched, i, node) {
+			node->flags = 0;
+		}
+		git_vector_clear(data->touched);
+	} else {
+		git_revwalk_free(walk);
+	}
 	return error;
 }
 
+static void free_names(git_oidmap *names)
+{
+	struct commit_name *name;
+
+	git_oidmap_foreach_value(names, name, {
+		git_tag_free(name->tag);
+		git__free(name->path);
+		git__free(name);
+	});
+
+	git_oidmap_free(names);
+}
+
 static int normalize_options(
 	git_describe_options *dst,
 	const git_describe_options *src)
@@ -657,8 +715,7 @@ int git_describe_commit(
 	git_describe_options *opts)
 {
 	struct get_name_data data;
-	struct commit_name *name;
-	git_commit *commit;
+	git_commit *commit = NULL;
 	int error = -1;
 	git_describe_options normalized;
 
@@ -669,6 +726,8 @@ int git_describe_commit(
 	data.result->repo = git_object_owner(committish);
 
 	data.repo = git_object_owner(committish);
+	data.walk = NULL;
+	data.touched = NULL;
 
 	if ((error = normalize_options(&normalized, opts)) < 0)
 		return error;
@@ -704,14 +763,7 @@ int git_describe_commit(
 
 cleanup:
 	git_commit_free(commit);
-
-	git_oidmap_foreach_value(data.names, name, {
-		git_tag_free(name->tag);
-		git__free(name->path);
-		git__free(name);
-	});
-
-	git_oidmap_free(data.names);
+	free_names(data.names);
 
 	if (error < 0)
 		git_describe_result_free(data.result);
@@ -721,6 +773,84 @@ cleanup:
 	return error;
 }
 
+int git_describe__batch_new(
+	git_describe__batch **out,
+	git_repository *repo,
+	git_describe_options *opts)
+{
+	git_describe__batch *batch;
+	int error;
+
+	assert(out && repo);
+
+	GITERR_CHECK_VERSION(
+		opts,
+		GIT_DESCRIBE_OPTIONS_VERSION,
+		"git_describe_options");
+
+	batch = git__calloc(1, sizeof(git_describe__batch));
+	GITERR_CHECK_ALLOC(batch);
+
+	if ((error = normalize_options(&batch->opts, opts)) < 0)
+		goto on_error;
+
+	batch->data.opts = &batch->opts;
+	batch->data.repo = repo;
+	batch->data.touched = &batch->touched;
+
+	if ((batch->data.names = git_oidmap_alloc()) == NULL) {
+		error = -1;
+		goto on_error;
+	}
+
+	if ((error = git_vector_init(&batch->touched, 0, NULL)) < 0 ||
+	    (error = git_revwalk_new(&batch->data.walk, repo)) < 0 ||
+	    (error = git_reference_foreach_name(repo, get_name, &batch->data)) < 0)
+		goto on_error;
+
+	*out = batch;
+	return 0;
+
+on_error:
+	git_describe__batch_free(batch);
+	return error;
+}
+
+int git_describe__batch_commit(
+	git_describe_result **out,
+	git_describe__batch *batch,
+	git_commit *commit)
+{
+	int error;
+
+	assert(out && batch && commit);
+
+	batch->data.result = git__calloc(1, sizeof(git_describe_result));
+	GITERR_CHECK_ALLOC(batch->data.result);
+	batch->data.result->repo = batch->data.repo;
+
+	if ((error = describe(&batch->data, commit)) < 0)
+		git_describe_result_free(batch->data.result);
+	else
+		*out = batch->data.result;
+
+	batch->data.result = NULL;
+
+	return error;
+}
+
+void git_describe__batch_free(git_describe__batch *batch)
+{
+	if (batch == NULL)
+		return;
+
+	if (batch->data.names)
+		free_names(batch->data.names);
+	git_revwalk_free(batch->data.walk);
+	git_vector_free(&batch->touched);
+	git__free(batch);
+}
+
 int git_describe_workdir(
 	git_describe_result **out,
 	git_repository *repo,
@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) the libgit2 contributors. All rights reserved.
+ *
+ * This file is part of libgit2, distributed under the GNU GPL v2 with
+ * a Linking Exception. For full terms see the included COPYING file.
+ */
+#ifndef INCLUDE_describe_h__
+#define INCLUDE_describe_h__
+
+#include "common.h"
+
+#include "git2/describe.h"
+
+/**
+ * Describe several commits of the same repository.
+ *
+ * The references are read once into a map of names when the batch
+ * is created, and the commit graph parsed while describing one commit
+ * is kept in a revision walker shared by all commits.
+ */
+typedef struct git_describe__batch git_describe__batch;
+
+extern int git_describe__batch_new(
+	git_describe__batch **out,
+	git_repository *repo,
+	git_describe_options *opts);
+
+/**
+ * Describe a commit. Returns GIT_ENOTFOUND when no reference can
+ * describe the commit, the result must be freed with
+ * git_describe_result_free.
+ */
+extern int git_describe__batch_commit(
+	git_describe_result **out,
+	git_describe__batch *batch,
+	git_commit *commit);
+
+extern void git_describe__batch_free(git_describe__batch *batch);
+
+#endif
@@ -294,6 +294,9 @@ int git_filebuf_open_withsize(git_filebuf *file, const char *path, int flags, mo
 	if (flags & GIT_FILEBUF_FSYNC)
 		file->do_fsync = true;
 
+	if (flags & GIT_FILEBUF_FSYNC_BATCH)
+		file->fsync_batch = true;
+
 	file->buf_size = size;
 	file->buf_pos = 0;
 	file->fd = -1;
@@ -417,9 +420,13 @@ int git_filebuf_commit_at(git_filebuf *file, const char *path)
 
 int git_filebuf_commit(git_filebuf *file)
 {
+	bool batch;
+
 	/* temporary files cannot be committed */
 	assert(file && file->path_original);
 
+	batch = file->do_fsync && git_futils__fsync_batch;
+
 	file->flush_mode = Z_FINISH;
 	flush_buffer(file);
 
@@ -428,7 +435,14 @@ int git_filebuf_commit(git_filebuf *file)
 
 	file->fd_is_open = false;
 
-	if (file->do_fsync && p_fsync(file->fd) < 0) {
+	/* In a batch, the content of an object file is synced later,
+	 * while other files are synced after the pending objects */
+	if (batch && !file->fsync_batch &&
+		git_futils_fsync_batch_barrier() < 0)
+		goto on_error;
+
+	if (file->do_fsync && !(batch && file->fsync_batch) &&
+		p_fsync(file->fd) < 0) {
 		giterr_set(GITERR_OS, "failed to fsync '%s'", file->path_lock);
 		goto on_error;
 	}
@@ -445,7 +459,10 @@ int git_filebuf_commit(git_filebuf *file)
 		goto on_error;
 	}
 
-	if (file->do_fsync && git_futils_fsync_parent(file->path_original) < 0)
+	if (batch) {
+		if (git_futils_fsync_batch_add(file->path_original, file->fsync_batch) < 0)
+			goto on_error;
+	} else if (file->do_fsync && git_futils_fsync_parent(file->path_original) < 0)
 		goto on_error;
 
 	file->did_rename = true;
@@ -16,6 +16,7 @@
 #endif
 
 #define GIT_FILEBUF_HASH_CONTENTS		(1 << 0)
+#define GIT_FILEBUF_FSYNC_BATCH			(1 << 1)
 #define GIT_FILEBUF_APPEND				(1 << 2)
 #define GIT_FILEBUF_FORCE				(1 << 3)
 #define GIT_FILEBUF_TEMPORARY			(1 << 4)
@@ -49,6 +50,7 @@ struct git_filebuf {
 	bool did_rename;
 	bool do_not_buffer;
 	bool do_fsync;
+	bool fsync_batch;
 	int last_error;
 };
 
@@ -6,6 +6,7 @@
  */
 #include "common.h"
 #include "fileops.h"
+#include "array.h"
 #include "global.h"
 #include "strmap.h"
 #include <ctype.h>
@@ -236,7 +237,7 @@ int git_futils_readbuffer(git_buf *buf, const char *path)
 int git_futils_writebuffer(
 	const git_buf *buf,	const char *path, int flags, mode_t mode)
 {
-	int fd, do_fsync = 0, error = 0;
+	int fd, do_fsync = 0, batch = 0, error = 0;
 
 	if (!flags)
 		flags = O_CREAT | O_TRUNC | O_WRONLY;
@@ -245,6 +246,10 @@ int git_futils_writebuffer(
 		do_fsync = 1;
 
 	flags &= ~O_FSYNC;
+	batch = do_fsync && git_futils__fsync_batch;
+
+	if (batch && (error = git_futils_fsync_batch_barrier()) < 0)
+		return error;
 
 	if (!mode)
 		mode = GIT_FILEMODE_BLOB;
@@ -272,7 +277,8 @@ int git_futils_writebuffer(
 	}
 
 	if (do_fsync && (flags & O_CREAT))
-		error = git_futils_fsync_parent(path);
+		error = batch ? git_futils_fsync_batch_add(path, false) :
+			git_futils_fsync_parent(path);
 
 	return error;
 }
@@ -1168,3 +1174,205 @@ int git_futils_fsync_parent(const char *path)
 	git__free(parent);
 	return error;
 }
+
+bool git_futils__fsync_batch = false;
+
+typedef git_array_t(dev_t) fsync_batch_devs;
+
+static git_mutex fsync_batch_lock;
+static git_strmap *fsync_batch_dirs;
+static git_vector fsync_batch_files = GIT_VECTOR_INIT;
+static bool fsync_batch_data;
+
+static void fsync_batch_clear(void)
+{
+	const char *dir;
+	char *file;
+	void *value;
+	size_t i;
+
+	git_strmap_foreach(fsync_batch_dirs, dir, value, {
+		GIT_UNUSED(value);
+		git__free((char *)dir);
+	});
+	git_strmap_clear(fsync_batch_dirs);
+
+	git_vector_foreach(&fsync_batch_files, i, file)
+		git__free(file);
+	git_vector_clear(&fsync_batch_files);
+
+	fsync_batch_data = false;
+}
+
+static void fsync_batch_global_shutdown(void)
+{
+	fsync_batch_clear();
+	git_strmap_free(fsync_batch_dirs);
+	fsync_batch_dirs = NULL;
+	git_vector_free(&fsync_batch_files);
+	git_mutex_free(&fsync_batch_lock);
+}
+
+int git_futils_fsync_batch_global_init(void)
+{
+	if (git_mutex_init(&fsync_batch_lock) < 0)
+		return -1;
+
+	git__on_shutdown(fsync_batch_global_shutdown);
+
+	return git_strmap_alloc(&fsync_batch_dirs);
+}
+
+int git_futils_fsync_batch_add(const char *path, bool data)
+{
+	char *dir, *file = NULL;
+	int error = 0;
+
+	if ((dir = git_path_dirname(path)) == NULL)
+		return -1;
+
+#ifndef HAVE_SYNCFS
+	/* Without syncfs, the content of each file is synced on its own */
+	if (data && (file = git__strdup(path)) == NULL) {
+		git__free(dir);
+		return -1;
+	}
+#endif
+
+	if (git_mutex_lock(&fsync_batch_lock) < 0) {
+		giterr_set(GITERR_OS, "failed to lock fsync batch");
+		error = -1;
+		goto done;
+	}
+
+	if (file && (error = git_vector_insert(&fsync_batch_files, file)) == 0)
+		file = NULL;
+
+	if (!error && !git_strmap_exists(fsync_batch_dirs, dir)) {
+		git_strmap_insert(fsync_batch_dirs, dir, NULL, &error);
+		if (error < 0) {
+			giterr_set_oom();
+		} else {
+			dir = NULL;
+			error = 0;
+		}
+	}
+
+	if (!error && data)
+		fsync_batch_data = true;
+
+	git_mutex_unlock(&fsync_batch_lock);
+
+done:
+	git__free(file);
+	git__free(dir);
+	return error;
+}
+
+static int fsync_batch_file(const char *path)
+{
+	int fd, error;
+
+	if ((fd = p_open(path, O_RDONLY)) < 0) {
+		/* The file has been replaced or removed since */
+		if (errno == ENOENT)
+			return 0;
+		giterr_set(GITERR_OS, "failed to open '%s' for fsync", path);
+		return -1;
+	}
+
+	if ((error = p_fsync(fd)) < 0)
+		giterr_set(GITERR_OS, "failed to fsync '%s'", path);
+
+	p_close(fd);
+	return error;
+}
+
+static int fsync_batch_dir(const char *path, fsync_batch_devs *devs)
+{
+	int fd, error;
+#ifdef HAVE_SYNCFS
+	struct stat st;
+	dev_t *dev;
+	size_t i;
+
+	if (p_stat(path, &st) < 0)
+		return 0;
+
+	/* One syncfs for each filesystem */
+	for (i = 0; i < git_array_size(*devs); i++) {
+		if (*git_array_get(*devs, i) == st.st_dev)
+			return 0;
+	}
+
+	dev = git_array_alloc(*devs);
+	GITERR_CHECK_ALLOC(dev);
+	*dev = st.st_dev;
+#else
+	GIT_UNUSED(devs);
+#endif
+
+	if ((fd = p_open(path, O_RDONLY)) < 0) {
+		if (errno == ENOENT)
+			return 0;
+		giterr_set(GITERR_OS, "failed to open directory '%s' for fsync", path);
+		return -1;
+	}
+
+#ifdef HAVE_SYNCFS
+	if ((error = syncfs(fd)) < 0)
+		giterr_set(GITERR_OS, "failed to syncfs '%s'", path);
+#else
+	if ((error = p_fsync(fd)) < 0)
+		giterr_set(GITERR_OS, "failed to fsync directory '%s'", path);
+#endif
+
+	p_close(fd);
+	return error;
+}
+
+static int fsync_batch_sync(bool barrier)
+{
+	fsync_batch_devs devs = GIT_ARRAY_INIT;
+	const char *dir;
+	char *file;
+	void *value;
+	size_t i;
+	int error = 0;
+
+	if (git_mutex_lock(&fsync_batch_lock) < 0) {
+		giterr_set(GITERR_OS, "failed to lock fsync batch");
+		return -1;
+	}
+
+	if (barrier && !fsync_batch_data)
+		goto done;
+
+	git_vector_foreach(&fsync_batch_files, i, file) {
+		if ((error = fsync_batch_file(file)) < 0)
+			break;
+	}
+
+	git_strmap_foreach(fsync_batch_dirs, dir, value, {
+		GIT_UNUSED(value);
+		if (!error)
+			error = fsync_batch_dir(dir, &devs);
+	});
+
+	fsync_batch_clear();
+	git_array_clear(devs);
+
+done:
+	git_mutex_unlock(&fsync_batch_lock);
+	return error;
+}
+
+int git_futils_fsync_batch_barrier(void)
+{
+	return fsync_batch_sync(true);
+}
+
+int git_futils_fsync_batch_flush(void)
+{
+	return fsync_batch_sync(false);
+}
@@ -381,4 +381,42 @@ extern int git_futils_fsync_dir(const char *path);
  */
 extern int git_futils_fsync_parent(const char *path);
 
+/**
+ * Batched `fsync`, see `GIT_OPT_ENABLE_FSYNC_BATCH`. When enabled,
+ * a synchronized write calls `git_futils_fsync_batch_add` instead
+ * of syncing the file and its parent directory. Object files are
+ * added as `data` and are synced by the next barrier, which is
+ * issued before a reference is written. The directories are synced
+ * by `git_futils_fsync_batch_flush`.
+ *
+ * With `syncfs` the pending files of a filesystem are synced with
+ * one call, else each pending file and directory is synced.
+ */
+extern bool git_futils__fsync_batch;
+
+extern int git_futils_fsync_batch_global_init(void);
+
+/**
+ * Add a file that was written and renamed in place to the batch.
+ *
+ * @param path Path of the file.
+ * @param data The content of the file is not synced yet.
+ * @return 0 on success, -1 on error
+ */
+extern int git_futils_fsync_batch_add(const char *path, bool data);
+
+/**
+ * Sync the pending files if there are object files among them.
+ *
+ * @return 0 on success, -1 on error
+ */
+extern int git_futils_fsync_batch_barrier(void);
+
+/**
+ * Sync the pending files and directories.
+ *
+ * @return 0 on success, -1 on error
+ */
+extern int git_futils_fsync_batch_flush(void);
+
 #endif /* INCLUDE_fileops_h__ */
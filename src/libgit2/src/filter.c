@@ -1023,6 +1023,146 @@ int git_filter_list_stream_blob(
 	return git_filter_list_stream_data(filters, &in, target);
 }
 
+int git_filter_list__stream_odb(
+	git_filter_list *filters,
+	git_odb_stream *stream,
+	const git_oid *oid,
+	git_writestream *target)
+{
+	char buf[FILTERIO_BUFSIZE];
+	git_vector filter_streams = GIT_VECTOR_INIT;
+	git_writestream *stream_start;
+	int readlen, error;
+
+	if (filters)
+		git_oid_cpy(&filters->source.oid, oid);
+
+	if ((error = stream_list_init(
+			&stream_start, &filter_streams, filters, target)) < 0)
+		goto done;
+
+	while ((readlen = git_odb_stream_read(stream, buf, sizeof(buf))) > 0) {
+		if ((error = stream_start->write(stream_start, buf, readlen)) < 0)
+			break;
+	}
+
+	if (!error && readlen < 0)
+		error = readlen;
+
+	error |= stream_start->close(stream_start);
+
+done:
+	stream_list_free(&filter_streams);
+	return error;
+}
+
+static int spool_write(git_writestream *s, const char *buffer, size_t len)
+{
+	git_filter_spool *spool = (git_filter_spool *)s;
+	git_buf tmp_path = GIT_BUF_INIT;
+	int error = 0;
+
+	if (spool->fd < 0 &&
+		(!spool->repo || spool->buf.size + len <= GIT_FILTER_SPOOL_MEMORY)) {
+		if ((error = git_buf_put(&spool->buf, buffer, len)) == 0)
+			spool->size += len;
+		return error;
+	}
+
+	if (spool->fd < 0) {
+		if ((error = git_buf_joinpath(&tmp_path,
+				git_repository_path(spool->repo), "filter_spool")) < 0)
+			return error;
+
+		spool->fd = git_futils_mktmp(&spool->path, tmp_path.ptr, 0600);
+		git_buf_free(&tmp_path);
+		if (spool->fd < 0)
+			return -1;
+
+		if ((error = p_write(spool->fd, spool->buf.ptr, spool->buf.size)) < 0) {
+			giterr_set(GITERR_OS, "failed to write '%s'", spool->path.ptr);
+			return error;
+		}
+		git_buf_free(&spool->buf);
+	}
+
+	if ((error = p_write(spool->fd, buffer, len)) < 0) {
+		giterr_set(GITERR_OS, "failed to write '%s'", spool->path.ptr);
+		return error;
+	}
+
+	spool->size += len;
+	return 0;
+}
+
+static int spool_close(git_writestream *s)
+{
+	GIT_UNUSED(s);
+	return 0;
+}
+
+static void spool_free(git_writestream *s)
+{
+	GIT_UNUSED(s);
+}
+
+void git_filter_spool__init(git_filter_spool *spool, git_repository *repo)
+{
+	memset(spool, 0, sizeof(git_filter_spool));
+	spool->parent.write = spool_write;
+	spool->parent.close = spool_close;
+	spool->parent.free = spool_free;
+	spool->repo = repo;
+	spool->fd = -1;
+}
+
+int git_filter_spool__foreach(
+	git_filter_spool *spool, git_filter_spool_cb cb, void *payload)
+{
+	char buf[FILTERIO_BUFSIZE];
+	ssize_t readlen;
+	size_t offset, len;
+	int error = 0;
+
+	if (spool->fd < 0) {
+		for (offset = 0; !error && offset < spool->buf.size; offset += len) {
+			len = min(spool->buf.size - offset, sizeof(buf));
+			error = cb(spool->buf.ptr + offset, len, payload);
+		}
+
+		return error;
+	}
+
+	if (p_lseek(spool->fd, 0, SEEK_SET) < 0) {
+		giterr_set(GITERR_OS, "failed to seek in '%s'", spool->path.ptr);
+		return -1;
+	}
+
+	while ((readlen = p_read(spool->fd, buf, sizeof(buf))) > 0) {
+		if ((error = cb(buf, (size_t)readlen, payload)) != 0)
+			return error;
+	}
+
+	if (readlen < 0) {
+		giterr_set(GITERR_OS, "failed to read '%s'", spool->path.ptr);
+		return -1;
+	}
+
+	return 0;
+}
+
+void git_filter_spool__free(git_filter_spool *spool)
+{
+	if (spool->fd >= 0) {
+		p_close(spool->fd);
+		p_unlink(spool->path.ptr);
+		spool->fd = -1;
+	}
+
+	git_buf_free(&spool->path);
+	git_buf_free(&spool->buf);
+}
+
 int git_filter_init(git_filter *filter, unsigned int version)
 {
 	GIT_INIT_STRUCTURE_FROM_TEMPLATE(filter, version, git_filter, GIT_FILTER_INIT);
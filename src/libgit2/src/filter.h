@@ -14,6 +14,9 @@
 /* Amount of file to examine for NUL byte when checking binary-ness */
 #define GIT_FILTER_BYTES_TO_CHECK_NUL 8000
 
+/* Amount of data a spool keeps in memory before using a temporary file */
+#define GIT_FILTER_SPOOL_MEMORY (1024 * 1024)
+
 /* Possible CRLF values */
 typedef enum {
 	GIT_CRLF_GUESS = -1,
@@ -44,6 +47,41 @@ extern int git_filter_list__load_ext(
 	git_filter_mode_t mode,
 	git_filter_options *filter_opts);
 
+/*
+ * Filter the contents of an object read from an odb stream, in
+ * chunks, into the target stream.
+ */
+extern int git_filter_list__stream_odb(
+	git_filter_list *filters,
+	git_odb_stream *stream,
+	const git_oid *oid,
+	git_writestream *target);
+
+/*
+ * A spool is a write stream that collects everything written to it,
+ * in memory up to GIT_FILTER_SPOOL_MEMORY bytes and in a temporary
+ * file in the repository directory beyond that, so that a filter can
+ * make a decision about its whole input before replaying it.
+ */
+typedef struct {
+	git_writestream parent;
+	git_repository *repo; /* can be NULL, then memory is always used */
+	git_buf buf;
+	git_buf path;
+	git_file fd;
+	git_off_t size;
+} git_filter_spool;
+
+typedef int (*git_filter_spool_cb)(const char *data, size_t len, void *payload);
+
+extern void git_filter_spool__init(git_filter_spool *spool, git_repository *repo);
+
+/* Call `cb` on the spooled data, in order, in chunks of bounded size */
+extern int git_filter_spool__foreach(
+	git_filter_spool *spool, git_filter_spool_cb cb, void *payload);
+
+extern void git_filter_spool__free(git_filter_spool *spool);
+
 /*
  * Available filters
  */
@@ -217,6 +217,9 @@ static int parse_ignore_file(
 		}
 	}
 
+	if (!error)
+		error = git_attr_file__compile(attrs);
+
 	git_mutex_unlock(&attrs->lock);
 	git__free(match);
 
@@ -422,15 +425,14 @@ static bool ignore_lookup_in_rules(
 	size_t j;
 	git_attr_fnmatch *match;
 
-	git_vector_rforeach(&file->rules, j, match) {
-		if (git_attr_fnmatch__match(match, path)) {
-			*ignored = ((match->flags & GIT_ATTR_FNMATCH_NEGATIVE) == 0) ?
-				GIT_IGNORE_TRUE : GIT_IGNORE_FALSE;
-			return true;
-		}
-	}
+	if (!(j = git_attr_file__prev_match(file, path, file->rules.length, false)))
+		return false;
 
-	return false;
+	match = git_vector_get(&file->rules, j - 1);
+	*ignored = ((match->flags & GIT_ATTR_FNMATCH_NEGATIVE) == 0) ?
+		GIT_IGNORE_TRUE : GIT_IGNORE_FALSE;
+
+	return true;
 }
 
 int git_ignore__lookup(
@@ -497,6 +499,66 @@ int git_ignore_clear_internal_rules(git_repository *repo)
 	return error;
 }
 
+/* Look up the path in the ignore files, success means path was found */
+static bool ignore_lookup_in_stack(
+	int *ignored, git_ignores *ignores, git_attr_path *path)
+{
+	unsigned int i;
+	git_attr_file *file;
+
+	/* first process builtins */
+	if (ignore_lookup_in_rules(ignored, ignores->ign_internal, path))
+		return true;
+
+	/* next process files in the path */
+	git_vector_foreach(&ignores->ign_path, i, file) {
+		if (ignore_lookup_in_rules(ignored, file, path))
+			return true;
+	}
+
+	/* last process global ignores */
+	git_vector_foreach(&ignores->ign_global, i, file) {
+		if (ignore_lookup_in_rules(ignored, file, path))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Look up the path and then each directory above it, until one of
+ * them is found. With `skip_path` only the directories are checked.
+ * The path is truncated to each directory in turn.
+ */
+static int ignore_lookup_up(
+	int *ignored, git_ignores *ignores, git_attr_path *path, bool skip_path)
+{
+	int error = 0;
+
+	while (1) {
+		if (!skip_path && ignore_lookup_in_stack(ignored, ignores, path))
+			return 0;
+		skip_path = false;
+
+		/* move up one directory */
+		if (path->basename == path->path)
+			break;
+		path->basename[-1] = '\0';
+		while (path->basename > path->path && *path->basename != '/')
+			path->basename--;
+		if (path->basename > path->path)
+			path->basename++;
+		path->is_dir = 1;
+
+		if ((error = git_ignore__pop_dir(ignores)) < 0)
+			break;
+	}
+
+	*ignored = 0;
+
+	return error;
+}
+
 int git_ignore_path_is_ignored(
 	int *ignored,
 	git_repository *repo,
@@ -506,8 +568,6 @@ int git_ignore_path_is_ignored(
 	const char *workdir;
 	git_attr_path path;
 	git_ignores ignores;
-	unsigned int i;
-	git_attr_file *file;
 
 	assert(repo && ignored && pathname);
 
@@ -520,42 +580,185 @@ int git_ignore_path_is_ignored(
 		(error = git_ignore__for_path(repo, path.path, &ignores)) < 0)
 		goto cleanup;
 
-	while (1) {
-		/* first process builtins - success means path was found */
-		if (ignore_lookup_in_rules(ignored, ignores.ign_internal, &path))
-			goto cleanup;
+	error = ignore_lookup_up(ignored, &ignores, &path, false);
+
+cleanup:
+	git_attr_path__free(&path);
+	git_ignore__free(&ignores);
+	return error;
+}
+
+/* The results for the directories of the stack, one per frame */
+typedef git_array_t(int) ignore_results;
+
+/*
+ * A path can use the stack of ignore files of the walk if it's
+ * relative and its directories are names, not "." or "..".
+ */
+static bool ignore_walkable_path(const char *pathname)
+{
+	const char *scan = pathname, *end;
 
-		/* next process files in the path */
-		git_vector_foreach(&ignores.ign_path, i, file) {
-			if (ignore_lookup_in_rules(ignored, file, &path))
-				goto cleanup;
+	if (git_path_root(pathname) >= 0)
+		return false;
+
+	while ((end = strchr(scan, '/')) != NULL) {
+		if ((end - scan == 1 && scan[0] == '.') ||
+			(end - scan == 2 && scan[0] == '.' && scan[1] == '.'))
+			return false;
+		scan = end + 1;
+	}
+
+	return true;
+}
+
+/*
+ * Look up the path in a stack that was built with
+ * git_ignore__push_dir, where the files of the deepest directory are
+ * last, in the same order as ignore_lookup_in_stack.
+ */
+static bool ignore_lookup_in_frames(
+	int *ignored, git_ignores *ignores, git_attr_path *path)
+{
+	size_t i;
+	git_attr_file *file;
+
+	if (ignore_lookup_in_rules(ignored, ignores->ign_internal, path))
+		return true;
+
+	git_vector_rforeach(&ignores->ign_path, i, file) {
+		if (ignore_lookup_in_rules(ignored, file, path))
+			return true;
+	}
+
+	git_vector_foreach(&ignores->ign_global, i, file) {
+		if (ignore_lookup_in_rules(ignored, file, path))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Move the stack of ignore files to the directory `dir`, a relative
+ * path that ends with a slash or is empty. The frames of the common
+ * parent directories are kept. For each directory that is pushed,
+ * the result for the directory itself is looked up in the stack of
+ * its parent, or inherited from the parent if no rule matches, and
+ * appended to `above`.
+ */
+static int ignore_move_to_dir(
+	git_ignores *ignores, ignore_results *above, const char *dir)
+{
+	int error = 0, *result;
+	const char *current = ignores->dir.ptr + ignores->dir_root;
+	size_t len = ignores->dir.size - ignores->dir_root;
+	const char *scan, *end;
+	git_buf name = GIT_BUF_INIT;
+	git_attr_path path;
+
+	/* pop the frames that are not parents of the directory */
+	while (len > 0 && (strlen(dir) < len || memcmp(current, dir, len))) {
+		if ((error = git_ignore__pop_dir(ignores)) < 0)
+			return error;
+		git_array_pop(*above);
+		current = ignores->dir.ptr + ignores->dir_root;
+		len = ignores->dir.size - ignores->dir_root;
+	}
+
+	/* push the frames of the subdirectories */
+	for (scan = dir + len; (end = strchr(scan, '/')) != NULL; scan = end + 1) {
+		int ignored;
+
+		if ((error = git_buf_set(&name, dir, end - dir)) < 0 ||
+			(error = git_attr_path__init(&path, name.ptr,
+				git_repository_workdir(ignores->repo), GIT_DIR_FLAG_TRUE)) < 0)
+			break;
+		if (!ignore_lookup_in_frames(&ignored, ignores, &path))
+			ignored = *git_array_last(*above);
+		git_attr_path__free(&path);
+
+		if ((result = git_array_alloc(*above)) == NULL) {
+			error = -1;
+			break;
+		}
+		*result = ignored;
+
+		if ((error = git_buf_set(&name, scan, end - scan + 1)) < 0 ||
+			(error = git_ignore__push_dir(ignores, name.ptr)) < 0)
+			break;
+	}
+
+	git_buf_free(&name);
+
+	return error;
+}
+
+int git_ignore__path_is_ignored_many(
+	int *ignored,
+	git_repository *repo,
+	const char **pathnames,
+	size_t num_paths)
+{
+	int error = 0, *root;
+	const char *workdir;
+	git_attr_path path;
+	git_ignores ignores;
+	ignore_results above = GIT_ARRAY_INIT;
+	git_buf dir = GIT_BUF_INIT;
+	bool loaded = false;
+	size_t i;
+
+	assert(repo && ignored && (pathnames || !num_paths));
+
+	workdir = git_repository_workdir(repo);
+
+	memset(&ignores, 0, sizeof(ignores));
+
+	for (i = 0; i < num_paths; i++) {
+		if (!workdir || !ignore_walkable_path(pathnames[i])) {
+			if ((error = git_ignore_path_is_ignored(
+					&ignored[i], repo, pathnames[i])) < 0)
+				break;
+			continue;
 		}
 
-		/* last process global ignores */
-		git_vector_foreach(&ignores.ign_global, i, file) {
-			if (ignore_lookup_in_rules(ignored, file, &path))
-				goto cleanup;
+		/*
+		 * The stack starts at the root of the working directory,
+		 * where nothing above the path is ignored.
+		 */
+		if (!loaded) {
+			if ((error = git_ignore__for_path(repo, "", &ignores)) < 0)
+				break;
+			loaded = true;
+			if ((root = git_array_alloc(above)) == NULL) {
+				error = -1;
+				break;
+			}
+			*root = GIT_IGNORE_FALSE;
 		}
 
-		/* move up one directory */
-		if (path.basename == path.path)
+		if ((error = git_attr_path__init(
+				&path, pathnames[i], workdir, GIT_DIR_FLAG_UNKNOWN)) < 0)
 			break;
-		path.basename[-1] = '\0';
-		while (path.basename > path.path && *path.basename != '/')
-			path.basename--;
-		if (path.basename > path.path)
-			path.basename++;
-		path.is_dir = 1;
-
-		if ((error = git_ignore__pop_dir(&ignores)) < 0)
+
+		if ((error = git_buf_set(&dir, path.path, path.basename - path.path)) < 0 ||
+			(error = ignore_move_to_dir(&ignores, &above, dir.ptr)) < 0) {
+			git_attr_path__free(&path);
 			break;
+		}
+
+		if (!ignore_lookup_in_frames(&ignored[i], &ignores, &path))
+			ignored[i] = *git_array_last(above);
+
+		git_attr_path__free(&path);
 	}
 
-	*ignored = 0;
+	git_buf_free(&dir);
+	git_array_clear(above);
+	if (loaded)
+		git_ignore__free(&ignores);
 
-cleanup:
-	git_attr_path__free(&path);
-	git_ignore__free(&ignores);
 	return error;
 }
 
@@ -51,6 +51,16 @@ enum {
 
 extern int git_ignore__lookup(int *out, git_ignores *ign, const char *path, git_dir_flag dir_flag);
 
+/* Check if each of the paths is ignored, as git_ignore_path_is_ignored.
+ * The ignore files are kept in a stack of directories that is pushed
+ * and popped from one path to the next, so the files of the common
+ * parent directories are read once. Sorting the paths by directory is
+ * faster.
+ */
+extern int git_ignore__path_is_ignored_many(
+	int *ignored, git_repository *repo,
+	const char **pathnames, size_t num_paths);
+
 /* command line Git sometimes generates an error message if given a
  * pathspec that contains an exact match to an ignored file (provided
  * --force isn't also given).  This makes it easy to check it that has
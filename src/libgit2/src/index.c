@@ -3290,10 +3290,22 @@ static int apply_each_file(const git_diff_delta *delta, float progress, void *pa
 		return error;
 
 	/* If the workdir item does not exist, remove it from the index. */
-	if ((delta->new_file.flags & GIT_DIFF_FLAG_EXISTS) == 0)
+	if ((delta->new_file.flags & GIT_DIFF_FLAG_EXISTS) == 0) {
 		error = git_index_remove_bypath(data->index, path);
-	else
+	} else if (git__suffixcmp(delta->new_file.path, "/") == 0) {
+		/* An untracked directory that is not recursed into is a
+		 * repository, add it as a submodule like 'git add'. */
+		git_buf dir = GIT_BUF_INIT;
+
+		if ((error = git_buf_sets(&dir, delta->new_file.path)) == 0) {
+			git_buf_truncate(&dir, dir.size - 1);
+			error = git_index_add_bypath(data->index, dir.ptr);
+		}
+
+		git_buf_free(&dir);
+	} else {
 		error = git_index_add_bypath(data->index, delta->new_file.path);
+	}
 
 	return error;
 }
@@ -18,6 +18,7 @@
 #include "oidmap.h"
 #include "zstream.h"
 #include "object.h"
+#include "trace.h"
 
 extern git_mutex git__mwindow_mutex;
 
@@ -978,6 +979,11 @@ int git_indexer_commit(git_indexer *idx, git_transfer_progress *stats)
 		return -1;
 	}
 
+	git_trace(GIT_TRACE_DEBUG,
+		"indexer: %u objects, %u deltas resolved, %u local objects",
+		stats->indexed_objects, stats->indexed_deltas,
+		stats->local_objects);
+
 	if (stats->local_objects > 0) {
 		if (update_header_and_rehash(idx, stats) < 0)
 			return -1;
@@ -1000,7 +1006,7 @@ int git_indexer_commit(git_indexer *idx, git_transfer_progress *stats)
 
 	if (git_filebuf_open(&index_file, filename.ptr,
 		GIT_FILEBUF_HASH_CONTENTS |
-		(idx->do_fsync ? GIT_FILEBUF_FSYNC : 0),
+		(idx->do_fsync ? GIT_FILEBUF_FSYNC | GIT_FILEBUF_FSYNC_BATCH : 0),
 		idx->mode) < 0)
 		goto on_error;
 
@@ -1076,7 +1082,8 @@ int git_indexer_commit(git_indexer *idx, git_transfer_progress *stats)
 		return -1;
 	}
 
-	if (idx->do_fsync && p_fsync(idx->pack->mwf.fd) < 0) {
+	if (idx->do_fsync && !git_futils__fsync_batch &&
+		p_fsync(idx->pack->mwf.fd) < 0) {
 		giterr_set(GITERR_OS, "failed to fsync packfile");
 		goto on_error;
 	}
@@ -1096,8 +1103,12 @@ int git_indexer_commit(git_indexer *idx, git_transfer_progress *stats)
 	if (p_rename(idx->pack->pack_name, git_buf_cstr(&filename)) < 0)
 		goto on_error;
 
-	/* And fsync the parent directory if we're asked to. */
-	if (idx->do_fsync &&
+	/* And fsync the parent directory if we're asked to, or add the
+	 * packfile to the batch. */
+	if (idx->do_fsync && git_futils__fsync_batch) {
+		if (git_futils_fsync_batch_add(git_buf_cstr(&filename), true) < 0)
+			goto on_error;
+	} else if (idx->do_fsync &&
 		git_futils_fsync_parent(git_buf_cstr(&filename)) < 0)
 		goto on_error;
 
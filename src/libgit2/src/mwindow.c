@@ -13,6 +13,7 @@
 #include "global.h"
 #include "strmap.h"
 #include "pack.h"
+#include "stats.h"
 
 #define DEFAULT_WINDOW_SIZE \
 	(sizeof(void*) >= 8 \
@@ -163,6 +164,7 @@ void git_mwindow_free_all_locked(git_mwindow_file *mwf)
 		ctl->open_windows--;
 
 		git_futils_mmap_free(&w->window_map);
+		GIT_STATS_INC(GIT_STATS_MWINDOW_UNMAP);
 
 		mwf->windows = w->next;
 		git__free(w);
@@ -235,6 +237,7 @@ static int git_mwindow_close_lru(git_mwindow_file *mwf)
 
 	ctl->mapped -= lru_w->window_map.len;
 	git_futils_mmap_free(&lru_w->window_map);
+	GIT_STATS_INC(GIT_STATS_MWINDOW_UNMAP);
 
 	if (lru_l)
 		lru_l->next = lru_w->next;
@@ -298,6 +301,7 @@ static git_mwindow *new_window(
 	}
 
 	ctl->mmap_calls++;
+	GIT_STATS_INC(GIT_STATS_MWINDOW_MAP);
 	ctl->open_windows++;
 
 	if (ctl->mapped > ctl->peak_mapped)
@@ -15,6 +15,7 @@
 #include "delta.h"
 #include "filebuf.h"
 #include "object.h"
+#include "stats.h"
 
 #include "git2/odb_backend.h"
 #include "git2/types.h"
@@ -29,6 +30,18 @@ typedef struct {
 	git_filebuf fbuf;
 } loose_writestream;
 
+typedef struct {
+	git_odb_stream stream;
+	git_oid oid;
+	git_file fd;
+	z_stream zstream;
+	git_hash_ctx hash;
+	unsigned char head[64];
+	size_t head_len, head_pos;
+	int done, verified;
+	unsigned char in[FILEIO_BUFSIZE];
+} loose_readstream;
+
 typedef struct loose_backend {
 	git_odb_backend parent;
 
@@ -650,6 +663,8 @@ static int loose_backend__read(void **buffer_p, size_t *len_p, git_otype *type_p
 		*buffer_p = raw.data;
 		*len_p = raw.len;
 		*type_p = raw.type;
+		GIT_STATS_INC(GIT_STATS_ODB_READ_LOOSE);
+		GIT_STATS_ADD(GIT_STATS_BYTES_INFLATED, raw.len);
 	}
 
 	git_buf_free(&object_path);
@@ -851,7 +866,7 @@ static int filebuf_flags(loose_backend *backend)
 		(backend->object_zlib_level << GIT_FILEBUF_DEFLATE_SHIFT);
 
 	if (backend->fsync_object_files || git_repository__fsync_gitdir)
-		flags |= GIT_FILEBUF_FSYNC;
+		flags |= GIT_FILEBUF_FSYNC | GIT_FILEBUF_FSYNC_BATCH;
 
 	return flags;
 }
@@ -896,6 +911,222 @@ static int loose_backend__stream(git_odb_stream **stream_out, git_odb_backend *_
 	return !stream ? -1 : 0;
 }
 
+static int loose_readstream__error(const char *message)
+{
+	giterr_set(GITERR_ODB, "failed to stream loose object: %s", message);
+	return -1;
+}
+
+static int loose_readstream__finish(loose_readstream *stream)
+{
+	git_oid hashed;
+
+	if (stream->verified)
+		return 0;
+
+	if (stream->stream.received_bytes != stream->stream.declared_size)
+		return loose_readstream__error("object is truncated");
+
+	if (git_odb__strict_hash_verification) {
+		if (git_hash_final(&hashed, &stream->hash) < 0)
+			return -1;
+		if (!git_oid_equal(&stream->oid, &hashed))
+			return git_odb__error_mismatch(&stream->oid, &hashed);
+	}
+
+	stream->verified = 1;
+
+	return 0;
+}
+
+/*
+ * Inflate more input from the object file into the output buffer,
+ * until at least one byte is produced or the zlib stream ends.
+ */
+static int loose_readstream__inflate(
+	loose_readstream *stream, void *out, size_t len)
+{
+	z_stream *zs = &stream->zstream;
+	ssize_t read_bytes;
+	int z_return;
+
+	set_stream_output(zs, out, len);
+
+	while (zs->avail_out == len && !stream->done) {
+		if (zs->avail_in == 0) {
+			if ((read_bytes = p_read(stream->fd, stream->in, sizeof(stream->in))) < 0)
+				return loose_readstream__error("read error");
+			if (read_bytes == 0)
+				return loose_readstream__error("object is truncated");
+			set_stream_input(zs, stream->in, (size_t)read_bytes);
+		}
+
+		z_return = inflate(zs, 0);
+		if (z_return == Z_STREAM_END)
+			stream->done = 1;
+		else if (z_return != Z_OK && z_return != Z_BUF_ERROR)
+			return loose_readstream__error("zlib error");
+	}
+
+	return (int)(len - zs->avail_out);
+}
+
+static int loose_backend__readstream_read(
+	git_odb_stream *_stream, char *buffer, size_t len)
+{
+	loose_readstream *stream = (loose_readstream *)_stream;
+	int n = 0;
+
+	if (len == 0)
+		return 0;
+
+	if (len > INT_MAX)
+		len = INT_MAX;
+
+	if (stream->head_pos < stream->head_len) {
+		n = (int)min(len, stream->head_len - stream->head_pos);
+		memcpy(buffer, stream->head + stream->head_pos, n);
+		stream->head_pos += n;
+	} else if (!stream->done &&
+		(n = loose_readstream__inflate(stream, buffer, len)) < 0) {
+		return n;
+	}
+
+	if (n == 0)
+		return loose_readstream__finish(stream);
+
+	stream->stream.received_bytes += n;
+	if (stream->stream.received_bytes > stream->stream.declared_size)
+		return loose_readstream__error("object is larger than its header");
+
+	if (git_hash_update(&stream->hash, buffer, n) < 0)
+		return -1;
+
+	return n;
+}
+
+static void loose_backend__readstream_free(git_odb_stream *_stream)
+{
+	loose_readstream *stream = (loose_readstream *)_stream;
+
+	inflateEnd(&stream->zstream);
+	git_hash_ctx_cleanup(&stream->hash);
+	if (stream->fd >= 0)
+		p_close(stream->fd);
+	git__free(stream);
+}
+
+/*
+ * Open a loose object for reading in chunks. Only the zlib
+ * compressed format is supported, the legacy pack-like format is
+ * reported as an error so that the caller reads the object whole.
+ */
+static int loose_backend__readstream(
+	git_odb_stream **stream_out, git_odb_backend *_backend, const git_oid *oid)
+{
+	loose_backend *backend = (loose_backend *)_backend;
+	loose_readstream *stream = NULL;
+	git_buf object_path = GIT_BUF_INIT;
+	obj_hdr hdr;
+	char hdr_buf[64];
+	size_t used;
+	int error = 0, hdr_len, header_done = 0;
+
+	assert(stream_out && backend && oid);
+
+	*stream_out = NULL;
+
+	if (locate_object(&object_path, backend, oid) < 0) {
+		error = git_odb__error_notfound("no matching loose object",
+			oid, GIT_OID_HEXSZ);
+		goto done;
+	}
+
+	stream = git__calloc(1, sizeof(loose_readstream));
+	GITERR_CHECK_ALLOC(stream);
+
+	stream->fd = -1;
+	git_oid_cpy(&stream->oid, oid);
+	init_stream(&stream->zstream, stream->head, sizeof(stream->head));
+
+	if ((error = git_hash_ctx_init(&stream->hash)) < 0)
+		goto done;
+
+	if (inflateInit(&stream->zstream) != Z_OK) {
+		error = loose_readstream__error("zlib error");
+		goto done;
+	}
+
+	if ((stream->fd = git_futils_open_ro(object_path.ptr)) < 0) {
+		error = stream->fd;
+		goto done;
+	}
+
+	/*
+	 * inflate the initial part of the object in order to parse the
+	 * object header, which is terminated by a '\0'.
+	 */
+	while (!header_done) {
+		size_t produced = sizeof(stream->head) - stream->zstream.avail_out;
+		ssize_t read_bytes;
+		int z_return;
+
+		if (memchr(stream->head, '\0', produced) || stream->done ||
+			stream->zstream.avail_out == 0) {
+			header_done = 1;
+			continue;
+		}
+
+		if (stream->zstream.avail_in == 0) {
+			if ((read_bytes = p_read(stream->fd, stream->in, sizeof(stream->in))) <= 0)
+				break;
+			if (stream->zstream.total_in == 0 &&
+				(read_bytes < 2 || !is_zlib_compressed_data(stream->in)))
+				break;
+			set_stream_input(&stream->zstream, stream->in, (size_t)read_bytes);
+		}
+
+		z_return = inflate(&stream->zstream, 0);
+		if (z_return == Z_STREAM_END)
+			stream->done = 1;
+		else if (z_return != Z_OK && z_return != Z_BUF_ERROR)
+			break;
+	}
+
+	stream->head_len = sizeof(stream->head) - stream->zstream.avail_out;
+
+	if (!header_done ||
+		!memchr(stream->head, '\0', stream->head_len) ||
+		(used = get_object_header(&hdr, stream->head)) == 0 ||
+		!git_object_typeisloose(hdr.type)) {
+		error = loose_readstream__error("unsupported object header");
+		goto done;
+	}
+
+	hdr_len = git_odb__format_object_header(hdr_buf, sizeof(hdr_buf), hdr.size, hdr.type);
+	if ((error = git_hash_update(&stream->hash, hdr_buf, hdr_len)) < 0)
+		goto done;
+
+	stream->head_pos = used;
+	stream->stream.backend = _backend;
+	stream->stream.declared_size = hdr.size;
+	stream->stream.read = &loose_backend__readstream_read;
+	stream->stream.write = NULL;
+	stream->stream.finalize_write = NULL;
+	stream->stream.free = &loose_backend__readstream_free;
+	stream->stream.mode = GIT_STREAM_RDONLY;
+
+	*stream_out = (git_odb_stream *)stream;
+	stream = NULL;
+
+done:
+	if (stream)
+		loose_backend__readstream_free((git_odb_stream *)stream);
+	git_buf_free(&object_path);
+
+	return error;
+}
+
 static int loose_backend__write(git_odb_backend *_backend, const git_oid *oid, const void *data, size_t len, git_otype type)
 {
 	int error = 0, header_len;
@@ -1003,6 +1234,7 @@ int git_odb_backend_loose(
 	backend->parent.read_prefix = &loose_backend__read_prefix;
 	backend->parent.read_header = &loose_backend__read_header;
 	backend->parent.writestream = &loose_backend__stream;
+	backend->parent.readstream = &loose_backend__readstream;
 	backend->parent.exists = &loose_backend__exists;
 	backend->parent.exists_prefix = &loose_backend__exists_prefix;
 	backend->parent.foreach = &loose_backend__foreach;
@@ -17,6 +17,7 @@
 #include "sha1_lookup.h"
 #include "mwindow.h"
 #include "pack.h"
+#include "stats.h"
 
 #include "git2/odb_backend.h"
 
@@ -30,6 +31,14 @@ struct pack_backend {
 	char *pack_folder;
 };
 
+struct pack_readstream {
+	git_odb_stream parent;
+	git_packfile_stream zstream;
+	git_oid oid;
+	git_hash_ctx hash;
+	int verified;
+};
+
 struct pack_writepack {
 	struct git_odb_writepack parent;
 	git_indexer *indexer;
@@ -400,6 +409,8 @@ static int pack_backend__read(
 		(error = git_packfile_unpack(&raw, e.p, &e.offset)) < 0)
 		return error;
 
+	GIT_STATS_INC(GIT_STATS_ODB_READ_PACKED);
+
 	*buffer_p = raw.data;
 	*len_p = raw.len;
 	*type_p = raw.type;
@@ -462,6 +473,149 @@ static int pack_backend__exists_prefix(
 	return error;
 }
 
+static int pack_readstream__finish(struct pack_readstream *stream)
+{
+	git_oid hashed;
+
+	if (stream->verified)
+		return 0;
+
+	if (stream->parent.received_bytes != stream->parent.declared_size) {
+		giterr_set(GITERR_ODB, "failed to stream packed object: object is truncated");
+		return -1;
+	}
+
+	if (git_odb__strict_hash_verification) {
+		if (git_hash_final(&hashed, &stream->hash) < 0)
+			return -1;
+		if (!git_oid_equal(&stream->oid, &hashed))
+			return git_odb__error_mismatch(&stream->oid, &hashed);
+	}
+
+	stream->verified = 1;
+
+	return 0;
+}
+
+static int pack_backend__readstream_read(
+	git_odb_stream *_stream, char *buffer, size_t len)
+{
+	struct pack_readstream *stream = (struct pack_readstream *)_stream;
+	git_off_t curpos;
+	ssize_t n;
+
+	if (len == 0)
+		return 0;
+
+	if (len > INT_MAX)
+		len = INT_MAX;
+
+	/*
+	 * The zlib stream asks for more input by returning GIT_EBUFS
+	 * without output, retry as long as the read advances in the pack.
+	 */
+	do {
+		curpos = stream->zstream.curpos;
+		n = git_packfile_stream_read(&stream->zstream, buffer, len);
+	} while (n == GIT_EBUFS && stream->zstream.curpos > curpos);
+
+	if (n == GIT_EBUFS) {
+		giterr_set(GITERR_ODB, "failed to stream packed object: object is truncated");
+		return -1;
+	}
+
+	if (n < 0)
+		return (int)n;
+
+	if (n == 0)
+		return pack_readstream__finish(stream);
+
+	stream->parent.received_bytes += n;
+	if (stream->parent.received_bytes > stream->parent.declared_size) {
+		giterr_set(GITERR_ODB, "failed to stream packed object: object is larger than its header");
+		return -1;
+	}
+
+	if (git_hash_update(&stream->hash, buffer, n) < 0)
+		return -1;
+
+	return (int)n;
+}
+
+static void pack_backend__readstream_free(git_odb_stream *_stream)
+{
+	struct pack_readstream *stream = (struct pack_readstream *)_stream;
+
+	git_packfile_stream_free(&stream->zstream);
+	git_hash_ctx_cleanup(&stream->hash);
+	git__free(stream);
+}
+
+/*
+ * Open a packed object for reading in chunks. Only objects that are
+ * stored whole in the pack can be streamed; deltified objects are
+ * reported as an error so that the caller reads the object whole.
+ */
+static int pack_backend__readstream(
+	git_odb_stream **stream_out, git_odb_backend *backend, const git_oid *oid)
+{
+	struct pack_readstream *stream;
+	struct git_pack_entry e;
+	git_mwindow *w_curs = NULL;
+	git_off_t curpos;
+	git_otype type;
+	size_t size;
+	char hdr[64];
+	int error, hdr_len;
+
+	assert(stream_out && backend && oid);
+
+	*stream_out = NULL;
+
+	if ((error = pack_entry_find(&e, (struct pack_backend *)backend, oid)) < 0)
+		return error;
+
+	curpos = e.offset;
+	if ((error = git_packfile_unpack_header(&size, &type, &e.p->mwf, &w_curs, &curpos)) < 0)
+		return error;
+
+	if (type == GIT_OBJ_OFS_DELTA || type == GIT_OBJ_REF_DELTA) {
+		giterr_set(GITERR_ODB, "failed to stream packed object: object is deltified");
+		return -1;
+	}
+
+	stream = git__calloc(1, sizeof(struct pack_readstream));
+	GITERR_CHECK_ALLOC(stream);
+
+	if ((error = git_hash_ctx_init(&stream->hash)) < 0) {
+		git__free(stream);
+		return error;
+	}
+
+	if ((error = git_packfile_stream_open(&stream->zstream, e.p, curpos)) < 0) {
+		git_hash_ctx_cleanup(&stream->hash);
+		git__free(stream);
+		return error;
+	}
+
+	hdr_len = git_odb__format_object_header(hdr, sizeof(hdr), size, type);
+	if ((error = git_hash_update(&stream->hash, hdr, hdr_len)) < 0) {
+		pack_backend__readstream_free((git_odb_stream *)stream);
+		return error;
+	}
+
+	git_oid_cpy(&stream->oid, oid);
+	stream->parent.backend = backend;
+	stream->parent.declared_size = size;
+	stream->parent.read = &pack_backend__readstream_read;
+	stream->parent.free = &pack_backend__readstream_free;
+	stream->parent.mode = GIT_STREAM_RDONLY;
+
+	*stream_out = (git_odb_stream *)stream;
+
+	return 0;
+}
+
 static int pack_backend__foreach(git_odb_backend *_backend, git_odb_foreach_cb cb, void *data)
 {
 	int error;
@@ -580,6 +734,7 @@ static int pack_backend__alloc(struct pack_backend **out, size_t initial_size)
 	backend->parent.read = &pack_backend__read;
 	backend->parent.read_prefix = &pack_backend__read_prefix;
 	backend->parent.read_header = &pack_backend__read_header;
+	backend->parent.readstream = &pack_backend__readstream;
 	backend->parent.exists = &pack_backend__exists;
 	backend->parent.exists_prefix = &pack_backend__exists_prefix;
 	backend->parent.refresh = &pack_backend__refresh;
@@ -202,8 +202,8 @@ static void rehash(git_packbuilder *pb)
 	}
 }
 
-int git_packbuilder_insert(git_packbuilder *pb, const git_oid *oid,
-			   const char *name)
+static int insert_object(git_packbuilder *pb, const git_oid *oid,
+			 const char *name, bool base)
 {
 	git_pobject *po;
 	khiter_t pos;
@@ -213,9 +213,20 @@ int git_packbuilder_insert(git_packbuilder *pb, const git_oid *oid,
 	assert(pb && oid);
 
 	/* If the object already exists in the hash table, then we don't
-	 * have any work to do */
-	if (git_oidmap_exists(pb->object_ix, oid))
+	 * have any work to do, except to write an object that was only
+	 * inserted as a base */
+	pos = git_oidmap_lookup_index(pb->object_ix, oid);
+	if (git_oidmap_valid_index(pb->object_ix, pos)) {
+		po = git_oidmap_value_at(pb->object_ix, pos);
+
+		if (po->preferred_base && !base) {
+			po->preferred_base = 0;
+			pb->nr_bases--;
+			pb->done = false;
+		}
+
 		return 0;
+	}
 
 	if (pb->nr_objects >= pb->nr_alloc) {
 		GITERR_CHECK_ALLOC_ADD(&newsize, pb->nr_alloc, 1024);
@@ -244,6 +255,11 @@ int git_packbuilder_insert(git_packbuilder *pb, const git_oid *oid,
 	git_oid_cpy(&po->id, oid);
 	po->hash = name_hash(name);
 
+	if (base) {
+		po->preferred_base = 1;
+		pb->nr_bases++;
+	}
+
 	pos = git_oidmap_put(pb->object_ix, &po->id, &ret);
 	if (ret < 0) {
 		giterr_set_oom();
@@ -263,7 +279,8 @@ int git_packbuilder_insert(git_packbuilder *pb, const git_oid *oid,
 
 			ret = pb->progress_cb(
 				GIT_PACKBUILDER_ADDING_OBJECTS,
-				pb->nr_objects, 0, pb->progress_cb_payload);
+				pb->nr_objects - pb->nr_bases, 0,
+				pb->progress_cb_payload);
 
 			if (ret)
 				return giterr_set_after_callback(ret);
@@ -273,6 +290,18 @@ int git_packbuilder_insert(git_packbuilder *pb, const git_oid *oid,
 	return 0;
 }
 
+int git_packbuilder_insert(git_packbuilder *pb, const git_oid *oid,
+			   const char *name)
+{
+	return insert_object(pb, oid, name, false);
+}
+
+int git_packbuilder__insert_base(git_packbuilder *pb, const git_oid *oid,
+	const char *name)
+{
+	return insert_object(pb, oid, name, true);
+}
+
 static int get_delta(void **out, git_odb *odb, git_pobject *po)
 {
 	git_odb_object *src = NULL, *trg = NULL;
@@ -337,6 +366,10 @@ static int write_object(
 
 		data_len = po->delta_size;
 		type = GIT_OBJ_REF_DELTA;
+
+		pb->nr_deltas++;
+		if (po->delta->preferred_base)
+			pb->nr_thin_deltas++;
 	} else {
 		if ((error = git_odb_read(&obj, pb->odb, &po->id)) < 0)
 			goto done;
@@ -427,7 +460,8 @@ static int write_one(
 		return 0;
 	}
 
-	if (po->delta) {
+	/* A preferred base is not written, the receiver has it */
+	if (po->delta && !po->delta->preferred_base) {
 		po->recursing = 1;
 
 		if ((error = write_one(status, pb, po->delta, write_cb, cb_data)) < 0)
@@ -501,7 +535,8 @@ static void add_family_to_write_order(git_pobject **wo, size_t *endp,
 {
 	git_pobject *root;
 
-	for (root = po; root->delta; root = root->delta)
+	for (root = po; root->delta && !root->delta->preferred_base;
+	     root = root->delta)
 		; /* nothing */
 	add_descendants_to_write_order(wo, endp, root);
 }
@@ -534,10 +569,11 @@ static git_pobject **compute_write_order(git_packbuilder *pb)
 	if ((wo = git__mallocarray(pb->nr_objects, sizeof(*wo))) == NULL)
 		return NULL;
 
+	/* The preferred bases are not written, don't fill them */
 	for (i = 0; i < pb->nr_objects; i++) {
 		git_pobject *po = pb->object_list + i;
 		po->tagged = 0;
-		po->filled = 0;
+		po->filled = po->preferred_base;
 		po->delta_child = NULL;
 		po->delta_sibling = NULL;
 	}
@@ -615,7 +651,7 @@ static git_pobject **compute_write_order(git_packbuilder *pb)
 			add_family_to_write_order(wo, &wo_end, po);
 	}
 
-	if (wo_end != pb->nr_objects) {
+	if (wo_end != pb->nr_objects - pb->nr_bases) {
 		git__free(wo);
 		giterr_set(GITERR_INVALID, "invalid write order");
 		return NULL;
@@ -633,7 +669,7 @@ static int write_pack(git_packbuilder *pb,
 	enum write_one_status status;
 	struct git_pack_header ph;
 	git_oid entry_oid;
-	size_t i = 0;
+	size_t i = 0, nr_objects = pb->nr_objects - pb->nr_bases;
 	int error = 0;
 
 	write_order = compute_write_order(pb);
@@ -648,16 +684,17 @@ static int write_pack(git_packbuilder *pb,
 	/* Write pack header */
 	ph.hdr_signature = htonl(PACK_SIGNATURE);
 	ph.hdr_version = htonl(PACK_VERSION);
-	ph.hdr_entries = htonl(pb->nr_objects);
+	ph.hdr_entries = htonl(nr_objects);
 
 	if ((error = write_cb(&ph, sizeof(ph), cb_data)) < 0 ||
 		(error = git_hash_update(&pb->ctx, &ph, sizeof(ph))) < 0)
 		goto done;
 
-	pb->nr_remaining = pb->nr_objects;
+	pb->nr_deltas = pb->nr_thin_deltas = 0;
+	pb->nr_remaining = nr_objects;
 	do {
 		pb->nr_written = 0;
-		for ( ; i < pb->nr_objects; ++i) {
+		for ( ; i < nr_objects; ++i) {
 			po = write_order[i];
 
 			if ((error = write_one(&status, pb, po, write_cb, cb_data)) < 0)
@@ -665,7 +702,7 @@ static int write_pack(git_packbuilder *pb,
 		}
 
 		pb->nr_remaining -= pb->nr_written;
-	} while (pb->nr_remaining && i < pb->nr_objects);
+	} while (pb->nr_remaining && i < nr_objects);
 
 	if ((error = git_hash_final(&entry_oid, &pb->ctx)) < 0)
 		goto done;
@@ -674,7 +711,7 @@ static int write_pack(git_packbuilder *pb,
 
 done:
 	/* if callback cancelled writing, we must still free delta_data */
-	for ( ; i < pb->nr_objects; ++i) {
+	for ( ; i < nr_objects; ++i) {
 		po = write_order[i];
 		if (po->delta_data) {
 			git__free(po->delta_data);
@@ -705,14 +742,10 @@ static int type_size_sort(const void *_a, const void *_b)
 		return -1;
 	if (a->hash < b->hash)
 		return 1;
-	/*
-	 * TODO
-	 *
 	if (a->preferred_base > b->preferred_base)
 		return -1;
 	if (a->preferred_base < b->preferred_base)
 		return 1;
-	*/
 	if (a->size > b->size)
 		return -1;
 	if (a->size < b->size)
@@ -987,6 +1020,10 @@ static int find_deltas(git_packbuilder *pb, git_pobject **list,
 			count--;
 		}
 
+		/* A preferred base is only a base for the next objects */
+		if (po->preferred_base)
+			goto next;
+
 		/*
 		 * If the current object is at pack edge, take the depth the
 		 * objects that depend on the current object into account
@@ -1334,6 +1371,9 @@ static int prepare_pack(git_packbuilder *pb)
 		if (po->size < 50 || po->size > pb->big_file_threshold)
 			continue;
 
+		if (po->preferred_base && !pb->thin)
+			continue;
+
 		delta_list[n++] = po;
 	}
 
@@ -1505,7 +1545,7 @@ cleanup:
 
 size_t git_packbuilder_object_count(git_packbuilder *pb)
 {
-	return pb->nr_objects;
+	return pb->nr_objects - pb->nr_bases;
 }
 
 size_t git_packbuilder_written(git_packbuilder *pb)
@@ -50,6 +50,8 @@ typedef struct git_pobject {
 	    recursing:1,
 	    tagged:1,
 	    filled:1;
+
+	unsigned int preferred_base:1; /* only a delta base of a thin pack */
 } git_pobject;
 
 typedef struct {
@@ -68,7 +70,10 @@ struct git_packbuilder {
 	uint32_t nr_objects,
 		nr_deltified,
 		nr_written,
-		nr_remaining;
+		nr_remaining,
+		nr_bases, /* preferred bases in object_list */
+		nr_deltas,
+		nr_thin_deltas;
 
 	size_t nr_alloc;
 
@@ -100,8 +105,19 @@ struct git_packbuilder {
 	double last_progress_report_time; /* the time progress was last reported */
 
 	bool done;
+	bool thin; /* deltify against the preferred bases */
 };
 
 int git_packbuilder_write_buf(git_buf *buf, git_packbuilder *pb);
 
+/**
+ * Insert an object that the receiver of the pack has, as a delta
+ * base for the objects in the pack. The object is not written, and
+ * the deltas against it make a thin pack. Inserting the object with
+ * git_packbuilder_insert later writes it. The bases are only used if
+ * `pb->thin` is set.
+ */
+int git_packbuilder__insert_base(git_packbuilder *pb, const git_oid *oid,
+	const char *name);
+
 #endif /* INCLUDE_pack_objects_h__ */
@@ -13,6 +13,7 @@
 #include "mwindow.h"
 #include "fileops.h"
 #include "oid.h"
+#include "stats.h"
 
 #include <zlib.h>
 
@@ -122,6 +123,8 @@ static git_pack_cache_entry *cache_get(git_pack_cache *cache, git_off_t offset)
 	}
 	git_mutex_unlock(&cache->lock);
 
+	GIT_STATS_INC(entry ? GIT_STATS_DELTA_CACHE_HIT : GIT_STATS_DELTA_CACHE_MISS);
+
 	return entry;
 }
 
@@ -642,6 +645,11 @@ int git_packfile_unpack(
 	if (error < 0)
 		return error;
 
+	if (stack_size > 1) {
+		GIT_STATS_INC(GIT_STATS_DELTA_CHAINS);
+		GIT_STATS_ADD(GIT_STATS_DELTA_CHAIN_LENGTH, stack_size - 1);
+	}
+
 	obj->data = NULL;
 	obj->len = 0;
 	obj->type = GIT_OBJ_BAD;
@@ -899,6 +907,8 @@ static int packfile_unpack_compressed(
 		return -1;
 	}
 
+	GIT_STATS_ADD(GIT_STATS_BYTES_INFLATED, size);
+
 	obj->type = type;
 	obj->len = size;
 	obj->data = buffer;
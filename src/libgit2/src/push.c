@@ -350,6 +350,26 @@ static int revwalk(git_vector *commits, git_push *push)
 		git_revwalk_hide(rw, &head->oid);
 	}
 
+	/*
+	 * The remote-tracking branches were on the remote when they were
+	 * fetched. Hiding them stops the walk early when the remote
+	 * advertises commits that we don't have.
+	 */
+	if (push->remote->name) {
+		git_buf glob = GIT_BUF_INIT;
+
+		if (git_buf_printf(&glob, GIT_REFS_REMOTES_DIR "%s/*",
+				push->remote->name) < 0) {
+			error = -1;
+			goto on_error;
+		}
+
+		if (git_revwalk_hide_glob(rw, git_buf_cstr(&glob)) < 0)
+			giterr_clear();
+
+		git_buf_free(&glob);
+	}
+
 	while ((error = git_revwalk_next(&oid, rw)) == 0) {
 		git_oid *o = git__malloc(GIT_OID_RAWSZ);
 		if (!o) {
@@ -406,9 +426,12 @@ static int queue_differences(
 		if (!cmp &&
 			git_tree_entry__is_tree(b_entry) &&
 			git_tree_entry__is_tree(d_entry)) {
-			/* Add the right-hand entry */
+			/* Add the right-hand entry, and the left-hand entry
+			 * as its delta base */
 			if ((error = git_packbuilder_insert(pb, d_entry->oid,
-				d_entry->filename)) < 0)
+				d_entry->filename)) < 0 ||
+				(error = git_packbuilder__insert_base(pb, b_entry->oid,
+				b_entry->filename)) < 0)
 				goto on_error;
 
 			/* Acquire the subtrees and recurse */
@@ -428,6 +451,14 @@ static int queue_differences(
 			(error = enqueue_object(d_entry, pb)) < 0)
 			goto on_error;
 
+		/* A changed blob is a delta against its previous version */
+		else if (!cmp &&
+			git_tree_entry_type(b_entry) == GIT_OBJ_BLOB &&
+			git_tree_entry_type(d_entry) == GIT_OBJ_BLOB &&
+			(error = git_packbuilder__insert_base(pb, b_entry->oid,
+				b_entry->filename)) < 0)
+			goto on_error;
+
 	loop:
 		if (cmp <= 0) i++;
 		if (cmp >= 0) j++;
@@ -461,6 +492,8 @@ static int queue_objects(git_push *push)
 	if ((error = revwalk(&commits, push)) < 0)
 		goto on_error;
 
+	push->stats.commits = commits.length;
+
 	git_vector_foreach(&commits, i, oid) {
 		git_commit *parent = NULL, *commit;
 		git_tree *tree = NULL, *ptree = NULL;
@@ -490,6 +523,8 @@ static int queue_objects(git_push *push)
 			for (j = 0; j < parentcount; j++) {
 				if ((error = git_commit_parent(&parent, commit, j)) < 0 ||
 					(error = git_commit_tree(&ptree, parent)) < 0 ||
+					(error = git_packbuilder__insert_base(push->pb,
+						git_tree_id(ptree), NULL)) < 0 ||
 					(error = queue_differences(ptree, tree, push->pb)) < 0)
 					goto loop_error;
 
@@ -595,6 +630,10 @@ static int do_push(git_push *push, const git_remote_callbacks *callbacks)
 
 	git_packbuilder_set_threads(push->pb, push->pb_parallelism);
 
+	/* The transport turns this off if the remote can't fix thin packs */
+	push->pb->thin = true;
+	memset(&push->stats, 0, sizeof(push->stats));
+
 	if (callbacks && callbacks->pack_progress)
 		if ((error = git_packbuilder_set_callbacks(push->pb, callbacks->pack_progress, callbacks->payload)) < 0)
 			goto on_error;
@@ -611,6 +650,11 @@ static int do_push(git_push *push, const git_remote_callbacks *callbacks)
 	    (error = transport->push(transport, push, callbacks)) < 0)
 		goto on_error;
 
+	push->stats.objects = git_packbuilder_object_count(push->pb);
+	push->stats.bases = push->pb->nr_bases;
+	push->stats.deltas = push->pb->nr_deltas;
+	push->stats.thin_deltas = push->pb->nr_thin_deltas;
+
 on_error:
 	git_packbuilder_free(push->pb);
 	return error;
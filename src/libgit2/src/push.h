@@ -24,6 +24,15 @@ typedef struct push_status {
 	char *msg;
 } push_status;
 
+/* What the last push enumerated and wrote */
+typedef struct {
+	size_t commits; /* commits that the remote doesn't have */
+	size_t objects; /* objects written to the pack */
+	size_t bases; /* objects the remote has, used as delta bases */
+	size_t deltas; /* objects written as deltas */
+	size_t thin_deltas; /* deltas against a base that isn't written */
+} git_push_stats;
+
 struct git_push {
 	git_repository *repo;
 	git_packbuilder *pb;
@@ -39,6 +48,8 @@ struct git_push {
 	/* options */
 	unsigned pb_parallelism;
 	const git_strarray *custom_headers;
+
+	git_push_stats stats;
 };
 
 /**
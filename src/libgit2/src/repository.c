@@ -29,6 +29,7 @@
 #include "annotated_commit.h"
 #include "submodule.h"
 #include "worktree.h"
+#include "stats.h"
 
 #include "strmap.h"
 
@@ -158,6 +159,10 @@ void git_repository_free(git_repository *repo)
 
 	git_repository__cleanup(repo);
 
+	/* Sync the files of a batch, the error cannot be returned */
+	if (git_futils__fsync_batch && git_futils_fsync_batch_flush() < 0)
+		giterr_clear();
+
 	git_cache_free(&repo->objects);
 
 	git_diff_driver_registry_free(repo->diff_drivers);
@@ -588,6 +593,7 @@ int git_repository_open_bare(
 	repo->workdir = NULL;
 
 	*repo_ptr = repo;
+	GIT_STATS_INC(GIT_STATS_REPOSITORY_OPEN);
 	return 0;
 }
 
@@ -856,8 +862,10 @@ cleanup:
 
 	if (error < 0)
 		git_repository_free(repo);
-	else
+	else {
 		*repo_ptr = repo;
+		GIT_STATS_INC(GIT_STATS_REPOSITORY_OPEN);
+	}
 
 	return error;
 }
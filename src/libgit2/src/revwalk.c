@@ -44,29 +44,42 @@ static int push_commit(git_revwalk *walk, const git_oid *oid, int uninteresting,
 {
 	git_oid commit_id;
 	int error;
+	size_t len;
+	git_otype type;
 	git_object *obj, *oobj;
 	git_commit_list_node *commit;
 	git_commit_list *list;
 
-	if ((error = git_object_lookup(&oobj, walk->repo, oid, GIT_OBJ_ANY)) < 0)
+	/*
+	 * A commit is pushed as is. Looking it up would parse it in
+	 * full, and copy the message, only to get its id.
+	 */
+	if ((error = git_odb_read_header(&len, &type, walk->odb, oid)) < 0)
 		return error;
 
-	error = git_object_peel(&obj, oobj, GIT_OBJ_COMMIT);
-	git_object_free(oobj);
+	if (type == GIT_OBJ_COMMIT) {
+		git_oid_cpy(&commit_id, oid);
+	} else {
+		if ((error = git_object_lookup(&oobj, walk->repo, oid, GIT_OBJ_ANY)) < 0)
+			return error;
 
-	if (error == GIT_ENOTFOUND || error == GIT_EINVALIDSPEC || error == GIT_EPEEL) {
-		/* If this comes from e.g. push_glob("tags"), ignore this */
-		if (from_glob)
-			return 0;
+		error = git_object_peel(&obj, oobj, GIT_OBJ_COMMIT);
+		git_object_free(oobj);
 
-		giterr_set(GITERR_INVALID, "object is not a committish");
-		return -1;
-	}
-	if (error < 0)
-		return error;
+		if (error == GIT_ENOTFOUND || error == GIT_EINVALIDSPEC || error == GIT_EPEEL) {
+			/* If this comes from e.g. push_glob("tags"), ignore this */
+			if (from_glob)
+				return 0;
 
-	git_oid_cpy(&commit_id, git_object_id(obj));
-	git_object_free(obj);
+			giterr_set(GITERR_INVALID, "object is not a committish");
+			return -1;
+		}
+		if (error < 0)
+			return error;
+
+		git_oid_cpy(&commit_id, git_object_id(obj));
+		git_object_free(obj);
+	}
 
 	commit = git_revwalk__commit_lookup(walk, &commit_id);
 	if (commit == NULL)
@@ -415,7 +428,7 @@ static int still_interesting(git_commit_list *list, int64_t time, int slop)
 
 static int limit_list(git_commit_list **out, git_revwalk *walk, git_commit_list *commits)
 {
-	int error, slop = SLOP;
+	int error, slop = SLOP, since_slop = SLOP;
 	int64_t time = ~0ll;
 	git_commit_list *list = commits;
 	git_commit_list *newlist = NULL;
@@ -437,9 +450,25 @@ static int limit_list(git_commit_list **out, git_revwalk *walk, git_commit_list
 			break;
 		}
 
+		/*
+		 * The list is sorted by date, so the remaining commits are
+		 * older too. Look at a few more in case of clock skew.
+		 */
+		if (walk->limit_since && commit->time < walk->since) {
+			if (--since_slop)
+				continue;
+
+			break;
+		}
+
+		since_slop = SLOP;
+
 		if (!commit->uninteresting && walk->hide_cb && walk->hide_cb(&commit->oid, walk->hide_cb_payload))
 				continue;
 
+		if (walk->limit_until && commit->time > walk->until)
+			continue;
+
 		time = commit->time;
 		p = &git_commit_list_insert(commit, p)->next;
 	}
@@ -557,7 +586,15 @@ static int prepare_walk(git_revwalk *walk)
 
 		if (!commit->seen) {
 			commit->seen = 1;
-			git_commit_list_insert(commit, &commits);
+
+			/*
+			 * limit_list stops on 'since' once it has seen a
+			 * few old commits, so start with the newest tips.
+			 */
+			if (walk->limit_since)
+				git_commit_list_insert_by_date(commit, &commits);
+			else
+				git_commit_list_insert(commit, &commits);
 		}
 	}
 
@@ -671,6 +708,18 @@ void git_revwalk_simplify_first_parent(git_revwalk *walk)
 	walk->first_parent = 1;
 }
 
+void git_revwalk__since(git_revwalk *walk, int64_t since)
+{
+	walk->limit_since = 1;
+	walk->since = since;
+}
+
+void git_revwalk__until(git_revwalk *walk, int64_t until)
+{
+	walk->limit_until = 1;
+	walk->until = until;
+}
+
 int git_revwalk_next(git_oid *oid, git_revwalk *walk)
 {
 	int error;
@@ -718,6 +767,7 @@ void git_revwalk_reset(git_revwalk *walk)
 	git_commit_list_free(&walk->iterator_reverse);
 	git_commit_list_free(&walk->user_input);
 	walk->first_parent = 0;
+	walk->limit_since = walk->limit_until = 0;
 	walk->walking = 0;
 	walk->did_push = walk->did_hide = 0;
 }
@@ -34,9 +34,15 @@ struct git_revwalk {
 	unsigned walking:1,
 		first_parent: 1,
 		did_hide: 1,
-		did_push: 1;
+		did_push: 1,
+		limit_since: 1,
+		limit_until: 1;
 	unsigned int sorting;
 
+	/* the window of commit times to output */
+	int64_t since;
+	int64_t until;
+
 	/* the pushes and hides */
 	git_commit_list *user_input;
 
@@ -47,4 +53,12 @@ struct git_revwalk {
 
 git_commit_list_node *git_revwalk__commit_lookup(git_revwalk *walk, const git_oid *oid);
 
+/*
+ * Only output commits with a commit time in the window. The walk
+ * stops after a few commits older than 'since', like git log --since
+ * and --until.
+ */
+void git_revwalk__since(git_revwalk *walk, int64_t since);
+void git_revwalk__until(git_revwalk *walk, int64_t until);
+
 #endif
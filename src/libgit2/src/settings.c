@@ -13,10 +13,12 @@
 #include "common.h"
 #include "sysdir.h"
 #include "cache.h"
+#include "fileops.h"
 #include "global.h"
 #include "object.h"
 #include "odb.h"
 #include "refs.h"
+#include "transports/pool.h"
 #include "transports/smart.h"
 
 void git_libgit2_version(int *major, int *minor, int *rev)
@@ -232,6 +234,20 @@ int git_libgit2_opts(int key, ...)
 		git_repository__fsync_gitdir = (va_arg(ap, int) != 0);
 		break;
 
+	case GIT_OPT_ENABLE_FSYNC_BATCH:
+#ifdef GIT_WIN32
+		(void)va_arg(ap, int);
+#else
+		git_futils__fsync_batch = (va_arg(ap, int) != 0);
+		if (!git_futils__fsync_batch)
+			error = git_futils_fsync_batch_flush();
+#endif
+		break;
+
+	case GIT_OPT_SET_TRANSPORT_POOL_TIMEOUT:
+		error = git_transport_pool_set_timeout(va_arg(ap, int));
+		break;
+
 	case GIT_OPT_GET_WINDOWS_SHAREMODE:
 #ifdef GIT_WIN32
 		*(va_arg(ap, unsigned long *)) = git_win32__createfile_sharemode;
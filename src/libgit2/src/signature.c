@@ -48,7 +48,7 @@ static bool is_crud(unsigned char c)
 		c == '\'';
 }
 
-static char *extract_trimmed(const char *ptr, size_t len)
+static char *extract_trimmed(const char *ptr, size_t len, git_pool *pool)
 {
 	while (len && is_crud((unsigned char)ptr[0])) {
 		ptr++; len--;
@@ -58,6 +58,9 @@ static char *extract_trimmed(const char *ptr, size_t len)
 		len--;
 	}
 
+	if (pool)
+		return git_pool_strndup(pool, ptr, len);
+
 	return git__substrdup(ptr, len);
 }
 
@@ -78,9 +81,9 @@ int git_signature_new(git_signature **sig_out, const char *name, const char *ema
 	p = git__calloc(1, sizeof(git_signature));
 	GITERR_CHECK_ALLOC(p);
 
-	p->name = extract_trimmed(name, strlen(name));
+	p->name = extract_trimmed(name, strlen(name), NULL);
 	GITERR_CHECK_ALLOC(p->name);
-	p->email = extract_trimmed(email, strlen(email));
+	p->email = extract_trimmed(email, strlen(email), NULL);
 	GITERR_CHECK_ALLOC(p->email);
 
 	if (p->name[0] == '\0' || p->email[0] == '\0') {
@@ -192,8 +195,8 @@ int git_signature_default(git_signature **out, git_repository *repo)
 	return error;
 }
 
-int git_signature__parse(git_signature *sig, const char **buffer_out,
-		const char *buffer_end, const char *header, char ender)
+static int signature_parse(git_signature *sig, const char **buffer_out,
+		const char *buffer_end, const char *header, char ender, git_pool *pool)
 {
 	const char *buffer = *buffer_out;
 	const char *email_start, *email_end;
@@ -220,8 +223,8 @@ int git_signature__parse(git_signature *sig, const char **buffer_out,
 		return signature_error("malformed e-mail");
 
 	email_start += 1;
-	sig->name = extract_trimmed(buffer, email_start - buffer - 1);
-	sig->email = extract_trimmed(email_start, email_end - email_start);
+	sig->name = extract_trimmed(buffer, email_start - buffer - 1, pool);
+	sig->email = extract_trimmed(email_start, email_end - email_start, pool);
 
 	/* Do we even have a time at the end of the signature? */
 	if (email_end + 2 < buffer_end) {
@@ -229,8 +232,10 @@ int git_signature__parse(git_signature *sig, const char **buffer_out,
 		const char *time_end;
 
 		if (git__strtol64(&sig->when.time, time_start, &time_end, 10) < 0) {
-			git__free(sig->name);
-			git__free(sig->email);
+			if (!pool) {
+				git__free(sig->name);
+				git__free(sig->email);
+			}
 			return signature_error("invalid Unix timestamp");
 		}
 
@@ -266,6 +271,19 @@ int git_signature__parse(git_signature *sig, const char **buffer_out,
 	return 0;
 }
 
+int git_signature__parse(git_signature *sig, const char **buffer_out,
+		const char *buffer_end, const char *header, char ender)
+{
+	return signature_parse(sig, buffer_out, buffer_end, header, ender, NULL);
+}
+
+int git_signature__parse_pool(git_signature *sig, const char **buffer_out,
+		const char *buffer_end, const char *header, char ender, git_pool *pool)
+{
+	assert(pool && pool->item_size == sizeof(char));
+	return signature_parse(sig, buffer_out, buffer_end, header, ender, pool);
+}
+
 int git_signature_from_buffer(git_signature **out, const char *buf)
 {
 	git_signature *sig;
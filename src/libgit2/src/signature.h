@@ -13,6 +13,7 @@
 #include <time.h>
 
 int git_signature__parse(git_signature *sig, const char **buffer_out, const char *buffer_end, const char *header, char ender);
+int git_signature__parse_pool(git_signature *sig, const char **buffer_out, const char *buffer_end, const char *header, char ender, git_pool *pool);
 void git_signature__writebuf(git_buf *buf, const char *header, const git_signature *sig);
 bool git_signature__equal(const git_signature *one, const git_signature *two);
 
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) the libgit2 contributors. All rights reserved.
+ *
+ * This file is part of libgit2, distributed under the GNU GPL v2 with
+ * a Linking Exception. For full terms see the included COPYING file.
+ */
+
+#include "stats.h"
+
+bool git_stats__enabled = false;
+git_atomic_ssize git_stats__counters[GIT_STATS__COUNT];
+
+static const char *stats_names[GIT_STATS__COUNT] = {
+	"repository_open",
+	"odb_read_loose",
+	"odb_read_packed",
+	"bytes_inflated",
+	"delta_chains",
+	"delta_chain_length",
+	"cache_hit",
+	"cache_miss",
+	"delta_cache_hit",
+	"delta_cache_miss",
+	"mwindow_map",
+	"mwindow_unmap",
+	"commit_message",
+};
+
+const char *git_stats__name(git_stats_t counter)
+{
+	assert(counter < GIT_STATS__COUNT);
+	return stats_names[counter];
+}
+
+int64_t git_stats__get(git_stats_t counter)
+{
+	assert(counter < GIT_STATS__COUNT);
+	return git_atomic_ssize_add(&git_stats__counters[counter], 0);
+}
+
+void git_stats__reset(void)
+{
+	size_t i;
+
+	for (i = 0; i < GIT_STATS__COUNT; i++)
+		git_atomic_ssize_add(&git_stats__counters[i],
+			-git_atomic_ssize_add(&git_stats__counters[i], 0));
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) the libgit2 contributors. All rights reserved.
+ *
+ * This file is part of libgit2, distributed under the GNU GPL v2 with
+ * a Linking Exception. For full terms see the included COPYING file.
+ */
+#ifndef INCLUDE_stats_h__
+#define INCLUDE_stats_h__
+
+#include "common.h"
+
+/**
+ * Counters of the work done by the object database, the caches, the
+ * memory windows and the commit parser. The counters are only updated
+ * when `git_stats__enabled` is set, so they cost one branch when
+ * disabled.
+ */
+typedef enum {
+	GIT_STATS_REPOSITORY_OPEN = 0,
+	GIT_STATS_ODB_READ_LOOSE,
+	GIT_STATS_ODB_READ_PACKED,
+	GIT_STATS_BYTES_INFLATED,
+	GIT_STATS_DELTA_CHAINS,
+	GIT_STATS_DELTA_CHAIN_LENGTH,
+	GIT_STATS_CACHE_HIT,
+	GIT_STATS_CACHE_MISS,
+	GIT_STATS_DELTA_CACHE_HIT,
+	GIT_STATS_DELTA_CACHE_MISS,
+	GIT_STATS_MWINDOW_MAP,
+	GIT_STATS_MWINDOW_UNMAP,
+	GIT_STATS_COMMIT_MESSAGE,
+	GIT_STATS__COUNT
+} git_stats_t;
+
+extern bool git_stats__enabled;
+extern git_atomic_ssize git_stats__counters[GIT_STATS__COUNT];
+
+#define GIT_STATS_ADD(counter, n) do { \
+	if (git_stats__enabled) \
+		git_atomic_ssize_add(&git_stats__counters[(counter)], (n)); \
+	} while (0)
+
+#define GIT_STATS_INC(counter) GIT_STATS_ADD(counter, 1)
+
+/** The name of a counter, e.g. "odb_read_loose" */
+const char *git_stats__name(git_stats_t counter);
+
+/** The value of a counter */
+int64_t git_stats__get(git_stats_t counter);
+
+/** Set all counters to zero */
+void git_stats__reset(void);
+
+#endif
@@ -261,6 +261,16 @@ int git_status_list_new(
 	git_status_list **out,
 	git_repository *repo,
 	const git_status_options *opts)
+{
+	return git_status_list__new(out, repo, opts, NULL, NULL);
+}
+
+int git_status_list__new(
+	git_status_list **out,
+	git_repository *repo,
+	const git_status_options *opts,
+	git_diff_progress_cb progress_cb,
+	void *payload)
 {
 	git_index *index = NULL;
 	git_status_list *status = NULL;
@@ -302,6 +312,8 @@ int git_status_list_new(
 	}
 
 	diffopt.flags = GIT_DIFF_INCLUDE_TYPECHANGE;
+	diffopt.progress_cb = progress_cb;
+	diffopt.payload = payload;
 	findopt.flags = GIT_DIFF_FIND_FOR_UNTRACKED;
 
 	if ((flags & GIT_STATUS_OPT_INCLUDE_UNTRACKED) != 0)
@@ -20,4 +20,16 @@ struct git_status_list {
 	git_vector paired;
 };
 
+/*
+ * Like git_status_list_new, with a callback that is called for each
+ * item that is compared. A non-zero return value of the callback
+ * stops the status and is returned.
+ */
+extern int git_status_list__new(
+	git_status_list **out,
+	git_repository *repo,
+	const git_status_options *opts,
+	git_diff_progress_cb progress_cb,
+	void *payload);
+
 #endif
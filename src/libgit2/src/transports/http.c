@@ -18,6 +18,7 @@
 #include "tls_stream.h"
 #include "socket_stream.h"
 #include "curl_stream.h"
+#include "pool.h"
 
 git_http_auth_scheme auth_schemes[] = {
 	{ GIT_AUTHTYPE_NEGOTIATE, "Negotiate", GIT_CREDTYPE_DEFAULT, git_http_auth_negotiate },
@@ -68,6 +69,7 @@ typedef struct {
 	git_stream *io;
 	gitno_connection_data connection_data;
 	bool connected;
+	bool reused;
 
 	/* Parser structures */
 	http_parser parser;
@@ -589,8 +591,33 @@ static int apply_proxy_config(http_subtransport *t)
 	return git_stream_set_proxy(t->io, &t->owner->proxy);
 }
 
-static int http_connect(http_subtransport *t)
+static void http_pool_free(void *conn)
 {
+	git_stream *io = conn;
+
+	git_stream_close(io);
+	git_stream_free(io);
+}
+
+/* The key of a connection in the transport pool, connections
+ * through a proxy are not pooled */
+static int http_pool_key(git_buf *key, http_subtransport *t)
+{
+	if (!git_transport_pool__timeout ||
+		t->owner->proxy.type != GIT_PROXY_NONE)
+		return GIT_ENOTFOUND;
+
+	return git_buf_printf(key, "%s://%s%s%s:%s",
+		t->connection_data.use_ssl ? "https" : "http",
+		t->connection_data.user ? t->connection_data.user : "",
+		t->connection_data.user ? "@" : "",
+		t->connection_data.host,
+		t->connection_data.port);
+}
+
+static int http_connect(http_subtransport *t, bool use_pool)
+{
+	git_buf key = GIT_BUF_INIT;
 	int error;
 
 	if (t->connected &&
@@ -605,6 +632,18 @@ static int http_connect(http_subtransport *t)
 		t->connected = 0;
 	}
 
+	t->reused = 0;
+
+	if (use_pool && http_pool_key(&key, t) == 0 &&
+		git_transport_pool_take((void **)&t->io, key.ptr) == 0) {
+		git_buf_free(&key);
+		t->connected = 1;
+		t->reused = 1;
+		return 0;
+	}
+
+	git_buf_free(&key);
+
 	if (t->connection_data.use_ssl) {
 		error = git_tls_stream_new(&t->io, t->connection_data.host, t->connection_data.port);
 	} else {
@@ -676,6 +715,10 @@ replay:
 
 		if (git_stream_write(t->io, request.ptr, request.size, 0) < 0) {
 			git_buf_free(&request);
+
+			if (t->reused)
+				goto reconnect;
+
 			return -1;
 		}
 
@@ -723,9 +766,14 @@ replay:
 
 		data_offset = t->parse_buffer.offset;
 
-		if (gitno_recv(&t->parse_buffer) < 0)
+		if ((error = gitno_recv(&t->parse_buffer)) <= 0 && t->reused)
+			goto reconnect;
+
+		if (error < 0)
 			return -1;
 
+		t->reused = 0;
+
 		/* This call to http_parser_execute will result in invocations of the
 		 * on_* family of callbacks. The most interesting of these is
 		 * on_body_fill_buffer, which is called when data is ready to be copied
@@ -752,7 +800,7 @@ replay:
 		if (PARSE_ERROR_REPLAY == t->parse_error) {
 			s->sent_request = 0;
 
-			if ((error = http_connect(t)) < 0)
+			if ((error = http_connect(t, s->verb == get_verb)) < 0)
 				return error;
 
 			goto replay;
@@ -774,6 +822,18 @@ replay:
 	}
 
 	return 0;
+
+reconnect:
+	/* The server closed the pooled connection while it was idle,
+	 * send the request again on a new connection */
+	giterr_clear();
+	t->connected = 0;
+	s->sent_request = 0;
+
+	if (http_connect(t, false) < 0)
+		return -1;
+
+	goto replay;
 }
 
 static int http_stream_write_chunked(
@@ -1009,7 +1069,11 @@ static int http_action(
 		 (ret = gitno_connection_data_from_url(&t->connection_data, url, NULL)) < 0)
 		return ret;
 
-	if ((ret = http_connect(t)) < 0)
+	/* A pooled connection is only used for the GET of the refs, the
+	 * request can be sent again if the server has closed it */
+	if ((ret = http_connect(t,
+			action == GIT_SERVICE_UPLOADPACK_LS ||
+			action == GIT_SERVICE_RECEIVEPACK_LS)) < 0)
 		return ret;
 
 	switch (action) {
@@ -1034,8 +1098,20 @@ static int http_close(git_smart_subtransport *subtransport)
 {
 	http_subtransport *t = (http_subtransport *) subtransport;
 	git_http_auth_context *context;
+	git_buf key = GIT_BUF_INIT;
 	size_t i;
 
+	/* Keep the connection for the next transport to the host if the
+	 * last response was read and the server keeps the connection */
+	if (t->io && t->connected && t->parse_finished &&
+		http_should_keep_alive(&t->parser) &&
+		http_pool_key(&key, t) == 0) {
+		git_transport_pool_put(key.ptr, t->io, http_pool_free);
+		t->io = NULL;
+	}
+
+	git_buf_free(&key);
+
 	clear_parser_state(t);
 
 	t->connected = 0;
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) the libgit2 contributors. All rights reserved.
+ *
+ * This file is part of libgit2, distributed under the GNU GPL v2 with
+ * a Linking Exception. For full terms see the included COPYING file.
+ */
+
+#include "pool.h"
+#include "array.h"
+#include "global.h"
+#include "vector.h"
+
+#include <time.h>
+
+/* The maximum number of idle connections, the least recently used
+ * connection is freed when a connection is put in a full pool */
+#define GIT_TRANSPORT_POOL_MAX 16
+
+typedef struct {
+	char *key;
+	void *conn;
+	git_transport_pool_free_cb free_cb;
+	time_t last_used;
+} pool_entry;
+
+int git_transport_pool__timeout = 0;
+
+static git_mutex pool_lock;
+static git_vector pool_entries = GIT_VECTOR_INIT;
+
+static void pool_entry_free(pool_entry *entry)
+{
+	entry->free_cb(entry->conn);
+	git__free(entry->key);
+	git__free(entry);
+}
+
+/* Remove the connections that have been idle too long, or all
+ * connections if the pool is disabled. The lock must be held. */
+static void pool_expire(git_vector *expired, time_t now)
+{
+	pool_entry *entry;
+	size_t i = 0;
+
+	while (i < pool_entries.length) {
+		entry = git_vector_get(&pool_entries, i);
+		if (git_transport_pool__timeout <= 0 ||
+			now - entry->last_used >= git_transport_pool__timeout) {
+			git_vector_remove(&pool_entries, i);
+			if (git_vector_insert(expired, entry) < 0)
+				pool_entry_free(entry);
+		} else {
+			i++;
+		}
+	}
+}
+
+/* Free the expired connections outside the lock, closing a
+ * connection can block on the network. */
+static void pool_free_expired(git_vector *expired)
+{
+	pool_entry *entry;
+	size_t i;
+
+	git_vector_foreach(expired, i, entry)
+		pool_entry_free(entry);
+	git_vector_free(expired);
+}
+
+static void pool_global_shutdown(void)
+{
+	git_vector expired = GIT_VECTOR_INIT;
+
+	git_transport_pool__timeout = 0;
+	pool_expire(&expired, time(NULL));
+	pool_free_expired(&expired);
+	git_vector_free(&pool_entries);
+	git_mutex_free(&pool_lock);
+}
+
+int git_transport_pool_global_init(void)
+{
+	if (git_mutex_init(&pool_lock) < 0)
+		return -1;
+
+	git__on_shutdown(pool_global_shutdown);
+	return 0;
+}
+
+static int pool_lock_acquire(void)
+{
+	if (git_mutex_lock(&pool_lock) < 0) {
+		giterr_set(GITERR_OS, "failed to lock transport pool");
+		return -1;
+	}
+
+	return 0;
+}
+
+int git_transport_pool_set_timeout(int timeout)
+{
+	git_vector expired = GIT_VECTOR_INIT;
+
+	if (pool_lock_acquire() < 0)
+		return -1;
+
+	git_transport_pool__timeout = timeout > 0 ? timeout : 0;
+	pool_expire(&expired, time(NULL));
+	git_mutex_unlock(&pool_lock);
+
+	pool_free_expired(&expired);
+	return 0;
+}
+
+int git_transport_pool_take(void **out, const char *key)
+{
+	git_vector expired = GIT_VECTOR_INIT;
+	pool_entry *entry = NULL;
+	size_t i;
+
+	*out = NULL;
+
+	if (!git_transport_pool__timeout)
+		return GIT_ENOTFOUND;
+
+	if (pool_lock_acquire() < 0)
+		return -1;
+
+	pool_expire(&expired, time(NULL));
+
+	/* The entries are ordered by last use, take the newest */
+	for (i = pool_entries.length; i > 0; i--) {
+		pool_entry *e = git_vector_get(&pool_entries, i - 1);
+		if (!strcmp(e->key, key)) {
+			entry = e;
+			git_vector_remove(&pool_entries, i - 1);
+			break;
+		}
+	}
+
+	git_mutex_unlock(&pool_lock);
+	pool_free_expired(&expired);
+
+	if (!entry)
+		return GIT_ENOTFOUND;
+
+	*out = entry->conn;
+	git__free(entry->key);
+	git__free(entry);
+	return 0;
+}
+
+int git_transport_pool_put(
+	const char *key, void *conn, git_transport_pool_free_cb free_cb)
+{
+	git_vector expired = GIT_VECTOR_INIT;
+	pool_entry *entry;
+	int error = 0;
+
+	if (!git_transport_pool__timeout) {
+		free_cb(conn);
+		return -1;
+	}
+
+	entry = git__calloc(1, sizeof(pool_entry));
+	if (!entry || (entry->key = git__strdup(key)) == NULL) {
+		git__free(entry);
+		free_cb(conn);
+		return -1;
+	}
+
+	entry->conn = conn;
+	entry->free_cb = free_cb;
+	entry->last_used = time(NULL);
+
+	if (pool_lock_acquire() < 0) {
+		pool_entry_free(entry);
+		return -1;
+	}
+
+	pool_expire(&expired, entry->last_used);
+
+	if (pool_entries.length >= GIT_TRANSPORT_POOL_MAX) {
+		pool_entry *oldest = git_vector_get(&pool_entries, 0);
+		git_vector_remove(&pool_entries, 0);
+		if (git_vector_insert(&expired, oldest) < 0)
+			pool_entry_free(oldest);
+	}
+
+	error = git_vector_insert(&pool_entries, entry);
+	git_mutex_unlock(&pool_lock);
+
+	if (error < 0)
+		pool_entry_free(entry);
+	pool_free_expired(&expired);
+
+	return error;
+}
+
+int git_transport_pool_foreach(
+	git_transport_pool_foreach_cb cb, void *payload)
+{
+	git_vector expired = GIT_VECTOR_INIT, keys = GIT_VECTOR_INIT;
+	git_array_t(int) idle = GIT_ARRAY_INIT;
+	pool_entry *entry;
+	time_t now = time(NULL);
+	char *key;
+	size_t i;
+	int error = 0;
+
+	if (pool_lock_acquire() < 0)
+		return -1;
+
+	pool_expire(&expired, now);
+
+	/* Copy the keys, the callback is called without the lock */
+	git_vector_foreach(&pool_entries, i, entry) {
+		int *n;
+		if ((key = git__strdup(entry->key)) == NULL) {
+			error = -1;
+			break;
+		}
+		if (git_vector_insert(&keys, key) < 0) {
+			git__free(key);
+			error = -1;
+			break;
+		}
+		if ((n = git_array_alloc(idle)) == NULL) {
+			error = -1;
+			break;
+		}
+		*n = (int)(now - entry->last_used);
+	}
+
+	git_mutex_unlock(&pool_lock);
+	pool_free_expired(&expired);
+
+	git_vector_foreach(&keys, i, key) {
+		if (!error && (error = cb(key, *git_array_get(idle, i), payload)) != 0)
+			giterr_set_after_callback(error);
+	}
+
+	git_vector_free_deep(&keys);
+	git_array_clear(idle);
+	return error;
+}
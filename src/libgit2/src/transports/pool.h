@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) the libgit2 contributors. All rights reserved.
+ *
+ * This file is part of libgit2, distributed under the GNU GPL v2 with
+ * a Linking Exception. For full terms see the included COPYING file.
+ */
+#ifndef INCLUDE_transports_pool_h__
+#define INCLUDE_transports_pool_h__
+
+#include "common.h"
+
+/**
+ * A pool of idle connections, e.g. HTTP keep-alive streams and
+ * authenticated SSH sessions, that a transport can take instead of
+ * connecting again. A connection is put in the pool when the
+ * transport that used it is closed, and is freed when it has been
+ * idle for `git_transport_pool__timeout` seconds. The pool is
+ * disabled when the timeout is zero, which is the default.
+ */
+
+typedef void (*git_transport_pool_free_cb)(void *conn);
+
+typedef int (*git_transport_pool_foreach_cb)(
+	const char *key, int idle, void *payload);
+
+extern int git_transport_pool__timeout;
+
+extern int git_transport_pool_global_init(void);
+
+/**
+ * Set the idle timeout, a timeout of zero frees all connections.
+ */
+extern int git_transport_pool_set_timeout(int timeout);
+
+/**
+ * Take the most recently used connection for `key` from the pool.
+ *
+ * @return 0 on success, GIT_ENOTFOUND if there is no connection
+ */
+extern int git_transport_pool_take(void **out, const char *key);
+
+/**
+ * Put a connection in the pool. The pool owns the connection, also
+ * on error, and frees it with `free_cb`.
+ *
+ * @return 0 on success, -1 if the connection was freed
+ */
+extern int git_transport_pool_put(
+	const char *key, void *conn, git_transport_pool_free_cb free_cb);
+
+/**
+ * Call `cb` with the key and idle seconds of each connection.
+ */
+extern int git_transport_pool_foreach(
+	git_transport_pool_foreach_cb cb, void *payload);
+
+#endif
@@ -9,6 +9,7 @@
 #include "refs.h"
 #include "refspec.h"
 #include "proxy.h"
+#include "trace.h"
 
 static int git_smart__recv_cb(gitno_buffer *buf)
 {
@@ -283,6 +284,18 @@ static int git_smart__connect(
 	/* Keep a list of heads for _ls */
 	git_smart__update_heads(t, &symrefs);
 
+	git_trace(GIT_TRACE_DEBUG,
+		"smart: connected to %s, %"PRIuZ" refs, caps%s%s%s%s%s%s",
+		t->url, t->heads.length,
+		t->caps.multi_ack_detailed ? " multi_ack_detailed" :
+		t->caps.multi_ack ? " multi_ack" : "",
+		t->caps.side_band_64k ? " side-band-64k" :
+		t->caps.side_band ? " side-band" : "",
+		t->caps.ofs_delta ? " ofs-delta" : "",
+		t->caps.thin_pack ? " thin-pack" : "",
+		t->caps.include_tag ? " include-tag" : "",
+		t->caps.report_status ? " report-status" : "");
+
 	free_symrefs(&symrefs);
 
 	if (t->rpc && git_smart__reset_stream(t, false) < 0)
@@ -24,6 +24,7 @@
 #define GIT_CAP_DELETE_REFS "delete-refs"
 #define GIT_CAP_REPORT_STATUS "report-status"
 #define GIT_CAP_THIN_PACK "thin-pack"
+#define GIT_CAP_NO_THIN "no-thin"
 #define GIT_CAP_SYMREF "symref"
 
 extern bool git_smart__ofs_delta_enabled;
@@ -124,7 +125,8 @@ typedef struct transport_smart_caps {
 		include_tag:1,
 		delete_refs:1,
 		report_status:1,
-		thin_pack:1;
+		thin_pack:1,
+		no_thin:1;
 } transport_smart_caps;
 
 typedef int (*packetsize_cb)(size_t received, void *payload);
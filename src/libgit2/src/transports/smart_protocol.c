@@ -14,6 +14,7 @@
 #include "pack-objects.h"
 #include "remote.h"
 #include "util.h"
+#include "trace.h"
 
 #define NETWORK_XFER_THRESHOLD (100*1024)
 /* The minimal interval between progress updates (in seconds). */
@@ -190,6 +191,12 @@ int git_smart__detect_caps(git_pkt_ref *pkt, transport_smart_caps *caps, git_vec
 			continue;
 		}
 
+		if (!git__prefixcmp(ptr, GIT_CAP_NO_THIN)) {
+			caps->common = caps->no_thin = 1;
+			ptr += strlen(GIT_CAP_NO_THIN);
+			continue;
+		}
+
 		if (!git__prefixcmp(ptr, GIT_CAP_SYMREF)) {
 			int error;
 
@@ -352,6 +359,8 @@ int git_smart__negotiate_fetch(git_transport *transport, git_repository *repo, c
 	if ((error = fetch_setup_walk(&walk, repo)) < 0)
 		goto on_error;
 
+	git_trace(GIT_TRACE_DEBUG, "negotiate: %"PRIuZ" wants", count);
+
 	/*
 	 * Our support for ACK extensions is simply to parse them. On
 	 * the first ACK we will accept that as enough common
@@ -384,6 +393,9 @@ int git_smart__negotiate_fetch(git_transport *transport, git_repository *repo, c
 				goto on_error;
 			}
 
+			git_trace(GIT_TRACE_TRACE, "negotiate: sending haves %u to %u",
+				i - 19, i);
+
 			if ((error = git_smart__negotiation_step(&t->parent, data.ptr, data.size)) < 0)
 				goto on_error;
 
@@ -454,6 +466,9 @@ int git_smart__negotiate_fetch(git_transport *transport, git_repository *repo, c
 	if ((error = git_pkt_buffer_done(&data)) < 0)
 		goto on_error;
 
+	git_trace(GIT_TRACE_DEBUG, "negotiate: done after %u haves, %"PRIuZ" common",
+		i, t->common.length);
+
 	if (t->cancelled.val) {
 		giterr_set(GITERR_NET, "The fetch was cancelled by the user");
 		error = GIT_EUSER;
@@ -636,6 +651,10 @@ int git_smart__download_pack(
 
 	error = writepack->commit(writepack, stats);
 
+	if (!error)
+		git_trace(GIT_TRACE_DEBUG, "download: %u objects, %u local objects",
+			stats->received_objects, stats->local_objects);
+
 done:
 	if (writepack)
 		writepack->free(writepack);
@@ -992,7 +1011,7 @@ static int stream_thunk(void *buf, size_t size, void *data)
 
 		if ((current_time - payload->last_progress_report_time) >= MIN_PROGRESS_UPDATE_INTERVAL) {
 			payload->last_progress_report_time = current_time;
-			error = payload->cb(payload->pb->nr_written, payload->pb->nr_objects, payload->last_bytes, payload->cb_payload);
+			error = payload->cb(payload->pb->nr_written, git_packbuilder_object_count(payload->pb), payload->last_bytes, payload->cb_payload);
 		}
 	}
 
@@ -1010,6 +1029,10 @@ int git_smart__push(git_transport *transport, git_push *push, const git_remote_c
 
 	packbuilder_payload.pb = push->pb;
 
+	/* The server can't resolve deltas against objects it has */
+	if (t->caps.no_thin)
+		push->pb->thin = false;
+
 	if (cbs && cbs->push_transfer_progress) {
 		packbuilder_payload.cb = cbs->push_transfer_progress;
 		packbuilder_payload.cb_payload = cbs->payload;
@@ -1066,7 +1089,7 @@ int git_smart__push(git_transport *transport, git_push *push, const git_remote_c
 	if (cbs && cbs->push_transfer_progress) {
 		error = cbs->push_transfer_progress(
 					push->pb->nr_written,
-					push->pb->nr_objects,
+					git_packbuilder_object_count(push->pb),
 					packbuilder_payload.last_bytes,
 					cbs->payload);
 
@@ -17,6 +17,8 @@
 #include "cred.h"
 #include "socket_stream.h"
 #include "ssh.h"
+#include "pool.h"
+#include "hash.h"
 
 #ifdef GIT_SSH
 
@@ -34,9 +36,21 @@ typedef struct {
 	LIBSSH2_CHANNEL *channel;
 	const char *cmd;
 	char *url;
-	unsigned sent_command : 1;
+	char *pool_key;
+	char *identity;
+	int auth_methods;
+	unsigned sent_command : 1,
+		failed : 1;
 } ssh_stream;
 
+/* An authenticated session in the transport pool */
+typedef struct {
+	git_stream *io;
+	LIBSSH2_SESSION *session;
+	char *identity;
+	int auth_methods;
+} ssh_pooled;
+
 typedef struct {
 	git_smart_subtransport parent;
 	transport_smart *owner;
@@ -133,11 +147,14 @@ static int ssh_stream_read(
 
 	*bytes_read = 0;
 
-	if (!s->sent_command && send_command(s) < 0)
+	if (!s->sent_command && send_command(s) < 0) {
+		s->failed = 1;
 		return -1;
+	}
 
 	if ((rc = libssh2_channel_read(s->channel, buffer, buf_size)) < LIBSSH2_ERROR_NONE) {
 		ssh_error(s->session, "SSH could not read data");
+		s->failed = 1;
 		return -1;
 	}
 
@@ -149,9 +166,11 @@ static int ssh_stream_read(
 	if (rc == 0) {
 		if ((rc = libssh2_channel_read_stderr(s->channel, buffer, buf_size)) > 0) {
 			giterr_set(GITERR_SSH, "%*s", rc, buffer);
+			s->failed = 1;
 			return GIT_EEOF;
 		} else if (rc < LIBSSH2_ERROR_NONE) {
 			ssh_error(s->session, "SSH could not read stderr");
+			s->failed = 1;
 			return -1;
 		}
 	}
@@ -171,8 +190,10 @@ static int ssh_stream_write(
 	size_t off = 0;
 	ssize_t ret = 0;
 
-	if (!s->sent_command && send_command(s) < 0)
+	if (!s->sent_command && send_command(s) < 0) {
+		s->failed = 1;
 		return -1;
+	}
 
 	do {
 		ret = libssh2_channel_write(s->channel, buffer + off, len - off);
@@ -185,12 +206,50 @@ static int ssh_stream_write(
 
 	if (ret < 0) {
 		ssh_error(s->session, "SSH could not write data");
+		s->failed = 1;
 		return -1;
 	}
 
 	return 0;
 }
 
+static void ssh_pool_free(void *conn)
+{
+	ssh_pooled *p = conn;
+
+	libssh2_session_free(p->session);
+	git_stream_close(p->io);
+	git_stream_free(p->io);
+	git__free(p->identity);
+	git__free(p);
+}
+
+/* Put the session of a stream in the transport pool, if the stream
+ * ended without errors and the credentials can be compared */
+static void ssh_pool_put(ssh_stream *s)
+{
+	ssh_pooled *p;
+
+	if (!s->pool_key || !s->identity || s->failed ||
+		!s->session || !s->io ||
+		(p = git__calloc(1, sizeof(ssh_pooled))) == NULL) {
+		giterr_clear();
+		return;
+	}
+
+	p->io = s->io;
+	p->session = s->session;
+	p->identity = s->identity;
+	p->auth_methods = s->auth_methods;
+
+	s->io = NULL;
+	s->session = NULL;
+	s->identity = NULL;
+
+	git_transport_pool_put(s->pool_key, p, ssh_pool_free);
+	giterr_clear();
+}
+
 static void ssh_stream_free(git_smart_subtransport_stream *stream)
 {
 	ssh_stream *s = (ssh_stream *)stream;
@@ -203,11 +262,14 @@ static void ssh_stream_free(git_smart_subtransport_stream *stream)
 	t->current_stream = NULL;
 
 	if (s->channel) {
-		libssh2_channel_close(s->channel);
+		if (libssh2_channel_close(s->channel) < 0)
+			s->failed = 1;
 		libssh2_channel_free(s->channel);
 		s->channel = NULL;
 	}
 
+	ssh_pool_put(s);
+
 	if (s->session) {
 		libssh2_session_free(s->session);
 		s->session = NULL;
@@ -220,6 +282,8 @@ static void ssh_stream_free(git_smart_subtransport_stream *stream)
 	}
 
 	git__free(s->url);
+	git__free(s->pool_key);
+	git__free(s->identity);
 	git__free(s);
 }
 
@@ -467,6 +531,107 @@ static int request_creds(git_cred **out, ssh_subtransport *t, const char *user,
 	return 0;
 }
 
+static int ssh_identity_secret(git_buf *out, const char *secret)
+{
+	char hex[GIT_OID_HEXSZ + 1];
+	git_oid oid;
+
+	if (!secret)
+		return git_buf_puts(out, ":");
+
+	if (git_hash_buf(&oid, secret, strlen(secret)) < 0)
+		return -1;
+
+	git_oid_tostr(hex, sizeof(hex), &oid);
+	return git_buf_printf(out, ":%s", hex);
+}
+
+/*
+ * A string that is equal for equal credentials, with the secrets
+ * hashed. Credentials with callbacks cannot be compared, so a
+ * session that was authenticated with them is not pooled.
+ */
+static int ssh_cred_identity(char **out, git_cred *cred)
+{
+	git_buf buf = GIT_BUF_INIT;
+
+	*out = NULL;
+
+	switch (cred->credtype) {
+	case GIT_CREDTYPE_USERPASS_PLAINTEXT: {
+		git_cred_userpass_plaintext *c = (git_cred_userpass_plaintext *)cred;
+
+		git_buf_printf(&buf, "password:%s", c->username);
+		ssh_identity_secret(&buf, c->password);
+		break;
+	}
+	case GIT_CREDTYPE_SSH_KEY: {
+		git_cred_ssh_key *c = (git_cred_ssh_key *)cred;
+
+		if (!c->privatekey) {
+			git_buf_printf(&buf, "agent:%s", c->username);
+		} else {
+			git_buf_printf(&buf, "key:%s:%s:%s", c->username,
+				c->publickey ? c->publickey : "", c->privatekey);
+			ssh_identity_secret(&buf, c->passphrase);
+		}
+		break;
+	}
+	default:
+		return GIT_ENOTFOUND;
+	}
+
+	if (git_buf_oom(&buf))
+		return -1;
+
+	*out = git_buf_detach(&buf);
+	return 0;
+}
+
+/*
+ * Take an authenticated session from the transport pool, if the
+ * credentials are the same as those that authenticated it. The
+ * credentials are requested if `cred` is not set, and are kept in
+ * `cred` if they differ.
+ */
+static int ssh_pool_take(
+	LIBSSH2_SESSION **session,
+	git_cred **cred,
+	ssh_subtransport *t,
+	ssh_stream *s,
+	const char *user)
+{
+	ssh_pooled *p;
+	char *identity = NULL;
+	int error;
+
+	if (git_transport_pool_take((void **)&p, s->pool_key) < 0)
+		return GIT_ENOTFOUND;
+
+	if (!*cred && (error = request_creds(cred, t, user, p->auth_methods)) < 0) {
+		git_transport_pool_put(s->pool_key, p, ssh_pool_free);
+		return error;
+	}
+
+	if (ssh_cred_identity(&identity, *cred) < 0 ||
+		strcmp(identity, p->identity)) {
+		git__free(identity);
+		git_transport_pool_put(s->pool_key, p, ssh_pool_free);
+		giterr_clear();
+		return GIT_ENOTFOUND;
+	}
+
+	git__free(identity);
+
+	s->io = p->io;
+	s->identity = p->identity;
+	s->auth_methods = p->auth_methods;
+	*session = p->session;
+	git__free(p);
+
+	return 0;
+}
+
 static int _git_ssh_session_create(
 	LIBSSH2_SESSION** session,
 	git_stream *io)
@@ -500,6 +665,29 @@ static int _git_ssh_session_create(
 	return 0;
 }
 
+static int ssh_request_user(
+	char **user,
+	git_cred **cred,
+	ssh_subtransport *t,
+	const char *pass)
+{
+	int error;
+
+	if (!*user) {
+		if ((error = request_creds(cred, t, NULL, GIT_CREDTYPE_USERNAME)) < 0)
+			return error;
+
+		*user = git__strdup(((git_cred_username *) *cred)->username);
+		(*cred)->free(*cred);
+		*cred = NULL;
+		GITERR_CHECK_ALLOC(*user);
+	} else if (pass) {
+		return git_cred_userpass_plaintext_new(cred, *user, pass);
+	}
+
+	return 0;
+}
+
 static int _git_ssh_setup_conn(
 	ssh_subtransport *t,
 	const char *url,
@@ -541,6 +729,39 @@ static int _git_ssh_setup_conn(
 	GITERR_CHECK_ALLOC(port);
 
 post_extract:
+	if (git_transport_pool__timeout) {
+		git_buf key = GIT_BUF_INIT;
+
+		/* The pooled sessions are looked up by username */
+		if ((error = ssh_request_user(&user, &cred, t, pass)) < 0)
+			goto done;
+
+		if ((error = git_buf_printf(&key, "ssh://%s@%s:%s", user, host, port)) < 0)
+			goto done;
+		s->pool_key = git_buf_detach(&key);
+
+		error = ssh_pool_take(&session, &cred, t, s, user);
+		if (!error) {
+			channel = libssh2_channel_open_session(session);
+			if (channel)
+				goto channel_open;
+
+			/* The server closed the session while it was idle */
+			libssh2_session_free(session);
+			session = NULL;
+			git_stream_close(s->io);
+			git_stream_free(s->io);
+			s->io = NULL;
+			git__free(s->identity);
+			s->identity = NULL;
+			giterr_clear();
+		} else if (error != GIT_ENOTFOUND) {
+			goto done;
+		}
+
+		error = 0;
+	}
+
 	if ((error = git_socket_stream_new(&s->io, host, port)) < 0 ||
 	    (error = git_stream_connect(s->io)) < 0)
 		goto done;
@@ -587,19 +808,8 @@ post_extract:
 	}
 
 	/* we need the username to ask for auth methods */
-	if (!user) {
-		if ((error = request_creds(&cred, t, NULL, GIT_CREDTYPE_USERNAME)) < 0)
-			goto done;
-
-		user = git__strdup(((git_cred_username *) cred)->username);
-		cred->free(cred);
-		cred = NULL;
-		if (!user)
-			goto done;
-	} else if (user && pass) {
-		if ((error = git_cred_userpass_plaintext_new(&cred, user, pass)) < 0)
-			goto done;
-	}
+	if (!s->pool_key && (error = ssh_request_user(&user, &cred, t, pass)) < 0)
+		goto done;
 
 	if ((error = list_auth_methods(&auth_methods, session, user)) < 0)
 		goto done;
@@ -630,6 +840,11 @@ post_extract:
 	if (error < 0)
 		goto done;
 
+	/* Remember the credentials to put the session in the pool */
+	s->auth_methods = auth_methods;
+	if (s->pool_key && ssh_cred_identity(&s->identity, cred) < 0)
+		giterr_clear();
+
 	channel = libssh2_channel_open_session(session);
 	if (!channel) {
 		error = -1;
@@ -637,6 +852,7 @@ post_extract:
 		goto done;
 	}
 
+channel_open:
 	libssh2_channel_set_blocking(channel, 1);
 
 	s->session = session;
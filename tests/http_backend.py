@@ -0,0 +1,122 @@
+# git2r, R bindings to the libgit2 library.
+# Copyright (C) 2013-2018 The git2r contributors
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License, version 2,
+# as published by the Free Software Foundation.
+#
+# git2r is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+# A local HTTP server for the network tests, that runs
+# 'git http-backend' for the repositories in a directory.
+#
+# Usage: python3 http_backend.py <root> <dir>
+#
+# The server listens on a free port of 127.0.0.1 and keeps the
+# connections alive. When it's ready, it writes the process id to
+# '<dir>/pid' and the port to '<dir>/port'. If '<dir>/password'
+# exists, the requests must authenticate with basic authentication
+# with the 'user:password' in the file, which is read for each
+# request. Each new connection adds a line to '<dir>/connections'.
+
+import base64
+import os
+import subprocess
+import sys
+import urllib.parse
+from http.server import BaseHTTPRequestHandler, HTTPServer
+from socketserver import ThreadingMixIn
+
+root, state = sys.argv[1], sys.argv[2]
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def setup(self):
+        BaseHTTPRequestHandler.setup(self)
+        with open(os.path.join(state, "connections"), "a") as f:
+            f.write("%s:%d\n" % self.client_address)
+
+    def log_message(self, format, *args):
+        pass
+
+    def authorized(self):
+        path = os.path.join(state, "password")
+        if not os.path.exists(path):
+            return True
+        with open(path) as f:
+            userpass = f.read().strip().encode()
+        expected = "Basic " + base64.b64encode(userpass).decode()
+        return self.headers.get("Authorization") == expected
+
+    def body(self):
+        if self.headers.get("Transfer-Encoding") == "chunked":
+            body = b""
+            while True:
+                size = int(self.rfile.readline().strip(), 16)
+                if not size:
+                    self.rfile.readline()
+                    return body
+                body += self.rfile.read(size)
+                self.rfile.readline()
+        return self.rfile.read(int(self.headers.get("Content-Length") or 0))
+
+    def backend(self):
+        body = self.body()
+        if not self.authorized():
+            self.send_response(401)
+            self.send_header("WWW-Authenticate", 'Basic realm="git2r"')
+            self.send_header("Content-Length", "0")
+            self.end_headers()
+            return
+
+        url = urllib.parse.urlsplit(self.path)
+        env = dict(os.environ,
+                   GIT_PROJECT_ROOT=root,
+                   GIT_HTTP_EXPORT_ALL="1",
+                   REQUEST_METHOD=self.command,
+                   PATH_INFO=url.path,
+                   QUERY_STRING=url.query,
+                   CONTENT_TYPE=self.headers.get("Content-Type", ""),
+                   CONTENT_LENGTH=str(len(body)),
+                   REMOTE_USER="git2r",
+                   REMOTE_ADDR=self.client_address[0])
+        output = subprocess.run(["git", "http-backend"], input=body, env=env,
+                                stdout=subprocess.PIPE).stdout
+        header, _, data = output.partition(b"\r\n\r\n")
+        status, fields = 200, []
+        for line in header.decode().split("\r\n"):
+            name, _, value = line.partition(":")
+            if name.lower() == "status":
+                status = int(value.split()[0])
+            elif name:
+                fields.append((name, value.strip()))
+        self.send_response(status)
+        for name, value in fields:
+            self.send_header(name, value)
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+    do_GET = backend
+    do_POST = backend
+
+
+class Server(ThreadingMixIn, HTTPServer):
+    daemon_threads = True
+
+
+server = Server(("127.0.0.1", 0), Handler)
+for name, value in (("pid", os.getpid()), ("port", server.server_port)):
+    with open(os.path.join(state, name + ".tmp"), "w") as f:
+        f.write("%d\n" % value)
+    os.rename(os.path.join(state, name + ".tmp"), os.path.join(state, name))
+server.serve_forever()